@@ -78,6 +78,59 @@ public:
 		}
 	}
 
+	// the tree is rebuilt in the background once its SAH cost is this many times the cost of a fresh build,
+	// zero disables rebuilds
+	void params_set_rebuild_threshold(real_t p_value) {
+		tree._rebuild_threshold = p_value;
+	}
+
+	// when at least this many items have changed, pairing culls them on worker threads, zero disables
+	void params_set_pairing_thread_threshold(uint32_t p_threshold) {
+		_pairing_thread_threshold = p_threshold;
+	}
+
+	// SAH cost of the trees at the last quality check, relative to the cost of their last fresh build
+	real_t get_quality_ratio() const {
+		real_t ratio = 1.0;
+		for (int n = 0; n < BVHTREE_CLASS::NUM_TREES; n++) {
+			if (tree._rebuild_cost_baseline[n] > 0.0) {
+				ratio = MAX(ratio, tree._rebuild_cost[n] / tree._rebuild_cost_baseline[n]);
+			}
+		}
+		return ratio;
+	}
+
+	// bound of all the items including the node expansion, false if there are no items
+	bool get_bounds(Bounds &r_bounds) const {
+		BVHABB_CLASS abb;
+		bool found = false;
+
+		for (int n = 0; n < BVHTREE_CLASS::NUM_TREES; n++) {
+			uint32_t root_id = tree._root_node_id[n];
+			if (root_id == BVHCommon::INVALID) {
+				continue;
+			}
+
+			// an empty root leaf has an undefined bound
+			const typename BVHTREE_CLASS::TNode &root = tree._nodes[root_id];
+			if (root.is_leaf() && !tree._node_get_leaf(root).num_items) {
+				continue;
+			}
+
+			if (found) {
+				abb.merge(root.aabb);
+			} else {
+				abb = root.aabb;
+				found = true;
+			}
+		}
+
+		if (found) {
+			abb.to(r_bounds);
+		}
+		return found;
+	}
+
 	void set_pair_callback(PairCallback p_callback, void *p_userdata) {
 		pair_callback = p_callback;
 		pair_callback_userdata = p_userdata;
@@ -307,7 +360,8 @@ public:
 	}
 
 	// cull tests
-	int cull_aabb(const Bounds &p_aabb, T **p_result_array, int p_result_max, int *p_subindex_array = nullptr, uint32_t p_mask = 0xFFFFFFFF) {
+	// r_hits is scratch space for the intermediate hits, which allows culling from several threads at once.
+	int cull_aabb(const Bounds &p_aabb, T **p_result_array, int p_result_max, int *p_subindex_array = nullptr, uint32_t p_mask = 0xFFFFFFFF, LocalVector<uint32_t, uint32_t, true> *r_hits = nullptr) {
 		typename BVHTREE_CLASS::CullParams params;
 
 		params.result_count_overall = 0;
@@ -318,13 +372,14 @@ public:
 		params.pairable_type = 0;
 		params.test_pairable_only = false;
 		params.abb.from(p_aabb);
+		params.hits = r_hits;
 
 		tree.cull_aabb(params);
 
 		return params.result_count_overall;
 	}
 
-	int cull_segment(const Point &p_from, const Point &p_to, T **p_result_array, int p_result_max, int *p_subindex_array = nullptr, uint32_t p_mask = 0xFFFFFFFF) {
+	int cull_segment(const Point &p_from, const Point &p_to, T **p_result_array, int p_result_max, int *p_subindex_array = nullptr, uint32_t p_mask = 0xFFFFFFFF, LocalVector<uint32_t, uint32_t, true> *r_hits = nullptr) {
 		typename BVHTREE_CLASS::CullParams params;
 
 		params.result_count_overall = 0;
@@ -336,13 +391,14 @@ public:
 
 		params.segment.from = p_from;
 		params.segment.to = p_to;
+		params.hits = r_hits;
 
 		tree.cull_segment(params);
 
 		return params.result_count_overall;
 	}
 
-	int cull_point(const Point &p_point, T **p_result_array, int p_result_max, int *p_subindex_array = nullptr, uint32_t p_mask = 0xFFFFFFFF) {
+	int cull_point(const Point &p_point, T **p_result_array, int p_result_max, int *p_subindex_array = nullptr, uint32_t p_mask = 0xFFFFFFFF, LocalVector<uint32_t, uint32_t, true> *r_hits = nullptr) {
 		typename BVHTREE_CLASS::CullParams params;
 
 		params.result_count_overall = 0;
@@ -353,6 +409,7 @@ public:
 		params.pairable_type = 0;
 
 		params.point = p_point;
+		params.hits = r_hits;
 
 		tree.cull_point(params);
 		return params.result_count_overall;
@@ -394,6 +451,11 @@ private:
 			return;
 		}
 
+		if (_pairing_thread_threshold && changed_items.size() >= _pairing_thread_threshold && WorkerThreadPool::get_singleton() && WorkerThreadPool::get_singleton()->get_thread_count() > 1) {
+			_check_for_collisions_threaded(p_full_check);
+			return;
+		}
+
 		Bounds bb;
 
 		typename BVHTREE_CLASS::CullParams params;
@@ -455,6 +517,81 @@ private:
 		_reset();
 	}
 
+	// Culling is the expensive part of pairing and only reads the tree, so the changed items are culled
+	// in chunks on worker threads. Each chunk keeps its own hits, which are then processed serially in the
+	// order of the changed items, so the pair callbacks happen in the same order as the serial version.
+	void _check_for_collisions_threaded(bool p_full_check) {
+		uint32_t item_count = changed_items.size();
+		uint32_t chunk_count = (item_count + PAIRING_CHUNK_SIZE - 1) / PAIRING_CHUNK_SIZE;
+
+		if (_pairing_chunks.size() < chunk_count) {
+			_pairing_chunks.resize(chunk_count);
+		}
+
+		for (uint32_t c = 0; c < chunk_count; c++) {
+			PairingChunk &chunk = _pairing_chunks[c];
+			chunk.first_item = c * PAIRING_CHUNK_SIZE;
+			chunk.item_count = MIN((uint32_t)PAIRING_CHUNK_SIZE, item_count - chunk.first_item);
+		}
+
+		WorkerThreadPool::get_singleton()->do_work(chunk_count, this, &BVH_Manager::_pairing_cull_chunk, (void *)nullptr);
+
+		for (uint32_t c = 0; c < chunk_count; c++) {
+			const PairingChunk &chunk = _pairing_chunks[c];
+			uint32_t hits_start = 0;
+
+			for (uint32_t i = 0; i < chunk.item_count; i++) {
+				const BVHHandle &h = changed_items[chunk.first_item + i];
+
+				BVHABB_CLASS abb;
+				abb.from(tree._pairs[h.id()].expanded_aabb);
+				_find_leavers(h, abb, p_full_check);
+
+				uint32_t hits_end = chunk.item_hits_end[i];
+				for (uint32_t n = hits_start; n < hits_end; n++) {
+					BVHHandle h_collidee;
+					h_collidee.set_id(chunk.hits[n]);
+					_collide(h, h_collidee);
+				}
+				hits_start = hits_end;
+			}
+		}
+		_reset();
+	}
+
+	void _pairing_cull_chunk(uint32_t p_chunk, void *p_userdata) {
+		PairingChunk &chunk = _pairing_chunks[p_chunk];
+		chunk.hits.clear();
+		chunk.item_hits_end.resize(chunk.item_count);
+
+		LocalVector<uint32_t, uint32_t, true> &hits = chunk.cull_hits;
+
+		typename BVHTREE_CLASS::CullParams params;
+		params.result_count_overall = 0;
+		params.result_max = INT_MAX;
+		params.result_array = nullptr;
+		params.subindex_array = nullptr;
+		params.hits = &hits;
+
+		for (uint32_t i = 0; i < chunk.item_count; i++) {
+			const BVHHandle &h = changed_items[chunk.first_item + i];
+			uint32_t changed_item_ref_id = h.id();
+
+			tree.item_fill_cullparams(h, params);
+			params.abb.from(tree._pairs[changed_item_ref_id].expanded_aabb);
+			params.result_count_overall = 0;
+			tree.cull_aabb(params, false);
+
+			for (unsigned int n = 0; n < hits.size(); n++) {
+				// don't collide against ourself
+				if (hits[n] != changed_item_ref_id) {
+					chunk.hits.push_back(hits[n]);
+				}
+			}
+			chunk.item_hits_end[i] = chunk.hits.size();
+		}
+	}
+
 public:
 	void item_get_AABB(BVHHandle p_handle, Bounds &r_aabb) {
 		BVHABB_CLASS abb;
@@ -680,6 +817,22 @@ private:
 	LocalVector<BVHHandle, uint32_t, true> changed_items;
 	uint32_t _tick;
 
+	enum {
+		PAIRING_CHUNK_SIZE = 64,
+	};
+
+	// changed items [first_item, first_item + item_count) and their hits, culled by one worker task
+	struct PairingChunk {
+		uint32_t first_item = 0;
+		uint32_t item_count = 0;
+		LocalVector<uint32_t, uint32_t, true> item_hits_end; // per item, end of its hits
+		LocalVector<uint32_t, uint32_t, true> hits;
+		LocalVector<uint32_t, uint32_t, true> cull_hits; // scratch for the cull
+	};
+
+	LocalVector<PairingChunk> _pairing_chunks;
+	uint32_t _pairing_thread_threshold = 0;
+
 public:
 	BVH_Manager() {
 		_tick = 1; // start from 1 so items with 0 indicate never updated
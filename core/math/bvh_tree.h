@@ -43,9 +43,11 @@
 #include "core/math/bvh_abb.h"
 #include "core/math/geometry_3d.h"
 #include "core/math/vector3.h"
+#include "core/os/worker_thread_pool.h"
 #include "core/string/print_string.h"
 #include "core/templates/local_vector.h"
 #include "core/templates/pooled_list.h"
+#include "core/templates/sort_array.h"
 #include <limits.h>
 
 #define BVHABB_CLASS BVH_ABB<Bounds, Point>
@@ -167,6 +169,10 @@ public:
 		_leaves.request(dummy_leaf_id);
 	}
 
+	~BVH_Tree() {
+		_rebuild_cancel();
+	}
+
 private:
 	bool node_add_child(uint32_t p_node_id, uint32_t p_child_node_id) {
 		TNode &tnode = _nodes[p_node_id];
@@ -412,6 +418,7 @@ private:
 #include "bvh_logic.inc"
 #include "bvh_misc.inc"
 #include "bvh_public.inc"
+#include "bvh_rebuild.inc"
 #include "bvh_refit.inc"
 #include "bvh_split.inc"
 };
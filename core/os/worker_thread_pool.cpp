@@ -0,0 +1,376 @@
+/*************************************************************************/
+/*  worker_thread_pool.cpp                                               */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2021 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2021 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "worker_thread_pool.h"
+
+#include "core/os/os.h"
+
+WorkerThreadPool *WorkerThreadPool::singleton = nullptr;
+thread_local int WorkerThreadPool::current_thread_index = -1;
+
+void WorkerThreadPool::TaskQueue::push(Task *p_task) {
+	MutexLock lock(mutex);
+	tasks.push_back(p_task);
+}
+
+WorkerThreadPool::Task *WorkerThreadPool::TaskQueue::pop() {
+	MutexLock lock(mutex);
+	if (head == tasks.size()) {
+		return nullptr;
+	}
+	Task *task = tasks[tasks.size() - 1];
+	tasks.resize(tasks.size() - 1);
+	if (head == tasks.size()) {
+		tasks.clear();
+		head = 0;
+	}
+	return task;
+}
+
+WorkerThreadPool::Task *WorkerThreadPool::TaskQueue::steal() {
+	MutexLock lock(mutex);
+	if (head == tasks.size()) {
+		return nullptr;
+	}
+	Task *task = tasks[head++];
+	if (head == tasks.size()) {
+		tasks.clear();
+		head = 0;
+	}
+	return task;
+}
+
+void WorkerThreadPool::_thread_function(void *p_user) {
+	ThreadData *thread_data = static_cast<ThreadData *>(p_user);
+	current_thread_index = thread_data->index;
+
+	while (true) {
+		singleton->task_available_semaphore.wait();
+		if (singleton->exit_threads.load(std::memory_order_acquire)) {
+			break;
+		}
+		// Drain everything reachable before going back to sleep; extra posts only cause spurious wake-ups.
+		while (singleton->_help_once()) {
+		}
+	}
+}
+
+void WorkerThreadPool::_post_task(Task *p_task) {
+	if (thread_count == 0) {
+		external_queue.push(p_task);
+		return;
+	}
+
+	uint32_t queue_index;
+	if (current_thread_index >= 0) {
+		// Nested work stays local, it is likely to touch the same data as its parent.
+		queue_index = current_thread_index;
+	} else {
+		queue_index = next_queue.fetch_add(1, std::memory_order_relaxed) % thread_count;
+	}
+	threads[queue_index].queue.push(p_task);
+	task_available_semaphore.post();
+}
+
+WorkerThreadPool::Task *WorkerThreadPool::_acquire_task() {
+	Task *task = nullptr;
+	if (current_thread_index >= 0) {
+		task = threads[current_thread_index].queue.pop();
+		if (task) {
+			return task;
+		}
+	}
+
+	uint32_t start = current_thread_index >= 0 ? uint32_t(current_thread_index) + 1 : next_queue.load(std::memory_order_relaxed);
+	for (uint32_t i = 0; i < thread_count; i++) {
+		task = threads[(start + i) % thread_count].queue.steal();
+		if (task) {
+			return task;
+		}
+	}
+
+	return external_queue.steal();
+}
+
+bool WorkerThreadPool::_help_once() {
+	Task *task = _acquire_task();
+	if (!task) {
+		return false;
+	}
+	_process_task(task);
+	return true;
+}
+
+void WorkerThreadPool::_process_group_elements(Group *p_group) {
+	while (true) {
+		uint32_t work_index = p_group->index.fetch_add(1, std::memory_order_relaxed);
+		if (work_index >= p_group->max) {
+			break;
+		}
+		p_group->template_userdata->callback_indexed(work_index);
+		p_group->completed_index.fetch_add(1, std::memory_order_release);
+	}
+}
+
+void WorkerThreadPool::_process_task(Task *p_task) {
+	if (p_task->group) {
+		Group *group = p_task->group;
+		// Group slices are owned by the group and never waited on individually.
+		memdelete(p_task);
+		_process_group_elements(group);
+		// The waiter may free the group as soon as the last slice is counted, read everything needed first.
+		uint32_t tasks_used = group->tasks_used;
+		if (group->finished.fetch_add(1, std::memory_order_acq_rel) + 1 == tasks_used) {
+			group->done_semaphore.post();
+		}
+		return;
+	}
+
+	if (p_task->template_userdata) {
+		p_task->template_userdata->callback();
+	} else {
+		p_task->native_func(p_task->native_func_userdata);
+	}
+	_complete_task(p_task);
+}
+
+void WorkerThreadPool::_complete_task(Task *p_task) {
+	MutexLock lock(task_mutex);
+	p_task->completed = true;
+	for (uint32_t i = 0; i < p_task->dependents.size(); i++) {
+		Task *dependent = p_task->dependents[i];
+		dependent->pending_dependencies--;
+		if (dependent->pending_dependencies == 0) {
+			_post_task(dependent);
+		}
+	}
+	p_task->dependents.clear();
+	p_task->done_semaphore.post();
+}
+
+WorkerThreadPool::TaskID WorkerThreadPool::_add_task(BaseTemplateUserdata *p_template_userdata, void (*p_func)(void *), void *p_userdata, const TaskID *p_dependencies, uint32_t p_dependency_count) {
+	Task *task = memnew(Task);
+	task->template_userdata = p_template_userdata;
+	task->native_func = p_func;
+	task->native_func_userdata = p_userdata;
+
+	MutexLock lock(task_mutex);
+	task->self = last_task++;
+	tasks.set(task->self, task);
+
+	for (uint32_t i = 0; i < p_dependency_count; i++) {
+		Task **dependency = tasks.getptr(p_dependencies[i]);
+		// Dependencies that were already waited on are complete by definition.
+		if (dependency && !(*dependency)->completed) {
+			(*dependency)->dependents.push_back(task);
+			task->pending_dependencies++;
+		}
+	}
+
+	if (task->pending_dependencies == 0) {
+		_post_task(task);
+	}
+
+	return task->self;
+}
+
+WorkerThreadPool::TaskID WorkerThreadPool::add_native_task(void (*p_func)(void *), void *p_userdata, const TaskID *p_dependencies, uint32_t p_dependency_count) {
+	ERR_FAIL_NULL_V(p_func, INVALID_TASK_ID);
+	return _add_task(nullptr, p_func, p_userdata, p_dependencies, p_dependency_count);
+}
+
+bool WorkerThreadPool::is_task_completed(TaskID p_task_id) const {
+	MutexLock lock(task_mutex);
+	Task *const *task = tasks.getptr(p_task_id);
+	ERR_FAIL_COND_V_MSG(!task, false, "Invalid Task ID.");
+	return (*task)->completed;
+}
+
+void WorkerThreadPool::wait_for_task_completion(TaskID p_task_id) {
+	Task *task = nullptr;
+	{
+		MutexLock lock(task_mutex);
+		Task **task_ptr = tasks.getptr(p_task_id);
+		ERR_FAIL_COND_MSG(!task_ptr, "Invalid Task ID.");
+		task = *task_ptr;
+	}
+
+	while (true) {
+		{
+			MutexLock lock(task_mutex);
+			if (task->completed) {
+				break;
+			}
+		}
+		if (!_help_once()) {
+			task->done_semaphore.wait();
+			break;
+		}
+	}
+
+	MutexLock lock(task_mutex);
+	tasks.erase(p_task_id);
+	if (task->template_userdata) {
+		memdelete(task->template_userdata);
+	}
+	memdelete(task);
+}
+
+WorkerThreadPool::GroupID WorkerThreadPool::_add_group_task(BaseTemplateUserdata *p_template_userdata, uint32_t p_elements, int p_tasks) {
+	if (p_tasks < 0) {
+		p_tasks = thread_count;
+	}
+
+	Group *group = memnew(Group);
+	group->template_userdata = p_template_userdata;
+	group->max = p_elements;
+	group->index.store(0, std::memory_order_relaxed);
+	group->completed_index.store(0, std::memory_order_relaxed);
+	group->finished.store(0, std::memory_order_relaxed);
+	// The waiting thread always participates, so slices beyond the element count would only spin.
+	group->tasks_used = MIN(uint32_t(p_tasks), p_elements);
+
+	{
+		MutexLock lock(task_mutex);
+		group->self = last_task++;
+		groups.set(group->self, group);
+	}
+
+	for (uint32_t i = 0; i < group->tasks_used; i++) {
+		Task *task = memnew(Task);
+		task->group = group;
+		_post_task(task);
+	}
+
+	return group->self;
+}
+
+uint32_t WorkerThreadPool::get_group_processed_element_count(GroupID p_group) const {
+	MutexLock lock(task_mutex);
+	Group *const *group = groups.getptr(p_group);
+	ERR_FAIL_COND_V_MSG(!group, 0, "Invalid Group ID.");
+	return (*group)->completed_index.load(std::memory_order_acquire);
+}
+
+bool WorkerThreadPool::is_group_task_completed(GroupID p_group) const {
+	MutexLock lock(task_mutex);
+	Group *const *group = groups.getptr(p_group);
+	ERR_FAIL_COND_V_MSG(!group, false, "Invalid Group ID.");
+	return (*group)->completed_index.load(std::memory_order_acquire) == (*group)->max;
+}
+
+void WorkerThreadPool::wait_for_group_task_completion(GroupID p_group) {
+	Group *group = nullptr;
+	{
+		MutexLock lock(task_mutex);
+		Group **group_ptr = groups.getptr(p_group);
+		ERR_FAIL_COND_MSG(!group_ptr, "Invalid Group ID.");
+		group = *group_ptr;
+	}
+
+	_process_group_elements(group);
+
+	// Slices still sitting in a busy worker's queue are stolen here; they exit immediately.
+	// The last slice signals the semaphore, and it must be consumed before the group can be freed.
+	if (group->tasks_used > 0) {
+		while (!group->done_semaphore.try_wait()) {
+			if (!_help_once()) {
+				group->done_semaphore.wait();
+				break;
+			}
+		}
+	}
+
+	{
+		MutexLock lock(task_mutex);
+		groups.erase(p_group);
+	}
+	memdelete(group->template_userdata);
+	memdelete(group);
+}
+
+void WorkerThreadPool::init(int p_thread_count) {
+	ERR_FAIL_COND(threads != nullptr);
+#ifdef NO_THREADS
+	p_thread_count = 0;
+#else
+	if (p_thread_count < 0) {
+		p_thread_count = OS::get_singleton()->get_processor_count();
+	}
+#endif
+
+	exit_threads.store(false);
+	thread_count = p_thread_count;
+	if (thread_count == 0) {
+		return;
+	}
+
+	threads = memnew_arr(ThreadData, thread_count);
+	for (uint32_t i = 0; i < thread_count; i++) {
+		threads[i].index = i;
+		threads[i].thread.start(&WorkerThreadPool::_thread_function, &threads[i]);
+	}
+
+	// Pick up anything that was queued before the workers existed.
+	while (Task *task = external_queue.steal()) {
+		_post_task(task);
+	}
+}
+
+void WorkerThreadPool::finish() {
+	if (threads == nullptr) {
+		return;
+	}
+
+	exit_threads.store(true, std::memory_order_release);
+	for (uint32_t i = 0; i < thread_count; i++) {
+		task_available_semaphore.post();
+	}
+	for (uint32_t i = 0; i < thread_count; i++) {
+		threads[i].thread.wait_to_finish();
+	}
+
+	memdelete_arr(threads);
+	threads = nullptr;
+	thread_count = 0;
+}
+
+WorkerThreadPool::WorkerThreadPool() {
+	singleton = this;
+	exit_threads.store(false);
+	next_queue.store(0);
+}
+
+WorkerThreadPool::~WorkerThreadPool() {
+	finish();
+	if (singleton == this) {
+		singleton = nullptr;
+	}
+}
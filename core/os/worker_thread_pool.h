@@ -0,0 +1,207 @@
+/*************************************************************************/
+/*  worker_thread_pool.h                                                 */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2021 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2021 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef WORKER_THREAD_POOL_H
+#define WORKER_THREAD_POOL_H
+
+#include "core/os/memory.h"
+#include "core/os/mutex.h"
+#include "core/os/semaphore.h"
+#include "core/os/thread.h"
+#include "core/templates/hash_map.h"
+#include "core/templates/local_vector.h"
+
+#include <atomic>
+
+// Engine-wide task scheduler shared by physics, rendering, resource loading and the editor.
+// Every worker owns a deque: it pushes and pops its own tasks at the back, while idle workers
+// steal from the front of the others. Threads waiting on a task or group do not block, they
+// keep processing queued work until what they wait for is done.
+
+class WorkerThreadPool {
+public:
+	typedef int64_t TaskID;
+	typedef int64_t GroupID;
+
+	enum {
+		INVALID_TASK_ID = -1,
+		INVALID_GROUP_ID = -1,
+	};
+
+private:
+	struct BaseTemplateUserdata {
+		virtual void callback() {}
+		virtual void callback_indexed(uint32_t p_index) {}
+		virtual ~BaseTemplateUserdata() {}
+	};
+
+	template <class C, class M, class U>
+	struct TaskUserData : public BaseTemplateUserdata {
+		C *instance;
+		M method;
+		U userdata;
+		virtual void callback() override {
+			(instance->*method)(userdata);
+		}
+	};
+
+	template <class C, class M, class U>
+	struct GroupUserData : public BaseTemplateUserdata {
+		C *instance;
+		M method;
+		U userdata;
+		virtual void callback_indexed(uint32_t p_index) override {
+			(instance->*method)(p_index, userdata);
+		}
+	};
+
+	struct Group {
+		GroupID self = INVALID_GROUP_ID;
+		BaseTemplateUserdata *template_userdata = nullptr;
+		uint32_t max = 0;
+		std::atomic<uint32_t> index;
+		std::atomic<uint32_t> completed_index;
+		uint32_t tasks_used = 0;
+		std::atomic<uint32_t> finished;
+		Semaphore done_semaphore;
+	};
+
+	struct Task {
+		TaskID self = INVALID_TASK_ID;
+		BaseTemplateUserdata *template_userdata = nullptr;
+		void (*native_func)(void *) = nullptr;
+		void *native_func_userdata = nullptr;
+		Group *group = nullptr;
+		// Guarded by task_mutex.
+		uint32_t pending_dependencies = 0;
+		LocalVector<Task *> dependents;
+		bool completed = false;
+		Semaphore done_semaphore;
+	};
+
+	// Work-stealing deque, the owner works at the back and thieves at the front.
+	struct TaskQueue {
+		BinaryMutex mutex;
+		LocalVector<Task *> tasks;
+		uint32_t head = 0;
+
+		void push(Task *p_task);
+		Task *pop();
+		Task *steal();
+	};
+
+	struct ThreadData {
+		uint32_t index = 0;
+		Thread thread;
+		TaskQueue queue;
+	};
+
+	static WorkerThreadPool *singleton;
+	static thread_local int current_thread_index;
+
+	ThreadData *threads = nullptr;
+	uint32_t thread_count = 0;
+	std::atomic<bool> exit_threads;
+	Semaphore task_available_semaphore;
+	std::atomic<uint32_t> next_queue;
+
+	// Tasks posted from threads outside the pool before any worker exists land here.
+	TaskQueue external_queue;
+
+	Mutex task_mutex;
+	TaskID last_task = 1;
+	HashMap<TaskID, Task *> tasks;
+	HashMap<GroupID, Group *> groups;
+
+	static void _thread_function(void *p_user);
+
+	void _post_task(Task *p_task);
+	Task *_acquire_task();
+	bool _help_once();
+	void _process_task(Task *p_task);
+	void _process_group_elements(Group *p_group);
+	void _complete_task(Task *p_task);
+
+	TaskID _add_task(BaseTemplateUserdata *p_template_userdata, void (*p_func)(void *), void *p_userdata, const TaskID *p_dependencies, uint32_t p_dependency_count);
+	GroupID _add_group_task(BaseTemplateUserdata *p_template_userdata, uint32_t p_elements, int p_tasks);
+
+public:
+	template <class C, class M, class U>
+	TaskID add_template_task(C *p_instance, M p_method, U p_userdata, const TaskID *p_dependencies = nullptr, uint32_t p_dependency_count = 0) {
+		TaskUserData<C, M, U> *ud = memnew((TaskUserData<C, M, U>));
+		ud->instance = p_instance;
+		ud->method = p_method;
+		ud->userdata = p_userdata;
+		return _add_task(ud, nullptr, nullptr, p_dependencies, p_dependency_count);
+	}
+
+	TaskID add_native_task(void (*p_func)(void *), void *p_userdata, const TaskID *p_dependencies = nullptr, uint32_t p_dependency_count = 0);
+	bool is_task_completed(TaskID p_task_id) const;
+	// Only one thread may wait on a given task; waiting releases it.
+	void wait_for_task_completion(TaskID p_task_id);
+
+	// Calls p_method(index, p_userdata) once for every index in [0, p_elements), spread over p_tasks workers (all of them by default).
+	template <class C, class M, class U>
+	GroupID add_template_group_task(C *p_instance, M p_method, U p_userdata, uint32_t p_elements, int p_tasks = -1) {
+		GroupUserData<C, M, U> *ud = memnew((GroupUserData<C, M, U>));
+		ud->instance = p_instance;
+		ud->method = p_method;
+		ud->userdata = p_userdata;
+		return _add_group_task(ud, p_elements, p_tasks);
+	}
+
+	uint32_t get_group_processed_element_count(GroupID p_group) const;
+	bool is_group_task_completed(GroupID p_group) const;
+	// The waiting thread processes elements of the group itself. Only one thread may wait on a given group; waiting releases it.
+	void wait_for_group_task_completion(GroupID p_group);
+
+	// Convenience for the common "split this loop over all cores and wait" pattern.
+	template <class C, class M, class U>
+	void do_work(uint32_t p_elements, C *p_instance, M p_method, U p_userdata) {
+		if (p_elements == 0) {
+			return;
+		}
+		wait_for_group_task_completion(add_template_group_task(p_instance, p_method, p_userdata, p_elements));
+	}
+
+	// Number of slices worth splitting work into. Never zero, since waiting threads process work themselves.
+	_FORCE_INLINE_ int get_thread_count() const { return MAX(thread_count, 1u); }
+	// Index of the calling worker thread, or -1 when called from outside the pool.
+	_FORCE_INLINE_ static int get_thread_index() { return current_thread_index; }
+
+	static WorkerThreadPool *get_singleton() { return singleton; }
+
+	void init(int p_thread_count = -1);
+	void finish();
+	WorkerThreadPool();
+	~WorkerThreadPool();
+};
+
+#endif // WORKER_THREAD_POOL_H
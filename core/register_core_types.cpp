@@ -72,6 +72,7 @@
 #include "core/object/undo_redo.h"
 #include "core/os/main_loop.h"
 #include "core/os/time.h"
+#include "core/os/worker_thread_pool.h"
 #include "core/string/optimized_translation.h"
 #include "core/string/translation.h"
 
@@ -106,6 +107,8 @@ extern void unregister_global_constants();
 
 static ResourceUID *resource_uid = nullptr;
 
+static WorkerThreadPool *worker_thread_pool = nullptr;
+
 void register_core_types() {
 	//consistency check
 	static_assert(sizeof(Callable) <= 16);
@@ -233,6 +236,9 @@ void register_core_types() {
 
 	resource_uid = memnew(ResourceUID);
 
+	// Threads are started in Main::setup(), once the project settings are known.
+	worker_thread_pool = memnew(WorkerThreadPool);
+
 	native_extension_manager = memnew(NativeExtensionManager);
 
 	resource_loader_native_extension.instantiate();
@@ -319,6 +325,7 @@ void unregister_core_types() {
 	memdelete(native_extension_manager);
 
 	memdelete(resource_uid);
+	memdelete(worker_thread_pool);
 	memdelete(_resource_loader);
 	memdelete(_resource_saver);
 	memdelete(_os);
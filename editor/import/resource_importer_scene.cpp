@@ -34,6 +34,7 @@
 #include "editor/editor_node.h"
 #include "editor/import/editor_importer_bake_reset.h"
 #include "editor/import/scene_import_settings.h"
+#include "editor/import/scene_importer_impostor.h"
 #include "editor/import/scene_importer_mesh_node_3d.h"
 #include "scene/3d/area_3d.h"
 #include "scene/3d/collision_shape_3d.h"
@@ -180,6 +181,10 @@ bool ResourceImporterScene::get_option_visibility(const String &p_option, const
 		return false;
 	}
 
+	if (p_option == "meshes/impostor_distance" && !bool(p_options["meshes/generate_impostors"])) {
+		return false;
+	}
+
 	return true;
 }
 
@@ -938,6 +943,7 @@ void ResourceImporterScene::get_internal_import_options(InternalImportCategory p
 			r_options->push_back(ImportOption(PropertyInfo(Variant::INT, "generate/shadow_meshes", PROPERTY_HINT_ENUM, "Default,Enable,Disable"), 0));
 			r_options->push_back(ImportOption(PropertyInfo(Variant::INT, "generate/lightmap_uv", PROPERTY_HINT_ENUM, "Default,Enable,Disable"), 0));
 			r_options->push_back(ImportOption(PropertyInfo(Variant::INT, "generate/lods", PROPERTY_HINT_ENUM, "Default,Enable,Disable"), 0));
+			r_options->push_back(ImportOption(PropertyInfo(Variant::INT, "generate/impostor", PROPERTY_HINT_ENUM, "Default,Enable,Disable"), 0));
 		} break;
 		case INTERNAL_IMPORT_CATEGORY_MATERIAL: {
 			r_options->push_back(ImportOption(PropertyInfo(Variant::BOOL, "use_external/enabled", PROPERTY_HINT_NONE, "", PROPERTY_USAGE_DEFAULT | PROPERTY_USAGE_UPDATE_ALL_IF_MODIFIED), false));
@@ -1036,6 +1042,8 @@ void ResourceImporterScene::get_import_options(List<ImportOption> *r_options, in
 	r_options->push_back(ImportOption(PropertyInfo(Variant::BOOL, "meshes/ensure_tangents"), true));
 	r_options->push_back(ImportOption(PropertyInfo(Variant::BOOL, "meshes/generate_lods"), true));
 	r_options->push_back(ImportOption(PropertyInfo(Variant::BOOL, "meshes/create_shadow_meshes"), true));
+	r_options->push_back(ImportOption(PropertyInfo(Variant::BOOL, "meshes/generate_impostors", PROPERTY_HINT_NONE, "", PROPERTY_USAGE_DEFAULT | PROPERTY_USAGE_UPDATE_ALL_IF_MODIFIED), false));
+	r_options->push_back(ImportOption(PropertyInfo(Variant::FLOAT, "meshes/impostor_distance", PROPERTY_HINT_RANGE, "0.01,10000,0.01,or_greater"), 100.0));
 	r_options->push_back(ImportOption(PropertyInfo(Variant::INT, "meshes/light_baking", PROPERTY_HINT_ENUM, "Disabled,Dynamic,Static,Static Lightmaps", PROPERTY_USAGE_DEFAULT | PROPERTY_USAGE_UPDATE_ALL_IF_MODIFIED), 2));
 	r_options->push_back(ImportOption(PropertyInfo(Variant::FLOAT, "meshes/lightmap_texel_size", PROPERTY_HINT_RANGE, "0.001,100,0.001"), 0.1));
 	r_options->push_back(ImportOption(PropertyInfo(Variant::BOOL, "skins/use_named_skins"), true));
@@ -1116,7 +1124,7 @@ Ref<Animation> ResourceImporterScene::import_animation_from_other_importer(Edito
 	return importer->import_animation(p_path, p_flags, p_bake_fps);
 }
 
-void ResourceImporterScene::_generate_meshes(Node *p_node, const Dictionary &p_mesh_data, bool p_generate_lods, bool p_create_shadow_meshes, LightBakeMode p_light_bake_mode, float p_lightmap_texel_size, const Vector<uint8_t> &p_src_lightmap_cache, Vector<Vector<uint8_t>> &r_lightmap_caches) {
+void ResourceImporterScene::_generate_meshes(Node *p_node, const Dictionary &p_mesh_data, bool p_generate_lods, bool p_create_shadow_meshes, bool p_generate_impostors, float p_impostor_distance, LightBakeMode p_light_bake_mode, float p_lightmap_texel_size, const Vector<uint8_t> &p_src_lightmap_cache, Vector<Vector<uint8_t>> &r_lightmap_caches, Map<Ref<Mesh>, Ref<Mesh>> &r_impostors) {
 	EditorSceneImporterMeshNode3D *src_mesh_node = Object::cast_to<EditorSceneImporterMeshNode3D>(p_node);
 	if (src_mesh_node) {
 		//is mesh
@@ -1125,8 +1133,10 @@ void ResourceImporterScene::_generate_meshes(Node *p_node, const Dictionary &p_m
 		mesh_node->set_transform(src_mesh_node->get_transform());
 		mesh_node->set_skin(src_mesh_node->get_skin());
 		mesh_node->set_skeleton_path(src_mesh_node->get_skeleton_path());
+		Ref<Mesh> impostor;
 		if (src_mesh_node->get_mesh().is_valid()) {
 			Ref<ArrayMesh> mesh;
+			bool generate_impostor = p_generate_impostors;
 			if (!src_mesh_node->get_mesh()->has_mesh()) {
 				//do mesh processing
 
@@ -1173,6 +1183,15 @@ void ResourceImporterScene::_generate_meshes(Node *p_node, const Dictionary &p_m
 						}
 					}
 
+					if (mesh_settings.has("generate/impostor")) {
+						int impostors = mesh_settings["generate/impostor"];
+						if (impostors == MESH_OVERRIDE_ENABLE) {
+							generate_impostor = true;
+						} else if (impostors == MESH_OVERRIDE_DISABLE) {
+							generate_impostor = false;
+						}
+					}
+
 					if (mesh_settings.has("save_to_file/enabled") && bool(mesh_settings["save_to_file/enabled"]) && mesh_settings.has("save_to_file/path")) {
 						save_to_file = mesh_settings["save_to_file/path"];
 						if (!save_to_file.is_resource_file()) {
@@ -1244,6 +1263,16 @@ void ResourceImporterScene::_generate_meshes(Node *p_node, const Dictionary &p_m
 				for (int i = 0; i < mesh->get_surface_count(); i++) {
 					mesh_node->set_surface_override_material(i, src_mesh_node->get_surface_material(i));
 				}
+
+				// Meshes used by several nodes are only baked once, with the settings seen the first time.
+				if (!r_impostors.has(mesh)) {
+					if (generate_impostor && src_mesh_node->get_skin().is_null()) {
+						impostor = EditorSceneImporterImpostor::generate(mesh);
+					}
+					r_impostors[mesh] = impostor;
+				} else {
+					impostor = r_impostors[mesh];
+				}
 			}
 		}
 
@@ -1263,10 +1292,24 @@ void ResourceImporterScene::_generate_meshes(Node *p_node, const Dictionary &p_m
 		p_node->replace_by(mesh_node);
 		memdelete(p_node);
 		p_node = mesh_node;
+
+		if (impostor.is_valid()) {
+			mesh_node->set_visibility_range_end(p_impostor_distance);
+
+			MeshInstance3D *impostor_node = memnew(MeshInstance3D);
+			impostor_node->set_name(String(mesh_node->get_name()) + "Impostor");
+			impostor_node->set_mesh(impostor);
+			impostor_node->set_visibility_range_begin(p_impostor_distance);
+			// A quad turned to the camera doesn't make sensible shadows or GI.
+			impostor_node->set_cast_shadows_setting(GeometryInstance3D::SHADOW_CASTING_SETTING_OFF);
+			impostor_node->set_gi_mode(GeometryInstance3D::GI_MODE_DISABLED);
+			mesh_node->add_child(impostor_node);
+			impostor_node->set_owner(mesh_node->get_owner() ? mesh_node->get_owner() : mesh_node);
+		}
 	}
 
 	for (int i = 0; i < p_node->get_child_count(); i++) {
-		_generate_meshes(p_node->get_child(i), p_mesh_data, p_generate_lods, p_create_shadow_meshes, p_light_bake_mode, p_lightmap_texel_size, p_src_lightmap_cache, r_lightmap_caches);
+		_generate_meshes(p_node->get_child(i), p_mesh_data, p_generate_lods, p_create_shadow_meshes, p_generate_impostors, p_impostor_distance, p_light_bake_mode, p_lightmap_texel_size, p_src_lightmap_cache, r_lightmap_caches, r_impostors);
 	}
 }
 
@@ -1434,6 +1477,8 @@ Error ResourceImporterScene::import(const String &p_source_file, const String &p
 
 	bool gen_lods = bool(p_options["meshes/generate_lods"]);
 	bool create_shadow_meshes = bool(p_options["meshes/create_shadow_meshes"]);
+	bool generate_impostors = bool(p_options["meshes/generate_impostors"]);
+	float impostor_distance = p_options["meshes/impostor_distance"];
 	int light_bake_mode = p_options["meshes/light_baking"];
 	float texel_size = p_options["meshes/lightmap_texel_size"];
 	float lightmap_texel_size = MAX(0.001, texel_size);
@@ -1452,7 +1497,8 @@ Error ResourceImporterScene::import(const String &p_source_file, const String &p
 	if (subresources.has("meshes")) {
 		mesh_data = subresources["meshes"];
 	}
-	_generate_meshes(scene, mesh_data, gen_lods, create_shadow_meshes, LightBakeMode(light_bake_mode), lightmap_texel_size, src_lightmap_cache, mesh_lightmap_caches);
+	Map<Ref<Mesh>, Ref<Mesh>> mesh_impostors;
+	_generate_meshes(scene, mesh_data, gen_lods, create_shadow_meshes, generate_impostors, impostor_distance, LightBakeMode(light_bake_mode), lightmap_texel_size, src_lightmap_cache, mesh_lightmap_caches, mesh_impostors);
 
 	if (mesh_lightmap_caches.size()) {
 		FileAccessRef f = FileAccess::open(p_source_file + ".unwrap_cache", FileAccess::WRITE);
@@ -0,0 +1,150 @@
+/*************************************************************************/
+/*  scene_importer_impostor.cpp                                          */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2021 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2021 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "scene_importer_impostor.h"
+
+#include "scene/resources/material.h"
+#include "scene/resources/primitive_meshes.h"
+#include "scene/resources/texture.h"
+#include "servers/rendering_server.h"
+
+static const char *impostor_shader_code = R"(
+shader_type spatial;
+render_mode cull_disabled;
+
+uniform sampler2D atlas : hint_albedo;
+uniform vec3 center;
+uniform int frames;
+uniform float alpha_scissor_threshold = 0.5;
+
+varying float frame;
+
+void vertex() {
+	// Turn around the Y axis to face the camera, and pick the view baked from that side.
+	vec3 camera = (inverse(WORLD_MATRIX) * vec4(CAMERA_MATRIX[3].xyz, 1.0)).xyz;
+	vec2 dir = camera.xz - center.xz;
+	dir = length(dir) > 0.0001 ? normalize(dir) : vec2(0.0, 1.0);
+	VERTEX = center + vec3(VERTEX.x * dir.y, VERTEX.y, -VERTEX.x * dir.x);
+	NORMAL = vec3(dir.x, 0.0, dir.y);
+	frame = mod(round(atan(dir.x, dir.y) / TAU * float(frames)), float(frames));
+}
+
+void fragment() {
+	vec4 color = texture(atlas, vec2((frame + UV.x) / float(frames), UV.y));
+	ALBEDO = color.rgb;
+	ALPHA = color.a;
+	ALPHA_SCISSOR_THRESHOLD = alpha_scissor_threshold;
+}
+)";
+
+Ref<Mesh> EditorSceneImporterImpostor::generate(const Ref<Mesh> &p_mesh) {
+	ERR_FAIL_COND_V(p_mesh.is_null(), Ref<Mesh>());
+
+	AABB aabb = p_mesh->get_aabb();
+	Vector3 center = aabb.position + aabb.size * 0.5;
+	float radius = Vector2(aabb.size.x, aabb.size.z).length() * 0.5;
+	float size = MAX(radius * 2.0, aabb.size.y);
+	ERR_FAIL_COND_V(size <= 0.0, Ref<Mesh>());
+	float distance = aabb.size.length() + 1.0;
+
+	RID scenario = RS::get_singleton()->scenario_create();
+
+	RID viewport = RS::get_singleton()->viewport_create();
+	RS::get_singleton()->viewport_set_update_mode(viewport, RS::VIEWPORT_UPDATE_ALWAYS);
+	RS::get_singleton()->viewport_set_scenario(viewport, scenario);
+	RS::get_singleton()->viewport_set_size(viewport, FRAME_SIZE, FRAME_SIZE);
+	RS::get_singleton()->viewport_set_transparent_background(viewport, true);
+	// Only the albedo is baked, lights are applied to the impostor.
+	RS::get_singleton()->viewport_set_debug_draw(viewport, RS::VIEWPORT_DEBUG_DRAW_UNSHADED);
+	RS::get_singleton()->viewport_set_active(viewport, true);
+	RID viewport_texture = RS::get_singleton()->viewport_get_texture(viewport);
+
+	RID camera = RS::get_singleton()->camera_create();
+	RS::get_singleton()->viewport_attach_camera(viewport, camera);
+	RS::get_singleton()->camera_set_orthogonal(camera, size, 0.01, distance * 2.0);
+
+	RID instance = RS::get_singleton()->instance_create2(p_mesh->get_rid(), scenario);
+
+	Ref<Image> atlas;
+	atlas.instantiate();
+	atlas->create(FRAME_SIZE * FRAMES, FRAME_SIZE, false, Image::FORMAT_RGBA8);
+
+	bool baked = true;
+	for (int i = 0; i < FRAMES; i++) {
+		float angle = Math_TAU * i / FRAMES;
+		Transform3D xform = Transform3D(Basis(Vector3(0, 1, 0), angle), center + Vector3(Math::sin(angle), 0, Math::cos(angle)) * distance);
+		RS::get_singleton()->camera_set_transform(camera, xform);
+
+		RS::get_singleton()->draw(false);
+
+		Ref<Image> img = RS::get_singleton()->texture_2d_get(viewport_texture);
+		if (img.is_null() || img->is_empty()) {
+			baked = false;
+			break;
+		}
+		img->convert(Image::FORMAT_RGBA8);
+		atlas->blit_rect(img, Rect2(0, 0, FRAME_SIZE, FRAME_SIZE), Point2(FRAME_SIZE * i, 0));
+	}
+
+	RS::get_singleton()->free(instance);
+	RS::get_singleton()->free(viewport);
+	RS::get_singleton()->free(camera);
+	RS::get_singleton()->free(scenario);
+
+	ERR_FAIL_COND_V_MSG(!baked, Ref<Mesh>(), "Couldn't render the views of the mesh to generate an impostor.");
+
+	// Keep the colors from turning dark on the edges when filtering.
+	atlas->fix_alpha_edges();
+	atlas->generate_mipmaps();
+
+	Ref<ImageTexture> atlas_texture;
+	atlas_texture.instantiate();
+	atlas_texture->create_from_image(atlas);
+
+	Ref<Shader> shader;
+	shader.instantiate();
+	shader->set_code(impostor_shader_code);
+
+	Ref<ShaderMaterial> material;
+	material.instantiate();
+	material->set_shader(shader);
+	material->set_shader_param("atlas", atlas_texture);
+	material->set_shader_param("center", center);
+	material->set_shader_param("frames", FRAMES);
+
+	Ref<QuadMesh> quad;
+	quad.instantiate();
+	quad->set_size(Size2(size, size));
+	quad->set_material(material);
+	// The quad is turned in the vertex shader, cover all the directions it can face.
+	quad->set_custom_aabb(AABB(center - Vector3(radius, size * 0.5, radius), Vector3(radius, size * 0.5, radius) * 2.0));
+
+	return quad;
+}
@@ -1,5 +1,5 @@
 /*************************************************************************/
-/*  renderer_thread_pool.h                                               */
+/*  scene_importer_impostor.h                                            */
 /*************************************************************************/
 /*                       This file is part of:                           */
 /*                           GODOT ENGINE                                */
@@ -28,18 +28,21 @@
 /* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
 /*************************************************************************/
 
-#ifndef RENDERERTHREADPOOL_H
-#define RENDERERTHREADPOOL_H
+#ifndef EDITOR_SCENE_IMPORTER_IMPOSTOR_H
+#define EDITOR_SCENE_IMPORTER_IMPOSTOR_H
 
-#include "core/templates/thread_work_pool.h"
+#include "scene/resources/mesh.h"
 
-class RendererThreadPool {
+// Renders a mesh from all around into an atlas, and makes a quad that shows the view closest
+// to the camera while turning to face it around the Y axis. Used in place of the mesh when far away.
+class EditorSceneImporterImpostor {
 public:
-	ThreadWorkPool thread_work_pool;
+	enum {
+		FRAMES = 8,
+		FRAME_SIZE = 128,
+	};
 
-	static RendererThreadPool *singleton;
-	RendererThreadPool();
-	~RendererThreadPool();
+	static Ref<Mesh> generate(const Ref<Mesh> &p_mesh);
 };
 
-#endif // RENDERERTHREADPOOL_H
+#endif // EDITOR_SCENE_IMPORTER_IMPOSTOR_H
@@ -2713,6 +2713,24 @@ void Node3DEditorViewport::_notification(int p_what) {
 			text += vformat(TTR("Objects: %d\n"), viewport->get_render_info(Viewport::RENDER_INFO_TYPE_VISIBLE, Viewport::RENDER_INFO_OBJECTS_IN_FRAME));
 			text += vformat(TTR("Primitives: %d\n"), viewport->get_render_info(Viewport::RENDER_INFO_TYPE_VISIBLE, Viewport::RENDER_INFO_PRIMITIVES_IN_FRAME));
 			text += vformat(TTR("Draw Calls: %d"), viewport->get_render_info(Viewport::RENDER_INFO_TYPE_VISIBLE, Viewport::RENDER_INFO_DRAW_CALLS_IN_FRAME));
+			int merged_draw_calls = viewport->get_render_info(Viewport::RENDER_INFO_TYPE_VISIBLE, Viewport::RENDER_INFO_MERGED_DRAW_CALLS_IN_FRAME);
+			if (merged_draw_calls > 0) {
+				text += vformat(TTR(" (%d merged)"), merged_draw_calls);
+			}
+
+			// Only list the LODs when some are used.
+			String lod_text;
+			bool uses_lods = false;
+			for (int i = 0; i < RS::MAX_RENDER_INFO_LODS; i++) {
+				int objects = viewport->get_render_lod_info(Viewport::RENDER_INFO_TYPE_VISIBLE, i, Viewport::RENDER_LOD_INFO_OBJECTS_IN_FRAME);
+				if (objects > 0) {
+					lod_text += vformat(TTR("\nLOD %d: %d surfaces, %d primitives"), i, objects, viewport->get_render_lod_info(Viewport::RENDER_INFO_TYPE_VISIBLE, i, Viewport::RENDER_LOD_INFO_PRIMITIVES_IN_FRAME));
+					uses_lods = uses_lods || i > 0;
+				}
+			}
+			if (uses_lods) {
+				text += "\n" + lod_text;
+			}
 
 			info_label->set_text(text);
 		}
@@ -47,6 +47,7 @@
 #include "core/object/message_queue.h"
 #include "core/os/os.h"
 #include "core/os/time.h"
+#include "core/os/worker_thread_pool.h"
 #include "core/register_core_types.h"
 #include "core/string/translation.h"
 #include "core/version.h"
@@ -89,6 +90,10 @@
 #include "editor/progress_dialog.h"
 #include "editor/project_manager.h"
 
+#ifdef MODULE_GDSCRIPT_ENABLED
+#include "modules/gdscript/gdscript_native.h"
+#endif
+
 #endif
 
 /* Static members */
@@ -375,6 +380,9 @@ void Main::print_help(const char *p_binary) {
 	OS::get_singleton()->print("  --doctool [<path>]                           Dump the engine API reference to the given <path> (defaults to current dir) in XML format, merging if existing files are found.\n");
 	OS::get_singleton()->print("  --no-docbase                                 Disallow dumping the base types (used with --doctool).\n");
 	OS::get_singleton()->print("  --build-solutions                            Build the scripting solutions (e.g. for C# projects). Implies --editor and requires a valid project to edit.\n");
+#ifdef MODULE_GDSCRIPT_ENABLED
+	OS::get_singleton()->print("  --gdscript-transpile <path>                  Translate the typed GDScript functions of the project to C++ source at the given <path>, to build the library set in gdscript/native_library/path.\n");
+#endif
 #ifdef DEBUG_METHODS_ENABLED
 	OS::get_singleton()->print("  --gdnative-generate-json-api <path>          Generate JSON dump of the Godot API for GDNative bindings and save it on the file specified in <path>.\n");
 	OS::get_singleton()->print("  --gdnative-generate-json-builtin-api <path>  Generate JSON dump of the Godot API of the builtin Variant types and utility functions for GDNative bindings and save it on the file specified in <path>.\n");
@@ -406,6 +414,8 @@ Error Main::test_setup() {
 
 	translation_server = memnew(TranslationServer);
 
+	WorkerThreadPool::get_singleton()->init();
+
 	register_core_extensions();
 
 	// From `Main::setup2()`.
@@ -906,6 +916,12 @@ Error Main::setup(const char *execpath, int argc, char *argv[], bool p_second_ph
 			// Actually handling is done in start().
 			cmdline_tool = true;
 			main_args.push_back(I->get());
+#ifdef MODULE_GDSCRIPT_ENABLED
+		} else if (I->get() == "--gdscript-transpile") {
+			// Actually handling is done in start().
+			cmdline_tool = true;
+			main_args.push_back(I->get());
+#endif
 #endif
 		} else if (I->get() == "--path") { // set path of project to start or edit
 
@@ -1096,6 +1112,14 @@ Error Main::setup(const char *execpath, int argc, char *argv[], bool p_second_ph
 					"memory/limits/multithreaded_server/rid_pool_prealloc",
 					PROPERTY_HINT_RANGE,
 					"0,500,1")); // No negative and limit to 500 due to crashes
+
+	GLOBAL_DEF_RST("threading/worker_pool/max_threads", -1);
+	ProjectSettings::get_singleton()->set_custom_property_info("threading/worker_pool/max_threads",
+			PropertyInfo(Variant::INT,
+					"threading/worker_pool/max_threads",
+					PROPERTY_HINT_RANGE,
+					"-1,256,1"));
+	WorkerThreadPool::get_singleton()->init(GLOBAL_GET("threading/worker_pool/max_threads"));
 	GLOBAL_DEF("network/limits/debugger/max_chars_per_second", 32768);
 	ProjectSettings::get_singleton()->set_custom_property_info("network/limits/debugger/max_chars_per_second",
 			PropertyInfo(Variant::INT,
@@ -1853,6 +1877,7 @@ bool Main::start() {
 #ifdef TOOLS_ENABLED
 	String doc_tool_path;
 	bool doc_base = true;
+	String gdscript_transpile_path;
 	String _export_preset;
 	bool export_debug = false;
 	bool export_pack_only = false;
@@ -1917,6 +1942,10 @@ bool Main::start() {
 				editor = true;
 				_export_preset = args[i + 1];
 				export_pack_only = true;
+#ifdef MODULE_GDSCRIPT_ENABLED
+			} else if (args[i] == "--gdscript-transpile") {
+				gdscript_transpile_path = args[i + 1];
+#endif
 #endif
 			} else {
 				// The parameter does not match anything known, don't skip the next argument
@@ -1931,6 +1960,12 @@ bool Main::start() {
 		else if (args[i] == "--doctool") {
 			doc_tool_path = ".";
 		}
+#ifdef MODULE_GDSCRIPT_ENABLED
+		else if (args[i] == "--gdscript-transpile") {
+			OS::get_singleton()->set_exit_code(EXIT_FAILURE);
+			ERR_FAIL_V_MSG(false, "Needed a path for the generated C++ source.");
+		}
+#endif
 #endif
 	}
 
@@ -2014,6 +2049,15 @@ bool Main::start() {
 		NativeExtensionAPIDump::generate_extension_json_file("extension_api.json");
 		return false;
 	}
+
+#ifdef MODULE_GDSCRIPT_ENABLED
+	if (gdscript_transpile_path != "") {
+		if (GDScriptNativeTranspiler::transpile_project(gdscript_transpile_path) != OK) {
+			OS::get_singleton()->set_exit_code(EXIT_FAILURE);
+		}
+		return false;
+	}
+#endif
 #endif
 
 	if (script == "" && game_path == "" && String(GLOBAL_GET("application/run/main_scene")) != "") {
@@ -72,6 +72,13 @@ void Performance::_bind_methods() {
 	BIND_ENUM_CONSTANT(PHYSICS_3D_ACTIVE_OBJECTS);
 	BIND_ENUM_CONSTANT(PHYSICS_3D_COLLISION_PAIRS);
 	BIND_ENUM_CONSTANT(PHYSICS_3D_ISLAND_COUNT);
+	BIND_ENUM_CONSTANT(PHYSICS_3D_INTEGRATE_FORCES_TIME);
+	BIND_ENUM_CONSTANT(PHYSICS_3D_GENERATE_ISLANDS_TIME);
+	BIND_ENUM_CONSTANT(PHYSICS_3D_SETUP_CONSTRAINTS_TIME);
+	BIND_ENUM_CONSTANT(PHYSICS_3D_SOLVE_CONSTRAINTS_TIME);
+	BIND_ENUM_CONSTANT(PHYSICS_3D_INTEGRATE_VELOCITIES_TIME);
+	BIND_ENUM_CONSTANT(PHYSICS_3D_UPDATE_BROADPHASE_TIME);
+	BIND_ENUM_CONSTANT(PHYSICS_3D_FLUSH_QUERIES_TIME);
 	BIND_ENUM_CONSTANT(AUDIO_OUTPUT_LATENCY);
 
 	BIND_ENUM_CONSTANT(MONITOR_MAX);
@@ -111,6 +118,13 @@ String Performance::get_monitor_name(Monitor p_monitor) const {
 		"physics_3d/active_objects",
 		"physics_3d/collision_pairs",
 		"physics_3d/islands",
+		"physics_3d/integrate_forces_time",
+		"physics_3d/generate_islands_time",
+		"physics_3d/setup_constraints_time",
+		"physics_3d/solve_constraints_time",
+		"physics_3d/integrate_velocities_time",
+		"physics_3d/update_broadphase_time",
+		"physics_3d/flush_queries_time",
 		"audio/driver/output_latency",
 
 	};
@@ -164,6 +178,20 @@ double Performance::get_monitor(Monitor p_monitor) const {
 			return PhysicsServer3D::get_singleton()->get_process_info(PhysicsServer3D::INFO_COLLISION_PAIRS);
 		case PHYSICS_3D_ISLAND_COUNT:
 			return PhysicsServer3D::get_singleton()->get_process_info(PhysicsServer3D::INFO_ISLAND_COUNT);
+		case PHYSICS_3D_INTEGRATE_FORCES_TIME:
+			return USEC_TO_SEC(PhysicsServer3D::get_singleton()->get_process_info(PhysicsServer3D::INFO_INTEGRATE_FORCES_TIME));
+		case PHYSICS_3D_GENERATE_ISLANDS_TIME:
+			return USEC_TO_SEC(PhysicsServer3D::get_singleton()->get_process_info(PhysicsServer3D::INFO_GENERATE_ISLANDS_TIME));
+		case PHYSICS_3D_SETUP_CONSTRAINTS_TIME:
+			return USEC_TO_SEC(PhysicsServer3D::get_singleton()->get_process_info(PhysicsServer3D::INFO_SETUP_CONSTRAINTS_TIME));
+		case PHYSICS_3D_SOLVE_CONSTRAINTS_TIME:
+			return USEC_TO_SEC(PhysicsServer3D::get_singleton()->get_process_info(PhysicsServer3D::INFO_SOLVE_CONSTRAINTS_TIME));
+		case PHYSICS_3D_INTEGRATE_VELOCITIES_TIME:
+			return USEC_TO_SEC(PhysicsServer3D::get_singleton()->get_process_info(PhysicsServer3D::INFO_INTEGRATE_VELOCITIES_TIME));
+		case PHYSICS_3D_UPDATE_BROADPHASE_TIME:
+			return USEC_TO_SEC(PhysicsServer3D::get_singleton()->get_process_info(PhysicsServer3D::INFO_UPDATE_BROADPHASE_TIME));
+		case PHYSICS_3D_FLUSH_QUERIES_TIME:
+			return USEC_TO_SEC(PhysicsServer3D::get_singleton()->get_process_info(PhysicsServer3D::INFO_FLUSH_QUERIES_TIME));
 		case AUDIO_OUTPUT_LATENCY:
 			return AudioServer::get_singleton()->get_output_latency();
 
@@ -201,6 +229,13 @@ Performance::MonitorType Performance::get_monitor_type(Monitor p_monitor) const
 		MONITOR_TYPE_QUANTITY,
 		MONITOR_TYPE_QUANTITY,
 		MONITOR_TYPE_TIME,
+		MONITOR_TYPE_TIME,
+		MONITOR_TYPE_TIME,
+		MONITOR_TYPE_TIME,
+		MONITOR_TYPE_TIME,
+		MONITOR_TYPE_TIME,
+		MONITOR_TYPE_TIME,
+		MONITOR_TYPE_TIME,
 
 	};
 
@@ -85,6 +85,13 @@ public:
 		PHYSICS_3D_ACTIVE_OBJECTS,
 		PHYSICS_3D_COLLISION_PAIRS,
 		PHYSICS_3D_ISLAND_COUNT,
+		PHYSICS_3D_INTEGRATE_FORCES_TIME,
+		PHYSICS_3D_GENERATE_ISLANDS_TIME,
+		PHYSICS_3D_SETUP_CONSTRAINTS_TIME,
+		PHYSICS_3D_SOLVE_CONSTRAINTS_TIME,
+		PHYSICS_3D_INTEGRATE_VELOCITIES_TIME,
+		PHYSICS_3D_UPDATE_BROADPHASE_TIME,
+		PHYSICS_3D_FLUSH_QUERIES_TIME,
 		//physics
 		AUDIO_OUTPUT_LATENCY,
 		MONITOR_MAX
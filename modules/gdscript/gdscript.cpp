@@ -40,9 +40,12 @@
 #include "core/io/file_access_encrypted.h"
 #include "core/os/os.h"
 #include "gdscript_analyzer.h"
+#include "gdscript_bytecode_cache.h"
 #include "gdscript_cache.h"
 #include "gdscript_compiler.h"
+#include "gdscript_native.h"
 #include "gdscript_parser.h"
+#include "gdscript_sampler.h"
 #include "gdscript_warning.h"
 
 #ifdef TESTS_ENABLED
@@ -813,26 +816,43 @@ Error GDScript::reload(bool p_keep_state) {
 	}
 
 	valid = false;
-	GDScriptParser parser;
-	Error err = parser.parse(source, path, false);
-	if (err) {
-		if (EngineDebugger::is_active()) {
-			GDScriptLanguage::get_singleton()->debug_break_parse(get_path(), parser.get_errors().front()->get().line, "Parser Error: " + parser.get_errors().front()->get().message);
+
+	if (!p_keep_state && GDScriptBytecodeCache::load_cached(this) == OK) {
+		return OK;
+	}
+
+	// Scripts that others being loaded depend on may already have been parsed on a worker thread.
+	GDScriptParser *parser = GDScriptCache::take_parsed_script(path, &source);
+	if (parser == nullptr) {
+		parser = memnew(GDScriptParser);
+		Error err = parser->parse(source, path, false);
+		if (err) {
+			if (EngineDebugger::is_active()) {
+				GDScriptLanguage::get_singleton()->debug_break_parse(get_path(), parser->get_errors().front()->get().line, "Parser Error: " + parser->get_errors().front()->get().message);
+			}
+			// TODO: Show all error messages.
+			_err_print_error("GDScript::reload", path.is_empty() ? "built-in" : (const char *)path.utf8().get_data(), parser->get_errors().front()->get().line, ("Parse Error: " + parser->get_errors().front()->get().message).utf8().get_data(), ERR_HANDLER_SCRIPT);
+			memdelete(parser);
+			ERR_FAIL_V(ERR_PARSE_ERROR);
 		}
-		// TODO: Show all error messages.
-		_err_print_error("GDScript::reload", path.is_empty() ? "built-in" : (const char *)path.utf8().get_data(), parser.get_errors().front()->get().line, ("Parse Error: " + parser.get_errors().front()->get().message).utf8().get_data(), ERR_HANDLER_SCRIPT);
-		ERR_FAIL_V(ERR_PARSE_ERROR);
+		GDScriptCache::queue_dependencies(parser);
 	}
 
-	GDScriptAnalyzer analyzer(&parser);
-	err = analyzer.analyze();
+	Error err = _compile_parsed(*parser, p_keep_state);
+	memdelete(parser);
+	return err;
+}
+
+Error GDScript::_compile_parsed(GDScriptParser &p_parser, bool p_keep_state) {
+	GDScriptAnalyzer analyzer(&p_parser);
+	Error err = analyzer.analyze();
 
 	if (err) {
 		if (EngineDebugger::is_active()) {
-			GDScriptLanguage::get_singleton()->debug_break_parse(get_path(), parser.get_errors().front()->get().line, "Parser Error: " + parser.get_errors().front()->get().message);
+			GDScriptLanguage::get_singleton()->debug_break_parse(get_path(), p_parser.get_errors().front()->get().line, "Parser Error: " + p_parser.get_errors().front()->get().message);
 		}
 
-		const List<GDScriptParser::ParserError>::Element *e = parser.get_errors().front();
+		const List<GDScriptParser::ParserError>::Element *e = p_parser.get_errors().front();
 		while (e != nullptr) {
 			_err_print_error("GDScript::reload", path.is_empty() ? "built-in" : (const char *)path.utf8().get_data(), e->get().line, ("Parse Error: " + e->get().message).utf8().get_data(), ERR_HANDLER_SCRIPT);
 			e = e->next();
@@ -840,10 +860,10 @@ Error GDScript::reload(bool p_keep_state) {
 		ERR_FAIL_V(ERR_PARSE_ERROR);
 	}
 
-	bool can_run = ScriptServer::is_scripting_enabled() || parser.is_tool();
+	bool can_run = ScriptServer::is_scripting_enabled() || p_parser.is_tool();
 
 	GDScriptCompiler compiler;
-	err = compiler.compile(&parser, this, p_keep_state);
+	err = compiler.compile(&p_parser, this, p_keep_state);
 
 #ifdef TOOLS_ENABLED
 	_update_doc();
@@ -861,7 +881,7 @@ Error GDScript::reload(bool p_keep_state) {
 		}
 	}
 #ifdef DEBUG_ENABLED
-	for (const GDScriptWarning &warning : parser.get_warnings()) {
+	for (const GDScriptWarning &warning : p_parser.get_warnings()) {
 		if (EngineDebugger::is_active()) {
 			Vector<ScriptLanguage::StackInfo> si;
 			EngineDebugger::get_script_debugger()->send_error("", get_path(), warning.start_line, warning.get_name(), warning.get_message(), ERR_HANDLER_WARNING, si);
@@ -877,6 +897,10 @@ Error GDScript::reload(bool p_keep_state) {
 
 	_init_rpc_methods_properties();
 
+	if (!p_keep_state) {
+		GDScriptBytecodeCache::save_cached(this);
+	}
+
 	return OK;
 }
 
@@ -974,12 +998,37 @@ void GDScript::_bind_methods() {
 }
 
 Vector<uint8_t> GDScript::get_as_byte_code() const {
-	return Vector<uint8_t>();
+	Vector<uint8_t> bytecode;
+	if (GDScriptBytecodeCache::serialize(this, bytecode) != OK) {
+		return Vector<uint8_t>();
+	}
+	return bytecode;
 };
 
-// TODO: Fully remove this. There's not this kind of "bytecode" anymore.
 Error GDScript::load_byte_code(const String &p_path) {
-	return ERR_COMPILATION_FAILED;
+	Error err = OK;
+	Vector<uint8_t> bytecode = FileAccess::get_file_as_array(p_path, &err);
+	ERR_FAIL_COND_V_MSG(err != OK, err, "Cannot open bytecode file '" + p_path + "'.");
+
+	return load_byte_code_from_buffer(bytecode);
+}
+
+Error GDScript::load_byte_code_from_buffer(const Vector<uint8_t> &p_bytecode) {
+	ERR_FAIL_COND_V(instances.size(), ERR_ALREADY_IN_USE);
+
+	valid = false;
+	Error err = GDScriptBytecodeCache::deserialize(this, p_bytecode);
+	if (err != OK) {
+		return err;
+	}
+
+	valid = true;
+	for (Map<StringName, Ref<GDScript>>::Element *E = subclasses.front(); E; E = E->next()) {
+		_set_subclass_path(E->get(), path);
+	}
+	_init_rpc_methods_properties();
+
+	return OK;
 }
 
 Error GDScript::load_source_code(const String &p_path) {
@@ -1664,6 +1713,17 @@ void GDScriptLanguage::init() {
 		_add_global(E.name, E.ptr);
 	}
 
+	if (GLOBAL_GET("debug/gdscript/sampling_profiler/enabled") && !Engine::get_singleton()->is_editor_hint()) {
+		uint64_t interval_usec = MAX(int(GLOBAL_GET("debug/gdscript/sampling_profiler/interval_usec")), 1);
+		uint64_t save_interval_usec = MAX(int(GLOBAL_GET("debug/gdscript/sampling_profiler/save_interval_sec")), 0) * 1000000ULL;
+		GDScriptSampler::start(interval_usec, GLOBAL_GET("debug/gdscript/sampling_profiler/output_path"), save_interval_usec);
+	}
+
+	String native_library_path = GLOBAL_GET("gdscript/native_library/path");
+	if (!native_library_path.is_empty() && !Engine::get_singleton()->is_editor_hint()) {
+		GDScriptNativeLibrary::load(native_library_path);
+	}
+
 #ifdef TESTS_ENABLED
 	GDScriptTests::GDScriptTestRunner::handle_cmdline();
 #endif
@@ -1683,6 +1743,15 @@ Error GDScriptLanguage::execute_file(const String &p_path) {
 }
 
 void GDScriptLanguage::finish() {
+	GDScriptNativeLibrary::unload();
+
+	if (GDScriptSampler::is_active()) {
+		GDScriptSampler::stop();
+		String output_path = GLOBAL_GET("debug/gdscript/sampling_profiler/output_path");
+		if (!output_path.is_empty()) {
+			GDScriptSampler::save(output_path);
+		}
+	}
 }
 
 void GDScriptLanguage::profiling_start() {
@@ -2160,6 +2229,14 @@ GDScriptLanguage::GDScriptLanguage() {
 	_debug_call_stack_pos = 0;
 	int dmcs = GLOBAL_DEF("debug/settings/gdscript/max_call_stack", 1024);
 	ProjectSettings::get_singleton()->set_custom_property_info("debug/settings/gdscript/max_call_stack", PropertyInfo(Variant::INT, "debug/settings/gdscript/max_call_stack", PROPERTY_HINT_RANGE, "1024,4096,1,or_greater")); //minimum is 1024
+	GLOBAL_DEF("gdscript/bytecode_cache/enabled", false);
+	GLOBAL_DEF("gdscript/native_library/path", "");
+	ProjectSettings::get_singleton()->set_custom_property_info("gdscript/native_library/path", PropertyInfo(Variant::STRING, "gdscript/native_library/path", PROPERTY_HINT_FILE, "*.so,*.dll,*.dylib"));
+	GLOBAL_DEF("debug/gdscript/sampling_profiler/enabled", false);
+	GLOBAL_DEF("debug/gdscript/sampling_profiler/interval_usec", 1000);
+	ProjectSettings::get_singleton()->set_custom_property_info("debug/gdscript/sampling_profiler/interval_usec", PropertyInfo(Variant::INT, "debug/gdscript/sampling_profiler/interval_usec", PROPERTY_HINT_RANGE, "100,100000,1,or_greater"));
+	GLOBAL_DEF("debug/gdscript/sampling_profiler/output_path", "user://gdscript_samples.folded");
+	GLOBAL_DEF("debug/gdscript/sampling_profiler/save_interval_sec", 10);
 
 	if (EngineDebugger::is_active()) {
 		//debugging enabled!
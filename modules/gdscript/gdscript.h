@@ -39,6 +39,8 @@
 #include "core/object/script_language.h"
 #include "gdscript_function.h"
 
+class GDScriptParser;
+
 class GDScriptNativeClass : public RefCounted {
 	GDCLASS(GDScriptNativeClass, RefCounted);
 
@@ -72,6 +74,8 @@ class GDScript : public Script {
 	friend class GDScriptAnalyzer;
 	friend class GDScriptCompiler;
 	friend class GDScriptLanguage;
+	friend class GDScriptBytecodeSerializer;
+	friend class GDScriptBytecodeDeserializer;
 	friend struct GDScriptUtilityFunctionsDefinitions;
 
 	Ref<GDScriptNativeClass> native;
@@ -151,6 +155,7 @@ class GDScript : public Script {
 
 	void _save_orphaned_subclasses();
 	void _init_rpc_methods_properties();
+	Error _compile_parsed(GDScriptParser &p_parser, bool p_keep_state);
 
 	void _get_script_property_list(List<PropertyInfo> *r_list, bool p_include_base) const;
 	void _get_script_method_list(List<MethodInfo> *r_list, bool p_include_base) const;
@@ -183,6 +188,7 @@ public:
 	const Map<StringName, GDScriptFunction *> &get_member_functions() const { return member_functions; }
 	const Ref<GDScriptNativeClass> &get_native() const { return native; }
 	const String &get_script_class_name() const { return name; }
+	const String &get_fully_qualified_name() const { return fully_qualified_name; }
 
 	virtual bool has_script_signal(const StringName &p_signal) const override;
 	virtual void get_script_signal_list(List<MethodInfo> *r_signals) const override;
@@ -220,6 +226,7 @@ public:
 	void set_script_path(const String &p_path) { path = p_path; } //because subclasses need a path too...
 	Error load_source_code(const String &p_path);
 	Error load_byte_code(const String &p_path);
+	Error load_byte_code_from_buffer(const Vector<uint8_t> &p_bytecode);
 
 	Vector<uint8_t> get_as_byte_code() const;
 
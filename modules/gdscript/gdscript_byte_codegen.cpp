@@ -148,6 +148,7 @@ void GDScriptByteCodeGenerator::start_parameters() {
 	if (function->_default_arg_count > 0) {
 		append(GDScriptFunction::OPCODE_JUMP_TO_DEF_ARGUMENT);
 		function->default_arguments.push_back(opcodes.size());
+		jump_target_pos = opcodes.size();
 	}
 }
 
@@ -393,6 +394,15 @@ GDScriptFunction *GDScriptByteCodeGenerator::write_end() {
 		function->_lambdas_count = 0;
 	}
 
+	if (inline_cache_count) {
+		function->inline_caches.resize(inline_cache_count);
+		function->_inline_caches_ptr = function->inline_caches.ptrw();
+		function->_inline_caches_count = inline_cache_count;
+	} else {
+		function->_inline_caches_ptr = nullptr;
+		function->_inline_caches_count = 0;
+	}
+
 	if (debug_stack) {
 		function->stack_debug = stack_debug;
 	}
@@ -536,6 +546,8 @@ void GDScriptByteCodeGenerator::write_unary_operator(const Address &p_target, Va
 		// Gather specific operator.
 		Variant::ValidatedOperatorEvaluator op_func = Variant::get_validated_operator_evaluator(p_operator, p_left_operand.type.builtin_type, Variant::NIL);
 
+		last_operator_pos = opcodes.size();
+		last_operator_target = p_target;
 		append(GDScriptFunction::OPCODE_OPERATOR_VALIDATED, 3);
 		append(p_left_operand);
 		append(Address());
@@ -565,6 +577,8 @@ void GDScriptByteCodeGenerator::write_binary_operator(const Address &p_target, V
 		// Gather specific operator.
 		Variant::ValidatedOperatorEvaluator op_func = Variant::get_validated_operator_evaluator(p_operator, p_left_operand.type.builtin_type, p_right_operand.type.builtin_type);
 
+		last_operator_pos = opcodes.size();
+		last_operator_target = p_target;
 		append(GDScriptFunction::OPCODE_OPERATOR_VALIDATED, 3);
 		append(p_left_operand);
 		append(p_right_operand);
@@ -595,16 +609,29 @@ void GDScriptByteCodeGenerator::write_type_test_builtin(const Address &p_target,
 	append(p_type);
 }
 
-void GDScriptByteCodeGenerator::write_and_left_operand(const Address &p_left_operand) {
+void GDScriptByteCodeGenerator::write_jump_if_not(const Address &p_condition) {
+	// Fold the jump into the operator computing the condition, unless something jumps in between them.
+	bool fuse = last_operator_pos >= 0 && last_operator_pos + 5 == opcodes.size() && jump_target_pos != opcodes.size() &&
+			last_operator_target.mode == p_condition.mode && last_operator_target.address == p_condition.address;
+#ifdef TESTS_ENABLED
+	fuse = fuse && !GDScriptFunction::disable_vm_optimizations;
+#endif
+	if (fuse) {
+		opcodes.write[last_operator_pos] = GDScriptFunction::OPCODE_JUMP_IF_NOT_OPERATOR_VALIDATED | (3 << GDScriptFunction::INSTR_BITS);
+		return;
+	}
 	append(GDScriptFunction::OPCODE_JUMP_IF_NOT, 1);
-	append(p_left_operand);
+	append(p_condition);
+}
+
+void GDScriptByteCodeGenerator::write_and_left_operand(const Address &p_left_operand) {
+	write_jump_if_not(p_left_operand);
 	logic_op_jump_pos1.push_back(opcodes.size());
 	append(0); // Jump target, will be patched.
 }
 
 void GDScriptByteCodeGenerator::write_and_right_operand(const Address &p_right_operand) {
-	append(GDScriptFunction::OPCODE_JUMP_IF_NOT, 1);
-	append(p_right_operand);
+	write_jump_if_not(p_right_operand);
 	logic_op_jump_pos2.push_back(opcodes.size());
 	append(0); // Jump target, will be patched.
 }
@@ -660,8 +687,7 @@ void GDScriptByteCodeGenerator::write_start_ternary(const Address &p_target) {
 }
 
 void GDScriptByteCodeGenerator::write_ternary_condition(const Address &p_condition) {
-	append(GDScriptFunction::OPCODE_JUMP_IF_NOT, 1);
-	append(p_condition);
+	write_jump_if_not(p_condition);
 	ternary_jump_fail_pos.push_back(opcodes.size());
 	append(0); // Jump target, will be patched.
 }
@@ -758,6 +784,7 @@ void GDScriptByteCodeGenerator::write_set_named(const Address &p_target, const S
 	append(p_target);
 	append(p_source);
 	append(p_name);
+	append(inline_cache_count++);
 }
 
 void GDScriptByteCodeGenerator::write_get_named(const Address &p_target, const StringName &p_name, const Address &p_source) {
@@ -773,6 +800,7 @@ void GDScriptByteCodeGenerator::write_get_named(const Address &p_target, const S
 	append(p_source);
 	append(p_target);
 	append(p_name);
+	append(inline_cache_count++);
 }
 
 void GDScriptByteCodeGenerator::write_set_member(const Address &p_value, const StringName &p_name) {
@@ -862,6 +890,7 @@ void GDScriptByteCodeGenerator::write_assign_false(const Address &p_target) {
 void GDScriptByteCodeGenerator::write_assign_default_parameter(const Address &p_dst, const Address &p_src) {
 	write_assign(p_dst, p_src);
 	function->default_arguments.push_back(opcodes.size());
+	jump_target_pos = opcodes.size();
 }
 
 void GDScriptByteCodeGenerator::write_store_named_global(const Address &p_dst, const StringName &p_global) {
@@ -910,6 +939,7 @@ void GDScriptByteCodeGenerator::write_call(const Address &p_target, const Addres
 	append(p_target);
 	append(p_arguments.size());
 	append(p_function_name);
+	append(inline_cache_count++);
 }
 
 void GDScriptByteCodeGenerator::write_super_call(const Address &p_target, const StringName &p_function_name, const Vector<Address> &p_arguments) {
@@ -931,6 +961,7 @@ void GDScriptByteCodeGenerator::write_call_async(const Address &p_target, const
 	append(p_target);
 	append(p_arguments.size());
 	append(p_function_name);
+	append(inline_cache_count++);
 }
 
 void GDScriptByteCodeGenerator::write_call_gdscript_utility(const Address &p_target, GDScriptUtilityFunctions::FunctionPtr p_function, const Vector<Address> &p_arguments) {
@@ -1160,6 +1191,7 @@ void GDScriptByteCodeGenerator::write_call_self(const Address &p_target, const S
 	append(p_target);
 	append(p_arguments.size());
 	append(p_function_name);
+	append(inline_cache_count++);
 }
 
 void GDScriptByteCodeGenerator::write_call_self_async(const Address &p_target, const StringName &p_function_name, const Vector<Address> &p_arguments) {
@@ -1171,6 +1203,7 @@ void GDScriptByteCodeGenerator::write_call_self_async(const Address &p_target, c
 	append(p_target);
 	append(p_arguments.size());
 	append(p_function_name);
+	append(inline_cache_count++);
 }
 
 void GDScriptByteCodeGenerator::write_call_script_function(const Address &p_target, const Address &p_base, const StringName &p_function_name, const Vector<Address> &p_arguments) {
@@ -1182,6 +1215,7 @@ void GDScriptByteCodeGenerator::write_call_script_function(const Address &p_targ
 	append(p_target);
 	append(p_arguments.size());
 	append(p_function_name);
+	append(inline_cache_count++);
 }
 
 void GDScriptByteCodeGenerator::write_lambda(const Address &p_target, GDScriptFunction *p_function, const Vector<Address> &p_captures) {
@@ -1290,8 +1324,7 @@ void GDScriptByteCodeGenerator::write_await(const Address &p_target, const Addre
 }
 
 void GDScriptByteCodeGenerator::write_if(const Address &p_condition) {
-	append(GDScriptFunction::OPCODE_JUMP_IF_NOT, 1);
-	append(p_condition);
+	write_jump_if_not(p_condition);
 	if_jmp_addrs.push_back(opcodes.size());
 	append(0); // Jump destination, will be patched.
 }
@@ -1438,6 +1471,7 @@ void GDScriptByteCodeGenerator::write_for() {
 	// Next iteration.
 	int continue_addr = opcodes.size();
 	continue_addrs.push_back(continue_addr);
+	jump_target_pos = continue_addr;
 	append(iterate_opcode, 3);
 	append(counter);
 	append(container);
@@ -1473,12 +1507,12 @@ void GDScriptByteCodeGenerator::write_endfor() {
 void GDScriptByteCodeGenerator::start_while_condition() {
 	current_breaks_to_patch.push_back(List<int>());
 	continue_addrs.push_back(opcodes.size());
+	jump_target_pos = opcodes.size();
 }
 
 void GDScriptByteCodeGenerator::write_while(const Address &p_condition) {
 	// Condition check.
-	append(GDScriptFunction::OPCODE_JUMP_IF_NOT, 1);
-	append(p_condition);
+	write_jump_if_not(p_condition);
 	while_jmp_addrs.push_back(opcodes.size());
 	append(0); // End of loop address, will be patched.
 }
@@ -71,6 +71,13 @@ class GDScriptByteCodeGenerator : public GDScriptCodeGenerator {
 	int current_line = 0;
 	int instr_args_max = 0;
 	int ptrcall_max = 0;
+	int inline_cache_count = 0;
+
+	// Last validated operator, which a conditional jump right after it can be fused with.
+	int last_operator_pos = -1;
+	Address last_operator_target;
+	// Last code position something jumps to.
+	int jump_target_pos = -1;
 
 #ifdef DEBUG_ENABLED
 	List<int> temp_stack;
@@ -402,8 +409,11 @@ class GDScriptByteCodeGenerator : public GDScriptCodeGenerator {
 
 	void patch_jump(int p_address) {
 		opcodes.write[p_address] = opcodes.size();
+		jump_target_pos = opcodes.size();
 	}
 
+	void write_jump_if_not(const Address &p_condition);
+
 public:
 	virtual uint32_t add_parameter(const StringName &p_name, bool p_is_optional, const GDScriptDataType &p_type) override;
 	virtual uint32_t add_local(const StringName &p_name, const GDScriptDataType &p_type) override;
@@ -0,0 +1,1455 @@
+/*************************************************************************/
+/*  gdscript_bytecode_cache.cpp                                          */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2021 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2021 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "gdscript_bytecode_cache.h"
+
+#include "core/config/engine.h"
+#include "core/config/project_settings.h"
+#include "core/io/dir_access.h"
+#include "core/io/file_access.h"
+#include "core/io/marshalls.h"
+#include "core/version.h"
+#include "gdscript.h"
+#include "gdscript_cache.h"
+#include "gdscript_native.h"
+#include "gdscript_utility_functions.h"
+
+#define BYTECODE_CACHE_MAGIC "GDBC"
+#define BYTECODE_CACHE_VERSION 2
+#define BYTECODE_CACHE_USER_DIR "user://gdscript_cache"
+
+enum {
+	CONSTANT_VARIANT,
+	CONSTANT_OBJECT,
+};
+
+enum {
+	OBJECT_REF_NULL,
+	OBJECT_REF_LOCAL_CLASS, // Class in the script being serialized, by inner class names.
+	OBJECT_REF_SCRIPT_CLASS, // Class in another script, by path and inner class names.
+	OBJECT_REF_GLOBAL, // Entry of the GDScript global array (native classes, singletons).
+	OBJECT_REF_RESOURCE, // Any other resource saved to its own file.
+};
+
+enum {
+	FUNCTION_FLAG_INITIALIZER = 1,
+	FUNCTION_FLAG_IMPLICIT_INITIALIZER = 2,
+};
+
+/* Engine pointer names */
+
+GDScriptEngineFunctionNames::GDScriptEngineFunctionNames() {
+	for (int i = 0; i < Variant::VARIANT_MAX; i++) {
+		Variant::Type type = Variant::Type(i);
+
+		for (int op = 0; op < Variant::OP_MAX; op++) {
+			for (int j = 0; j < Variant::VARIANT_MAX; j++) {
+				Variant::ValidatedOperatorEvaluator evaluator = Variant::get_validated_operator_evaluator(Variant::Operator(op), type, Variant::Type(j));
+				if (evaluator && !operators.has(evaluator)) {
+					OperatorKey key;
+					key.op = Variant::Operator(op);
+					key.type_a = type;
+					key.type_b = Variant::Type(j);
+					operators.insert(evaluator, key);
+				}
+			}
+		}
+
+		List<StringName> members;
+		Variant::get_member_list(type, &members);
+		for (const StringName &E : members) {
+			MemberKey key;
+			key.type = type;
+			key.name = E;
+			Variant::ValidatedSetter setter = Variant::get_member_validated_setter(type, E);
+			if (setter && !setters.has(setter)) {
+				setters.insert(setter, key);
+			}
+			Variant::ValidatedGetter getter = Variant::get_member_validated_getter(type, E);
+			if (getter && !getters.has(getter)) {
+				getters.insert(getter, key);
+			}
+		}
+
+		Variant::ValidatedKeyedSetter keyed_setter = Variant::get_member_validated_keyed_setter(type);
+		if (keyed_setter && !keyed_setters.has(keyed_setter)) {
+			keyed_setters.insert(keyed_setter, type);
+		}
+		Variant::ValidatedKeyedGetter keyed_getter = Variant::get_member_validated_keyed_getter(type);
+		if (keyed_getter && !keyed_getters.has(keyed_getter)) {
+			keyed_getters.insert(keyed_getter, type);
+		}
+		Variant::ValidatedIndexedSetter indexed_setter = Variant::get_member_validated_indexed_setter(type);
+		if (indexed_setter && !indexed_setters.has(indexed_setter)) {
+			indexed_setters.insert(indexed_setter, type);
+		}
+		Variant::ValidatedIndexedGetter indexed_getter = Variant::get_member_validated_indexed_getter(type);
+		if (indexed_getter && !indexed_getters.has(indexed_getter)) {
+			indexed_getters.insert(indexed_getter, type);
+		}
+
+		List<StringName> methods;
+		Variant::get_builtin_method_list(type, &methods);
+		for (const StringName &E : methods) {
+			Variant::ValidatedBuiltInMethod method = Variant::get_validated_builtin_method(type, E);
+			if (method && !builtin_methods.has(method)) {
+				MemberKey key;
+				key.type = type;
+				key.name = E;
+				builtin_methods.insert(method, key);
+			}
+		}
+
+		for (int j = 0; j < Variant::get_constructor_count(type); j++) {
+			Variant::ValidatedConstructor constructor = Variant::get_validated_constructor(type, j);
+			if (constructor && !constructors.has(constructor)) {
+				ConstructorKey key;
+				key.type = type;
+				key.index = j;
+				constructors.insert(constructor, key);
+			}
+		}
+	}
+
+	List<StringName> utility_functions;
+	Variant::get_utility_function_list(&utility_functions);
+	for (const StringName &E : utility_functions) {
+		Variant::ValidatedUtilityFunction utility = Variant::get_validated_utility_function(E);
+		if (utility && !utilities.has(utility)) {
+			utilities.insert(utility, E);
+		}
+	}
+
+	List<StringName> gds_utility_functions;
+	GDScriptUtilityFunctions::get_function_list(&gds_utility_functions);
+	for (const StringName &E : gds_utility_functions) {
+		GDScriptUtilityFunctions::FunctionPtr utility = GDScriptUtilityFunctions::get_function(E);
+		if (utility && !gds_utilities.has(utility)) {
+			gds_utilities.insert(utility, E);
+		}
+	}
+}
+
+const GDScriptEngineFunctionNames &GDScriptBytecodeCache::get_engine_function_names() {
+	static GDScriptEngineFunctionNames names;
+	return names;
+}
+
+/* Buffer access */
+
+class GDScriptBytecodeWriter {
+public:
+	Vector<uint8_t> data;
+
+	void put_8(uint8_t p_value) {
+		data.push_back(p_value);
+	}
+
+	void put_32(uint32_t p_value) {
+		int pos = data.size();
+		data.resize(pos + 4);
+		encode_uint32(p_value, data.ptrw() + pos);
+	}
+
+	void put_buffer(const uint8_t *p_buffer, int p_size) {
+		int pos = data.size();
+		data.resize(pos + p_size);
+		memcpy(data.ptrw() + pos, p_buffer, p_size);
+	}
+
+	void put_string(const String &p_string) {
+		CharString utf8 = p_string.utf8();
+		put_32(utf8.length());
+		put_buffer((const uint8_t *)utf8.get_data(), utf8.length());
+	}
+
+	bool put_variant(const Variant &p_variant) {
+		int len = 0;
+		Error err = encode_variant(p_variant, nullptr, len, false);
+		if (err != OK) {
+			return false;
+		}
+		put_32(len);
+		int pos = data.size();
+		data.resize(pos + len);
+		encode_variant(p_variant, data.ptrw() + pos, len, false);
+		return true;
+	}
+};
+
+class GDScriptBytecodeReader {
+	const uint8_t *data = nullptr;
+	int size = 0;
+	int pos = 0;
+	bool error = false;
+
+	bool _check(int p_size) {
+		if (error || p_size < 0 || pos + p_size > size) {
+			error = true;
+			return false;
+		}
+		return true;
+	}
+
+public:
+	bool has_error() const { return error; }
+	void set_error() { error = true; }
+
+	uint8_t get_8() {
+		if (!_check(1)) {
+			return 0;
+		}
+		return data[pos++];
+	}
+
+	uint32_t get_32() {
+		if (!_check(4)) {
+			return 0;
+		}
+		uint32_t value = decode_uint32(data + pos);
+		pos += 4;
+		return value;
+	}
+
+	String get_string() {
+		int len = get_32();
+		if (!_check(len)) {
+			return String();
+		}
+		String string;
+		string.parse_utf8((const char *)data + pos, len);
+		pos += len;
+		return string;
+	}
+
+	Variant get_variant() {
+		int len = get_32();
+		if (!_check(len)) {
+			return Variant();
+		}
+		Variant variant;
+		if (decode_variant(variant, data + pos, len, nullptr, false) != OK) {
+			error = true;
+		}
+		pos += len;
+		return variant;
+	}
+
+	GDScriptBytecodeReader(const Vector<uint8_t> &p_buffer) {
+		data = p_buffer.ptr();
+		size = p_buffer.size();
+	}
+};
+
+/* Serializer */
+
+class GDScriptBytecodeSerializer {
+	const GDScript *root = nullptr;
+	Map<String, String> dependencies;
+	GDScriptBytecodeWriter body;
+	String error;
+
+	bool _fail(const String &p_error) {
+		if (error.is_empty()) {
+			error = p_error;
+		}
+		return false;
+	}
+
+	static const GDScript *_get_root_class(const GDScript *p_class, Vector<StringName> *r_names = nullptr) {
+		while (p_class->_owner) {
+			if (r_names) {
+				r_names->insert(0, p_class->name);
+			}
+			p_class = p_class->_owner;
+		}
+		return p_class;
+	}
+
+	void _add_dependency(const GDScript *p_script) {
+		while (p_script) {
+			const GDScript *script_root = _get_root_class(p_script);
+			if (script_root != root) {
+				const String &path = script_root->get_path();
+				if (path.is_resource_file() && !dependencies.has(path)) {
+					dependencies[path] = FileAccess::get_md5(path);
+				}
+			}
+			p_script = p_script->_base;
+		}
+	}
+
+	static bool _has_objects(const Variant &p_variant) {
+		switch (p_variant.get_type()) {
+			case Variant::OBJECT:
+			case Variant::CALLABLE:
+			case Variant::SIGNAL:
+				return true;
+			case Variant::ARRAY: {
+				Array array = p_variant;
+				if (array.is_typed()) {
+					// Typed arrays don't survive `encode_variant()`.
+					return true;
+				}
+				for (int i = 0; i < array.size(); i++) {
+					if (_has_objects(array[i])) {
+						return true;
+					}
+				}
+			} break;
+			case Variant::DICTIONARY: {
+				Dictionary dict = p_variant;
+				List<Variant> keys;
+				dict.get_key_list(&keys);
+				for (const Variant &E : keys) {
+					if (_has_objects(E) || _has_objects(dict[E])) {
+						return true;
+					}
+				}
+			} break;
+			default:
+				break;
+		}
+		return false;
+	}
+
+	bool _write_object(GDScriptBytecodeWriter &w, const Object *p_object) {
+		if (!p_object) {
+			w.put_8(OBJECT_REF_NULL);
+			return true;
+		}
+
+		const GDScript *script = Object::cast_to<GDScript>(p_object);
+		if (script) {
+			Vector<StringName> names;
+			const GDScript *script_root = _get_root_class(script, &names);
+			if (script_root == root) {
+				w.put_8(OBJECT_REF_LOCAL_CLASS);
+			} else {
+				const String &path = script_root->get_path();
+				if (!path.is_resource_file()) {
+					return _fail("Reference to a built-in script.");
+				}
+				w.put_8(OBJECT_REF_SCRIPT_CLASS);
+				w.put_string(path);
+				_add_dependency(script);
+			}
+			w.put_32(names.size());
+			for (int i = 0; i < names.size(); i++) {
+				w.put_string(names[i]);
+			}
+			return true;
+		}
+
+		GDScriptLanguage *language = GDScriptLanguage::get_singleton();
+		for (const Map<StringName, int>::Element *E = language->get_global_map().front(); E; E = E->next()) {
+			const Variant &global = language->get_global_array()[E->get()];
+			if (global.get_type() == Variant::OBJECT && global.operator Object *() == p_object) {
+				w.put_8(OBJECT_REF_GLOBAL);
+				w.put_string(E->key());
+				return true;
+			}
+		}
+
+		const Resource *resource = Object::cast_to<Resource>(p_object);
+		if (resource && resource->get_path().is_resource_file()) {
+			w.put_8(OBJECT_REF_RESOURCE);
+			w.put_string(resource->get_path());
+			return true;
+		}
+
+		return _fail("Reference to an object of type '" + p_object->get_class() + "' which is neither a global nor a saved resource.");
+	}
+
+	bool _write_constant(GDScriptBytecodeWriter &w, const Variant &p_constant) {
+		if (p_constant.get_type() == Variant::OBJECT) {
+			w.put_8(CONSTANT_OBJECT);
+			return _write_object(w, p_constant.operator Object *());
+		}
+		if (_has_objects(p_constant)) {
+			return _fail("Constant of type '" + Variant::get_type_name(p_constant.get_type()) + "' holds objects.");
+		}
+		w.put_8(CONSTANT_VARIANT);
+		if (!w.put_variant(p_constant)) {
+			return _fail("Constant of type '" + Variant::get_type_name(p_constant.get_type()) + "' can't be encoded.");
+		}
+		return true;
+	}
+
+	bool _write_data_type(GDScriptBytecodeWriter &w, const GDScriptDataType &p_type) {
+		w.put_8(p_type.has_type);
+		w.put_8(p_type.kind);
+		w.put_32(p_type.builtin_type);
+		w.put_string(p_type.native_type);
+		if (!_write_object(w, p_type.script_type)) {
+			return false;
+		}
+		w.put_8(p_type.script_type_ref.is_valid());
+		w.put_8(p_type.has_container_element_type());
+		if (p_type.has_container_element_type()) {
+			return _write_data_type(w, p_type.get_container_element_type());
+		}
+		return true;
+	}
+
+	bool _write_function(GDScriptBytecodeWriter &w, const GDScriptFunction *p_function) {
+		const GDScriptEngineFunctionNames &engine_names = GDScriptBytecodeCache::get_engine_function_names();
+
+		w.put_string(p_function->name);
+		w.put_string(p_function->source);
+		w.put_8(p_function->_static);
+		w.put_string(p_function->rpc_config.name);
+		w.put_32(p_function->rpc_config.rpc_mode);
+		w.put_8(p_function->rpc_config.sync);
+		w.put_32(p_function->rpc_config.transfer_mode);
+		w.put_32(p_function->rpc_config.channel);
+		if (!_write_data_type(w, p_function->return_type)) {
+			return false;
+		}
+
+		w.put_32(p_function->_argument_count);
+		w.put_32(p_function->argument_types.size());
+		for (int i = 0; i < p_function->argument_types.size(); i++) {
+			if (!_write_data_type(w, p_function->argument_types[i])) {
+				return false;
+			}
+		}
+#ifdef TOOLS_ENABLED
+		w.put_32(p_function->arg_names.size());
+		for (int i = 0; i < p_function->arg_names.size(); i++) {
+			w.put_string(p_function->arg_names[i]);
+		}
+		w.put_32(p_function->default_arg_values.size());
+		for (int i = 0; i < p_function->default_arg_values.size(); i++) {
+			if (!_write_constant(w, p_function->default_arg_values[i])) {
+				return false;
+			}
+		}
+#else
+		w.put_32(0);
+		w.put_32(0);
+#endif
+		w.put_32(p_function->default_arguments.size());
+		for (int i = 0; i < p_function->default_arguments.size(); i++) {
+			w.put_32(p_function->default_arguments[i]);
+		}
+
+		w.put_32(p_function->_initial_line);
+		w.put_32(p_function->_stack_size);
+		w.put_32(p_function->_instruction_args_size);
+		w.put_32(p_function->_ptrcall_args_size);
+		w.put_32(p_function->_inline_caches_count);
+
+		w.put_32(p_function->temporary_slots.size());
+		for (const Map<int, Variant::Type>::Element *E = p_function->temporary_slots.front(); E; E = E->next()) {
+			w.put_32(E->key());
+			w.put_32(E->get());
+		}
+
+		w.put_32(p_function->constants.size());
+		for (int i = 0; i < p_function->constants.size(); i++) {
+			if (!_write_constant(w, p_function->constants[i])) {
+				return false;
+			}
+		}
+
+		w.put_32(p_function->global_names.size());
+		for (int i = 0; i < p_function->global_names.size(); i++) {
+#ifdef TOOLS_ENABLED
+			// Autoloads are only named globals in the editor, the code using them won't run in a game.
+			if (GDScriptLanguage::get_singleton()->get_named_globals_map().has(p_function->global_names[i])) {
+				return _fail("Function '" + String(p_function->name) + "' uses the editor named global '" + String(p_function->global_names[i]) + "'.");
+			}
+#endif
+			w.put_string(p_function->global_names[i]);
+		}
+
+		w.put_32(p_function->code.size());
+		for (int i = 0; i < p_function->code.size(); i++) {
+			w.put_32(p_function->code[i]);
+		}
+
+		w.put_32(p_function->operator_funcs.size());
+		for (int i = 0; i < p_function->operator_funcs.size(); i++) {
+			const Map<Variant::ValidatedOperatorEvaluator, GDScriptEngineFunctionNames::OperatorKey>::Element *E = engine_names.operators.find(p_function->operator_funcs[i]);
+			if (!E) {
+				return _fail("Unknown operator evaluator.");
+			}
+			w.put_32(E->get().op);
+			w.put_32(E->get().type_a);
+			w.put_32(E->get().type_b);
+		}
+
+		w.put_32(p_function->setters.size());
+		for (int i = 0; i < p_function->setters.size(); i++) {
+			const Map<Variant::ValidatedSetter, GDScriptEngineFunctionNames::MemberKey>::Element *E = engine_names.setters.find(p_function->setters[i]);
+			if (!E) {
+				return _fail("Unknown member setter.");
+			}
+			w.put_32(E->get().type);
+			w.put_string(E->get().name);
+		}
+
+		w.put_32(p_function->getters.size());
+		for (int i = 0; i < p_function->getters.size(); i++) {
+			const Map<Variant::ValidatedGetter, GDScriptEngineFunctionNames::MemberKey>::Element *E = engine_names.getters.find(p_function->getters[i]);
+			if (!E) {
+				return _fail("Unknown member getter.");
+			}
+			w.put_32(E->get().type);
+			w.put_string(E->get().name);
+		}
+
+		w.put_32(p_function->keyed_setters.size());
+		for (int i = 0; i < p_function->keyed_setters.size(); i++) {
+			const Map<Variant::ValidatedKeyedSetter, Variant::Type>::Element *E = engine_names.keyed_setters.find(p_function->keyed_setters[i]);
+			if (!E) {
+				return _fail("Unknown keyed setter.");
+			}
+			w.put_32(E->get());
+		}
+
+		w.put_32(p_function->keyed_getters.size());
+		for (int i = 0; i < p_function->keyed_getters.size(); i++) {
+			const Map<Variant::ValidatedKeyedGetter, Variant::Type>::Element *E = engine_names.keyed_getters.find(p_function->keyed_getters[i]);
+			if (!E) {
+				return _fail("Unknown keyed getter.");
+			}
+			w.put_32(E->get());
+		}
+
+		w.put_32(p_function->indexed_setters.size());
+		for (int i = 0; i < p_function->indexed_setters.size(); i++) {
+			const Map<Variant::ValidatedIndexedSetter, Variant::Type>::Element *E = engine_names.indexed_setters.find(p_function->indexed_setters[i]);
+			if (!E) {
+				return _fail("Unknown indexed setter.");
+			}
+			w.put_32(E->get());
+		}
+
+		w.put_32(p_function->indexed_getters.size());
+		for (int i = 0; i < p_function->indexed_getters.size(); i++) {
+			const Map<Variant::ValidatedIndexedGetter, Variant::Type>::Element *E = engine_names.indexed_getters.find(p_function->indexed_getters[i]);
+			if (!E) {
+				return _fail("Unknown indexed getter.");
+			}
+			w.put_32(E->get());
+		}
+
+		w.put_32(p_function->builtin_methods.size());
+		for (int i = 0; i < p_function->builtin_methods.size(); i++) {
+			const Map<Variant::ValidatedBuiltInMethod, GDScriptEngineFunctionNames::MemberKey>::Element *E = engine_names.builtin_methods.find(p_function->builtin_methods[i]);
+			if (!E) {
+				return _fail("Unknown built-in method.");
+			}
+			w.put_32(E->get().type);
+			w.put_string(E->get().name);
+		}
+
+		w.put_32(p_function->constructors.size());
+		for (int i = 0; i < p_function->constructors.size(); i++) {
+			const Map<Variant::ValidatedConstructor, GDScriptEngineFunctionNames::ConstructorKey>::Element *E = engine_names.constructors.find(p_function->constructors[i]);
+			if (!E) {
+				return _fail("Unknown constructor.");
+			}
+			w.put_32(E->get().type);
+			w.put_32(E->get().index);
+		}
+
+		w.put_32(p_function->utilities.size());
+		for (int i = 0; i < p_function->utilities.size(); i++) {
+			const Map<Variant::ValidatedUtilityFunction, StringName>::Element *E = engine_names.utilities.find(p_function->utilities[i]);
+			if (!E) {
+				return _fail("Unknown utility function.");
+			}
+			w.put_string(E->get());
+		}
+
+		w.put_32(p_function->gds_utilities.size());
+		for (int i = 0; i < p_function->gds_utilities.size(); i++) {
+			const Map<GDScriptUtilityFunctions::FunctionPtr, StringName>::Element *E = engine_names.gds_utilities.find(p_function->gds_utilities[i]);
+			if (!E) {
+				return _fail("Unknown GDScript utility function.");
+			}
+			w.put_string(E->get());
+		}
+
+		w.put_32(p_function->methods.size());
+		for (int i = 0; i < p_function->methods.size(); i++) {
+			w.put_string(p_function->methods[i]->get_instance_class());
+			w.put_string(p_function->methods[i]->get_name());
+		}
+
+		w.put_32(p_function->lambdas.size());
+		for (int i = 0; i < p_function->lambdas.size(); i++) {
+			if (!_write_function(w, p_function->lambdas[i])) {
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	void _write_class_tree(const GDScript *p_class) {
+		body.put_32(p_class->subclasses.size());
+		for (const Map<StringName, Ref<GDScript>>::Element *E = p_class->subclasses.front(); E; E = E->next()) {
+			body.put_string(E->key());
+			_write_class_tree(E->get().ptr());
+		}
+	}
+
+	bool _write_class(const GDScript *p_class) {
+		GDScriptBytecodeWriter &w = body;
+
+		w.put_8(p_class->tool);
+		w.put_string(p_class->name);
+
+		if (p_class->base.is_valid()) {
+			w.put_8(1);
+			if (!_write_object(w, p_class->base.ptr())) {
+				return false;
+			}
+			_add_dependency(p_class->base.ptr());
+		} else {
+			ERR_FAIL_COND_V(p_class->native.is_null(), false);
+			w.put_8(0);
+			w.put_string(p_class->native->get_name());
+		}
+
+		w.put_32(p_class->member_indices.size());
+		for (const Map<StringName, GDScript::MemberInfo>::Element *E = p_class->member_indices.front(); E; E = E->next()) {
+			w.put_string(E->key());
+			w.put_32(E->get().index);
+			w.put_string(E->get().setter);
+			w.put_string(E->get().getter);
+			if (!_write_data_type(w, E->get().data_type)) {
+				return false;
+			}
+		}
+
+		w.put_32(p_class->members.size());
+		for (const Set<StringName>::Element *E = p_class->members.front(); E; E = E->next()) {
+			w.put_string(E->get());
+		}
+
+		w.put_32(p_class->member_info.size());
+		for (const Map<StringName, PropertyInfo>::Element *E = p_class->member_info.front(); E; E = E->next()) {
+			w.put_string(E->key());
+			w.put_32(E->get().type);
+			w.put_string(E->get().class_name);
+			w.put_32(E->get().hint);
+			w.put_string(E->get().hint_string);
+			w.put_32(E->get().usage);
+		}
+
+		w.put_32(p_class->constants.size());
+		for (const Map<StringName, Variant>::Element *E = p_class->constants.front(); E; E = E->next()) {
+			w.put_string(E->key());
+			if (!_write_constant(w, E->get())) {
+				return false;
+			}
+		}
+
+		w.put_32(p_class->_signals.size());
+		for (const Map<StringName, Vector<StringName>>::Element *E = p_class->_signals.front(); E; E = E->next()) {
+			w.put_string(E->key());
+			w.put_32(E->get().size());
+			for (int i = 0; i < E->get().size(); i++) {
+				w.put_string(E->get()[i]);
+			}
+		}
+
+		w.put_32(p_class->member_functions.size());
+		for (const Map<StringName, GDScriptFunction *>::Element *E = p_class->member_functions.front(); E; E = E->next()) {
+			uint8_t flags = 0;
+			if (E->get() == p_class->initializer) {
+				flags |= FUNCTION_FLAG_INITIALIZER;
+			}
+			if (E->get() == p_class->implicit_initializer) {
+				flags |= FUNCTION_FLAG_IMPLICIT_INITIALIZER;
+			}
+			w.put_string(E->key());
+			w.put_8(flags);
+			if (!_write_function(w, E->get())) {
+				return false;
+			}
+		}
+
+		w.put_32(p_class->subclasses.size());
+		for (const Map<StringName, Ref<GDScript>>::Element *E = p_class->subclasses.front(); E; E = E->next()) {
+			w.put_string(E->key());
+			if (!_write_class(E->get().ptr())) {
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+public:
+	const String &get_error() const { return error; }
+
+	Error serialize(const GDScript *p_script, Vector<uint8_t> &r_buffer) {
+		ERR_FAIL_COND_V_MSG(p_script->_owner != nullptr, ERR_INVALID_PARAMETER, "Inner classes are serialized with the script that contains them.");
+		root = p_script;
+
+		_write_class_tree(p_script);
+		if (!_write_class(p_script)) {
+			return ERR_UNAVAILABLE;
+		}
+
+		GDScriptBytecodeWriter header;
+		header.put_buffer((const uint8_t *)BYTECODE_CACHE_MAGIC, 4);
+		header.put_32(BYTECODE_CACHE_VERSION);
+		header.put_string(VERSION_FULL_BUILD);
+#ifdef DEBUG_ENABLED
+		header.put_8(1);
+#else
+		header.put_8(0);
+#endif
+		header.put_string(p_script->source.md5_text());
+		header.put_32(dependencies.size());
+		for (const Map<String, String>::Element *E = dependencies.front(); E; E = E->next()) {
+			header.put_string(E->key());
+			header.put_string(E->get());
+		}
+
+		r_buffer = header.data;
+		r_buffer.append_array(body.data);
+		return OK;
+	}
+};
+
+
+/* Deserializer */
+
+class GDScriptBytecodeDeserializer {
+	GDScript *root = nullptr;
+	GDScriptBytecodeReader r;
+	String error;
+
+	bool _fail(const String &p_error) {
+		if (error.is_empty()) {
+			error = p_error;
+		}
+		r.set_error();
+		return false;
+	}
+
+	bool _read_class_names(Ref<GDScript> &r_class) {
+		int count = r.get_32();
+		for (int i = 0; i < count && !r.has_error(); i++) {
+			StringName name = r.get_string();
+			const Map<StringName, Ref<GDScript>>::Element *E = r_class->subclasses.find(name);
+			if (!E) {
+				return _fail("Inner class '" + String(name) + "' not found in '" + r_class->fully_qualified_name + "'.");
+			}
+			r_class = E->get();
+		}
+		return !r.has_error();
+	}
+
+	// Returns the object wrapped in a Variant so references are held until the caller stores them.
+	// Scripts used as types are loaded shallow, like the compiler does for external classes.
+	bool _read_object(Variant &r_object, bool p_full_script) {
+		r_object = Variant();
+		switch (r.get_8()) {
+			case OBJECT_REF_NULL: {
+				r_object = (Object *)nullptr;
+			} break;
+			case OBJECT_REF_LOCAL_CLASS: {
+				Ref<GDScript> script = Ref<GDScript>(root);
+				if (!_read_class_names(script)) {
+					return false;
+				}
+				r_object = script;
+			} break;
+			case OBJECT_REF_SCRIPT_CLASS: {
+				String path = r.get_string();
+				if (r.has_error()) {
+					return false;
+				}
+				Ref<GDScript> script;
+				if (p_full_script) {
+					Error err = OK;
+					script = GDScriptCache::get_full_script(path, err, root->path);
+					if (err != OK || script.is_null() || !script->is_valid()) {
+						return _fail("Can't load script '" + path + "'.");
+					}
+				} else {
+					script = GDScriptCache::get_shallow_script(path, root->path);
+				}
+				if (!_read_class_names(script)) {
+					return false;
+				}
+				r_object = script;
+			} break;
+			case OBJECT_REF_GLOBAL: {
+				StringName name = r.get_string();
+				GDScriptLanguage *language = GDScriptLanguage::get_singleton();
+				const Map<StringName, int>::Element *E = language->get_global_map().find(name);
+				if (!E) {
+					return _fail("Global '" + String(name) + "' not found.");
+				}
+				r_object = language->get_global_array()[E->get()];
+			} break;
+			case OBJECT_REF_RESOURCE: {
+				String path = r.get_string();
+				if (r.has_error()) {
+					return false;
+				}
+				RES resource = ResourceLoader::load(path);
+				if (resource.is_null()) {
+					return _fail("Can't load resource '" + path + "'.");
+				}
+				r_object = resource;
+			} break;
+			default: {
+				return _fail("Invalid object reference.");
+			} break;
+		}
+		return !r.has_error();
+	}
+
+	bool _read_constant(Variant &r_constant) {
+		switch (r.get_8()) {
+			case CONSTANT_VARIANT: {
+				r_constant = r.get_variant();
+			} break;
+			case CONSTANT_OBJECT: {
+				return _read_object(r_constant, true);
+			} break;
+			default: {
+				return _fail("Invalid constant.");
+			} break;
+		}
+		return !r.has_error();
+	}
+
+	bool _read_data_type(GDScriptDataType &r_type) {
+		r_type.has_type = r.get_8();
+		r_type.kind = GDScriptDataType::Kind(r.get_8());
+		r_type.builtin_type = Variant::Type(r.get_32());
+		r_type.native_type = r.get_string();
+
+		Variant script;
+		if (!_read_object(script, false)) {
+			return false;
+		}
+		r_type.script_type = Object::cast_to<Script>((Object *)script);
+		if (r.get_8()) {
+			r_type.script_type_ref = Ref<Script>(r_type.script_type);
+		}
+		if (r.get_8()) {
+			GDScriptDataType element_type;
+			if (!_read_data_type(element_type)) {
+				return false;
+			}
+			r_type.set_container_element_type(element_type);
+		}
+		return !r.has_error();
+	}
+
+	// Sets up the raw pointers the VM uses, mirroring GDScriptByteCodeGenerator::write_end().
+	static void _update_function_pointers(GDScriptFunction *p_function) {
+		p_function->_constant_count = p_function->constants.size();
+		p_function->_constants_ptr = p_function->constants.size() ? p_function->constants.ptrw() : nullptr;
+		p_function->_global_names_count = p_function->global_names.size();
+		p_function->_global_names_ptr = p_function->global_names.size() ? p_function->global_names.ptr() : nullptr;
+		p_function->_code_size = p_function->code.size();
+		p_function->_code_ptr = p_function->code.size() ? p_function->code.ptr() : nullptr;
+		p_function->_default_arg_count = p_function->default_arguments.size() ? p_function->default_arguments.size() - 1 : 0;
+		p_function->_default_arg_ptr = p_function->default_arguments.size() ? p_function->default_arguments.ptr() : nullptr;
+		p_function->_operator_funcs_count = p_function->operator_funcs.size();
+		p_function->_operator_funcs_ptr = p_function->operator_funcs.size() ? p_function->operator_funcs.ptr() : nullptr;
+		p_function->_setters_count = p_function->setters.size();
+		p_function->_setters_ptr = p_function->setters.size() ? p_function->setters.ptr() : nullptr;
+		p_function->_getters_count = p_function->getters.size();
+		p_function->_getters_ptr = p_function->getters.size() ? p_function->getters.ptr() : nullptr;
+		p_function->_keyed_setters_count = p_function->keyed_setters.size();
+		p_function->_keyed_setters_ptr = p_function->keyed_setters.size() ? p_function->keyed_setters.ptr() : nullptr;
+		p_function->_keyed_getters_count = p_function->keyed_getters.size();
+		p_function->_keyed_getters_ptr = p_function->keyed_getters.size() ? p_function->keyed_getters.ptr() : nullptr;
+		p_function->_indexed_setters_count = p_function->indexed_setters.size();
+		p_function->_indexed_setters_ptr = p_function->indexed_setters.size() ? p_function->indexed_setters.ptr() : nullptr;
+		p_function->_indexed_getters_count = p_function->indexed_getters.size();
+		p_function->_indexed_getters_ptr = p_function->indexed_getters.size() ? p_function->indexed_getters.ptr() : nullptr;
+		p_function->_builtin_methods_count = p_function->builtin_methods.size();
+		p_function->_builtin_methods_ptr = p_function->builtin_methods.size() ? p_function->builtin_methods.ptr() : nullptr;
+		p_function->_constructors_count = p_function->constructors.size();
+		p_function->_constructors_ptr = p_function->constructors.size() ? p_function->constructors.ptr() : nullptr;
+		p_function->_utilities_count = p_function->utilities.size();
+		p_function->_utilities_ptr = p_function->utilities.size() ? p_function->utilities.ptr() : nullptr;
+		p_function->_gds_utilities_count = p_function->gds_utilities.size();
+		p_function->_gds_utilities_ptr = p_function->gds_utilities.size() ? p_function->gds_utilities.ptr() : nullptr;
+		p_function->_methods_count = p_function->methods.size();
+		p_function->_methods_ptr = p_function->methods.size() ? p_function->methods.ptrw() : nullptr;
+		p_function->_lambdas_count = p_function->lambdas.size();
+		p_function->_lambdas_ptr = p_function->lambdas.size() ? p_function->lambdas.ptrw() : nullptr;
+		p_function->_inline_caches_count = p_function->inline_caches.size();
+		p_function->_inline_caches_ptr = p_function->inline_caches.size() ? p_function->inline_caches.ptrw() : nullptr;
+	}
+
+	bool _read_function_body(GDScriptFunction *p_function) {
+		p_function->_static = r.get_8();
+		p_function->rpc_config.name = r.get_string();
+		p_function->rpc_config.rpc_mode = MultiplayerAPI::RPCMode(r.get_32());
+		p_function->rpc_config.sync = r.get_8();
+		p_function->rpc_config.transfer_mode = MultiplayerPeer::TransferMode(r.get_32());
+		p_function->rpc_config.channel = r.get_32();
+		if (!_read_data_type(p_function->return_type)) {
+			return false;
+		}
+
+		p_function->_argument_count = r.get_32();
+		int count = r.get_32();
+		for (int i = 0; i < count && !r.has_error(); i++) {
+			GDScriptDataType type;
+			if (!_read_data_type(type)) {
+				return false;
+			}
+			p_function->argument_types.push_back(type);
+		}
+		count = r.get_32();
+		for (int i = 0; i < count && !r.has_error(); i++) {
+			StringName arg_name = r.get_string();
+#ifdef TOOLS_ENABLED
+			p_function->arg_names.push_back(arg_name);
+#endif
+		}
+		count = r.get_32();
+		for (int i = 0; i < count && !r.has_error(); i++) {
+			Variant value;
+			if (!_read_constant(value)) {
+				return false;
+			}
+#ifdef TOOLS_ENABLED
+			p_function->default_arg_values.push_back(value);
+#endif
+		}
+		count = r.get_32();
+		for (int i = 0; i < count && !r.has_error(); i++) {
+			p_function->default_arguments.push_back(r.get_32());
+		}
+
+		p_function->_initial_line = r.get_32();
+		p_function->_stack_size = r.get_32();
+		p_function->_instruction_args_size = r.get_32();
+		p_function->_ptrcall_args_size = r.get_32();
+		p_function->inline_caches.resize(r.get_32());
+
+		count = r.get_32();
+		for (int i = 0; i < count && !r.has_error(); i++) {
+			int slot = r.get_32();
+			p_function->temporary_slots[slot] = Variant::Type(r.get_32());
+		}
+
+		count = r.get_32();
+		for (int i = 0; i < count && !r.has_error(); i++) {
+			Variant constant;
+			if (!_read_constant(constant)) {
+				return false;
+			}
+			p_function->constants.push_back(constant);
+		}
+
+		count = r.get_32();
+		for (int i = 0; i < count && !r.has_error(); i++) {
+			p_function->global_names.push_back(r.get_string());
+		}
+
+		count = r.get_32();
+		if (!r.has_error()) {
+			p_function->code.resize(count);
+			int *code = p_function->code.ptrw();
+			for (int i = 0; i < count; i++) {
+				code[i] = r.get_32();
+			}
+		}
+
+		count = r.get_32();
+		for (int i = 0; i < count && !r.has_error(); i++) {
+			Variant::Operator op = Variant::Operator(r.get_32());
+			Variant::Type type_a = Variant::Type(r.get_32());
+			Variant::Type type_b = Variant::Type(r.get_32());
+			if (op < 0 || op >= Variant::OP_MAX || type_a < 0 || type_a >= Variant::VARIANT_MAX || type_b < 0 || type_b >= Variant::VARIANT_MAX) {
+				return _fail("Invalid operator.");
+			}
+			Variant::ValidatedOperatorEvaluator evaluator = Variant::get_validated_operator_evaluator(op, type_a, type_b);
+			if (!evaluator) {
+				return _fail("Operator evaluator not found.");
+			}
+			p_function->operator_funcs.push_back(evaluator);
+		}
+
+		count = r.get_32();
+		for (int i = 0; i < count && !r.has_error(); i++) {
+			Variant::Type type = Variant::Type(r.get_32());
+			StringName member = r.get_string();
+			if (type < 0 || type >= Variant::VARIANT_MAX || !Variant::get_member_validated_setter(type, member)) {
+				return _fail("Setter for '" + String(member) + "' not found.");
+			}
+			p_function->setters.push_back(Variant::get_member_validated_setter(type, member));
+		}
+
+		count = r.get_32();
+		for (int i = 0; i < count && !r.has_error(); i++) {
+			Variant::Type type = Variant::Type(r.get_32());
+			StringName member = r.get_string();
+			if (type < 0 || type >= Variant::VARIANT_MAX || !Variant::get_member_validated_getter(type, member)) {
+				return _fail("Getter for '" + String(member) + "' not found.");
+			}
+			p_function->getters.push_back(Variant::get_member_validated_getter(type, member));
+		}
+
+		count = r.get_32();
+		for (int i = 0; i < count && !r.has_error(); i++) {
+			Variant::Type type = Variant::Type(r.get_32());
+			if (type < 0 || type >= Variant::VARIANT_MAX || !Variant::get_member_validated_keyed_setter(type)) {
+				return _fail("Keyed setter not found.");
+			}
+			p_function->keyed_setters.push_back(Variant::get_member_validated_keyed_setter(type));
+		}
+
+		count = r.get_32();
+		for (int i = 0; i < count && !r.has_error(); i++) {
+			Variant::Type type = Variant::Type(r.get_32());
+			if (type < 0 || type >= Variant::VARIANT_MAX || !Variant::get_member_validated_keyed_getter(type)) {
+				return _fail("Keyed getter not found.");
+			}
+			p_function->keyed_getters.push_back(Variant::get_member_validated_keyed_getter(type));
+		}
+
+		count = r.get_32();
+		for (int i = 0; i < count && !r.has_error(); i++) {
+			Variant::Type type = Variant::Type(r.get_32());
+			if (type < 0 || type >= Variant::VARIANT_MAX || !Variant::get_member_validated_indexed_setter(type)) {
+				return _fail("Indexed setter not found.");
+			}
+			p_function->indexed_setters.push_back(Variant::get_member_validated_indexed_setter(type));
+		}
+
+		count = r.get_32();
+		for (int i = 0; i < count && !r.has_error(); i++) {
+			Variant::Type type = Variant::Type(r.get_32());
+			if (type < 0 || type >= Variant::VARIANT_MAX || !Variant::get_member_validated_indexed_getter(type)) {
+				return _fail("Indexed getter not found.");
+			}
+			p_function->indexed_getters.push_back(Variant::get_member_validated_indexed_getter(type));
+		}
+
+		count = r.get_32();
+		for (int i = 0; i < count && !r.has_error(); i++) {
+			Variant::Type type = Variant::Type(r.get_32());
+			StringName method = r.get_string();
+			if (type < 0 || type >= Variant::VARIANT_MAX || !Variant::get_validated_builtin_method(type, method)) {
+				return _fail("Built-in method '" + String(method) + "' not found.");
+			}
+			p_function->builtin_methods.push_back(Variant::get_validated_builtin_method(type, method));
+		}
+
+		count = r.get_32();
+		for (int i = 0; i < count && !r.has_error(); i++) {
+			Variant::Type type = Variant::Type(r.get_32());
+			int index = r.get_32();
+			if (type < 0 || type >= Variant::VARIANT_MAX || index < 0 || index >= Variant::get_constructor_count(type)) {
+				return _fail("Constructor not found.");
+			}
+			p_function->constructors.push_back(Variant::get_validated_constructor(type, index));
+		}
+
+		count = r.get_32();
+		for (int i = 0; i < count && !r.has_error(); i++) {
+			StringName utility = r.get_string();
+			if (!Variant::get_validated_utility_function(utility)) {
+				return _fail("Utility function '" + String(utility) + "' not found.");
+			}
+			p_function->utilities.push_back(Variant::get_validated_utility_function(utility));
+		}
+
+		count = r.get_32();
+		for (int i = 0; i < count && !r.has_error(); i++) {
+			StringName utility = r.get_string();
+			if (!GDScriptUtilityFunctions::function_exists(utility)) {
+				return _fail("GDScript utility function '" + String(utility) + "' not found.");
+			}
+			p_function->gds_utilities.push_back(GDScriptUtilityFunctions::get_function(utility));
+		}
+
+		count = r.get_32();
+		for (int i = 0; i < count && !r.has_error(); i++) {
+			StringName class_name = r.get_string();
+			StringName method = r.get_string();
+			MethodBind *method_bind = ClassDB::get_method(class_name, method);
+			if (!method_bind) {
+				return _fail("Method '" + String(class_name) + "::" + String(method) + "' not found.");
+			}
+			p_function->methods.push_back(method_bind);
+		}
+
+		count = r.get_32();
+		for (int i = 0; i < count && !r.has_error(); i++) {
+			GDScriptFunction *lambda = _read_function(p_function->_script);
+			if (!lambda) {
+				return false;
+			}
+			p_function->lambdas.push_back(lambda);
+		}
+
+		if (r.has_error()) {
+			return false;
+		}
+		_update_function_pointers(p_function);
+		return true;
+	}
+
+	GDScriptFunction *_read_function(GDScript *p_class) {
+		GDScriptFunction *function = memnew(GDScriptFunction);
+		function->name = r.get_string();
+		function->source = r.get_string();
+		function->_script = p_class;
+#ifdef DEBUG_ENABLED
+		function->func_cname = (String(function->source) + " - " + String(function->name)).utf8();
+		function->_func_cname = function->func_cname.get_data();
+#endif
+
+		if (!_read_function_body(function)) {
+			memdelete(function);
+			return nullptr;
+		}
+		return function;
+	}
+
+	bool _make_class_tree(GDScript *p_class) {
+		p_class->subclasses.clear();
+
+		int count = r.get_32();
+		for (int i = 0; i < count && !r.has_error(); i++) {
+			StringName name = r.get_string();
+			String fully_qualified_name = p_class->fully_qualified_name + "::" + name;
+
+			Ref<GDScript> subclass = GDScriptLanguage::get_singleton()->get_orphan_subclass(fully_qualified_name);
+			if (subclass.is_null()) {
+				subclass.instantiate();
+			}
+			subclass->_owner = p_class;
+			subclass->fully_qualified_name = fully_qualified_name;
+			p_class->subclasses.insert(name, subclass);
+
+			if (!_make_class_tree(subclass.ptr())) {
+				return false;
+			}
+		}
+		return !r.has_error();
+	}
+
+	bool _read_class(GDScript *p_class) {
+		p_class->native = Ref<GDScriptNativeClass>();
+		p_class->base = Ref<GDScript>();
+		p_class->_base = nullptr;
+		p_class->members.clear();
+		p_class->constants.clear();
+		for (Map<StringName, GDScriptFunction *>::Element *E = p_class->member_functions.front(); E; E = E->next()) {
+			memdelete(E->get());
+		}
+		p_class->member_functions.clear();
+		p_class->member_indices.clear();
+		// Inline caches may point into the member layout.
+		GDScriptFunction::flush_inline_caches();
+		p_class->member_info.clear();
+		p_class->_signals.clear();
+		p_class->initializer = nullptr;
+		p_class->implicit_initializer = nullptr;
+
+		p_class->tool = r.get_8();
+		p_class->name = r.get_string();
+
+		if (r.get_8()) {
+			Variant base;
+			if (!_read_object(base, true)) {
+				return false;
+			}
+			Ref<GDScript> base_script = base;
+			if (base_script.is_null()) {
+				return _fail("Base of '" + p_class->fully_qualified_name + "' is not a GDScript.");
+			}
+			p_class->base = base_script;
+			p_class->_base = base_script.ptr();
+			p_class->native = base_script->native;
+		} else {
+			StringName native_name = r.get_string();
+			GDScriptLanguage *language = GDScriptLanguage::get_singleton();
+			const Map<StringName, int>::Element *E = language->get_global_map().find(native_name);
+			if (!E) {
+				return _fail("Native class '" + String(native_name) + "' not found.");
+			}
+			p_class->native = language->get_global_array()[E->get()];
+			if (p_class->native.is_null()) {
+				return _fail("'" + String(native_name) + "' is not a native class.");
+			}
+		}
+
+		int count = r.get_32();
+		for (int i = 0; i < count && !r.has_error(); i++) {
+			StringName name = r.get_string();
+			GDScript::MemberInfo info;
+			info.index = r.get_32();
+			info.setter = r.get_string();
+			info.getter = r.get_string();
+			if (!_read_data_type(info.data_type)) {
+				return false;
+			}
+			p_class->member_indices[name] = info;
+		}
+
+		count = r.get_32();
+		for (int i = 0; i < count && !r.has_error(); i++) {
+			p_class->members.insert(r.get_string());
+		}
+
+		count = r.get_32();
+		for (int i = 0; i < count && !r.has_error(); i++) {
+			PropertyInfo info;
+			info.name = r.get_string();
+			info.type = Variant::Type(r.get_32());
+			info.class_name = r.get_string();
+			info.hint = PropertyHint(r.get_32());
+			info.hint_string = r.get_string();
+			info.usage = r.get_32();
+			p_class->member_info[info.name] = info;
+		}
+
+		count = r.get_32();
+		for (int i = 0; i < count && !r.has_error(); i++) {
+			StringName name = r.get_string();
+			Variant constant;
+			if (!_read_constant(constant)) {
+				return false;
+			}
+			p_class->constants.insert(name, constant);
+		}
+
+		count = r.get_32();
+		for (int i = 0; i < count && !r.has_error(); i++) {
+			StringName name = r.get_string();
+			Vector<StringName> parameters;
+			int parameter_count = r.get_32();
+			for (int j = 0; j < parameter_count && !r.has_error(); j++) {
+				parameters.push_back(r.get_string());
+			}
+			p_class->_signals[name] = parameters;
+		}
+
+		count = r.get_32();
+		for (int i = 0; i < count && !r.has_error(); i++) {
+			StringName name = r.get_string();
+			uint8_t flags = r.get_8();
+			GDScriptFunction *function = _read_function(p_class);
+			if (!function) {
+				return false;
+			}
+			p_class->member_functions[name] = function;
+			if (flags & FUNCTION_FLAG_INITIALIZER) {
+				p_class->initializer = function;
+			}
+			if (flags & FUNCTION_FLAG_IMPLICIT_INITIALIZER) {
+				p_class->implicit_initializer = function;
+			}
+		}
+
+		count = r.get_32();
+		for (int i = 0; i < count && !r.has_error(); i++) {
+			StringName name = r.get_string();
+			Map<StringName, Ref<GDScript>>::Element *E = p_class->subclasses.find(name);
+			if (!E) {
+				return _fail("Inner class '" + String(name) + "' not found.");
+			}
+			if (!_read_class(E->get().ptr())) {
+				return false;
+			}
+		}
+
+		if (r.has_error()) {
+			return false;
+		}
+		p_class->valid = true;
+		return true;
+	}
+
+	bool _read_header(const String &p_source) {
+		uint8_t magic[4];
+		for (int i = 0; i < 4; i++) {
+			magic[i] = r.get_8();
+		}
+		if (r.has_error() || memcmp(magic, BYTECODE_CACHE_MAGIC, 4) != 0) {
+			return _fail("Not a GDScript bytecode file.");
+		}
+		if (r.get_32() != BYTECODE_CACHE_VERSION) {
+			return _fail("Unsupported bytecode version.");
+		}
+		if (r.get_string() != VERSION_FULL_BUILD) {
+			return _fail("Bytecode was compiled by a different engine build.");
+		}
+#ifdef DEBUG_ENABLED
+		const uint8_t debug = 1;
+#else
+		const uint8_t debug = 0;
+#endif
+		if (r.get_8() != debug) {
+			return _fail("Bytecode was compiled for a different build type (debug/release).");
+		}
+		if (r.get_string() != p_source.md5_text()) {
+			return _fail("Source code changed.");
+		}
+		int count = r.get_32();
+		for (int i = 0; i < count && !r.has_error(); i++) {
+			String path = r.get_string();
+			String md5 = r.get_string();
+			if (FileAccess::get_md5(path) != md5) {
+				return _fail("Dependency '" + path + "' changed.");
+			}
+		}
+		return !r.has_error();
+	}
+
+public:
+	const String &get_error() const { return error; }
+
+	Error deserialize(GDScript *p_script) {
+		root = p_script;
+
+		if (!_read_header(p_script->source)) {
+			return ERR_FILE_MISSING_DEPENDENCIES;
+		}
+
+		p_script->fully_qualified_name = p_script->path;
+		p_script->_owner = nullptr;
+		if (!_make_class_tree(p_script) || !_read_class(p_script)) {
+			p_script->valid = false;
+			return ERR_FILE_CORRUPT;
+		}
+
+		GDScriptNativeLibrary::bind_script(p_script);
+
+		return GDScriptCache::finish_compiling(p_script->get_path());
+	}
+
+	GDScriptBytecodeDeserializer(const Vector<uint8_t> &p_buffer) :
+			r(p_buffer) {}
+};
+
+/* GDScriptBytecodeCache */
+
+Error GDScriptBytecodeCache::serialize(const GDScript *p_script, Vector<uint8_t> &r_buffer) {
+	ERR_FAIL_NULL_V(p_script, ERR_INVALID_PARAMETER);
+	ERR_FAIL_COND_V_MSG(!p_script->is_valid(), ERR_UNCONFIGURED, "Only successfully compiled scripts can be serialized.");
+
+	GDScriptBytecodeSerializer serializer;
+	Error err = serializer.serialize(p_script, r_buffer);
+	if (err != OK) {
+		print_verbose("GDScript: Can't serialize bytecode for '" + p_script->get_path() + "': " + serializer.get_error());
+	}
+	return err;
+}
+
+Error GDScriptBytecodeCache::deserialize(GDScript *p_script, const Vector<uint8_t> &p_buffer) {
+	ERR_FAIL_NULL_V(p_script, ERR_INVALID_PARAMETER);
+
+	GDScriptBytecodeDeserializer deserializer(p_buffer);
+	Error err = deserializer.deserialize(p_script);
+	if (err != OK) {
+		print_verbose("GDScript: Can't use bytecode for '" + p_script->get_path() + "': " + deserializer.get_error());
+	}
+	return err;
+}
+
+String GDScriptBytecodeCache::get_export_path(const String &p_script_path) {
+	return p_script_path.get_basename() + ".gdc";
+}
+
+String GDScriptBytecodeCache::get_user_cache_path(const String &p_script_path) {
+	return String(BYTECODE_CACHE_USER_DIR).plus_file(p_script_path.md5_text() + ".gdc");
+}
+
+bool GDScriptBytecodeCache::can_use_cache(const GDScript *p_script) {
+	// The editor needs the parser for documentation, and the debugger needs stack information
+	// which is not kept in the cache.
+	if (Engine::get_singleton()->is_editor_hint() || EngineDebugger::is_active()) {
+		return false;
+	}
+	return p_script->get_path().is_resource_file() && p_script->get_path().get_extension() == "gd";
+}
+
+Error GDScriptBytecodeCache::load_cached(GDScript *p_script) {
+	if (!can_use_cache(p_script)) {
+		return ERR_UNAVAILABLE;
+	}
+
+	Vector<String> paths;
+	paths.push_back(get_export_path(p_script->get_path()));
+	if (GLOBAL_GET("gdscript/bytecode_cache/enabled")) {
+		paths.push_back(get_user_cache_path(p_script->get_path()));
+	}
+
+	for (int i = 0; i < paths.size(); i++) {
+		if (!FileAccess::exists(paths[i])) {
+			continue;
+		}
+		Error err = OK;
+		Vector<uint8_t> buffer = FileAccess::get_file_as_array(paths[i], &err);
+		if (err == OK && p_script->load_byte_code_from_buffer(buffer) == OK) {
+			return OK;
+		}
+	}
+
+	return ERR_FILE_NOT_FOUND;
+}
+
+void GDScriptBytecodeCache::save_cached(const GDScript *p_script) {
+	if (!can_use_cache(p_script) || !GLOBAL_GET("gdscript/bytecode_cache/enabled")) {
+		return;
+	}
+
+	Vector<uint8_t> buffer;
+	if (serialize(p_script, buffer) != OK) {
+		return;
+	}
+
+	DirAccessRef da = DirAccess::create(DirAccess::ACCESS_USERDATA);
+	if (!da->dir_exists(BYTECODE_CACHE_USER_DIR)) {
+		Error err = da->make_dir_recursive(BYTECODE_CACHE_USER_DIR);
+		ERR_FAIL_COND_MSG(err != OK, "Can't create GDScript bytecode cache folder: " + String(BYTECODE_CACHE_USER_DIR));
+	}
+
+	String cache_path = get_user_cache_path(p_script->get_path());
+	FileAccessRef f = FileAccess::open(cache_path, FileAccess::WRITE);
+	ERR_FAIL_COND_MSG(!f, "Can't write GDScript bytecode cache file: " + cache_path);
+	f->store_buffer(buffer.ptr(), buffer.size());
+}
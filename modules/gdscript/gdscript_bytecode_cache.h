@@ -0,0 +1,99 @@
+/*************************************************************************/
+/*  gdscript_bytecode_cache.h                                            */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2021 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2021 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef GDSCRIPT_BYTECODE_CACHE_H
+#define GDSCRIPT_BYTECODE_CACHE_H
+
+#include "core/string/ustring.h"
+#include "core/templates/map.h"
+#include "core/templates/vector.h"
+#include "core/variant/variant.h"
+#include "gdscript_utility_functions.h"
+
+class GDScript;
+
+// The validated function pointers stored in a GDScriptFunction have no names,
+// so they are looked up by enumerating everything Variant exposes. This is only
+// done once, the first time they are needed.
+struct GDScriptEngineFunctionNames {
+	struct OperatorKey {
+		Variant::Operator op = Variant::OP_MAX;
+		Variant::Type type_a = Variant::NIL;
+		Variant::Type type_b = Variant::NIL;
+	};
+
+	struct MemberKey {
+		Variant::Type type = Variant::NIL;
+		StringName name;
+	};
+
+	struct ConstructorKey {
+		Variant::Type type = Variant::NIL;
+		int index = 0;
+	};
+
+	Map<Variant::ValidatedOperatorEvaluator, OperatorKey> operators;
+	Map<Variant::ValidatedSetter, MemberKey> setters;
+	Map<Variant::ValidatedGetter, MemberKey> getters;
+	Map<Variant::ValidatedKeyedSetter, Variant::Type> keyed_setters;
+	Map<Variant::ValidatedKeyedGetter, Variant::Type> keyed_getters;
+	Map<Variant::ValidatedIndexedSetter, Variant::Type> indexed_setters;
+	Map<Variant::ValidatedIndexedGetter, Variant::Type> indexed_getters;
+	Map<Variant::ValidatedBuiltInMethod, MemberKey> builtin_methods;
+	Map<Variant::ValidatedConstructor, ConstructorKey> constructors;
+	Map<Variant::ValidatedUtilityFunction, StringName> utilities;
+	Map<GDScriptUtilityFunctions::FunctionPtr, StringName> gds_utilities;
+
+	GDScriptEngineFunctionNames();
+};
+
+// Serialized form of a compiled GDScript class tree. Constants, global names,
+// code and type information are stored as is, while engine pointers (validated
+// operators, setters, method binds...) are stored by name and resolved again
+// on load. A buffer is only accepted if the hashes of the script source and of
+// the scripts it depends on still match, otherwise the script is recompiled.
+class GDScriptBytecodeCache {
+public:
+	static Error serialize(const GDScript *p_script, Vector<uint8_t> &r_buffer);
+	static Error deserialize(GDScript *p_script, const Vector<uint8_t> &p_buffer);
+
+	// Bytecode written next to the script on export, e.g. `res://player.gdc`.
+	static String get_export_path(const String &p_script_path);
+	// Bytecode written to the user cache after a script is compiled at runtime.
+	static String get_user_cache_path(const String &p_script_path);
+
+	static const GDScriptEngineFunctionNames &get_engine_function_names();
+
+	static bool can_use_cache(const GDScript *p_script);
+	static Error load_cached(GDScript *p_script);
+	static void save_cached(const GDScript *p_script);
+};
+
+#endif // GDSCRIPT_BYTECODE_CACHE_H
@@ -30,6 +30,7 @@
 
 #include "gdscript_cache.h"
 
+#include "core/config/project_settings.h"
 #include "core/io/file_access.h"
 #include "core/templates/vector.h"
 #include "gdscript.h"
@@ -58,6 +59,9 @@ Error GDScriptParserRef::raise_status(Status p_new_status) {
 			case EMPTY:
 				result = parser->parse(GDScriptCache::get_source_code(path), path, false);
 				status = PARSED;
+				if (result == OK) {
+					GDScriptCache::queue_dependencies(parser);
+				}
 				break;
 			case PARSED: {
 				analyzer = memnew(GDScriptAnalyzer(parser));
@@ -113,6 +117,10 @@ GDScriptParserRef::~GDScriptParserRef() {
 }
 
 GDScriptCache *GDScriptCache::singleton = nullptr;
+#ifdef TESTS_ENABLED
+bool GDScriptCache::disable_parse_ahead = false;
+uint32_t GDScriptCache::parse_ahead_taken = 0;
+#endif
 
 void GDScriptCache::remove_script(const String &p_path) {
 	MutexLock lock(singleton->lock);
@@ -133,10 +141,18 @@ Ref<GDScriptParserRef> GDScriptCache::get_parser(const String &p_path, GDScriptP
 			r_error = ERR_FILE_NOT_FOUND;
 			return ref;
 		}
-		GDScriptParser *parser = memnew(GDScriptParser);
 		ref.instantiate();
-		ref->parser = parser;
 		ref->path = p_path;
+		ref->parser = take_parsed_script(p_path);
+		if (ref->parser != nullptr) {
+			ref->status = GDScriptParserRef::PARSED;
+			// The owner compiles this script once it's done, so parse it again for that in the meantime.
+			if (p_owner != String() && !singleton->full_gdscript_cache.has(p_path)) {
+				_queue_parse(p_path);
+			}
+		} else {
+			ref->parser = memnew(GDScriptParser);
+		}
 		singleton->parser_map[p_path] = ref.ptr();
 	}
 
@@ -208,7 +224,13 @@ Ref<GDScript> GDScriptCache::get_full_script(const String &p_path, Error &r_erro
 		return script;
 	}
 
+	singleton->loading_depth++;
 	r_error = script->reload();
+	singleton->loading_depth--;
+	if (singleton->loading_depth == 0) {
+		// Nothing else will claim what was parsed ahead of time for this load.
+		_clear_parse_tasks();
+	}
 	if (r_error) {
 		return script;
 	}
@@ -243,11 +265,121 @@ Error GDScriptCache::finish_compiling(const String &p_owner) {
 	return err;
 }
 
+void GDScriptCache::_parse_task(void *p_userdata) {
+	ParseTask *task = (ParseTask *)p_userdata;
+
+	task->source = get_source_code(task->path);
+	task->parser = memnew(GDScriptParser);
+	task->error = task->parser->parse(task->source, task->path, false);
+	if (task->error == OK) {
+		task->parser->get_dependency_hints(&task->dependency_paths, &task->dependency_names);
+	}
+}
+
+void GDScriptCache::_queue_parse(const String &p_path) {
+	if (singleton->loading_depth == 0 || singleton->parse_tasks.has(p_path)) {
+		return;
+	}
+#ifdef TESTS_ENABLED
+	if (disable_parse_ahead) {
+		return;
+	}
+#endif
+
+	// The parser fills these lazily, make sure it's done before workers use them.
+	GDScriptParser::get_builtin_type(StringName());
+	GDScriptParser::get_real_class_name(StringName());
+
+	ParseTask *task = memnew(ParseTask);
+	task->path = p_path;
+	task->task_id = WorkerThreadPool::get_singleton()->add_native_task(&GDScriptCache::_parse_task, task);
+	singleton->parse_tasks[p_path] = task;
+}
+
+void GDScriptCache::_queue_dependencies(const Set<String> &p_paths, const Set<StringName> &p_names) {
+	Set<String> paths = p_paths;
+
+	// Names are resolved here rather than on the workers, since global classes and autoloads may change on the main thread.
+	for (const Set<StringName>::Element *E = p_names.front(); E; E = E->next()) {
+		if (ScriptServer::is_global_class(E->get())) {
+			paths.insert(ScriptServer::get_global_class_path(E->get()));
+		} else if (ProjectSettings::get_singleton()->has_autoload(E->get())) {
+			const ProjectSettings::AutoloadInfo &info = ProjectSettings::get_singleton()->get_autoload(E->get());
+			if (info.is_singleton) {
+				paths.insert(info.path);
+			}
+		}
+	}
+
+	for (const Set<String>::Element *E = paths.front(); E; E = E->next()) {
+		const String &path = E->get();
+		if (path.get_extension().to_lower() != "gd" || singleton->parser_map.has(path) || singleton->full_gdscript_cache.has(path)) {
+			continue;
+		}
+		if (!FileAccess::exists(path)) {
+			continue;
+		}
+		_queue_parse(path);
+	}
+}
+
+void GDScriptCache::queue_dependencies(const GDScriptParser *p_parser) {
+	MutexLock lock(singleton->lock);
+	// Only done while loading, whatever is left unused is discarded once it ends.
+	if (singleton->loading_depth == 0) {
+		return;
+	}
+
+	Set<String> paths;
+	Set<StringName> names;
+	p_parser->get_dependency_hints(&paths, &names);
+	_queue_dependencies(paths, names);
+}
+
+GDScriptParser *GDScriptCache::take_parsed_script(const String &p_path, const String *p_source) {
+	MutexLock lock(singleton->lock);
+	ParseTask **task_ptr = singleton->parse_tasks.getptr(p_path);
+	if (task_ptr == nullptr) {
+		return nullptr;
+	}
+	ParseTask *task = *task_ptr;
+	singleton->parse_tasks.erase(p_path);
+
+	// Workers never take the lock, so it can be held while waiting.
+	WorkerThreadPool::get_singleton()->wait_for_task_completion(task->task_id);
+
+	GDScriptParser *parser = nullptr;
+	if (task->error == OK && (p_source == nullptr || *p_source == task->source)) {
+		parser = task->parser;
+		_queue_dependencies(task->dependency_paths, task->dependency_names);
+#ifdef TESTS_ENABLED
+		parse_ahead_taken++;
+#endif
+	} else {
+		memdelete(task->parser);
+	}
+	memdelete(task);
+
+	return parser;
+}
+
+void GDScriptCache::_clear_parse_tasks() {
+	const String *key = nullptr;
+	while ((key = singleton->parse_tasks.next(key))) {
+		ParseTask *task = singleton->parse_tasks[*key];
+		WorkerThreadPool::get_singleton()->wait_for_task_completion(task->task_id);
+		memdelete(task->parser);
+		memdelete(task);
+	}
+	singleton->parse_tasks.clear();
+}
+
 GDScriptCache::GDScriptCache() {
 	singleton = this;
 }
 
 GDScriptCache::~GDScriptCache() {
+	_clear_parse_tasks();
 	parser_map.clear();
 	shallow_gdscript_cache.clear();
 	full_gdscript_cache.clear();
@@ -33,6 +33,7 @@
 
 #include "core/object/ref_counted.h"
 #include "core/os/mutex.h"
+#include "core/os/worker_thread_pool.h"
 #include "core/templates/hash_map.h"
 #include "core/templates/set.h"
 #include "gdscript.h"
@@ -69,11 +70,25 @@ public:
 };
 
 class GDScriptCache {
+	// A script parsed ahead of time on a worker thread, because a script being loaded depends on it.
+	// Only the worker touches it until the task is waited on.
+	struct ParseTask {
+		WorkerThreadPool::TaskID task_id = -1;
+		String path;
+		String source;
+		GDScriptParser *parser = nullptr;
+		Error error = OK;
+		Set<String> dependency_paths;
+		Set<StringName> dependency_names;
+	};
+
 	// String key is full path.
 	HashMap<String, GDScriptParserRef *> parser_map;
 	HashMap<String, GDScript *> shallow_gdscript_cache;
 	HashMap<String, GDScript *> full_gdscript_cache;
 	HashMap<String, Set<String>> dependencies;
+	HashMap<String, ParseTask *> parse_tasks;
+	int loading_depth = 0;
 
 	friend class GDScript;
 	friend class GDScriptParserRef;
@@ -83,13 +98,26 @@ class GDScriptCache {
 	Mutex lock;
 	static void remove_script(const String &p_path);
 
+	static void _parse_task(void *p_userdata);
+	static void _queue_parse(const String &p_path);
+	static void _queue_dependencies(const Set<String> &p_paths, const Set<StringName> &p_names);
+	static void _clear_parse_tasks();
+
 public:
 	static Ref<GDScriptParserRef> get_parser(const String &p_path, GDScriptParserRef::Status status, Error &r_error, const String &p_owner = String());
+	static void queue_dependencies(const GDScriptParser *p_parser);
+	static GDScriptParser *take_parsed_script(const String &p_path, const String *p_source = nullptr);
 	static String get_source_code(const String &p_path);
 	static Ref<GDScript> get_shallow_script(const String &p_path, const String &p_owner = String());
 	static Ref<GDScript> get_full_script(const String &p_path, Error &r_error, const String &p_owner = String());
 	static Error finish_compiling(const String &p_owner);
 
+#ifdef TESTS_ENABLED
+	// Lets tests compare with a serial load, and count the parses done ahead of time that were used.
+	static bool disable_parse_ahead;
+	static uint32_t parse_ahead_taken;
+#endif
+
 	GDScriptCache();
 	~GDScriptCache();
 };
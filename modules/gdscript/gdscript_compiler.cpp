@@ -33,6 +33,7 @@
 #include "gdscript.h"
 #include "gdscript_byte_codegen.h"
 #include "gdscript_cache.h"
+#include "gdscript_native.h"
 #include "gdscript_utility_functions.h"
 
 bool GDScriptCompiler::_is_class_member_property(CodeGen &codegen, const StringName &p_name) {
@@ -62,6 +63,56 @@ bool GDScriptCompiler::_is_class_member_property(GDScript *owner, const StringNa
 	return ClassDB::has_property(nc->get_name(), p_name);
 }
 
+// Whether a compound assignment can write the result of the operation straight into the variable, instead of going
+// through a temporary. The variable must already hold its type so the validated operator can store into it in place.
+bool GDScriptCompiler::_can_operate_in_place(const GDScriptParser::AssignmentNode *p_assignment, const GDScriptCodeGenerator::Address &p_target, const GDScriptCodeGenerator::Address &p_assigned) const {
+#ifdef TESTS_ENABLED
+	if (GDScriptFunction::disable_vm_optimizations) {
+		return false;
+	}
+#endif
+	if (p_assignment->use_conversion_assign || p_assignment->assignee->type != GDScriptParser::Node::IDENTIFIER) {
+		return false;
+	}
+
+	const GDScriptParser::IdentifierNode *identifier = static_cast<const GDScriptParser::IdentifierNode *>(p_assignment->assignee);
+	if (identifier->source == GDScriptParser::IdentifierNode::LOCAL_VARIABLE) {
+		if (p_target.mode != GDScriptCodeGenerator::Address::LOCAL_VARIABLE) {
+			return false;
+		}
+	} else if (identifier->source == GDScriptParser::IdentifierNode::MEMBER_VARIABLE) {
+		// Onready members are null until _ready() runs.
+		if (p_target.mode != GDScriptCodeGenerator::Address::MEMBER || !identifier->variable_source || identifier->variable_source->onready) {
+			return false;
+		}
+	} else {
+		return false;
+	}
+
+	if (!p_target.type.has_type || p_target.type.kind != GDScriptDataType::BUILTIN || !p_assigned.type.has_type || p_assigned.type.kind != GDScriptDataType::BUILTIN) {
+		return false;
+	}
+
+	Variant::Type type = p_target.type.builtin_type;
+	if (Variant::get_operator_return_type(p_assignment->variant_op, type, p_assigned.type.builtin_type) != type) {
+		return false;
+	}
+
+	// Only types whose operators compute the whole result before storing it, so the target can also be an operand.
+	switch (type) {
+		case Variant::BOOL:
+		case Variant::INT:
+		case Variant::FLOAT:
+		case Variant::VECTOR2:
+		case Variant::VECTOR2I:
+		case Variant::VECTOR3:
+		case Variant::VECTOR3I:
+			return true;
+		default:
+			return false;
+	}
+}
+
 void GDScriptCompiler::_set_error(const String &p_error, const GDScriptParser::Node *p_node) {
 	if (error != "") {
 		return;
@@ -1065,7 +1116,14 @@ GDScriptCodeGenerator::Address GDScriptCompiler::_parse_expression(CodeGen &code
 					return GDScriptCodeGenerator::Address();
 				}
 
-				if (assignment->operation != GDScriptParser::AssignmentNode::OP_NONE) {
+				if (assignment->operation != GDScriptParser::AssignmentNode::OP_NONE && _can_operate_in_place(assignment, target, assigned)) {
+					// Store the result straight into the variable.
+					gen->write_binary_operator(target, assignment->variant_op, target, assigned);
+					if (assigned.mode == GDScriptCodeGenerator::Address::TEMPORARY) {
+						gen->pop_temporary();
+					}
+					return GDScriptCodeGenerator::Address(); // Assignment does not return a value.
+				} else if (assignment->operation != GDScriptParser::AssignmentNode::OP_NONE) {
 					// Perform operation.
 					op_result = codegen.add_temporary();
 					gen->write_binary_operator(op_result, assignment->variant_op, target, assigned);
@@ -2180,6 +2238,8 @@ Error GDScriptCompiler::_parse_class_level(GDScript *p_script, const GDScriptPar
 	}
 	p_script->member_functions.clear();
 	p_script->member_indices.clear();
+	// Inline caches may point into the member layout.
+	GDScriptFunction::flush_inline_caches();
 	p_script->member_info.clear();
 	p_script->_signals.clear();
 	p_script->initializer = nullptr;
@@ -2626,6 +2686,8 @@ Error GDScriptCompiler::compile(const GDScriptParser *p_parser, GDScript *p_scri
 		return err;
 	}
 
+	GDScriptNativeLibrary::bind_script(p_script);
+
 	return GDScriptCache::finish_compiling(p_script->get_path());
 }
 
@@ -115,6 +115,7 @@ class GDScriptCompiler {
 
 	bool _is_class_member_property(CodeGen &codegen, const StringName &p_name);
 	bool _is_class_member_property(GDScript *owner, const StringName &p_name);
+	bool _can_operate_in_place(const GDScriptParser::AssignmentNode *p_assignment, const GDScriptCodeGenerator::Address &p_target, const GDScriptCodeGenerator::Address &p_assigned) const;
 
 	void _set_error(const String &p_error, const GDScriptParser::Node *p_node);
 
@@ -31,6 +31,8 @@
 #include "gdscript_function.h"
 
 #include "gdscript.h"
+#include "gdscript_native.h"
+#include "gdscript_sampler.h"
 
 const int *GDScriptFunction::get_code() const {
 	return _code_ptr;
@@ -138,6 +140,11 @@ void GDScriptFunction::debug_get_stack_member_state(int p_line, List<Pair<String
 	}
 }
 
+SafeNumeric<uint32_t> GDScriptFunction::inline_cache_epoch(1);
+#ifdef TESTS_ENABLED
+bool GDScriptFunction::disable_vm_optimizations = false;
+#endif
+
 GDScriptFunction::GDScriptFunction() {
 	name = "<anonymous>";
 #ifdef DEBUG_ENABLED
@@ -149,10 +156,16 @@ GDScriptFunction::GDScriptFunction() {
 }
 
 GDScriptFunction::~GDScriptFunction() {
+	GDScriptSampler::function_freed(this);
+	GDScriptNativeLibrary::function_freed(this);
+
 	for (int i = 0; i < lambdas.size(); i++) {
 		memdelete(lambdas[i]);
 	}
 
+	// Inline caches may point to this function.
+	flush_inline_caches();
+
 #ifdef DEBUG_ENABLED
 
 	MutexLock lock(GDScriptLanguage::get_singleton()->lock);
@@ -38,6 +38,7 @@
 #include "core/templates/pair.h"
 #include "core/templates/self_list.h"
 #include "core/variant/variant.h"
+#include "gdscript_native.h"
 #include "gdscript_utility_functions.h"
 
 class GDScriptInstance;
@@ -306,6 +307,7 @@ public:
 		OPCODE_JUMP,
 		OPCODE_JUMP_IF,
 		OPCODE_JUMP_IF_NOT,
+		OPCODE_JUMP_IF_NOT_OPERATOR_VALIDATED,
 		OPCODE_JUMP_TO_DEF_ARGUMENT,
 		OPCODE_RETURN,
 		OPCODE_RETURN_TYPED_BUILTIN,
@@ -424,9 +426,42 @@ public:
 		StringName identifier;
 	};
 
+	// Remembers what a named get, set or call resolved to for the last few types of objects seen at its call site.
+	struct InlineCache {
+		enum {
+			ENTRY_COUNT = 4,
+		};
+
+		enum Kind {
+			KIND_EMPTY,
+			KIND_GENERIC, // Can't be cached, take the regular path.
+			KIND_MEMBER, // Member variable without setter or getter of a GDScript instance.
+			KIND_SCRIPT_FUNCTION, // Function of the script of a GDScript instance, or of one of its bases.
+			KIND_METHOD_BIND, // Native method not overridden by the script.
+		};
+
+		struct Entry {
+			Kind kind = KIND_EMPTY;
+			ObjectID script_id; // Null for objects without script.
+			StringName class_name;
+			int member_index = -1;
+			const GDScriptDataType *member_type = nullptr;
+			GDScriptFunction *function = nullptr;
+			MethodBind *method = nullptr;
+		};
+
+		uint32_t epoch = 0;
+		uint32_t next_entry = 0;
+		Entry entries[ENTRY_COUNT];
+	};
+
 private:
 	friend class GDScriptCompiler;
 	friend class GDScriptByteCodeGenerator;
+	friend class GDScriptBytecodeSerializer;
+	friend class GDScriptBytecodeDeserializer;
+	friend class GDScriptNativeFunctionWriter;
+	friend class GDScriptNativeLibrary;
 
 	StringName source;
 
@@ -463,6 +498,8 @@ private:
 	MethodBind **_methods_ptr = nullptr;
 	int _lambdas_count = 0;
 	GDScriptFunction **_lambdas_ptr = nullptr;
+	int _inline_caches_count = 0;
+	InlineCache *_inline_caches_ptr = nullptr;
 	const int *_code_ptr = nullptr;
 	int _code_size = 0;
 	int _argument_count = 0;
@@ -493,12 +530,16 @@ private:
 	Vector<GDScriptUtilityFunctions::FunctionPtr> gds_utilities;
 	Vector<MethodBind *> methods;
 	Vector<GDScriptFunction *> lambdas;
+	Vector<InlineCache> inline_caches;
 	Vector<int> code;
 	Vector<GDScriptDataType> argument_types;
 	GDScriptDataType return_type;
 
 	Map<int, Variant::Type> temporary_slots;
 
+	// Ahead-of-time compiled body, see GDScriptNativeLibrary.
+	GDScriptNativeFunction native_function = nullptr;
+
 #ifdef TOOLS_ENABLED
 	Vector<StringName> arg_names;
 	Vector<Variant> default_arg_values;
@@ -509,6 +550,16 @@ private:
 	_FORCE_INLINE_ Variant *_get_variant(int p_address, GDScriptInstance *p_instance, Variant *p_stack, String &r_error) const;
 	_FORCE_INLINE_ String _get_call_error(const Callable::CallError &p_err, const String &p_where, const Variant **argptrs) const;
 
+	// Bumped whenever functions or member layouts go away, which flushes all inline caches.
+	static SafeNumeric<uint32_t> inline_cache_epoch;
+
+	InlineCache::Entry *_find_inline_cache_entry(int p_cache, Object *p_object, GDScriptInstance *&r_instance) const;
+	bool _get_named_cached(int p_cache, const Variant *p_base, const StringName &p_name, Variant *r_dst) const;
+	bool _set_named_cached(int p_cache, Variant *p_base, const StringName &p_name, const Variant *p_value) const;
+	bool _call_cached(int p_cache, Variant *p_base, const StringName &p_method, const Variant **p_args, int p_argcount, Variant &r_ret, Callable::CallError &r_err) const;
+
+	bool _call_native(const Variant **p_args, int p_argcount, Variant &r_ret);
+
 	friend class GDScriptLanguage;
 
 	SelfList<GDScriptFunction> function_list{ this };
@@ -562,6 +613,7 @@ public:
 	GDScriptDataType get_argument_type(int p_idx) const;
 	GDScript *get_script() const { return _script; }
 	StringName get_source() const { return source; }
+	bool has_native_code() const { return native_function != nullptr; }
 
 	void debug_get_stack_member_state(int p_line, List<Pair<StringName, int>> *r_stackvars) const;
 
@@ -588,6 +640,12 @@ public:
 
 	Variant call(GDScriptInstance *p_instance, const Variant **p_args, int p_argcount, Callable::CallError &r_err, CallState *p_state = nullptr);
 
+	static void flush_inline_caches() { inline_cache_epoch.increment(); }
+#ifdef TESTS_ENABLED
+	// Lets the VM benchmark compare against the code generated and run without inline caches and superinstructions.
+	static bool disable_vm_optimizations;
+#endif
+
 #ifdef DEBUG_ENABLED
 	void disassemble(const Vector<String> &p_code_lines) const;
 #endif
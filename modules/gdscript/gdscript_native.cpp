@@ -0,0 +1,1173 @@
+/*************************************************************************/
+/*  gdscript_native.cpp                                                  */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2021 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2021 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "gdscript_native.h"
+
+#include "core/config/project_settings.h"
+#include "core/io/dir_access.h"
+#include "core/io/file_access.h"
+#include "core/io/resource_loader.h"
+#include "core/os/os.h"
+#include "core/string/string_builder.h"
+#include "gdscript.h"
+#include "gdscript_bytecode_cache.h"
+
+/* Utility functions */
+
+// Math utility functions with a direct C++ equivalent. Arguments are
+// substituted for `{0}`, `{1}`... and are always plain variables or literals,
+// so they can be used more than once. The expressions mirror core/math.
+struct GDScriptNativeUtility {
+	const char *name;
+	const char *code;
+	Variant::Type return_type;
+	int argument_count;
+	Variant::Type argument_type;
+};
+
+static const GDScriptNativeUtility native_utilities[] = {
+	{ "sin", "std::sin({0})", Variant::FLOAT, 1, Variant::FLOAT },
+	{ "cos", "std::cos({0})", Variant::FLOAT, 1, Variant::FLOAT },
+	{ "tan", "std::tan({0})", Variant::FLOAT, 1, Variant::FLOAT },
+	{ "sinh", "std::sinh({0})", Variant::FLOAT, 1, Variant::FLOAT },
+	{ "cosh", "std::cosh({0})", Variant::FLOAT, 1, Variant::FLOAT },
+	{ "tanh", "std::tanh({0})", Variant::FLOAT, 1, Variant::FLOAT },
+	{ "asin", "std::asin({0})", Variant::FLOAT, 1, Variant::FLOAT },
+	{ "acos", "std::acos({0})", Variant::FLOAT, 1, Variant::FLOAT },
+	{ "atan", "std::atan({0})", Variant::FLOAT, 1, Variant::FLOAT },
+	{ "atan2", "std::atan2({0}, {1})", Variant::FLOAT, 2, Variant::FLOAT },
+	{ "sqrt", "std::sqrt({0})", Variant::FLOAT, 1, Variant::FLOAT },
+	{ "fmod", "std::fmod({0}, {1})", Variant::FLOAT, 2, Variant::FLOAT },
+	{ "fposmod", "gd_fposmod({0}, {1})", Variant::FLOAT, 2, Variant::FLOAT },
+	{ "posmod", "gd_posmod({0}, {1})", Variant::INT, 2, Variant::INT },
+	{ "floor", "std::floor({0})", Variant::FLOAT, 1, Variant::FLOAT },
+	{ "ceil", "std::ceil({0})", Variant::FLOAT, 1, Variant::FLOAT },
+	{ "round", "std::round({0})", Variant::FLOAT, 1, Variant::FLOAT },
+	{ "absf", "std::fabs({0})", Variant::FLOAT, 1, Variant::FLOAT },
+	{ "absi", "gd_absi({0})", Variant::INT, 1, Variant::INT },
+	{ "signf", "(({0}) == 0 ? 0.0 : (({0}) < 0 ? -1.0 : 1.0))", Variant::FLOAT, 1, Variant::FLOAT },
+	{ "signi", "(({0}) == 0 ? int64_t(0) : (({0}) < 0 ? int64_t(-1) : int64_t(1)))", Variant::INT, 1, Variant::INT },
+	{ "pow", "std::pow({0}, {1})", Variant::FLOAT, 2, Variant::FLOAT },
+	{ "log", "std::log({0})", Variant::FLOAT, 1, Variant::FLOAT },
+	{ "exp", "std::exp({0})", Variant::FLOAT, 1, Variant::FLOAT },
+	{ "deg2rad", "(({0}) * (GD_PI / 180.0))", Variant::FLOAT, 1, Variant::FLOAT },
+	{ "rad2deg", "(({0}) * (180.0 / GD_PI))", Variant::FLOAT, 1, Variant::FLOAT },
+	{ "mini", "(({0}) < ({1}) ? ({0}) : ({1}))", Variant::INT, 2, Variant::INT },
+	{ "maxi", "(({0}) > ({1}) ? ({0}) : ({1}))", Variant::INT, 2, Variant::INT },
+	{ "minf", "(({0}) < ({1}) ? ({0}) : ({1}))", Variant::FLOAT, 2, Variant::FLOAT },
+	{ "maxf", "(({0}) > ({1}) ? ({0}) : ({1}))", Variant::FLOAT, 2, Variant::FLOAT },
+	{ "clampi", "(({0}) < ({1}) ? ({1}) : (({0}) > ({2}) ? ({2}) : ({0})))", Variant::INT, 3, Variant::INT },
+	{ "clampf", "(({0}) < ({1}) ? ({1}) : (({0}) > ({2}) ? ({2}) : ({0})))", Variant::FLOAT, 3, Variant::FLOAT },
+	{ nullptr, nullptr, Variant::NIL, 0, Variant::NIL },
+};
+
+// Helpers used by the generated code. Integer arithmetic wraps around instead
+// of being undefined, and division or modulo by zero gives zero.
+static const char *native_preamble = R"(#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+#if defined(_WIN32)
+#define GDSCRIPT_NATIVE_EXPORT extern "C" __declspec(dllexport)
+#else
+#define GDSCRIPT_NATIVE_EXPORT extern "C" __attribute__((visibility("default")))
+#endif
+
+#define GD_PI 3.1415926535897932384626433833
+
+namespace {
+
+typedef void (*GDScriptNativeFunction)(const void **p_args, void *r_ret);
+
+struct GDScriptNativeFunctionInfo {
+	const char *script;
+	const char *function;
+	uint64_t hash;
+	GDScriptNativeFunction function_ptr;
+};
+
+inline double gd_f64(uint64_t p_bits) {
+	double value;
+	memcpy(&value, &p_bits, sizeof(value));
+	return value;
+}
+
+inline int64_t gd_add(int64_t a, int64_t b) { return (int64_t)((uint64_t)a + (uint64_t)b); }
+inline int64_t gd_sub(int64_t a, int64_t b) { return (int64_t)((uint64_t)a - (uint64_t)b); }
+inline int64_t gd_mul(int64_t a, int64_t b) { return (int64_t)((uint64_t)a * (uint64_t)b); }
+inline int64_t gd_neg(int64_t a) { return (int64_t)(0 - (uint64_t)a); }
+inline int64_t gd_div(int64_t a, int64_t b) { return b == 0 ? 0 : (b == -1 ? gd_neg(a) : a / b); }
+inline int64_t gd_mod(int64_t a, int64_t b) { return (b == 0 || b == -1) ? 0 : a % b; }
+inline int64_t gd_shl(int64_t a, int64_t b) { return (int64_t)((uint64_t)a << (b & 63)); }
+inline int64_t gd_shr(int64_t a, int64_t b) { return a >> (b & 63); }
+inline int64_t gd_absi(int64_t a) { return a < 0 ? gd_neg(a) : a; }
+
+inline int64_t gd_posmod(int64_t x, int64_t y) {
+	int64_t value = gd_mod(x, y);
+	if ((value < 0 && y > 0) || (value > 0 && y < 0)) {
+		value += y;
+	}
+	return value;
+}
+
+inline double gd_fposmod(double x, double y) {
+	double value = std::fmod(x, y);
+	if ((value < 0 && y > 0) || (value > 0 && y < 0)) {
+		value += y;
+	}
+	value += 0.0;
+	return value;
+}
+
+)";
+
+/* Function translation */
+
+// Translates one function. A first pass follows the control flow to find the
+// type of every stack slot at every instruction, since temporaries and block
+// locals share slots. A slot gets one C++ variable per type it holds, which
+// the VM guarantees are never read across types. A second pass writes the code,
+// with instructions becoming statements and jumps becoming gotos.
+class GDScriptNativeFunctionWriter {
+	enum {
+		TYPE_UNSET = -1,
+		TYPE_CONFLICT = -2,
+	};
+
+	typedef Vector<int8_t> State;
+
+	struct Successor {
+		int ip = 0;
+		State state;
+	};
+
+	const GDScriptFunction *function = nullptr;
+	String error;
+
+	Vector<int> instructions; // Start of each instruction.
+	Map<int, int> instruction_index;
+	Vector<State> states; // State before each instruction, empty if unreachable.
+	Map<int, int> labels;
+	Set<String> variables;
+
+	bool returns_value = false;
+	Variant::Type return_type = Variant::NIL;
+
+	bool _fail(const String &p_error) {
+		if (error.is_empty()) {
+			error = p_error;
+		}
+		return false;
+	}
+
+	static bool _is_supported_type(int p_type) {
+		return p_type == Variant::BOOL || p_type == Variant::INT || p_type == Variant::FLOAT;
+	}
+
+	static String _get_c_type(Variant::Type p_type) {
+		switch (p_type) {
+			case Variant::BOOL:
+				return "bool";
+			case Variant::INT:
+				return "int64_t";
+			default:
+				return "double";
+		}
+	}
+
+	static String _get_variable(int p_slot, Variant::Type p_type) {
+		static const char *suffixes[] = { "", "b", "i", "f" };
+		return "s" + itos(p_slot) + "_" + suffixes[p_type];
+	}
+
+	static String _convert(const String &p_code, Variant::Type p_from, Variant::Type p_to) {
+		if (p_from == p_to) {
+			return p_code;
+		}
+		return "(" + _get_c_type(p_to) + ")(" + p_code + ")";
+	}
+
+	static String _booleanize(const String &p_code, Variant::Type p_type) {
+		switch (p_type) {
+			case Variant::BOOL:
+				return p_code;
+			case Variant::INT:
+				return "(" + p_code + " != 0)";
+			default:
+				return "(" + p_code + " != 0.0)";
+		}
+	}
+
+	String _get_constant_code(const Variant &p_value) const {
+		switch (p_value.get_type()) {
+			case Variant::BOOL:
+				return bool(p_value) ? "true" : "false";
+			case Variant::INT: {
+				int64_t value = p_value;
+				if (value == INT64_MIN) {
+					return "INT64_MIN";
+				}
+				return "int64_t(" + itos(value) + ")";
+			}
+			default: {
+				double value = p_value;
+				uint64_t bits;
+				memcpy(&bits, &value, sizeof(bits));
+				return "gd_f64(0x" + String::num_uint64(bits, 16) + "ull)";
+			}
+		}
+	}
+
+	bool _read(int p_address, const State &p_state, Variant::Type &r_type, String &r_code) {
+		int index = p_address & GDScriptFunction::ADDR_MASK;
+		switch ((p_address & GDScriptFunction::ADDR_TYPE_MASK) >> GDScriptFunction::ADDR_BITS) {
+			case GDScriptFunction::ADDR_TYPE_STACK: {
+				if (index == GDScriptFunction::ADDR_STACK_NIL) {
+					r_type = Variant::NIL;
+					return true;
+				}
+				if (index < GDScriptFunction::ADDR_STACK_NIL) {
+					return _fail("Uses `self`.");
+				}
+				if (index >= p_state.size() || !_is_supported_type(p_state[index])) {
+					return _fail("Reads a value that isn't a bool, int or float.");
+				}
+				r_type = Variant::Type(p_state[index]);
+				r_code = _get_variable(index, r_type);
+				variables.insert(r_code);
+				return true;
+			}
+			case GDScriptFunction::ADDR_TYPE_CONSTANT: {
+				if (index >= function->_constant_count) {
+					return _fail("Invalid constant.");
+				}
+				const Variant &constant = function->_constants_ptr[index];
+				if (!_is_supported_type(constant.get_type())) {
+					return _fail("Uses a constant that isn't a bool, int or float.");
+				}
+				r_type = constant.get_type();
+				r_code = _get_constant_code(constant);
+				return true;
+			}
+			default: {
+				return _fail("Accesses members.");
+			}
+		}
+	}
+
+	bool _read_as(int p_address, const State &p_state, Variant::Type p_type, String &r_code) {
+		Variant::Type type = Variant::NIL;
+		if (!_read(p_address, p_state, type, r_code)) {
+			return false;
+		}
+		if (type != p_type) {
+			return _fail("Reads a value of type " + Variant::get_type_name(type) + " where " + Variant::get_type_name(p_type) + " is expected.");
+		}
+		return true;
+	}
+
+	bool _write(int p_address, Variant::Type p_type, State &r_state, String &r_code) {
+		int index = p_address & GDScriptFunction::ADDR_MASK;
+		if ((p_address & GDScriptFunction::ADDR_TYPE_MASK) >> GDScriptFunction::ADDR_BITS != GDScriptFunction::ADDR_TYPE_STACK) {
+			return _fail("Writes to members.");
+		}
+		if (index <= GDScriptFunction::ADDR_STACK_NIL || index >= r_state.size()) {
+			return _fail("Invalid write address.");
+		}
+		r_state.write[index] = p_type;
+		r_code = _get_variable(index, p_type);
+		variables.insert(r_code);
+		return true;
+	}
+
+	bool _get_operator_code(Variant::Operator p_op, Variant::Type p_type_a, Variant::Type p_type_b, Variant::Type p_return_type, const String &p_a, const String &p_b, String &r_code) {
+		bool int_result = p_return_type == Variant::INT;
+		switch (p_op) {
+			case Variant::OP_EQUAL:
+				r_code = "(" + p_a + " == " + p_b + ")";
+				return true;
+			case Variant::OP_NOT_EQUAL:
+				r_code = "(" + p_a + " != " + p_b + ")";
+				return true;
+			case Variant::OP_LESS:
+				r_code = "(" + p_a + " < " + p_b + ")";
+				return true;
+			case Variant::OP_LESS_EQUAL:
+				r_code = "(" + p_a + " <= " + p_b + ")";
+				return true;
+			case Variant::OP_GREATER:
+				r_code = "(" + p_a + " > " + p_b + ")";
+				return true;
+			case Variant::OP_GREATER_EQUAL:
+				r_code = "(" + p_a + " >= " + p_b + ")";
+				return true;
+			case Variant::OP_ADD:
+				r_code = int_result ? "gd_add(" + p_a + ", " + p_b + ")" : "(" + p_a + " + " + p_b + ")";
+				return true;
+			case Variant::OP_SUBTRACT:
+				r_code = int_result ? "gd_sub(" + p_a + ", " + p_b + ")" : "(" + p_a + " - " + p_b + ")";
+				return true;
+			case Variant::OP_MULTIPLY:
+				r_code = int_result ? "gd_mul(" + p_a + ", " + p_b + ")" : "(" + p_a + " * " + p_b + ")";
+				return true;
+			case Variant::OP_DIVIDE:
+				r_code = int_result ? "gd_div(" + p_a + ", " + p_b + ")" : "(" + p_a + " / " + p_b + ")";
+				return true;
+			case Variant::OP_NEGATE:
+				r_code = int_result ? "gd_neg(" + p_a + ")" : "(-" + p_a + ")";
+				return true;
+			case Variant::OP_POSITIVE:
+				r_code = p_a;
+				return true;
+			case Variant::OP_MODULE:
+				if (p_type_a != Variant::INT || p_type_b != Variant::INT) {
+					break;
+				}
+				r_code = "gd_mod(" + p_a + ", " + p_b + ")";
+				return true;
+			case Variant::OP_SHIFT_LEFT:
+				r_code = "gd_shl(" + p_a + ", " + p_b + ")";
+				return true;
+			case Variant::OP_SHIFT_RIGHT:
+				r_code = "gd_shr(" + p_a + ", " + p_b + ")";
+				return true;
+			case Variant::OP_BIT_AND:
+				r_code = "(" + p_a + " & " + p_b + ")";
+				return true;
+			case Variant::OP_BIT_OR:
+				r_code = "(" + p_a + " | " + p_b + ")";
+				return true;
+			case Variant::OP_BIT_XOR:
+				r_code = "(" + p_a + " ^ " + p_b + ")";
+				return true;
+			case Variant::OP_BIT_NEGATE:
+				r_code = "(~" + p_a + ")";
+				return true;
+			case Variant::OP_AND:
+				r_code = "(" + p_a + " && " + p_b + ")";
+				return true;
+			case Variant::OP_OR:
+				r_code = "(" + p_a + " || " + p_b + ")";
+				return true;
+			case Variant::OP_XOR:
+				r_code = "(" + _booleanize(p_a, p_type_a) + " != " + _booleanize(p_b, p_type_b) + ")";
+				return true;
+			case Variant::OP_NOT:
+				r_code = "(!" + p_a + ")";
+				return true;
+			default:
+				break;
+		}
+		return _fail("Uses the operator `" + Variant::get_operator_name(p_op) + "`.");
+	}
+
+	// Evaluates an operator into its target. Operators the compiler couldn't validate are
+	// translated too when the types of the operands are known here.
+	bool _write_operator(int p_ip, bool p_validated, State &r_state, String &r_code, Variant::Type &r_type, String &r_target) {
+		const int *code = function->_code_ptr;
+		GDScriptEngineFunctionNames::OperatorKey key;
+		String a, b;
+		if (p_validated) {
+			int operator_idx = code[p_ip + 4];
+			if (operator_idx < 0 || operator_idx >= function->_operator_funcs_count) {
+				return _fail("Invalid operator.");
+			}
+			const Map<Variant::ValidatedOperatorEvaluator, GDScriptEngineFunctionNames::OperatorKey>::Element *E = GDScriptBytecodeCache::get_engine_function_names().operators.find(function->_operator_funcs_ptr[operator_idx]);
+			if (!E) {
+				return _fail("Unknown operator.");
+			}
+			key = E->get();
+			if (!_is_supported_type(key.type_a) || (key.type_b != Variant::NIL && !_is_supported_type(key.type_b))) {
+				return _fail("Uses an operator on values that aren't bool, int or float.");
+			}
+			if (!_read_as(code[p_ip + 1], r_state, key.type_a, a)) {
+				return false;
+			}
+			if (key.type_b != Variant::NIL && !_read_as(code[p_ip + 2], r_state, key.type_b, b)) {
+				return false;
+			}
+		} else {
+			if (code[p_ip + 4] < 0 || code[p_ip + 4] >= Variant::OP_MAX) {
+				return _fail("Invalid operator.");
+			}
+			key.op = Variant::Operator(code[p_ip + 4]);
+			if (!_read(code[p_ip + 1], r_state, key.type_a, a) || !_read(code[p_ip + 2], r_state, key.type_b, b)) {
+				return false;
+			}
+			if (key.type_a == Variant::NIL) {
+				return _fail("Uses an operator on null.");
+			}
+		}
+
+		r_type = Variant::get_operator_return_type(key.op, key.type_a, key.type_b);
+		if (!_is_supported_type(r_type)) {
+			return _fail("Uses an operator that doesn't return a bool, int or float.");
+		}
+		String expression;
+		if (!_get_operator_code(key.op, key.type_a, key.type_b, r_type, a, b, expression)) {
+			return false;
+		}
+		if (!_write(code[p_ip + 3], r_type, r_state, r_target)) {
+			return false;
+		}
+		r_code = r_target + " = " + expression + ";";
+		return true;
+	}
+
+	bool _write_utility(int p_ip, const StringName &p_name, int p_argc, State &r_state, String &r_code) {
+		const int *code = function->_code_ptr;
+		const GDScriptNativeUtility *utility = nullptr;
+		for (int i = 0; native_utilities[i].name; i++) {
+			if (p_name == native_utilities[i].name) {
+				utility = &native_utilities[i];
+				break;
+			}
+		}
+		if (!utility) {
+			return _fail("Calls the utility function `" + String(p_name) + "`.");
+		}
+		// The table is only valid for the signatures it was written for.
+		if (p_argc != utility->argument_count || Variant::get_utility_function_return_type(p_name) != utility->return_type) {
+			return _fail("Unexpected signature for `" + String(p_name) + "`.");
+		}
+
+		String expression = utility->code;
+		for (int i = 0; i < p_argc; i++) {
+			if (Variant::get_utility_function_argument_type(p_name, i) != utility->argument_type) {
+				return _fail("Unexpected signature for `" + String(p_name) + "`.");
+			}
+			Variant::Type type = Variant::NIL;
+			String argument;
+			if (!_read(code[p_ip + 1 + i], r_state, type, argument)) {
+				return false;
+			}
+			if (type != utility->argument_type && !(type == Variant::INT && utility->argument_type == Variant::FLOAT)) {
+				return _fail("Passes a " + Variant::get_type_name(type) + " to `" + String(p_name) + "`.");
+			}
+			expression = expression.replace("{" + itos(i) + "}", _convert(argument, type, utility->argument_type));
+		}
+
+		String target;
+		if (!_write(code[p_ip + 1 + p_argc], utility->return_type, r_state, target)) {
+			return false;
+		}
+		r_code = target + " = " + expression + ";";
+		return true;
+	}
+
+	bool _jump(int p_target, const State &p_state, Vector<Successor> &r_successors, String &r_label) {
+		if (p_target != function->_code_size && !instruction_index.has(p_target)) {
+			return _fail("Invalid jump.");
+		}
+		Successor successor;
+		successor.ip = p_target;
+		successor.state = p_state;
+		r_successors.push_back(successor);
+		r_label = "goto " + _get_label(p_target) + ";";
+		return true;
+	}
+
+	String _get_label(int p_ip) {
+		if (!labels.has(p_ip)) {
+			labels.insert(p_ip, -1); // Numbered once all jumps are known.
+		}
+		return "L_" + itos(p_ip);
+	}
+
+	bool _write_return(const String &p_value, Variant::Type p_type, String &r_code) {
+		if (!returns_value) {
+			if (p_type != Variant::NIL) {
+				return _fail("Returns a value from a function without return type.");
+			}
+			r_code = "return;";
+			return true;
+		}
+		if (p_type != return_type) {
+			return _fail("Returns a " + Variant::get_type_name(p_type) + " from a function returning " + Variant::get_type_name(return_type) + ".");
+		}
+		r_code = "*(" + _get_c_type(return_type) + " *)r_ret = " + p_value + ";\n\treturn;";
+		return true;
+	}
+
+	// Runs one instruction on `p_state`. Returns the states it continues with and, if `r_code` is not null, the C++ statements.
+	bool _step(int p_index, const State &p_state, Vector<Successor> &r_successors, String &r_code) {
+		const int *code = function->_code_ptr;
+		int ip = instructions[p_index];
+		int opcode = code[ip] & GDScriptFunction::INSTR_MASK;
+		int instr_var_args = (code[ip] & GDScriptFunction::INSTR_ARGS_MASK) >> GDScriptFunction::INSTR_BITS;
+		int next = p_index + 1 < instructions.size() ? instructions[p_index + 1] : function->_code_size;
+
+		State state = p_state;
+		bool falls_through = true;
+		String stmt;
+
+		switch (opcode) {
+			case GDScriptFunction::OPCODE_OPERATOR:
+			case GDScriptFunction::OPCODE_OPERATOR_VALIDATED: {
+				Variant::Type type;
+				String target;
+				if (!_write_operator(ip, opcode == GDScriptFunction::OPCODE_OPERATOR_VALIDATED, state, stmt, type, target)) {
+					return false;
+				}
+			} break;
+			case GDScriptFunction::OPCODE_JUMP_IF_NOT_OPERATOR_VALIDATED: {
+				Variant::Type type;
+				String target, jump;
+				if (!_write_operator(ip, true, state, stmt, type, target) || !_jump(code[ip + 5], state, r_successors, jump)) {
+					return false;
+				}
+				stmt += "\n\tif (!" + _booleanize(target, type) + ") {\n\t\t" + jump + "\n\t}";
+			} break;
+			case GDScriptFunction::OPCODE_ASSIGN: {
+				Variant::Type type;
+				String source, target;
+				if (!_read(code[ip + 2], state, type, source)) {
+					return false;
+				}
+				if (type == Variant::NIL) {
+					return _fail("Assigns null.");
+				}
+				if (!_write(code[ip + 1], type, state, target)) {
+					return false;
+				}
+				stmt = target + " = " + source + ";";
+			} break;
+			case GDScriptFunction::OPCODE_ASSIGN_TRUE:
+			case GDScriptFunction::OPCODE_ASSIGN_FALSE: {
+				String target;
+				if (!_write(code[ip + 1], Variant::BOOL, state, target)) {
+					return false;
+				}
+				stmt = target + (opcode == GDScriptFunction::OPCODE_ASSIGN_TRUE ? " = true;" : " = false;");
+			} break;
+			case GDScriptFunction::OPCODE_ASSIGN_TYPED_BUILTIN: {
+				Variant::Type to_type = Variant::Type(code[ip + 3]);
+				Variant::Type type;
+				String source, target;
+				if (!_is_supported_type(to_type)) {
+					return _fail("Assigns to a variable that isn't a bool, int or float.");
+				}
+				if (!_read(code[ip + 2], state, type, source)) {
+					return false;
+				}
+				if (type == Variant::NIL || !Variant::can_convert_strict(type, to_type)) {
+					return _fail("Assigns a " + Variant::get_type_name(type) + " to a " + Variant::get_type_name(to_type) + " variable.");
+				}
+				if (!_write(code[ip + 1], to_type, state, target)) {
+					return false;
+				}
+				stmt = target + " = " + _convert(source, type, to_type) + ";";
+			} break;
+			case GDScriptFunction::OPCODE_CONSTRUCT_VALIDATED: {
+				int argc = code[ip + 1 + instr_var_args];
+				int constructor_idx = code[ip + 2 + instr_var_args];
+				if (constructor_idx < 0 || constructor_idx >= function->_constructors_count || argc > 1) {
+					return _fail("Uses a constructor with more than one argument.");
+				}
+				const Map<Variant::ValidatedConstructor, GDScriptEngineFunctionNames::ConstructorKey>::Element *E = GDScriptBytecodeCache::get_engine_function_names().constructors.find(function->_constructors_ptr[constructor_idx]);
+				if (!E || !_is_supported_type(E->get().type)) {
+					return _fail("Constructs a value that isn't a bool, int or float.");
+				}
+				Variant::Type to_type = E->get().type;
+				String value = to_type == Variant::BOOL ? "false" : (to_type == Variant::INT ? "int64_t(0)" : "0.0");
+				if (argc == 1) {
+					Variant::Type type = Variant::get_constructor_argument_type(to_type, E->get().index, 0);
+					if (!_is_supported_type(type) || !_read_as(code[ip + 1], state, type, value)) {
+						return _fail("Constructs a " + Variant::get_type_name(to_type) + " from a value that isn't a bool, int or float.");
+					}
+					value = _convert(value, type, to_type);
+				}
+				String target;
+				if (!_write(code[ip + 1 + argc], to_type, state, target)) {
+					return false;
+				}
+				stmt = target + " = " + value + ";";
+			} break;
+			case GDScriptFunction::OPCODE_CALL_UTILITY: {
+				int argc = code[ip + 1 + instr_var_args];
+				int name_idx = code[ip + 2 + instr_var_args];
+				if (name_idx < 0 || name_idx >= function->_global_names_count) {
+					return _fail("Invalid utility function.");
+				}
+				if (!_write_utility(ip, function->_global_names_ptr[name_idx], argc, state, stmt)) {
+					return false;
+				}
+			} break;
+			case GDScriptFunction::OPCODE_CALL_UTILITY_VALIDATED: {
+				int argc = code[ip + 1 + instr_var_args];
+				int utility_idx = code[ip + 2 + instr_var_args];
+				if (utility_idx < 0 || utility_idx >= function->_utilities_count) {
+					return _fail("Invalid utility function.");
+				}
+				const Map<Variant::ValidatedUtilityFunction, StringName>::Element *E = GDScriptBytecodeCache::get_engine_function_names().utilities.find(function->_utilities_ptr[utility_idx]);
+				if (!E || !_write_utility(ip, E->get(), argc, state, stmt)) {
+					return _fail("Calls an unknown utility function.");
+				}
+			} break;
+			case GDScriptFunction::OPCODE_JUMP: {
+				if (!_jump(code[ip + 1], state, r_successors, stmt)) {
+					return false;
+				}
+				falls_through = false;
+			} break;
+			case GDScriptFunction::OPCODE_JUMP_IF:
+			case GDScriptFunction::OPCODE_JUMP_IF_NOT: {
+				Variant::Type type;
+				String test, jump;
+				if (!_read(code[ip + 1], state, type, test) || !_jump(code[ip + 2], state, r_successors, jump)) {
+					return false;
+				}
+				if (type == Variant::NIL) {
+					return _fail("Tests null.");
+				}
+				bool negate = opcode == GDScriptFunction::OPCODE_JUMP_IF_NOT;
+				stmt = String("if (") + (negate ? "!" : "") + _booleanize(test, type) + ") {\n\t\t" + jump + "\n\t}";
+			} break;
+			case GDScriptFunction::OPCODE_RETURN: {
+				Variant::Type type;
+				String value;
+				if (!_read(code[ip + 1], state, type, value) || !_write_return(value, type, stmt)) {
+					return false;
+				}
+				falls_through = false;
+			} break;
+			case GDScriptFunction::OPCODE_RETURN_TYPED_BUILTIN: {
+				Variant::Type to_type = Variant::Type(code[ip + 2]);
+				Variant::Type type;
+				String value;
+				if (!_read(code[ip + 1], state, type, value)) {
+					return false;
+				}
+				if (to_type == Variant::NIL && type == Variant::NIL) {
+					if (!_write_return(String(), Variant::NIL, stmt)) {
+						return false;
+					}
+					falls_through = false;
+					break;
+				}
+				if (!_is_supported_type(to_type) || type == Variant::NIL || !Variant::can_convert_strict(type, to_type)) {
+					return _fail("Returns a " + Variant::get_type_name(type) + " as " + Variant::get_type_name(to_type) + ".");
+				}
+				if (!_write_return(_convert(value, type, to_type), to_type, stmt)) {
+					return false;
+				}
+				falls_through = false;
+			} break;
+			case GDScriptFunction::OPCODE_ITERATE_BEGIN_INT:
+			case GDScriptFunction::OPCODE_ITERATE_BEGIN_FLOAT: {
+				Variant::Type type = opcode == GDScriptFunction::OPCODE_ITERATE_BEGIN_INT ? Variant::INT : Variant::FLOAT;
+				String size, counter, iterator, jump;
+				if (!_read_as(code[ip + 2], state, type, size) || !_write(code[ip + 1], type, state, counter)) {
+					return false;
+				}
+				String zero = type == Variant::INT ? "0" : "0.0";
+				// The loop is skipped before the iterator is written.
+				if (!_jump(code[ip + 4], state, r_successors, jump) || !_write(code[ip + 3], type, state, iterator)) {
+					return false;
+				}
+				stmt = counter + " = " + zero + ";\n\tif (" + size + " > " + zero + ") {\n\t\t" + iterator + " = " + zero + ";\n\t} else {\n\t\t" + jump + "\n\t}";
+			} break;
+			case GDScriptFunction::OPCODE_ITERATE_INT:
+			case GDScriptFunction::OPCODE_ITERATE_FLOAT: {
+				Variant::Type type = opcode == GDScriptFunction::OPCODE_ITERATE_INT ? Variant::INT : Variant::FLOAT;
+				String size, counter, iterator, jump;
+				if (!_read_as(code[ip + 2], state, type, size) || !_read_as(code[ip + 1], state, type, counter)) {
+					return false;
+				}
+				if (!_jump(code[ip + 4], state, r_successors, jump) || !_write(code[ip + 3], type, state, iterator)) {
+					return false;
+				}
+				String increment = type == Variant::INT ? counter + "++;" : counter + " += 1.0;";
+				stmt = increment + "\n\tif (" + counter + " >= " + size + ") {\n\t\t" + jump + "\n\t}\n\t" + iterator + " = " + counter + ";";
+			} break;
+			case GDScriptFunction::OPCODE_TYPE_ADJUST_BOOL:
+			case GDScriptFunction::OPCODE_TYPE_ADJUST_INT:
+			case GDScriptFunction::OPCODE_TYPE_ADJUST_FLOAT: {
+				Variant::Type type = opcode == GDScriptFunction::OPCODE_TYPE_ADJUST_BOOL ? Variant::BOOL : (opcode == GDScriptFunction::OPCODE_TYPE_ADJUST_INT ? Variant::INT : Variant::FLOAT);
+				int index = code[ip + 1] & GDScriptFunction::ADDR_MASK;
+				if (index >= state.size()) {
+					return _fail("Invalid address.");
+				}
+				// Keeps the value if the slot already has the type, like the VM does.
+				if (state[index] == TYPE_CONFLICT) {
+					return _fail("Adjusts the type of a slot with different types.");
+				}
+				if (state[index] != type) {
+					String target;
+					if (!_write(code[ip + 1], type, state, target)) {
+						return false;
+					}
+					stmt = target + " = " + (type == Variant::BOOL ? "false" : (type == Variant::INT ? "0" : "0.0")) + ";";
+				}
+			} break;
+			case GDScriptFunction::OPCODE_LINE: {
+				// Only in debug builds, skipped so both produce the same code.
+			} break;
+			case GDScriptFunction::OPCODE_END: {
+				if (!_write_return(String(), Variant::NIL, stmt)) {
+					return false;
+				}
+				falls_through = false;
+			} break;
+			default: {
+				return _fail("Uses an instruction that needs the VM (opcode " + itos(opcode) + ").");
+			}
+		}
+
+		if (falls_through) {
+			Successor successor;
+			successor.ip = next;
+			successor.state = state;
+			r_successors.push_back(successor);
+		}
+		r_code = stmt;
+		return true;
+	}
+
+	bool _decode() {
+		const int *code = function->_code_ptr;
+		int ip = 0;
+		while (ip < function->_code_size) {
+			instruction_index.insert(ip, instructions.size());
+			instructions.push_back(ip);
+
+			int opcode = code[ip] & GDScriptFunction::INSTR_MASK;
+			int instr_var_args = (code[ip] & GDScriptFunction::INSTR_ARGS_MASK) >> GDScriptFunction::INSTR_BITS;
+			switch (opcode) {
+				case GDScriptFunction::OPCODE_OPERATOR:
+				case GDScriptFunction::OPCODE_OPERATOR_VALIDATED:
+					ip += 5;
+					break;
+				case GDScriptFunction::OPCODE_JUMP_IF_NOT_OPERATOR_VALIDATED:
+					ip += 6;
+					break;
+				case GDScriptFunction::OPCODE_ASSIGN:
+				case GDScriptFunction::OPCODE_JUMP_IF:
+				case GDScriptFunction::OPCODE_JUMP_IF_NOT:
+				case GDScriptFunction::OPCODE_RETURN_TYPED_BUILTIN:
+					ip += 3;
+					break;
+				case GDScriptFunction::OPCODE_ASSIGN_TRUE:
+				case GDScriptFunction::OPCODE_ASSIGN_FALSE:
+				case GDScriptFunction::OPCODE_JUMP:
+				case GDScriptFunction::OPCODE_RETURN:
+				case GDScriptFunction::OPCODE_LINE:
+				case GDScriptFunction::OPCODE_TYPE_ADJUST_BOOL:
+				case GDScriptFunction::OPCODE_TYPE_ADJUST_INT:
+				case GDScriptFunction::OPCODE_TYPE_ADJUST_FLOAT:
+					ip += 2;
+					break;
+				case GDScriptFunction::OPCODE_ASSIGN_TYPED_BUILTIN:
+					ip += 4;
+					break;
+				case GDScriptFunction::OPCODE_CONSTRUCT_VALIDATED:
+					ip += 3 + instr_var_args;
+					break;
+				case GDScriptFunction::OPCODE_CALL_UTILITY:
+				case GDScriptFunction::OPCODE_CALL_UTILITY_VALIDATED:
+					ip += 3 + instr_var_args;
+					break;
+				case GDScriptFunction::OPCODE_ITERATE_BEGIN_INT:
+				case GDScriptFunction::OPCODE_ITERATE_BEGIN_FLOAT:
+				case GDScriptFunction::OPCODE_ITERATE_INT:
+				case GDScriptFunction::OPCODE_ITERATE_FLOAT:
+					ip += 5;
+					break;
+				case GDScriptFunction::OPCODE_END:
+					ip += 1;
+					break;
+				default:
+					return _fail("Uses an instruction that needs the VM (opcode " + itos(opcode) + ").");
+			}
+		}
+		return true;
+	}
+
+	static bool _join(State &r_state, const State &p_state) {
+		if (r_state.is_empty()) {
+			r_state = p_state;
+			return true;
+		}
+		bool changed = false;
+		for (int i = 0; i < r_state.size(); i++) {
+			if (r_state[i] != p_state[i] && r_state[i] != TYPE_CONFLICT) {
+				r_state.write[i] = TYPE_CONFLICT;
+				changed = true;
+			}
+		}
+		return changed;
+	}
+
+public:
+	bool write(String &r_code) {
+		if (function->_code_size == 0 || !function->_code_ptr) {
+			return _fail("Empty function.");
+		}
+		if (function->_default_arg_count > 0) {
+			return _fail("Has default arguments.");
+		}
+		if (function->_argument_count > GDScriptNativeTranspiler::MAX_ARGUMENTS) {
+			return _fail("Has too many arguments.");
+		}
+
+		const GDScriptDataType &ret = function->return_type;
+		if (ret.has_type && !(ret.kind == GDScriptDataType::BUILTIN && (ret.builtin_type == Variant::NIL || _is_supported_type(ret.builtin_type)))) {
+			return _fail("Doesn't return a bool, int or float.");
+		}
+		returns_value = ret.has_type && ret.builtin_type != Variant::NIL;
+		return_type = ret.builtin_type;
+
+		State initial;
+		initial.resize(function->_stack_size);
+		for (int i = 0; i < initial.size(); i++) {
+			initial.write[i] = TYPE_UNSET;
+		}
+		// Typed temporaries are initialized to their type when the function starts.
+		for (const Map<int, Variant::Type>::Element *E = function->temporary_slots.front(); E; E = E->next()) {
+			if (E->key() < initial.size() && _is_supported_type(E->get())) {
+				initial.write[E->key()] = E->get();
+			}
+		}
+
+		String arguments;
+		for (int i = 0; i < function->_argument_count; i++) {
+			const GDScriptDataType &type = function->argument_types[i];
+			if (!type.has_type || type.kind != GDScriptDataType::BUILTIN || !_is_supported_type(type.builtin_type)) {
+				return _fail("Has an argument that isn't a typed bool, int or float.");
+			}
+			int slot = GDScriptFunction::ADDR_STACK_NIL + 1 + i;
+			ERR_FAIL_COND_V(slot >= initial.size(), false);
+			initial.write[slot] = type.builtin_type;
+
+			String variable = _get_variable(slot, type.builtin_type);
+			variables.insert(variable);
+			arguments += "\t" + variable + " = *(const " + _get_c_type(type.builtin_type) + " *)p_args[" + itos(i) + "];\n";
+		}
+
+		if (!_decode()) {
+			return false;
+		}
+
+		// Propagate slot types until nothing changes.
+		states.resize(instructions.size());
+		states.write[0] = initial;
+		Vector<int> pending;
+		pending.push_back(0);
+		while (!pending.is_empty()) {
+			int index = pending[pending.size() - 1];
+			pending.resize(pending.size() - 1);
+
+			Vector<Successor> successors;
+			String unused;
+			if (!_step(index, states[index], successors, unused)) {
+				return false;
+			}
+			for (int i = 0; i < successors.size(); i++) {
+				if (successors[i].ip == function->_code_size) {
+					if (returns_value) {
+						return _fail("Can reach the end without returning a value.");
+					}
+					continue;
+				}
+				int target = instruction_index[successors[i].ip];
+				if (_join(states.write[target], successors[i].state)) {
+					pending.push_back(target);
+				}
+			}
+		}
+
+		StringBuilder body;
+		for (int i = 0; i < instructions.size(); i++) {
+			if (states[i].is_empty()) {
+				continue; // Unreachable.
+			}
+			Vector<Successor> successors;
+			String stmt;
+			if (!_step(i, states[i], successors, stmt)) {
+				return false;
+			}
+			if (labels.has(instructions[i])) {
+				body += "L_" + itos(instructions[i]) + ":\n";
+			}
+			if (!stmt.is_empty()) {
+				body += "\t" + stmt + "\n";
+			}
+		}
+		bool end_reachable = false;
+		for (const Map<int, int>::Element *E = labels.front(); E; E = E->next()) {
+			end_reachable = end_reachable || E->key() == function->_code_size;
+		}
+		if (end_reachable) {
+			body += "L_" + itos(function->_code_size) + ":\n\treturn;\n";
+		}
+
+		// Number labels in order, so they don't depend on the offsets of debug only instructions.
+		String code = body.as_string();
+		int label_count = 0;
+		for (Map<int, int>::Element *E = labels.front(); E; E = E->next()) {
+			code = code.replace("L_" + itos(E->key()) + ":", "L" + itos(label_count) + ":");
+			code = code.replace("goto L_" + itos(E->key()) + ";", "goto L" + itos(label_count) + ";");
+			label_count++;
+		}
+
+		StringBuilder declarations;
+		for (const Set<String>::Element *E = variables.front(); E; E = E->next()) {
+			String variable = E->get();
+			String suffix = variable.get_slice("_", 1);
+			String c_type = suffix == "b" ? "bool" : (suffix == "i" ? "int64_t" : "double");
+			String zero = suffix == "b" ? "false" : (suffix == "i" ? "0" : "0.0");
+			declarations += "\t" + c_type + " " + variable + " = " + zero + ";\n";
+		}
+
+		r_code = declarations.as_string() + arguments + code;
+		return true;
+	}
+
+	String get_error() const { return error; }
+
+	GDScriptNativeFunctionWriter(const GDScriptFunction *p_function) :
+			function(p_function) {}
+};
+
+/* Transpiler */
+
+bool GDScriptNativeTranspiler::transpile_function(const GDScriptFunction *p_function, String &r_code, String &r_error) {
+	ERR_FAIL_NULL_V(p_function, false);
+
+	GDScriptNativeFunctionWriter writer(p_function);
+	if (!writer.write(r_code)) {
+		r_error = writer.get_error();
+		return false;
+	}
+	return true;
+}
+
+static String _get_function_key(const GDScript *p_script, const StringName &p_function) {
+	return p_script->get_fully_qualified_name() + "::" + String(p_function);
+}
+
+static void _collect_functions(const GDScript *p_script, List<Pair<const GDScript *, const GDScriptFunction *>> &r_functions) {
+	for (const Map<StringName, GDScriptFunction *>::Element *E = p_script->get_member_functions().front(); E; E = E->next()) {
+		if (String(E->key()).begins_with("@")) {
+			continue; // Implicit initializers only set up members.
+		}
+		r_functions.push_back(Pair<const GDScript *, const GDScriptFunction *>(p_script, E->get()));
+	}
+	for (const Map<StringName, Ref<GDScript>>::Element *E = p_script->get_subclasses().front(); E; E = E->next()) {
+		_collect_functions(E->get().ptr(), r_functions);
+	}
+}
+
+String GDScriptNativeTranspiler::transpile_scripts(const Vector<Ref<GDScript>> &p_scripts, int &r_function_count, int &r_transpiled_count) {
+	r_function_count = 0;
+	r_transpiled_count = 0;
+
+	List<Pair<const GDScript *, const GDScriptFunction *>> functions;
+	for (int i = 0; i < p_scripts.size(); i++) {
+		ERR_CONTINUE(p_scripts[i].is_null() || !p_scripts[i]->is_valid());
+		_collect_functions(p_scripts[i].ptr(), functions);
+	}
+
+	StringBuilder definitions;
+	StringBuilder table;
+	for (const Pair<const GDScript *, const GDScriptFunction *> &E : functions) {
+		const GDScriptFunction *function = E.second;
+		r_function_count++;
+
+		String code, error;
+		if (!transpile_function(function, code, error)) {
+			print_verbose(vformat("GDScript: %s stays in the VM: %s", _get_function_key(E.first, function->get_name()), error));
+			continue;
+		}
+
+		String name = "gdscript_native_" + itos(r_transpiled_count);
+		definitions += "// " + _get_function_key(E.first, function->get_name()) + "\n";
+		definitions += "static void " + name + "([[maybe_unused]] const void **p_args, [[maybe_unused]] void *r_ret) {\n" + code + "}\n\n";
+		table += "\t{ \"" + E.first->get_fully_qualified_name().c_escape() + "\", \"" + String(function->get_name()).c_escape() + "\", 0x" + String::num_uint64(code.hash64(), 16) + "ull, " + name + " },\n";
+		r_transpiled_count++;
+	}
+
+	StringBuilder source;
+	source += "// Generated with `--gdscript-transpile`, do not edit.\n";
+	source += "// Build as a shared library and set `gdscript/native_library/path` to it, e.g.:\n";
+	source += "// c++ -std=c++17 -O2 -shared -fPIC gdscript_native.cpp -o gdscript_native.so\n\n";
+	source += native_preamble;
+	source += definitions.as_string();
+	source += "const GDScriptNativeFunctionInfo functions[] = {\n";
+	source += table.as_string();
+	source += "\t{ nullptr, nullptr, 0, nullptr },\n";
+	source += "};\n\n";
+	source += "} // namespace\n\n";
+	source += "GDSCRIPT_NATIVE_EXPORT const GDScriptNativeFunctionInfo *" GDSCRIPT_NATIVE_ENTRY_SYMBOL "(uint32_t *r_count, uint32_t *r_version) {\n";
+	source += "\t*r_count = " + itos(r_transpiled_count) + ";\n";
+	source += "\t*r_version = " + itos(GDSCRIPT_NATIVE_ABI_VERSION) + ";\n";
+	source += "\treturn functions;\n";
+	source += "}\n";
+	return source.as_string();
+}
+
+#ifdef TOOLS_ENABLED
+static void _find_scripts(const String &p_dir, Vector<String> &r_paths) {
+	DirAccessRef dir = DirAccess::open(p_dir);
+	ERR_FAIL_COND_MSG(!dir, "Cannot open directory: " + p_dir);
+
+	dir->list_dir_begin();
+	String next = dir->get_next();
+	while (!next.is_empty()) {
+		if (dir->current_is_dir()) {
+			if (!next.begins_with(".")) {
+				_find_scripts(p_dir.plus_file(next), r_paths);
+			}
+		} else if (next.get_extension().to_lower() == "gd") {
+			r_paths.push_back(p_dir.plus_file(next));
+		}
+		next = dir->get_next();
+	}
+	dir->list_dir_end();
+}
+
+Error GDScriptNativeTranspiler::transpile_project(const String &p_output_path) {
+	Vector<String> paths;
+	_find_scripts("res://", paths);
+	paths.sort();
+
+	Vector<Ref<GDScript>> scripts;
+	for (int i = 0; i < paths.size(); i++) {
+		Ref<GDScript> script = ResourceLoader::load(paths[i], "GDScript");
+		if (script.is_null() || !script->is_valid()) {
+			ERR_PRINT("Failed to compile script: " + paths[i]);
+			continue;
+		}
+		scripts.push_back(script);
+	}
+
+	int function_count = 0;
+	int transpiled_count = 0;
+	String source = transpile_scripts(scripts, function_count, transpiled_count);
+
+	Error err;
+	FileAccessRef f = FileAccess::open(p_output_path, FileAccess::WRITE, &err);
+	ERR_FAIL_COND_V_MSG(!f, err, "Cannot write to: " + p_output_path);
+	f->store_string(source);
+
+	print_line(vformat("Transpiled %d of %d GDScript functions to %s.", transpiled_count, function_count, p_output_path));
+	return OK;
+}
+#endif // TOOLS_ENABLED
+
+/* Library */
+
+void *GDScriptNativeLibrary::library_handle = nullptr;
+Map<String, GDScriptNativeLibrary::Function> GDScriptNativeLibrary::functions;
+Set<GDScriptFunction *> GDScriptNativeLibrary::bound_functions;
+Mutex GDScriptNativeLibrary::mutex;
+
+Error GDScriptNativeLibrary::load(const String &p_path) {
+	unload();
+
+	String path = ProjectSettings::get_singleton()->globalize_path(p_path);
+	Error err = OS::get_singleton()->open_dynamic_library(path, library_handle);
+	ERR_FAIL_COND_V_MSG(err != OK, err, "Cannot open GDScript native library: " + p_path);
+
+	void *symbol = nullptr;
+	err = OS::get_singleton()->get_dynamic_library_symbol_handle(library_handle, GDSCRIPT_NATIVE_ENTRY_SYMBOL, symbol);
+	if (err != OK) {
+		unload();
+		ERR_FAIL_V_MSG(err, "Not a GDScript native library: " + p_path);
+	}
+
+	typedef const GDScriptNativeFunctionInfo *(*GetFunctions)(uint32_t *, uint32_t *);
+	uint32_t count = 0;
+	uint32_t version = 0;
+	const GDScriptNativeFunctionInfo *infos = ((GetFunctions)symbol)(&count, &version);
+	if (version != GDSCRIPT_NATIVE_ABI_VERSION) {
+		unload();
+		ERR_FAIL_V_MSG(ERR_FILE_UNRECOGNIZED, "GDScript native library was generated by a different engine version, transpile the project again: " + p_path);
+	}
+
+	for (uint32_t i = 0; i < count; i++) {
+		Function function;
+		function.hash = infos[i].hash;
+		function.function_ptr = infos[i].function_ptr;
+		functions[String::utf8(infos[i].script) + "::" + String::utf8(infos[i].function)] = function;
+	}
+	print_verbose(vformat("GDScript: Loaded %d native functions from %s.", int(count), p_path));
+	return OK;
+}
+
+void GDScriptNativeLibrary::unload() {
+	MutexLock lock(mutex);
+
+	for (Set<GDScriptFunction *>::Element *E = bound_functions.front(); E; E = E->next()) {
+		E->get()->native_function = nullptr;
+	}
+	bound_functions.clear();
+
+	functions.clear();
+	if (library_handle) {
+		OS::get_singleton()->close_dynamic_library(library_handle);
+		library_handle = nullptr;
+	}
+}
+
+void GDScriptNativeLibrary::bind_script(GDScript *p_script) {
+	MutexLock lock(mutex);
+
+	if (functions.is_empty()) {
+		return;
+	}
+
+	List<Pair<const GDScript *, const GDScriptFunction *>> script_functions;
+	_collect_functions(p_script, script_functions);
+	for (const Pair<const GDScript *, const GDScriptFunction *> &E : script_functions) {
+		const Map<String, Function>::Element *F = functions.find(_get_function_key(E.first, E.second->get_name()));
+		if (!F) {
+			continue;
+		}
+		// Only use the native code if the function still translates to the same code.
+		String code, error;
+		if (!GDScriptNativeTranspiler::transpile_function(E.second, code, error) || code.hash64() != F->get().hash) {
+			print_verbose(vformat("GDScript: Native code for %s is out of date, using the VM.", F->key()));
+			continue;
+		}
+		GDScriptFunction *function = const_cast<GDScriptFunction *>(E.second);
+		function->native_function = F->get().function_ptr;
+		bound_functions.insert(function);
+	}
+}
+
+void GDScriptNativeLibrary::function_freed(GDScriptFunction *p_function) {
+	if (!p_function->native_function) {
+		return;
+	}
+
+	MutexLock lock(mutex);
+	bound_functions.erase(p_function);
+}
@@ -0,0 +1,109 @@
+/*************************************************************************/
+/*  gdscript_native.h                                                    */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2021 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2021 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef GDSCRIPT_NATIVE_H
+#define GDSCRIPT_NATIVE_H
+
+#include "core/object/ref_counted.h"
+#include "core/os/mutex.h"
+#include "core/string/ustring.h"
+#include "core/templates/map.h"
+#include "core/templates/set.h"
+#include "core/templates/vector.h"
+
+class GDScript;
+class GDScriptFunction;
+
+// Ahead-of-time compilation of typed GDScript functions to C++.
+//
+// The transpiler works on compiled bytecode. A function is translated when it
+// only takes and returns `bool`, `int` and `float` values and only uses the
+// opcodes the VM runs on those without going through Variant (validated
+// operators and constructors, jumps, integer and float `for` loops and a set of
+// math utility functions). Everything else, e.g. member access or calls, keeps
+// running in the VM.
+//
+// The generated source has no dependencies and is compiled to a shared library
+// that is loaded from `gdscript/native_library/path`. Every function in it
+// carries a hash of its generated code, so a function is only replaced if it
+// still compiles to the exact same code.
+
+// Shared with the generated library, see GDSCRIPT_NATIVE_ABI_VERSION.
+typedef void (*GDScriptNativeFunction)(const void **p_args, void *r_ret);
+
+struct GDScriptNativeFunctionInfo {
+	const char *script;
+	const char *function;
+	uint64_t hash;
+	GDScriptNativeFunction function_ptr;
+};
+
+#define GDSCRIPT_NATIVE_ABI_VERSION 1
+#define GDSCRIPT_NATIVE_ENTRY_SYMBOL "gdscript_native_get_functions"
+
+class GDScriptNativeTranspiler {
+public:
+	enum {
+		MAX_ARGUMENTS = 16,
+	};
+
+	// Translates the body of `p_function`, returns false and sets `r_error` if it uses something not supported.
+	static bool transpile_function(const GDScriptFunction *p_function, String &r_code, String &r_error);
+	// Translates all functions of the scripts (and their inner classes) into a library source.
+	static String transpile_scripts(const Vector<Ref<GDScript>> &p_scripts, int &r_function_count, int &r_transpiled_count);
+
+#ifdef TOOLS_ENABLED
+	// Translates every script of the project into `p_output_path`, used by `--gdscript-transpile <output.cpp>`.
+	static Error transpile_project(const String &p_output_path);
+#endif
+};
+
+class GDScriptNativeLibrary {
+	struct Function {
+		uint64_t hash = 0;
+		GDScriptNativeFunction function_ptr = nullptr;
+	};
+
+	static void *library_handle;
+	static Map<String, Function> functions;
+	// Functions pointing into the library, which must go back to the VM before it is closed.
+	static Set<GDScriptFunction *> bound_functions;
+	static Mutex mutex;
+
+public:
+	static Error load(const String &p_path);
+	static void unload();
+
+	// Replaces the functions of a freshly compiled script (and its inner classes) that have native code.
+	static void bind_script(GDScript *p_script);
+	static void function_freed(GDScriptFunction *p_function);
+};
+
+#endif // GDSCRIPT_NATIVE_H
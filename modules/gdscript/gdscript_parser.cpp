@@ -141,6 +141,47 @@ void GDScriptParser::get_annotation_list(List<MethodInfo> *r_annotations) const
 	}
 }
 
+// Collects what this script may depend on from the tree alone, so dependencies can be found before analysis:
+// literal `extends` and `preload()` paths, and every name that could refer to a global class or an autoload.
+void GDScriptParser::get_dependency_hints(Set<String> *r_paths, Set<StringName> *r_names) const {
+	const String base_dir = script_path.get_base_dir();
+
+	for (const Node *node = list; node != nullptr; node = node->next) {
+		String path;
+		switch (node->type) {
+			case Node::CLASS: {
+				const ClassNode *class_node = static_cast<const ClassNode *>(node);
+				if (!class_node->extends_path.is_empty()) {
+					path = class_node->extends_path;
+				} else if (!class_node->extends.is_empty()) {
+					r_names->insert(class_node->extends[0]);
+				}
+			} break;
+			case Node::PRELOAD: {
+				const PreloadNode *preload = static_cast<const PreloadNode *>(node);
+				if (preload->path != nullptr && preload->path->type == Node::LITERAL) {
+					const Variant &value = static_cast<const LiteralNode *>(preload->path)->value;
+					if (value.get_type() == Variant::STRING) {
+						path = value;
+					}
+				}
+			} break;
+			case Node::IDENTIFIER:
+				r_names->insert(static_cast<const IdentifierNode *>(node)->name);
+				break;
+			default:
+				break;
+		}
+
+		if (!path.is_empty()) {
+			if (path.is_rel_path()) {
+				path = base_dir.plus_file(path);
+			}
+			r_paths->insert(path.simplify_path());
+		}
+	}
+}
+
 GDScriptParser::GDScriptParser() {
 	// Register valid annotations.
 	// TODO: Should this be static?
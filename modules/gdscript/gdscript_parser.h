@@ -1406,6 +1406,7 @@ public:
 	void get_annotation_list(List<MethodInfo> *r_annotations) const;
 
 	const List<ParserError> &get_errors() const { return errors; }
+	void get_dependency_hints(Set<String> *r_paths, Set<StringName> *r_names) const;
 	const List<String> get_dependencies() const {
 		// TODO: Keep track of deps.
 		return List<String>();
@@ -0,0 +1,210 @@
+/*************************************************************************/
+/*  gdscript_sampler.cpp                                                 */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2021 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2021 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "gdscript_sampler.h"
+
+#include "core/io/dir_access.h"
+#include "core/io/file_access.h"
+#include "core/os/os.h"
+#include "gdscript.h"
+
+SafeFlag GDScriptSampler::active;
+SafeFlag GDScriptSampler::exit_thread;
+Thread GDScriptSampler::thread;
+Mutex GDScriptSampler::mutex;
+thread_local GDScriptSampler::ThreadStack GDScriptSampler::thread_stack;
+LocalVector<GDScriptSampler::ThreadStack *> GDScriptSampler::thread_stacks;
+
+uint64_t GDScriptSampler::interval_usec = 1000;
+uint64_t GDScriptSampler::save_interval_usec = 0;
+String GDScriptSampler::output_path;
+uint64_t GDScriptSampler::sample_count = 0;
+Map<const GDScriptFunction *, String> GDScriptSampler::frame_names;
+Map<String, uint64_t> GDScriptSampler::samples;
+
+GDScriptSampler::ThreadStack::~ThreadStack() {
+	if (registered) {
+		MutexLock lock(mutex);
+		thread_stacks.erase(this);
+	}
+}
+
+void GDScriptSampler::_register_thread_stack() {
+	MutexLock lock(mutex);
+	thread_stack.thread_id = Thread::get_caller_id();
+	thread_stack.registered = true;
+	thread_stacks.push_back(&thread_stack);
+}
+
+const String &GDScriptSampler::_get_frame_name(const GDScriptFunction *p_function) {
+	Map<const GDScriptFunction *, String>::Element *E = frame_names.find(p_function);
+	if (E) {
+		return E->get();
+	}
+
+	String name;
+	if (p_function->get_script()) {
+		name = p_function->get_script()->get_path() + ":";
+	}
+	name += p_function->get_name();
+	// Separators of the collapsed format can't appear in frames.
+	name = name.replace(";", ":").replace("\n", " ");
+	return frame_names.insert(p_function, name)->get();
+}
+
+void GDScriptSampler::_take_samples() {
+	MutexLock lock(mutex);
+
+	// Functions can't be freed while the lock is held (see function_freed()),
+	// and never while they are on a stack, so every function read below is valid.
+	// Slots above the depth read first may be overwritten meanwhile, which only
+	// attributes this sample to a slightly newer stack.
+	for (uint32_t i = 0; i < thread_stacks.size(); i++) {
+		const ThreadStack *stack = thread_stacks[i];
+		uint32_t depth = stack->depth.get();
+		if (depth == 0) {
+			continue;
+		}
+
+		String collapsed = stack->thread_id == Thread::get_main_id() ? String("main") : "thread_" + String::num_uint64(stack->thread_id);
+		for (uint32_t j = 0; j < MIN(depth, (uint32_t)MAX_STACK_DEPTH); j++) {
+			collapsed += ";" + _get_frame_name(stack->functions[j]);
+		}
+		if (depth > MAX_STACK_DEPTH) {
+			collapsed += ";(truncated)";
+		}
+
+		Map<String, uint64_t>::Element *E = samples.find(collapsed);
+		if (E) {
+			E->get()++;
+		} else {
+			samples.insert(collapsed, 1);
+		}
+		sample_count++;
+	}
+}
+
+void GDScriptSampler::_thread_func(void *p_ud) {
+	uint64_t last_save = OS::get_singleton()->get_ticks_usec();
+
+	while (!exit_thread.is_set()) {
+		OS::get_singleton()->delay_usec(interval_usec);
+		_take_samples();
+
+		if (!output_path.is_empty() && save_interval_usec > 0 && OS::get_singleton()->get_ticks_usec() - last_save >= save_interval_usec) {
+			save(output_path);
+			last_save = OS::get_singleton()->get_ticks_usec();
+		}
+	}
+}
+
+void GDScriptSampler::function_freed(const GDScriptFunction *p_function) {
+	if (!active.is_set()) {
+		return;
+	}
+
+	MutexLock lock(mutex);
+	// The address may be reused by another function.
+	frame_names.erase(p_function);
+}
+
+Error GDScriptSampler::start(uint64_t p_interval_usec, const String &p_output_path, uint64_t p_save_interval_usec) {
+	ERR_FAIL_COND_V_MSG(active.is_set(), ERR_ALREADY_IN_USE, "The GDScript sampling profiler is already running.");
+	ERR_FAIL_COND_V(p_interval_usec == 0, ERR_INVALID_PARAMETER);
+
+	interval_usec = p_interval_usec;
+	output_path = p_output_path;
+	save_interval_usec = p_save_interval_usec;
+
+	exit_thread.clear();
+	active.set();
+	thread.start(_thread_func, nullptr);
+	if (!thread.is_started()) {
+		active.clear();
+		ERR_FAIL_V_MSG(ERR_UNAVAILABLE, "The GDScript sampling profiler requires thread support.");
+	}
+
+	return OK;
+}
+
+void GDScriptSampler::stop() {
+	if (!active.is_set()) {
+		return;
+	}
+
+	exit_thread.set();
+	thread.wait_to_finish();
+	active.clear();
+
+	MutexLock lock(mutex);
+	frame_names.clear();
+}
+
+void GDScriptSampler::clear() {
+	MutexLock lock(mutex);
+	samples.clear();
+	sample_count = 0;
+}
+
+uint64_t GDScriptSampler::get_sample_count() {
+	MutexLock lock(mutex);
+	return sample_count;
+}
+
+String GDScriptSampler::get_collapsed_stacks() {
+	MutexLock lock(mutex);
+
+	String collapsed;
+	for (const Map<String, uint64_t>::Element *E = samples.front(); E; E = E->next()) {
+		collapsed += E->key() + " " + itos(E->get()) + "\n";
+	}
+	return collapsed;
+}
+
+Error GDScriptSampler::save(const String &p_path) {
+	String collapsed = get_collapsed_stacks();
+
+	// Write to a temporary file first, so tools reading the output of a
+	// running server never see it half written.
+	String temp_path = p_path + ".tmp";
+	Error err;
+	FileAccessRef f = FileAccess::open(temp_path, FileAccess::WRITE, &err);
+	ERR_FAIL_COND_V_MSG(err != OK, err, "Cannot save GDScript samples to '" + temp_path + "'.");
+	f->store_string(collapsed);
+	f->close();
+
+	DirAccessRef da = DirAccess::create_for_path(p_path);
+	if (da->file_exists(p_path)) {
+		da->remove(p_path);
+	}
+	err = da->rename(temp_path, p_path);
+	ERR_FAIL_COND_V_MSG(err != OK, err, "Cannot save GDScript samples to '" + p_path + "'.");
+	return OK;
+}
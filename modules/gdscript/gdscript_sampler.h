@@ -0,0 +1,118 @@
+/*************************************************************************/
+/*  gdscript_sampler.h                                                   */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2021 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2021 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef GDSCRIPT_SAMPLER_H
+#define GDSCRIPT_SAMPLER_H
+
+#include "core/os/mutex.h"
+#include "core/os/thread.h"
+#include "core/string/ustring.h"
+#include "core/templates/local_vector.h"
+#include "core/templates/map.h"
+#include "core/templates/safe_refcount.h"
+
+class GDScriptFunction;
+
+// Low overhead alternative to the instrumenting profiler. While active, every
+// thread running GDScript keeps a shadow stack of the functions it is in, and
+// a background thread periodically copies those stacks and counts how often
+// each one was seen. The counts are saved in the collapsed stack format
+// (`main;res://a.gd:_process;res://b.gd:update 42`) understood by most flame
+// graph tools.
+class GDScriptSampler {
+public:
+	enum {
+		MAX_STACK_DEPTH = 256,
+	};
+
+	// Written only by the thread it belongs to, read by the sampler thread.
+	struct ThreadStack {
+		Thread::ID thread_id = 0;
+		bool registered = false;
+		SafeNumeric<uint32_t> depth;
+		GDScriptFunction *functions[MAX_STACK_DEPTH];
+
+		~ThreadStack();
+	};
+
+private:
+	static SafeFlag active;
+	static SafeFlag exit_thread;
+	static Thread thread;
+	static Mutex mutex;
+	static thread_local ThreadStack thread_stack;
+	static LocalVector<ThreadStack *> thread_stacks;
+
+	static uint64_t interval_usec;
+	static uint64_t save_interval_usec;
+	static String output_path;
+	static uint64_t sample_count;
+	static Map<const GDScriptFunction *, String> frame_names;
+	static Map<String, uint64_t> samples;
+
+	static void _register_thread_stack();
+	static const String &_get_frame_name(const GDScriptFunction *p_function);
+	static void _take_samples();
+	static void _thread_func(void *p_ud);
+
+public:
+	_FORCE_INLINE_ static bool is_active() { return active.is_set(); }
+
+	// Calls must be paired on the same thread, even if sampling stops in between.
+	_FORCE_INLINE_ static void enter_function(GDScriptFunction *p_function) {
+		if (unlikely(!thread_stack.registered)) {
+			_register_thread_stack();
+		}
+		uint32_t depth = thread_stack.depth.get();
+		if (depth < MAX_STACK_DEPTH) {
+			thread_stack.functions[depth] = p_function;
+		}
+		thread_stack.depth.set(depth + 1);
+	}
+	_FORCE_INLINE_ static void exit_function() {
+		thread_stack.depth.decrement();
+	}
+	// Number of functions the calling thread is in, as seen by the sampler.
+	_FORCE_INLINE_ static uint32_t get_stack_depth() {
+		return thread_stack.depth.get();
+	}
+
+	static void function_freed(const GDScriptFunction *p_function);
+
+	// If `p_output_path` is set, samples are also saved there every `p_save_interval_usec`.
+	static Error start(uint64_t p_interval_usec, const String &p_output_path = String(), uint64_t p_save_interval_usec = 0);
+	static void stop();
+	static void clear();
+	static uint64_t get_sample_count();
+	static String get_collapsed_stacks();
+	static Error save(const String &p_path);
+};
+
+#endif // GDSCRIPT_SAMPLER_H
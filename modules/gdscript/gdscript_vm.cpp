@@ -34,6 +34,7 @@
 #include "core/os/os.h"
 #include "gdscript.h"
 #include "gdscript_lambda_callable.h"
+#include "gdscript_sampler.h"
 
 Variant *GDScriptFunction::_get_variant(int p_address, GDScriptInstance *p_instance, Variant *p_stack, String &r_error) const {
 	int address = p_address & ADDR_MASK;
@@ -276,6 +277,7 @@ void (*type_init_function_table[])(Variant *) = {
 		&&OPCODE_JUMP,                               \
 		&&OPCODE_JUMP_IF,                            \
 		&&OPCODE_JUMP_IF_NOT,                        \
+		&&OPCODE_JUMP_IF_NOT_OPERATOR_VALIDATED,     \
 		&&OPCODE_JUMP_TO_DEF_ARGUMENT,               \
 		&&OPCODE_RETURN,                             \
 		&&OPCODE_RETURN_TYPED_BUILTIN,               \
@@ -423,6 +425,277 @@ void (*type_init_function_table[])(Variant *) = {
 #define OP_GET_BASIS get_basis
 #define OP_GET_RID get_rid
 
+GDScriptFunction::InlineCache::Entry *GDScriptFunction::_find_inline_cache_entry(int p_cache, Object *p_object, GDScriptInstance *&r_instance) const {
+	ObjectID script_id;
+	r_instance = nullptr;
+
+	ScriptInstance *script_instance = p_object->get_script_instance();
+	if (script_instance) {
+		if (script_instance->is_placeholder() || script_instance->get_language() != GDScriptLanguage::get_singleton()) {
+			return nullptr;
+		}
+		r_instance = static_cast<GDScriptInstance *>(script_instance);
+		script_id = r_instance->script->get_instance_id();
+	}
+
+	ERR_FAIL_INDEX_V(p_cache, _inline_caches_count, nullptr);
+	InlineCache &cache = _inline_caches_ptr[p_cache];
+
+	uint32_t epoch = inline_cache_epoch.get();
+	if (unlikely(cache.epoch != epoch)) {
+		for (int i = 0; i < InlineCache::ENTRY_COUNT; i++) {
+			cache.entries[i] = InlineCache::Entry();
+		}
+		cache.epoch = epoch;
+		cache.next_entry = 0;
+	}
+
+	const StringName &class_name = p_object->get_class_name();
+	for (int i = 0; i < InlineCache::ENTRY_COUNT; i++) {
+		InlineCache::Entry &entry = cache.entries[i];
+		if (entry.kind == InlineCache::KIND_EMPTY) {
+			// Entries are filled in order, so the remaining ones are empty too.
+			break;
+		}
+		if (entry.script_id == script_id && entry.class_name == class_name) {
+			return &entry;
+		}
+	}
+
+	// Evict the oldest entry, the caller resolves the new one.
+	InlineCache::Entry &entry = cache.entries[cache.next_entry];
+	cache.next_entry = (cache.next_entry + 1) % InlineCache::ENTRY_COUNT;
+	entry = InlineCache::Entry();
+	entry.script_id = script_id;
+	entry.class_name = class_name;
+	return &entry;
+}
+
+bool GDScriptFunction::_get_named_cached(int p_cache, const Variant *p_base, const StringName &p_name, Variant *r_dst) const {
+	if (p_base->get_type() != Variant::OBJECT) {
+		return false;
+	}
+	Object *object = p_base->is_ref() ? p_base->operator Object *() : p_base->get_validated_object();
+	if (unlikely(!object)) {
+		return false;
+	}
+
+	GDScriptInstance *instance;
+	InlineCache::Entry *entry = _find_inline_cache_entry(p_cache, object, instance);
+	if (!entry) {
+		return false;
+	}
+
+	if (entry->kind == InlineCache::KIND_EMPTY) {
+		entry->kind = InlineCache::KIND_GENERIC;
+		if (instance) {
+			// Members with getters, constants, signals and native properties are left to GDScriptInstance::get().
+			const Map<StringName, GDScript::MemberInfo>::Element *E = instance->script->member_indices.find(p_name);
+			if (E && !E->get().getter) {
+				entry->kind = InlineCache::KIND_MEMBER;
+				entry->member_index = E->get().index;
+				entry->member_type = &E->get().data_type;
+			}
+		}
+	}
+
+	if (entry->kind != InlineCache::KIND_MEMBER) {
+		return false;
+	}
+
+	// Copy first, the destination might hold the last reference to the object.
+	Variant value = instance->members[entry->member_index];
+	*r_dst = value;
+	return true;
+}
+
+bool GDScriptFunction::_set_named_cached(int p_cache, Variant *p_base, const StringName &p_name, const Variant *p_value) const {
+	if (p_base->get_type() != Variant::OBJECT) {
+		return false;
+	}
+	Object *object = p_base->is_ref() ? p_base->operator Object *() : p_base->get_validated_object();
+	if (unlikely(!object)) {
+		return false;
+	}
+
+	GDScriptInstance *instance;
+	InlineCache::Entry *entry = _find_inline_cache_entry(p_cache, object, instance);
+	if (!entry) {
+		return false;
+	}
+
+	if (entry->kind == InlineCache::KIND_EMPTY) {
+		entry->kind = InlineCache::KIND_GENERIC;
+#ifdef TOOLS_ENABLED
+		// Object::set() also marks the object as edited, which the editor relies on.
+		bool cacheable = instance && !Engine::get_singleton()->is_editor_hint();
+#else
+		bool cacheable = instance != nullptr;
+#endif
+		if (cacheable) {
+			const Map<StringName, GDScript::MemberInfo>::Element *E = instance->script->member_indices.find(p_name);
+			if (E && !E->get().setter && !(E->get().data_type.builtin_type == Variant::ARRAY && E->get().data_type.has_container_element_type())) {
+				entry->kind = InlineCache::KIND_MEMBER;
+				entry->member_index = E->get().index;
+				entry->member_type = &E->get().data_type;
+			}
+		}
+	}
+
+	if (entry->kind != InlineCache::KIND_MEMBER) {
+		return false;
+	}
+
+	// Values needing a conversion go through GDScriptInstance::set().
+	if (entry->member_type->has_type && !entry->member_type->is_type(*p_value)) {
+		return false;
+	}
+
+	instance->members.write[entry->member_index] = *p_value;
+	return true;
+}
+
+bool GDScriptFunction::_call_cached(int p_cache, Variant *p_base, const StringName &p_method, const Variant **p_args, int p_argcount, Variant &r_ret, Callable::CallError &r_err) const {
+	if (p_base->get_type() != Variant::OBJECT) {
+		return false;
+	}
+	// Same checks as Variant::call().
+	Object *object = p_base->operator Object *();
+	if (unlikely(!object)) {
+		return false;
+	}
+#ifdef DEBUG_ENABLED
+	if (EngineDebugger::is_active() && !p_base->is_ref() && !p_base->get_validated_object()) {
+		return false;
+	}
+#endif
+
+	GDScriptInstance *instance;
+	InlineCache::Entry *entry = _find_inline_cache_entry(p_cache, object, instance);
+	if (!entry) {
+		return false;
+	}
+
+	if (entry->kind == InlineCache::KIND_EMPTY) {
+		entry->kind = InlineCache::KIND_GENERIC;
+		// Object::call() handles freeing on its own.
+		if (p_method != CoreStringNames::get_singleton()->_free) {
+			if (instance) {
+				for (GDScript *script = instance->script.ptr(); script; script = script->_base) {
+					const Map<StringName, GDScriptFunction *>::Element *E = script->member_functions.find(p_method);
+					if (E) {
+						entry->kind = InlineCache::KIND_SCRIPT_FUNCTION;
+						entry->function = E->get();
+						break;
+					}
+				}
+			}
+			if (entry->kind == InlineCache::KIND_GENERIC) {
+				MethodBind *method = ClassDB::get_method(entry->class_name, p_method);
+				if (method) {
+					entry->kind = InlineCache::KIND_METHOD_BIND;
+					entry->method = method;
+				}
+			}
+		}
+	}
+
+	switch (entry->kind) {
+		case InlineCache::KIND_SCRIPT_FUNCTION: {
+#ifdef DEBUG_ENABLED
+			_ObjectDebugLock lock(object);
+#endif
+			r_err.error = Callable::CallError::CALL_OK;
+			r_ret = entry->function->call(instance, p_args, p_argcount, r_err);
+			return true;
+		}
+		case InlineCache::KIND_METHOD_BIND: {
+#ifdef DEBUG_ENABLED
+			_ObjectDebugLock lock(object);
+#endif
+			r_err.error = Callable::CallError::CALL_OK;
+			r_ret = entry->method->call(object, p_args, p_argcount, r_err);
+			return true;
+		}
+		default: {
+			return false;
+		}
+	}
+}
+
+bool GDScriptFunction::_call_native(const Variant **p_args, int p_argcount, Variant &r_ret) {
+#ifdef DEBUG_ENABLED
+	// Breakpoints, stepping and the profiler need the VM.
+	if (EngineDebugger::is_active() || GDScriptLanguage::get_singleton()->profiling) {
+		return false;
+	}
+#endif
+#ifdef TESTS_ENABLED
+	if (disable_vm_optimizations) {
+		return false;
+	}
+#endif
+	// Arguments needing a conversion or an error go through the VM.
+	if (p_argcount != _argument_count) {
+		return false;
+	}
+
+	union Value {
+		bool b;
+		int64_t i;
+		double f;
+	};
+	Value values[GDScriptNativeTranspiler::MAX_ARGUMENTS];
+	const void *args[GDScriptNativeTranspiler::MAX_ARGUMENTS];
+	for (int i = 0; i < p_argcount; i++) {
+		Variant::Type type = argument_types[i].builtin_type;
+		if (p_args[i]->get_type() != type) {
+			return false;
+		}
+		switch (type) {
+			case Variant::BOOL:
+				values[i].b = *VariantInternal::get_bool(p_args[i]);
+				break;
+			case Variant::INT:
+				values[i].i = *VariantInternal::get_int(p_args[i]);
+				break;
+			default:
+				values[i].f = *VariantInternal::get_float(p_args[i]);
+				break;
+		}
+		args[i] = &values[i];
+	}
+
+	bool sampled = GDScriptSampler::is_active();
+	if (unlikely(sampled)) {
+		GDScriptSampler::enter_function(this);
+	}
+
+	Value ret;
+	native_function(args, &ret);
+
+	if (unlikely(sampled)) {
+		GDScriptSampler::exit_function();
+	}
+
+	if (!return_type.has_type || return_type.builtin_type == Variant::NIL) {
+		r_ret = Variant();
+		return true;
+	}
+	switch (return_type.builtin_type) {
+		case Variant::BOOL:
+			r_ret = ret.b;
+			break;
+		case Variant::INT:
+			r_ret = ret.i;
+			break;
+		default:
+			r_ret = ret.f;
+			break;
+	}
+	return true;
+}
+
 Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_args, int p_argcount, Callable::CallError &r_err, CallState *p_state) {
 	OPCODES_TABLE;
 
@@ -433,6 +706,10 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 	r_err.error = Callable::CallError::CALL_OK;
 
 	Variant retvalue;
+	if (native_function && !p_state && _call_native(p_args, p_argcount, retvalue)) {
+		return retvalue;
+	}
+
 	Variant *stack = nullptr;
 	Variant **instruction_args = nullptr;
 	const void **call_args_ptr = nullptr;
@@ -449,6 +726,12 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 	int ip = 0;
 	int line = _initial_line;
 
+	// Inline caches aren't synchronized, functions running on other threads take the regular paths.
+	bool use_inline_caches = Thread::get_caller_id() == Thread::get_main_id();
+#ifdef TESTS_ENABLED
+	use_inline_caches = use_inline_caches && !disable_vm_optimizations;
+#endif
+
 	if (p_state) {
 		//use existing (supplied) state (awaited)
 		stack = (Variant *)p_state->stack.ptr();
@@ -586,6 +869,11 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 	bool awaited = false;
 #endif
 
+	bool sampled = GDScriptSampler::is_active();
+	if (unlikely(sampled)) {
+		GDScriptSampler::enter_function(this);
+	}
+
 #ifdef DEBUG_ENABLED
 	OPCODE_WHILE(ip < _code_size) {
 		int last_opcode = _code_ptr[ip] & INSTR_MASK;
@@ -930,7 +1218,7 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 			DISPATCH_OPCODE;
 
 			OPCODE(OPCODE_SET_NAMED) {
-				CHECK_SPACE(3);
+				CHECK_SPACE(5);
 
 				GET_INSTRUCTION_ARG(dst, 0);
 				GET_INSTRUCTION_ARG(value, 1);
@@ -940,8 +1228,10 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 				GD_ERR_BREAK(indexname < 0 || indexname >= _global_names_count);
 				const StringName *index = &_global_names_ptr[indexname];
 
-				bool valid;
-				dst->set_named(*index, *value, valid);
+				bool valid = true;
+				if (!use_inline_caches || !_set_named_cached(_code_ptr[ip + 4], dst, *index, value)) {
+					dst->set_named(*index, *value, valid);
+				}
 
 #ifdef DEBUG_ENABLED
 				if (!valid) {
@@ -950,7 +1240,7 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 					OPCODE_BREAK;
 				}
 #endif
-				ip += 4;
+				ip += 5;
 			}
 			DISPATCH_OPCODE;
 
@@ -970,7 +1260,7 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 			DISPATCH_OPCODE;
 
 			OPCODE(OPCODE_GET_NAMED) {
-				CHECK_SPACE(4);
+				CHECK_SPACE(5);
 
 				GET_INSTRUCTION_ARG(src, 0);
 				GET_INSTRUCTION_ARG(dst, 1);
@@ -980,6 +1270,11 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 				GD_ERR_BREAK(indexname < 0 || indexname >= _global_names_count);
 				const StringName *index = &_global_names_ptr[indexname];
 
+				if (use_inline_caches && _get_named_cached(_code_ptr[ip + 4], src, *index, dst)) {
+					ip += 5;
+					DISPATCH_OPCODE;
+				}
+
 				bool valid;
 #ifdef DEBUG_ENABLED
 				//allow better error message in cases where src and dst are the same stack position
@@ -999,7 +1294,7 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 				}
 				*dst = ret;
 #endif
-				ip += 4;
+				ip += 5;
 			}
 			DISPATCH_OPCODE;
 
@@ -1439,7 +1734,7 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 			OPCODE(OPCODE_CALL_ASYNC)
 			OPCODE(OPCODE_CALL_RETURN)
 			OPCODE(OPCODE_CALL) {
-				CHECK_SPACE(3 + instr_arg_count);
+				CHECK_SPACE(4 + instr_arg_count);
 				bool call_ret = (_code_ptr[ip] & INSTR_MASK) != OPCODE_CALL;
 #ifdef DEBUG_ENABLED
 				bool call_async = (_code_ptr[ip] & INSTR_MASK) == OPCODE_CALL_ASYNC;
@@ -1465,10 +1760,14 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 				}
 
 #endif
+				int inline_cache_idx = _code_ptr[ip + 3];
+
 				Callable::CallError err;
 				if (call_ret) {
 					GET_INSTRUCTION_ARG(ret, argc + 1);
-					base->call(*methodname, (const Variant **)argptrs, argc, *ret, err);
+					if (!use_inline_caches || !_call_cached(inline_cache_idx, base, *methodname, (const Variant **)argptrs, argc, *ret, err)) {
+						base->call(*methodname, (const Variant **)argptrs, argc, *ret, err);
+					}
 #ifdef DEBUG_ENABLED
 					if (!call_async && ret->get_type() == Variant::OBJECT) {
 						// Check if getting a function state without await.
@@ -1487,7 +1786,9 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 #endif
 				} else {
 					Variant ret;
-					base->call(*methodname, (const Variant **)argptrs, argc, ret, err);
+					if (!use_inline_caches || !_call_cached(inline_cache_idx, base, *methodname, (const Variant **)argptrs, argc, ret, err)) {
+						base->call(*methodname, (const Variant **)argptrs, argc, ret, err);
+					}
 				}
 #ifdef DEBUG_ENABLED
 				if (GDScriptLanguage::get_singleton()->profiling) {
@@ -1532,7 +1833,7 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 				}
 #endif
 
-				ip += 3;
+				ip += 4;
 			}
 			DISPATCH_OPCODE;
 
@@ -2222,6 +2523,29 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 			}
 			DISPATCH_OPCODE;
 
+			OPCODE(OPCODE_JUMP_IF_NOT_OPERATOR_VALIDATED) {
+				CHECK_SPACE(6);
+
+				int operator_idx = _code_ptr[ip + 4];
+				GD_ERR_BREAK(operator_idx < 0 || operator_idx >= _operator_funcs_count);
+				Variant::ValidatedOperatorEvaluator operator_func = _operator_funcs_ptr[operator_idx];
+
+				GET_INSTRUCTION_ARG(a, 0);
+				GET_INSTRUCTION_ARG(b, 1);
+				GET_INSTRUCTION_ARG(dst, 2);
+
+				operator_func(a, b, dst);
+
+				if (!dst->booleanize()) {
+					int to = _code_ptr[ip + 5];
+					GD_ERR_BREAK(to < 0 || to > _code_size);
+					ip = to;
+				} else {
+					ip += 6;
+				}
+			}
+			DISPATCH_OPCODE;
+
 			OPCODE(OPCODE_JUMP_TO_DEF_ARGUMENT) {
 				CHECK_SPACE(2);
 				ip = _default_arg_ptr[defarg];
@@ -3292,6 +3616,10 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 	}
 
 	OPCODES_OUT
+	if (unlikely(sampled)) {
+		GDScriptSampler::exit_function();
+	}
+
 #ifdef DEBUG_ENABLED
 	if (GDScriptLanguage::get_singleton()->profiling) {
 		uint64_t time_taken = OS::get_singleton()->get_ticks_usec() - function_start_time;
@@ -36,6 +36,7 @@
 #include "core/io/resource_loader.h"
 #include "gdscript.h"
 #include "gdscript_analyzer.h"
+#include "gdscript_bytecode_cache.h"
 #include "gdscript_cache.h"
 #include "gdscript_tokenizer.h"
 #include "gdscript_utility_functions.h"
@@ -69,7 +70,13 @@ Ref<GDScriptEditorTranslationParserPlugin> gdscript_translation_parser_plugin;
 class EditorExportGDScript : public EditorExportPlugin {
 	GDCLASS(EditorExportGDScript, EditorExportPlugin);
 
+	bool debug = false;
+
 public:
+	virtual void _export_begin(const Set<String> &p_features, bool p_debug, const String &p_path, int p_flags) override {
+		debug = p_debug;
+	}
+
 	virtual void _export_file(const String &p_path, const String &p_type, const Set<String> &p_features) override {
 		int script_mode = EditorExportPreset::MODE_SCRIPT_COMPILED;
 		String script_key;
@@ -85,8 +92,21 @@ public:
 			return;
 		}
 
-		// TODO: Re-add compiled GDScript on export.
-		return;
+		// The editor compiles scripts with debug code (line markers, asserts),
+		// release builds reject that bytecode, so only ship it for debug exports.
+		if (!debug) {
+			return;
+		}
+
+		// The source is kept, it's used to validate the bytecode and as a fallback.
+		Ref<GDScript> script = ResourceLoader::load(p_path);
+		if (script.is_null() || !script->is_valid()) {
+			return;
+		}
+		Vector<uint8_t> bytecode = script->get_as_byte_code();
+		if (!bytecode.is_empty()) {
+			add_file(GDScriptBytecodeCache::get_export_path(p_path), bytecode, false);
+		}
 	}
 };
 
@@ -178,8 +198,13 @@ void test_bytecode() {
 	GDScriptTests::test(GDScriptTests::TestType::TEST_BYTECODE);
 }
 
+void benchmark_vm() {
+	GDScriptTests::benchmark_vm();
+}
+
 REGISTER_TEST_COMMAND("gdscript-tokenizer", &test_tokenizer);
 REGISTER_TEST_COMMAND("gdscript-parser", &test_parser);
 REGISTER_TEST_COMMAND("gdscript-compiler", &test_compiler);
 REGISTER_TEST_COMMAND("gdscript-bytecode", &test_bytecode);
+REGISTER_TEST_COMMAND("gdscript-vm-benchmark", &benchmark_vm);
 #endif
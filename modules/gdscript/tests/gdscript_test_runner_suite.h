@@ -31,6 +31,7 @@
 #ifndef GDSCRIPT_TEST_RUNNER_SUITE_H
 #define GDSCRIPT_TEST_RUNNER_SUITE_H
 
+#include "../gdscript_byte_codegen.h"
 #include "gdscript_test_runner.h"
 #include "tests/test_macros.h"
 
@@ -69,6 +70,100 @@ func _init():
 	CHECK_MESSAGE(int(ref_counted->get_meta("result")) == 42, "The script should assign object metadata successfully.");
 }
 
+TEST_CASE("[Modules][GDScript] Load compiled bytecode and run it") {
+	const String source = R"(
+extends RefCounted
+
+const OFFSET = 10
+enum Mode { A, B = 5 }
+
+class Accumulator:
+	var total := 0
+
+	func add(p_value: int) -> void:
+		total += p_value
+
+var values := [1, 2, 3]
+var scale := 1:
+	set(value):
+		scale = value * 2
+
+func compute() -> int:
+	var accumulator := Accumulator.new()
+	for value in values:
+		accumulator.add(value * scale)
+	var doubled := func(x): return x * 2
+	var text := str(accumulator.total).pad_zeros(4)
+	return doubled.call(accumulator.total) + len(text) + OFFSET + Mode.B + int(Vector2(3, 4).length())
+
+func _init():
+	scale = 3
+	set_meta("result", compute())
+)";
+
+	Ref<GDScript> compiled = memnew(GDScript);
+	compiled->set_source_code(source);
+	ERR_PRINT_OFF;
+	const Error error = compiled->reload();
+	ERR_PRINT_ON;
+	REQUIRE_MESSAGE(error == OK, "The script should compile successfully.");
+
+	const Vector<uint8_t> bytecode = compiled->get_as_byte_code();
+	REQUIRE_MESSAGE(!bytecode.is_empty(), "The compiled script should be serializable.");
+
+	Ref<GDScript> loaded = memnew(GDScript);
+	loaded->set_source_code(source);
+	REQUIRE_MESSAGE(loaded->load_byte_code_from_buffer(bytecode) == OK, "The bytecode should load without compiling the source.");
+	CHECK_MESSAGE(loaded->get_as_byte_code() == bytecode, "Loaded bytecode should serialize back to the same buffer.");
+
+	Ref<RefCounted> ref_counted = memnew(RefCounted);
+	ref_counted->set_script(loaded);
+	CHECK_MESSAGE(int(ref_counted->get_meta("result")) == 96, "The loaded bytecode should run like the compiled script.");
+
+	Ref<GDScript> modified = memnew(GDScript);
+	modified->set_source_code(source + "\n# Modified.\n");
+	CHECK_MESSAGE(modified->load_byte_code_from_buffer(bytecode) != OK, "Bytecode should be rejected when the source changes.");
+}
+
+TEST_CASE("[Modules][GDScript] Conditional jumps are not fused with an operator when something jumps in between") {
+	// Debug builds put a line marker before each statement, so scripts can't produce this layout in tests.
+	// Build the equivalent of `if bump: value += 1` followed by `if value: return 1` by hand.
+	Ref<GDScript> script = memnew(GDScript);
+	GDScriptDataType bool_type;
+	bool_type.has_type = true;
+	bool_type.kind = GDScriptDataType::BUILTIN;
+	bool_type.builtin_type = Variant::BOOL;
+	GDScriptDataType int_type = bool_type;
+	int_type.builtin_type = Variant::INT;
+
+	GDScriptByteCodeGenerator gen;
+	gen.write_start(script.ptr(), "bump_then_check", true, MultiplayerAPI::RPCConfig(), int_type);
+	const GDScriptCodeGenerator::Address bump(GDScriptCodeGenerator::Address::FUNCTION_PARAMETER, gen.add_parameter("bump", false, bool_type), bool_type);
+	const GDScriptCodeGenerator::Address value(GDScriptCodeGenerator::Address::FUNCTION_PARAMETER, gen.add_parameter("value", false, int_type), int_type);
+	const GDScriptCodeGenerator::Address zero(GDScriptCodeGenerator::Address::CONSTANT, gen.add_or_get_constant(0), int_type);
+	const GDScriptCodeGenerator::Address one(GDScriptCodeGenerator::Address::CONSTANT, gen.add_or_get_constant(1), int_type);
+	gen.write_if(bump);
+	gen.write_binary_operator(value, Variant::OP_ADD, value, one);
+	gen.write_endif();
+	// Skipping the block above lands right after the operator, so this jump must stay separate.
+	gen.write_if(value);
+	gen.write_return(one);
+	gen.write_endif();
+	gen.write_return(zero);
+	GDScriptFunction *function = gen.write_end();
+
+	const int cases[][3] = { { false, 0, 0 }, { true, 0, 1 }, { true, -1, 0 }, { false, -1, 1 } };
+	for (const int *c : cases) {
+		const Variant args[2] = { bool(c[0]), c[1] };
+		const Variant *argptrs[2] = { &args[0], &args[1] };
+		Callable::CallError call_error;
+		const Variant result = function->call(nullptr, argptrs, 2, call_error);
+		CHECK(call_error.error == Callable::CallError::CALL_OK);
+		CHECK_MESSAGE(int(result) == c[2], vformat("bump_then_check(%s, %d) should return %d.", bool(c[0]), c[1], c[2]));
+	}
+	memdelete(function);
+}
+
 } // namespace GDScriptTests
 
 #endif // GDSCRIPT_TEST_RUNNER_SUITE_H
@@ -0,0 +1,152 @@
+/*************************************************************************/
+/*  gdscript_vm_benchmark.cpp                                            */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2021 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2021 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "test_gdscript.h"
+
+#include "core/os/os.h"
+
+#include "modules/gdscript/gdscript.h"
+
+namespace GDScriptTests {
+
+// Each function is called on one instance of the script, with another instance as `o`. That one is untyped, so all
+// accesses through it are resolved by name at runtime.
+static const char *vm_benchmark_source = R"(
+extends RefCounted
+
+var value = 1
+var counter := 0
+
+func get_value():
+	return value
+
+func get_named(n: int, o):
+	for i in n:
+		var v = o.value
+
+func set_named(n: int, o):
+	for i in n:
+		o.value = i
+
+func call_script(n: int, o):
+	for i in n:
+		o.get_value()
+
+func call_native(n: int, o):
+	for i in n:
+		o.get_reference_count()
+
+func compare_and_jump(n: int, _o):
+	var i := 0
+	while i < n:
+		i += 1
+
+func operate_member(n: int, _o):
+	for i in n:
+		counter += 1
+)";
+
+static const char *vm_benchmark_cases[] = {
+	"get_named",
+	"set_named",
+	"call_script",
+	"call_native",
+	"compare_and_jump",
+	"operate_member",
+};
+
+static const int VM_BENCHMARK_ITERATIONS = 1000000;
+static const int VM_BENCHMARK_RUNS = 5;
+
+static double run_vm_benchmark(const StringName &p_case, bool p_optimized) {
+	// Superinstructions are picked when compiling, so each mode needs its own script.
+	GDScriptFunction::disable_vm_optimizations = !p_optimized;
+
+	Ref<GDScript> script;
+	script.instantiate();
+	script->set_source_code(vm_benchmark_source);
+	Error err = script->reload();
+	if (err != OK) {
+		GDScriptFunction::disable_vm_optimizations = false;
+		ERR_FAIL_V_MSG(0, "Could not compile the VM benchmark script.");
+	}
+
+	Ref<RefCounted> self = memnew(RefCounted);
+	self->set_script(script);
+	Ref<RefCounted> other = memnew(RefCounted);
+	other->set_script(script);
+
+	Variant iterations = VM_BENCHMARK_ITERATIONS;
+	Variant warm_up_iterations = 16;
+	Variant other_variant = other;
+	const Variant *args[2] = { &warm_up_iterations, &other_variant };
+	Callable::CallError call_error;
+
+	// Fill the inline caches before measuring.
+	self->call(p_case, args, 2, call_error);
+
+	// Report the fastest run, the others are mostly noise from the rest of the system.
+	args[0] = &iterations;
+	uint64_t time = UINT64_MAX;
+	for (int i = 0; i < VM_BENCHMARK_RUNS; i++) {
+		uint64_t begin_time = OS::get_singleton()->get_ticks_usec();
+		self->call(p_case, args, 2, call_error);
+		time = MIN(time, OS::get_singleton()->get_ticks_usec() - begin_time);
+	}
+
+	GDScriptFunction::disable_vm_optimizations = false;
+	ERR_FAIL_COND_V_MSG(call_error.error != Callable::CallError::CALL_OK, 0, vformat("Calling '%s' failed.", p_case));
+	return time / 1000.0;
+}
+
+void benchmark_vm() {
+	List<String> args = OS::get_singleton()->get_cmdline_args();
+
+	init_language("modules/gdscript/tests/scripts");
+
+	bool run_all = true;
+	for (const char *name : vm_benchmark_cases) {
+		run_all = run_all && !args.find(name);
+	}
+
+	print_line(vformat("%d iterations per case, best of %d runs, without and with inline caches and superinstructions:", VM_BENCHMARK_ITERATIONS, VM_BENCHMARK_RUNS));
+	for (const char *name : vm_benchmark_cases) {
+		if (!run_all && !args.find(name)) {
+			continue;
+		}
+		double regular_time = run_vm_benchmark(name, false);
+		double optimized_time = run_vm_benchmark(name, true);
+		print_line(vformat("\t%s: %.3f ms -> %.3f ms (%.2fx)", name, regular_time, optimized_time, optimized_time > 0 ? regular_time / optimized_time : 0.0));
+	}
+
+	finish_language();
+}
+
+} // namespace GDScriptTests
@@ -0,0 +1,42 @@
+# An operator followed by a conditional jump on its result is fused into one
+# instruction, except when another jump lands between the two. Debug builds put a
+# line marker between statements, so the unfused cases below only show up in release.
+
+func bump_then_check(value: int, bump: bool) -> String:
+	var i := value
+	if bump:
+		i += 1
+	# Skipping the `if` above jumps right between `i += 1` and the check below.
+	if i:
+		return "nonzero %d" % i
+	return "zero"
+
+func count_down(start: int) -> int:
+	var n := 0
+	var iterations := 0
+	n += start
+	# Each iteration jumps back right after `n += start`.
+	while n:
+		n -= 1
+		iterations += 1
+	return iterations
+
+func compare_loops(limit: int) -> Array:
+	var result := []
+	var i := 0
+	while i < limit:
+		if i % 2 == 0 and i != 2:
+			result.append(i)
+		i += 1
+	result.append("even" if limit % 2 == 0 else "odd")
+	return result
+
+func test():
+	print(bump_then_check(0, false))
+	print(bump_then_check(0, true))
+	print(bump_then_check(-1, true))
+	print(bump_then_check(-1, false))
+	print(count_down(0))
+	print(count_down(3))
+	print(compare_loops(7))
+	print(compare_loops(4))
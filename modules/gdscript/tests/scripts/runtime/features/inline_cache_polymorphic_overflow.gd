@@ -0,0 +1,48 @@
+# Each call site caches at most four classes. Cycling through more than that keeps
+# evicting entries, which must still resolve to the right member or method.
+
+class A:
+	var value = "A"
+	func describe():
+		return "A " + value
+
+class B:
+	var padding = 0
+	var value = "B"
+	func describe():
+		return "B " + value
+
+class C extends A:
+	var extra = "extra"
+	func describe():
+		return "C " + value + " " + extra
+
+class D extends A:
+	pass
+
+class E:
+	var padding_1 = 1
+	var padding_2 = 2
+	var value = "E"
+	func describe():
+		return "E " + value
+
+class F extends B:
+	var value_2 = "F"
+
+func test():
+	var objects = [A.new(), B.new(), C.new(), D.new(), E.new(), F.new()]
+	for pass_index in 3:
+		var line = []
+		for obj in objects:
+			obj.value = obj.value + str(pass_index)
+			line.append(obj.describe())
+		print(line)
+
+	# Native classes, without scripts.
+	var natives = [RefCounted.new(), Resource.new(), Image.new(), RandomNumberGenerator.new(), StreamPeerBuffer.new(), A.new()]
+	for pass_index in 2:
+		var line = []
+		for obj in natives:
+			line.append(obj.get_class())
+		print(line)
@@ -0,0 +1,32 @@
+# Call sites cache member indices and functions per script. Reloading the script
+# changes both, so the sites below must not keep using what they cached before.
+
+func read(obj):
+	return [obj.value, obj.describe()]
+
+func write(obj, value):
+	obj.value = value
+
+func test():
+	var script := GDScript.new()
+	# Compiling a script without a path is reported as an error, so give it one that is never saved.
+	script.resource_path = "res://inline_cache_script_reload_generated.gd"
+	script.source_code = "var value = 1\nfunc describe():\n\treturn 'first'\n"
+	script.reload()
+
+	var obj = script.new()
+	for i in 3:
+		write(obj, i)
+		print(read(obj))
+	obj = null
+
+	# Same script object, but `value` moves to another index and `describe()` is a new function.
+	script.source_code = "var padding = 'padding'\nvar value = 10\nfunc describe():\n\treturn 'second ' + padding\n"
+	script.reload()
+
+	obj = script.new()
+	print(read(obj))
+	for i in 3:
+		write(obj, 20 + i)
+		print(read(obj))
+	print(obj.padding)
@@ -0,0 +1,37 @@
+# Typed members assigned from outside the class with values of another type need
+# a conversion, even when the call site already cached where the member is.
+
+class Holder:
+	var f: float = 0.0
+	var i: int = 0
+	var s: String = ""
+	var v: Vector2 = Vector2()
+
+	func add(amount):
+		f += amount
+		i += amount
+
+func assign(holder, value):
+	holder.f = value
+	holder.i = value
+
+func test():
+	var holder = Holder.new()
+	for value in [1, 2.75, 3, true]:
+		assign(holder, value)
+		print(holder.f, " ", typeof(holder.f) == TYPE_FLOAT, " ", holder.i, " ", typeof(holder.i) == TYPE_INT)
+
+	for value in [&"name", "string", &"name_again"]:
+		holder.s = value
+		print(holder.s, " ", typeof(holder.s) == TYPE_STRING)
+
+	for value in [Vector2i(1, 2), Vector2(0.5, 1.5)]:
+		holder.v = value
+		print(holder.v, " ", typeof(holder.v) == TYPE_VECTOR2)
+
+	# Compound assignments: `i += 0.5` produces a float and can't be done in place.
+	holder.f = 0.0
+	holder.i = 0
+	for amount in [1, 0.5, 2]:
+		holder.add(amount)
+		print(holder.f, " ", holder.i, " ", typeof(holder.i) == TYPE_INT)
@@ -44,6 +44,7 @@ enum TestType {
 };
 
 void test(TestType p_type);
+void benchmark_vm();
 
 } // namespace GDScriptTests
 
@@ -0,0 +1,169 @@
+/*************************************************************************/
+/*  test_gdscript_cache.h                                                */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2021 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2021 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+
+#ifndef TEST_GDSCRIPT_CACHE_H
+#define TEST_GDSCRIPT_CACHE_H
+
+#include "../gdscript.h"
+#include "../gdscript_cache.h"
+#include "core/io/dir_access.h"
+#include "core/io/file_access.h"
+#include "core/io/resource_loader.h"
+#include "core/os/os.h"
+#include "tests/test_macros.h"
+
+namespace TestGDScriptCache {
+
+struct ScriptFile {
+	const char *name;
+	const char *source;
+};
+
+// Every dependency kind the parser hints at: an `extends` path, `preload()` paths (nested in helper.gd) and a `class_name`.
+// `$DIR` is replaced by the directory the scripts are written to.
+const ScriptFile script_files[] = {
+	{ "main.gd", R"(
+extends "$DIR/base.gd"
+
+const Helper = preload("$DIR/helper.gd")
+
+func run() -> int:
+	return base_value() + Helper.twice(4) + ParseAheadShared.value()
+)" },
+	{ "base.gd", R"(
+extends RefCounted
+
+func base_value() -> int:
+	return 1
+)" },
+	{ "helper.gd", R"(
+const Leaf = preload("$DIR/leaf.gd")
+
+static func twice(x: int) -> int:
+	return x * 2 + Leaf.leaf_value()
+)" },
+	{ "leaf.gd", R"(
+extends "$DIR/shared.gd"
+
+static func leaf_value() -> int:
+	return value() + 10
+)" },
+	{ "shared.gd", R"(
+class_name ParseAheadShared
+extends RefCounted
+
+static func value() -> int:
+	return 3
+)" },
+};
+const int script_file_count = sizeof(script_files) / sizeof(script_files[0]);
+
+struct LoadResult {
+	int run_result = 0;
+	// Bytecode by function name.
+	Map<String, Vector<int>> code;
+};
+
+void collect_code(const GDScript *p_script, LoadResult &r_result) {
+	for (const Map<StringName, GDScriptFunction *>::Element *E = p_script->get_member_functions().front(); E; E = E->next()) {
+		const GDScriptFunction *function = E->get();
+		Vector<int> code;
+		for (int i = 0; i < function->get_code_size(); i++) {
+			code.push_back(function->get_code()[i]);
+		}
+		r_result.code[p_script->get_path().get_file() + ":" + function->get_name()] = code;
+	}
+}
+
+LoadResult load_main(const String &p_dir) {
+	LoadResult result;
+	Ref<GDScript> script = ResourceLoader::load(p_dir.plus_file("main.gd"), "GDScript");
+	REQUIRE(script.is_valid());
+	REQUIRE(script->is_valid());
+
+	collect_code(script.ptr(), result);
+	const Ref<GDScript> base = script->get_base_script();
+	REQUIRE(base.is_valid());
+	collect_code(base.ptr(), result);
+	const Ref<GDScript> helper = script->get_constants()["Helper"];
+	REQUIRE(helper.is_valid());
+	collect_code(helper.ptr(), result);
+
+	Ref<RefCounted> object;
+	object.instantiate();
+	object->set_script(script);
+	result.run_result = object->call("run");
+	return result;
+}
+
+TEST_CASE("[Modules][GDScript] Dependencies parsed ahead of time compile like a serial load") {
+	const String dir = OS::get_singleton()->get_cache_path().plus_file("gdscript_cache_test").simplify_path();
+	{
+		DirAccessRef da = DirAccess::create(DirAccess::ACCESS_FILESYSTEM);
+		REQUIRE(da->make_dir_recursive(dir) == OK);
+	}
+	for (int i = 0; i < script_file_count; i++) {
+		FileAccessRef f = FileAccess::open(dir.plus_file(script_files[i].name), FileAccess::WRITE);
+		REQUIRE(f);
+		f->store_string(String(script_files[i].source).replace("$DIR", dir));
+	}
+	ScriptServer::add_global_class("ParseAheadShared", "RefCounted", "GDScript", dir.plus_file("shared.gd"));
+
+	GDScriptCache::disable_parse_ahead = true;
+	uint32_t taken = GDScriptCache::parse_ahead_taken;
+	const LoadResult serial = load_main(dir);
+	CHECK(GDScriptCache::parse_ahead_taken == taken);
+	GDScriptCache::disable_parse_ahead = false;
+
+	// The scripts were released, so this loads them again, now parsing the dependencies on worker threads.
+	// Loading nested dependencies while their parses are waited on must not deadlock.
+	taken = GDScriptCache::parse_ahead_taken;
+	const LoadResult parsed_ahead = load_main(dir);
+	CHECK_MESSAGE(GDScriptCache::parse_ahead_taken - taken >= uint32_t(script_file_count - 1), "Every dependency should use the parse done ahead of time instead of parsing again.");
+
+	CHECK(serial.run_result == 1 + 8 + 13 + 3);
+	CHECK(parsed_ahead.run_result == serial.run_result);
+	REQUIRE(parsed_ahead.code.size() == serial.code.size());
+	for (const Map<String, Vector<int>>::Element *E = serial.code.front(); E; E = E->next()) {
+		REQUIRE(parsed_ahead.code.has(E->key()));
+		CHECK_MESSAGE(parsed_ahead.code[E->key()] == E->get(), vformat("%s should compile to the same bytecode.", E->key()));
+	}
+
+	ScriptServer::remove_global_class("ParseAheadShared");
+	for (int i = 0; i < script_file_count; i++) {
+		DirAccess::remove_file_or_error(dir.plus_file(script_files[i].name));
+	}
+	DirAccess::remove_file_or_error(dir);
+}
+
+} // namespace TestGDScriptCache
+
+#endif // TEST_GDSCRIPT_CACHE_H
@@ -0,0 +1,320 @@
+/*************************************************************************/
+/*  test_gdscript_native.h                                               */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2021 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2021 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef TEST_GDSCRIPT_NATIVE_H
+#define TEST_GDSCRIPT_NATIVE_H
+
+#include "../gdscript.h"
+#include "../gdscript_byte_codegen.h"
+#include "../gdscript_native.h"
+#include "core/io/dir_access.h"
+#include "core/io/file_access.h"
+#include "core/os/os.h"
+#include "tests/test_macros.h"
+
+namespace TestGDScriptNative {
+
+const char *source = R"(
+extends RefCounted
+
+var speed := 2.0
+
+func fib(n: int) -> int:
+	var a := 0
+	var b := 1
+	for i in n:
+		var t := a + b
+		a = b
+		b = t
+	return a
+
+func distance(x1: float, y1: float, x2: float, y2: float) -> float:
+	var dx := x2 - x1
+	var dy: float = y2 - y1
+	return sqrt(dx * dx + dy * dy)
+
+func tick(gold: int, rate: float, days: int) -> int:
+	var total: float = gold
+	var day := 0
+	while day < days:
+		if total > 1000.0 and day % 2 == 0:
+			total *= 1.0 + rate
+		elif not (total < 0.0):
+			total += 1
+		else:
+			break
+		day += 1
+	return int(total)
+
+func pick(a: bool, b: int) -> bool:
+	var c: int = b if a else -b
+	return c > 3 or a
+
+func mix(a: int, b: int, f: float) -> float:
+	var q := a / b
+	var r := a % b
+	var s := (a << 3) ^ (b >> 1) & ~a
+	var m := clampf(f, -2.0, 2.0) + posmod(a, 7) + fposmod(f, 1.5) + mini(a, b) + absi(-a) + signf(f)
+	return q + r + s + m + deg2rad(f) + float(-a) + floor(f * 0.5)
+
+func accumulate(n: float) -> float:
+	var acc := 0.0
+	for x in n:
+		acc += x * 0.5
+	return acc
+
+func toggle(a: bool, b: bool) -> bool:
+	return (a and not b) or (b and not a)
+
+func scaled(a: float) -> float:
+	return a * speed
+
+func fib_plus_one(a: int) -> int:
+	return fib(a) + 1
+
+func increment(a):
+	return a + 1
+)";
+
+const char *native_functions[] = { "fib", "distance", "tick", "pick", "mix", "accumulate", "toggle" };
+const char *vm_functions[] = { "scaled", "fib_plus_one", "increment" };
+const int native_function_count = sizeof(native_functions) / sizeof(native_functions[0]);
+const int vm_function_count = sizeof(vm_functions) / sizeof(vm_functions[0]);
+
+Ref<GDScript> compile_script(const String &p_source) {
+	Ref<GDScript> script = memnew(GDScript);
+	script->set_source_code(p_source);
+	// Scripts without a path print a spurious `Condition "err" is true` message, see "Load source code dynamically and run it".
+	ERR_PRINT_OFF;
+	const Error error = script->reload();
+	ERR_PRINT_ON;
+	CHECK_MESSAGE(error == OK, "The script should compile successfully.");
+	return script;
+}
+
+TEST_CASE("[Modules][GDScript] Native transpiler accepts typed functions with loops, jumps, operators and utility calls") {
+	Ref<GDScript> script = compile_script(source);
+	for (const char *name : native_functions) {
+		const GDScriptFunction *function = script->get_member_functions()[name];
+		String code, error;
+		CHECK_MESSAGE(GDScriptNativeTranspiler::transpile_function(function, code, error), vformat("%s should be transpiled, got: %s", name, error));
+		CHECK_MESSAGE(!code.is_empty(), vformat("%s should have a body.", name));
+	}
+}
+
+TEST_CASE("[Modules][GDScript] Native transpiler rejects member access, calls and untyped arguments") {
+	Ref<GDScript> script = compile_script(source);
+	for (const char *name : vm_functions) {
+		const GDScriptFunction *function = script->get_member_functions()[name];
+		String code, error;
+		CHECK_MESSAGE(!GDScriptNativeTranspiler::transpile_function(function, code, error), vformat("%s should stay in the VM.", name));
+		CHECK_MESSAGE(!error.is_empty(), vformat("%s should report why it stays in the VM.", name));
+	}
+
+	int function_count = 0;
+	int transpiled_count = 0;
+	Vector<Ref<GDScript>> scripts;
+	scripts.push_back(script);
+	const String library = GDScriptNativeTranspiler::transpile_scripts(scripts, function_count, transpiled_count);
+	CHECK(function_count == native_function_count + vm_function_count);
+	CHECK(transpiled_count == native_function_count);
+	for (const char *name : vm_functions) {
+		CHECK_MESSAGE(library.find(vformat("\"%s\"", name)) == -1, vformat("%s shouldn't be in the library.", name));
+	}
+}
+
+// Writes `if bump: value += 2`, `value += 1` and `if value: return 1` followed by `return 0`.
+// Debug builds put a line marker before each statement, release builds fuse the last operator with the jump after it.
+GDScriptFunction *write_bump_function(GDScript *p_script, bool p_debug) {
+	GDScriptDataType bool_type;
+	bool_type.has_type = true;
+	bool_type.kind = GDScriptDataType::BUILTIN;
+	bool_type.builtin_type = Variant::BOOL;
+	GDScriptDataType int_type = bool_type;
+	int_type.builtin_type = Variant::INT;
+
+	GDScriptByteCodeGenerator gen;
+	gen.write_start(p_script, "bump", false, MultiplayerAPI::RPCConfig(), int_type);
+	const GDScriptCodeGenerator::Address bump(GDScriptCodeGenerator::Address::FUNCTION_PARAMETER, gen.add_parameter("bump", false, bool_type), bool_type);
+	const GDScriptCodeGenerator::Address value(GDScriptCodeGenerator::Address::FUNCTION_PARAMETER, gen.add_parameter("value", false, int_type), int_type);
+	const GDScriptCodeGenerator::Address zero(GDScriptCodeGenerator::Address::CONSTANT, gen.add_or_get_constant(0), int_type);
+	const GDScriptCodeGenerator::Address one(GDScriptCodeGenerator::Address::CONSTANT, gen.add_or_get_constant(1), int_type);
+	const GDScriptCodeGenerator::Address two(GDScriptCodeGenerator::Address::CONSTANT, gen.add_or_get_constant(2), int_type);
+
+	int line = 1;
+	if (p_debug) {
+		gen.write_newline(line++);
+	}
+	gen.write_if(bump);
+	if (p_debug) {
+		gen.write_newline(line++);
+	}
+	gen.write_binary_operator(value, Variant::OP_ADD, value, two);
+	gen.write_endif();
+	if (p_debug) {
+		gen.write_newline(line++);
+	}
+	gen.write_binary_operator(value, Variant::OP_ADD, value, one);
+	if (p_debug) {
+		gen.write_newline(line++);
+	}
+	gen.write_if(value);
+	if (p_debug) {
+		gen.write_newline(line++);
+	}
+	gen.write_return(one);
+	gen.write_endif();
+	if (p_debug) {
+		gen.write_newline(line++);
+	}
+	gen.write_return(zero);
+	return gen.write_end();
+}
+
+TEST_CASE("[Modules][GDScript] Native code has the same hash for debug and release bytecode") {
+	Ref<GDScript> script = memnew(GDScript);
+	GDScriptFunction *debug = write_bump_function(script.ptr(), true);
+	GDScriptFunction *release = write_bump_function(script.ptr(), false);
+
+	// `if bump` (3) and `value += 2` (5) come first, then the fused `value += 1` and `if value`.
+	REQUIRE(release->get_code_size() > 8);
+	CHECK_MESSAGE((release->get_code()[8] & GDScriptFunction::INSTR_MASK) == GDScriptFunction::OPCODE_JUMP_IF_NOT_OPERATOR_VALIDATED, "Release bytecode should fuse the operator and the jump.");
+	CHECK_MESSAGE(debug->get_code_size() > release->get_code_size(), "Debug bytecode should have line markers.");
+
+	String debug_code, release_code, error;
+	CHECK_MESSAGE(GDScriptNativeTranspiler::transpile_function(debug, debug_code, error), error);
+	CHECK_MESSAGE(GDScriptNativeTranspiler::transpile_function(release, release_code, error), error);
+	CHECK(debug_code == release_code);
+	CHECK_MESSAGE(debug_code.hash64() == release_code.hash64(), "Native code generated in the editor should be used by exported projects.");
+
+	memdelete(debug);
+	memdelete(release);
+}
+
+Array call_functions(Object *p_object) {
+	Array results;
+	results.push_back(p_object->call("fib", 0));
+	results.push_back(p_object->call("fib", 50));
+	results.push_back(p_object->call("fib", 100)); // Wraps around.
+	results.push_back(p_object->call("distance", 1.0, 2.0, 4.5, -3.25));
+	results.push_back(p_object->call("tick", 990, 0.013, 400));
+	results.push_back(p_object->call("tick", -5, 0.5, 10));
+	results.push_back(p_object->call("pick", true, 2));
+	results.push_back(p_object->call("pick", false, -7));
+	results.push_back(p_object->call("mix", 37, 5, 1.75));
+	results.push_back(p_object->call("mix", -37, 4, -3.5));
+	results.push_back(p_object->call("mix", 9, -2, 0.0));
+	results.push_back(p_object->call("accumulate", 10.5));
+	results.push_back(p_object->call("accumulate", -1.0));
+	results.push_back(p_object->call("toggle", true, false));
+	results.push_back(p_object->call("toggle", true, true));
+	return results;
+}
+
+TEST_CASE("[Modules][GDScript] Native code returns the same results as the VM") {
+	// The library is built with the C++ compiler found in the path, like a user would.
+	List<String> arguments;
+	arguments.push_back("--version");
+	int exit_code = -1;
+	if (OS::get_singleton()->execute("c++", arguments, nullptr, &exit_code) != OK || exit_code != 0) {
+		MESSAGE("No C++ compiler found, skipping.");
+		return;
+	}
+
+	Vector<Ref<GDScript>> scripts;
+	scripts.push_back(compile_script(source));
+	int function_count = 0;
+	int transpiled_count = 0;
+	const String library_source = GDScriptNativeTranspiler::transpile_scripts(scripts, function_count, transpiled_count);
+	scripts.clear();
+
+	const String source_path = OS::get_singleton()->get_cache_path().plus_file("gdscript_native_test.cpp");
+	const String library_path = OS::get_singleton()->get_cache_path().plus_file("gdscript_native_test.so");
+	{
+		FileAccessRef f = FileAccess::open(source_path, FileAccess::WRITE);
+		REQUIRE(f);
+		f->store_string(library_source);
+	}
+	arguments.clear();
+	arguments.push_back("-std=c++17");
+	arguments.push_back("-O2");
+	arguments.push_back("-shared");
+	arguments.push_back("-fPIC");
+	arguments.push_back(source_path);
+	arguments.push_back("-o");
+	arguments.push_back(library_path);
+	String output;
+	REQUIRE(OS::get_singleton()->execute("c++", arguments, &output, &exit_code, true) == OK);
+	REQUIRE_MESSAGE(exit_code == 0, output);
+	REQUIRE(GDScriptNativeLibrary::load(library_path) == OK);
+
+	// Functions are bound when the script compiles.
+	Ref<GDScript> script = compile_script(source);
+	for (const char *name : native_functions) {
+		CHECK_MESSAGE(script->get_member_functions()[name]->has_native_code(), vformat("%s should run native code.", name));
+	}
+	for (const char *name : vm_functions) {
+		CHECK_MESSAGE(!script->get_member_functions()[name]->has_native_code(), vformat("%s should run in the VM.", name));
+	}
+
+	Ref<RefCounted> object;
+	object.instantiate();
+	object->set_script(script);
+	GDScriptFunction::disable_vm_optimizations = true;
+	const Array vm_results = call_functions(object.ptr());
+	GDScriptFunction::disable_vm_optimizations = false;
+	const Array native_results = call_functions(object.ptr());
+
+	REQUIRE(vm_results.size() == native_results.size());
+	for (int i = 0; i < vm_results.size(); i++) {
+		CHECK_MESSAGE(vm_results[i].get_type() == native_results[i].get_type(), vformat("Call %d should return the same type.", i));
+		CHECK_MESSAGE(vm_results[i] == native_results[i], vformat("Call %d returned %s in the VM and %s natively.", i, vm_results[i], native_results[i]));
+	}
+
+	// Unloading the library sends the functions back to the VM instead of leaving them pointing into it.
+	GDScriptNativeLibrary::unload();
+	for (const char *name : native_functions) {
+		CHECK_MESSAGE(!script->get_member_functions()[name]->has_native_code(), vformat("%s should run in the VM after unloading.", name));
+	}
+	const Array unloaded_results = call_functions(object.ptr());
+	REQUIRE(unloaded_results.size() == vm_results.size());
+	for (int i = 0; i < vm_results.size(); i++) {
+		CHECK_MESSAGE(unloaded_results[i] == vm_results[i], vformat("Call %d should return the same result after unloading.", i));
+	}
+
+	object.unref();
+	script.unref();
+	DirAccess::remove_file_or_error(source_path);
+	DirAccess::remove_file_or_error(library_path);
+}
+
+} // namespace TestGDScriptNative
+
+#endif // TEST_GDSCRIPT_NATIVE_H
@@ -0,0 +1,110 @@
+/*************************************************************************/
+/*  test_gdscript_sampler.h                                              */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2021 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2021 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+
+#ifndef TEST_GDSCRIPT_SAMPLER_H
+#define TEST_GDSCRIPT_SAMPLER_H
+
+#include "../gdscript.h"
+#include "../gdscript_sampler.h"
+#include "core/os/os.h"
+#include "tests/test_macros.h"
+
+namespace TestGDScriptSampler {
+
+const char *source = R"(
+extends RefCounted
+
+func inner(n: int) -> int:
+	var total := 0
+	for i in n:
+		total += i * i
+	return total
+
+func outer() -> int:
+	var total := 0
+	for i in 200:
+		total += inner(100)
+	return total
+
+func failing(object):
+	return object.missing
+)";
+
+TEST_CASE("[Modules][GDScript] Sampling profiler records nested calls") {
+	Ref<GDScript> script = memnew(GDScript);
+	script->set_source_code(source);
+	// Scripts without a path print a spurious `Condition "err" is true` message, see "Load source code dynamically and run it".
+	ERR_PRINT_OFF;
+	const Error error = script->reload();
+	ERR_PRINT_ON;
+	REQUIRE_MESSAGE(error == OK, "The script should compile successfully.");
+
+	Ref<RefCounted> object;
+	object.instantiate();
+	object->set_script(script);
+
+	GDScriptSampler::clear();
+	REQUIRE(GDScriptSampler::start(100) == OK);
+
+	// Keep the functions running until the sampler thread caught them at least once.
+	String stack;
+	uint64_t count = 0;
+	const uint64_t timeout = OS::get_singleton()->get_ticks_msec() + 10000;
+	while (count == 0 && OS::get_singleton()->get_ticks_msec() < timeout) {
+		object->call("outer");
+
+		const Vector<String> lines = GDScriptSampler::get_collapsed_stacks().split("\n", false);
+		for (int i = 0; i < lines.size(); i++) {
+			if (lines[i].find(":outer;") != -1 && lines[i].find(":inner ") != -1) {
+				stack = lines[i].get_slice(" ", 0);
+				count = lines[i].get_slice(" ", 1).to_int();
+			}
+		}
+	}
+
+	// A script error leaves the function early, it should still pop its frame.
+	ERR_PRINT_OFF;
+	object->call("failing", Variant());
+	ERR_PRINT_ON;
+
+	GDScriptSampler::stop();
+
+	CHECK_MESSAGE(count > 0, "The sampler should have seen `inner()` called from `outer()`.");
+	CHECK_MESSAGE(stack.ends_with(":outer;:inner"), vformat("`inner()` should be the innermost frame, got \"%s\".", stack));
+	CHECK_MESSAGE(GDScriptSampler::get_stack_depth() == 0, "No frames should be left once all calls returned.");
+
+	GDScriptSampler::clear();
+	CHECK(GDScriptSampler::get_collapsed_stacks().is_empty());
+}
+
+} // namespace TestGDScriptSampler
+
+#endif // TEST_GDSCRIPT_SAMPLER_H
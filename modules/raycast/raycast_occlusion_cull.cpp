@@ -30,6 +30,8 @@
 
 #include "raycast_occlusion_cull.h"
 #include "core/config/project_settings.h"
+#include "core/math/geometry_3d.h"
+#include "core/os/worker_thread_pool.h"
 #include "core/templates/local_vector.h"
 
 #ifdef __SSE2__
@@ -43,7 +45,15 @@ void RaycastOcclusionCull::RaycastHZBuffer::clear() {
 
 	camera_rays.clear();
 	camera_ray_masks.clear();
+	dirty_packets.clear();
 	packs_size = Size2i();
+
+	history_valid = false;
+	history_samples.clear();
+	reprojected_depths.clear();
+	reprojected_samples.clear();
+	packet_reprojected.clear();
+	packet_dirty.clear();
 }
 
 void RaycastOcclusionCull::RaycastHZBuffer::resize(const Size2i &p_size) {
@@ -62,16 +72,247 @@ void RaycastOcclusionCull::RaycastHZBuffer::resize(const Size2i &p_size) {
 	int ray_packets_count = packs_size.x * packs_size.y;
 	camera_rays.resize(ray_packets_count);
 	camera_ray_masks.resize(ray_packets_count * TILE_SIZE * TILE_SIZE);
+
+	history_valid = false;
+	packet_reprojected.resize(ray_packets_count);
+	packet_dirty.resize(ray_packets_count);
 }
 
-void RaycastOcclusionCull::RaycastHZBuffer::update_camera_rays(const Transform3D &p_cam_transform, const CameraMatrix &p_cam_projection, bool p_cam_orthogonal, ThreadWorkPool &p_thread_work_pool) {
+void RaycastOcclusionCull::RaycastHZBuffer::update_camera_rays(const Transform3D &p_cam_transform, const CameraMatrix &p_cam_projection, bool p_cam_orthogonal) {
 	CameraRayThreadData td;
 	td.camera_matrix = p_cam_projection;
 	td.camera_transform = p_cam_transform;
 	td.camera_orthogonal = p_cam_orthogonal;
-	td.thread_count = p_thread_work_pool.get_thread_count();
+	td.thread_count = WorkerThreadPool::get_singleton()->get_thread_count();
+
+	ray_far = p_cam_projection.get_z_far() * 1.05f;
+
+	WorkerThreadPool::get_singleton()->do_work(td.thread_count, this, &RaycastHZBuffer::_camera_rays_threaded, &td);
+}
+
+void RaycastOcclusionCull::RaycastHZBuffer::_mark_packets_dirty(const Rect2i &p_rect) {
+	Rect2i rect = p_rect.intersection(Rect2i(Point2i(), sizes[0]));
+	if (!rect.has_no_area()) {
+		for (int y = rect.position.y / TILE_SIZE; y <= (rect.position.y + rect.size.y - 1) / TILE_SIZE; y++) {
+			for (int x = rect.position.x / TILE_SIZE; x <= (rect.position.x + rect.size.x - 1) / TILE_SIZE; x++) {
+				packet_dirty[y * packs_size.x + x] = true;
+			}
+		}
+	}
+}
+
+void RaycastOcclusionCull::RaycastHZBuffer::_reproject_history(const CameraMatrix &p_view_projection, const Scenario &p_scenario) {
+	Size2i buffer_size = sizes[0];
+
+	reprojected_depths.resize(buffer_size.x * buffer_size.y);
+	reprojected_samples.resize(buffer_size.x * buffer_size.y);
+	for (uint32_t i = 0; i < reprojected_depths.size(); i++) {
+		reprojected_depths[i] = FLT_MAX;
+		reprojected_samples[i] = UINT32_MAX;
+	}
+
+	// Scatter the previous hits to the nearest new ray, keeping the closest.
+	for (uint32_t i = 0; i < history_samples.size(); i++) {
+		const Vector3 &point = history_samples[i].point;
+		Plane clip = p_view_projection.xform4(Plane(point, 1.0));
+		if (clip.d <= 0.0) {
+			continue;
+		}
+
+		Vector3 ndc = clip.normal / clip.d;
+		int x = Math::round((ndc.x * 0.5 + 0.5) * (buffer_size.x - 1));
+		int y = Math::round((ndc.y * 0.5 + 0.5) * (buffer_size.y - 1));
+		if (x < 0 || y < 0 || x >= buffer_size.x || y >= buffer_size.y) {
+			continue;
+		}
+
+		const RayPacket &packet = camera_rays[(y / TILE_SIZE) * packs_size.x + x / TILE_SIZE];
+		int k = (y % TILE_SIZE) * TILE_SIZE + x % TILE_SIZE;
+		Vector3 origin = Vector3(packet.ray.org_x[k], packet.ray.org_y[k], packet.ray.org_z[k]);
+		Vector3 dir = Vector3(packet.ray.dir_x[k], packet.ray.dir_y[k], packet.ray.dir_z[k]);
+		float depth = (point - origin).dot(dir);
+		if (depth > 0.0f && depth < reprojected_depths[y * buffer_size.x + x]) {
+			reprojected_depths[y * buffer_size.x + x] = depth;
+			reprojected_samples[y * buffer_size.x + x] = i;
+		}
+	}
+
+	// The previous depths can't be used as they are: a ray going through a gap too thin for the previous
+	// rays to see would get the depth of the occluders around it. Instead, each ray is intersected with the
+	// triangles hit around it and keeps the closest one it goes through. Nothing past an occluder it goes
+	// through can be visible, so the reprojected depth is never closer than a raycast one and can only
+	// occlude less. Packets with rays going through none of them, next to holes left by disocclusion or
+	// on the edges of the screen, are raycast again.
+	for (uint32_t i = 0; i < camera_rays.size(); i++) {
+		RayPacket &packet = camera_rays[i];
+		int tile_x = (i % packs_size.x) * TILE_SIZE;
+		int tile_y = (i / packs_size.x) * TILE_SIZE;
+		float depths[TILE_RAYS];
+		uint32_t hits[TILE_RAYS];
+		bool covered = true;
+
+		for (int j = 0; j < TILE_RAYS && covered; j++) {
+			if (!camera_ray_masks[i * TILE_RAYS + j]) {
+				continue;
+			}
+
+			int x = tile_x + j % TILE_SIZE;
+			int y = tile_y + j / TILE_SIZE;
+			Vector3 origin = Vector3(packet.ray.org_x[j], packet.ray.org_y[j], packet.ray.org_z[j]);
+			Vector3 dir = Vector3(packet.ray.dir_x[j], packet.ray.dir_y[j], packet.ray.dir_z[j]);
+			uint32_t tested[9];
+			int tested_count = 0;
+			depths[j] = FLT_MAX;
+
+			for (int ny = MAX(0, y - 1); ny <= MIN(buffer_size.y - 1, y + 1); ny++) {
+				for (int nx = MAX(0, x - 1); nx <= MIN(buffer_size.x - 1, x + 1); nx++) {
+					uint32_t sample_idx = reprojected_samples[ny * buffer_size.x + nx];
+					if (sample_idx == UINT32_MAX) {
+						continue;
+					}
+
+					const HistorySample &sample = history_samples[sample_idx];
+					bool seen = false;
+					for (int k = 0; k < tested_count && !seen; k++) {
+						seen = history_samples[tested[k]].geom_id == sample.geom_id && history_samples[tested[k]].prim_id == sample.prim_id;
+					}
+					if (seen) {
+						continue;
+					}
+					tested[tested_count++] = sample_idx;
+
+					float distance;
+					if (p_scenario.intersect_triangle(sample.geom_id, sample.prim_id, origin, dir, distance) && distance < depths[j]) {
+						depths[j] = distance;
+						hits[j] = sample_idx;
+					}
+				}
+			}
+
+			covered = depths[j] != FLT_MAX;
+		}
+
+		if (!covered) {
+			packet_dirty[i] = true;
+			continue;
+		}
+
+		for (int j = 0; j < TILE_RAYS; j++) {
+			if (!camera_ray_masks[i * TILE_RAYS + j]) {
+				continue;
+			}
+			// Past the far plane the ray wouldn't have hit anything either.
+			packet.ray.tfar[j] = MIN(depths[j], ray_far);
+			packet.hit.geomID[j] = history_samples[hits[j]].geom_id;
+			packet.hit.primID[j] = history_samples[hits[j]].prim_id;
+		}
+		packet_reprojected[i] = true;
+	}
+}
+
+bool RaycastOcclusionCull::RaycastHZBuffer::update_dirty_packets(const Transform3D &p_cam_transform, const CameraMatrix &p_cam_projection, bool p_cam_orthogonal, const Scenario &p_scenario) {
+	uint32_t packet_count = camera_rays.size();
+	bool camera_changed = !history_valid || history_cam_transform != p_cam_transform || history_cam_projection != p_cam_projection || history_cam_orthogonal != p_cam_orthogonal;
+
+	for (uint32_t i = 0; i < packet_count; i++) {
+		packet_dirty[i] = false;
+	}
+
+	if (!history_valid || history_scenario_version < p_scenario.forgotten_version) {
+		update_camera_rays(p_cam_transform, p_cam_projection, p_cam_orthogonal);
+		for (uint32_t i = 0; i < packet_count; i++) {
+			packet_dirty[i] = true;
+		}
+	} else {
+		CameraMatrix view_projection = p_cam_projection * CameraMatrix(p_cam_transform.affine_inverse());
+
+		if (camera_changed) {
+			history_samples.clear();
+			for (uint32_t i = 0; i < packet_count; i++) {
+				const RayPacket &packet = camera_rays[i];
+				for (int j = 0; j < TILE_RAYS; j++) {
+					if (camera_ray_masks[i * TILE_RAYS + j] && packet.hit.geomID[j] != RTC_INVALID_GEOMETRY_ID && packet.ray.tfar[j] < ray_far) {
+						Vector3 origin = Vector3(packet.ray.org_x[j], packet.ray.org_y[j], packet.ray.org_z[j]);
+						Vector3 dir = Vector3(packet.ray.dir_x[j], packet.ray.dir_y[j], packet.ray.dir_z[j]);
+						history_samples.push_back({ origin + dir * packet.ray.tfar[j], packet.hit.geomID[j], packet.hit.primID[j] });
+					}
+				}
+			}
+
+			update_camera_rays(p_cam_transform, p_cam_projection, p_cam_orthogonal);
+			_reproject_history(view_projection, p_scenario);
+		}
+
+		// Raycast again wherever an occluder changed since the last update.
+		Size2i buffer_size = sizes[0];
+
+		for (uint32_t i = 0; i < p_scenario.changed_bounds.size(); i++) {
+			if (p_scenario.changed_bounds[i].version <= history_scenario_version) {
+				continue;
+			}
+
+			const AABB &aabb = p_scenario.changed_bounds[i].aabb;
+			Vector2 rect_min = Vector2(FLT_MAX, FLT_MAX);
+			Vector2 rect_max = Vector2(-FLT_MAX, -FLT_MAX);
+			bool behind = false;
+
+			for (int j = 0; j < 8; j++) {
+				Plane clip = view_projection.xform4(Plane(aabb.get_endpoint(j), 1.0));
+				if (clip.d <= 0.0) {
+					behind = true;
+					break;
+				}
+				Vector2 ndc = Vector2(clip.normal.x, clip.normal.y) / clip.d;
+				rect_min = rect_min.min(ndc);
+				rect_max = rect_max.max(ndc);
+			}
+
+			if (behind) {
+				_mark_packets_dirty(Rect2i(Point2i(), buffer_size));
+				break;
+			}
+
+			Point2i from = Point2i(Math::floor((rect_min.x * 0.5 + 0.5) * (buffer_size.x - 1)), Math::floor((rect_min.y * 0.5 + 0.5) * (buffer_size.y - 1)));
+			Point2i to = Point2i(Math::ceil((rect_max.x * 0.5 + 0.5) * (buffer_size.x - 1)), Math::ceil((rect_max.y * 0.5 + 0.5) * (buffer_size.y - 1)));
+			_mark_packets_dirty(Rect2i(from, to - from + Point2i(1, 1)).grow(1));
+		}
+
+		// Refresh some of the reprojected packets.
+		uint32_t refresh_count = MAX(1u, packet_count / REPROJECTION_REFRESH_DIVISOR);
+		for (uint32_t i = 0; i < packet_count && refresh_count > 0; i++) {
+			uint32_t packet = (refresh_offset + i) % packet_count;
+			if (packet_reprojected[packet] && !packet_dirty[packet]) {
+				packet_dirty[packet] = true;
+				refresh_count--;
+			}
+			if (refresh_count == 0) {
+				refresh_offset = (packet + 1) % packet_count;
+			}
+		}
+	}
+
+	dirty_packets.clear();
+	for (uint32_t i = 0; i < packet_count; i++) {
+		if (!packet_dirty[i]) {
+			continue;
+		}
+
+		RayPacket &packet = camera_rays[i];
+		for (int j = 0; j < TILE_RAYS; j++) {
+			packet.ray.tfar[j] = ray_far;
+			packet.hit.geomID[j] = RTC_INVALID_GEOMETRY_ID;
+		}
+		packet_reprojected[i] = false;
+		dirty_packets.push_back(i);
+	}
 
-	p_thread_work_pool.do_work(td.thread_count, this, &RaycastHZBuffer::_camera_rays_threaded, &td);
+	history_valid = true;
+	history_cam_transform = p_cam_transform;
+	history_cam_projection = p_cam_projection;
+	history_cam_orthogonal = p_cam_orthogonal;
+	history_scenario_version = p_scenario.version;
+
+	return camera_changed || !dirty_packets.is_empty();
 }
 
 void RaycastOcclusionCull::RaycastHZBuffer::_camera_rays_threaded(uint32_t p_thread, RaycastOcclusionCull::RaycastHZBuffer::CameraRayThreadData *p_data) {
@@ -267,6 +508,7 @@ void RaycastOcclusionCull::scenario_set_instance(RID p_scenario, RID p_instance,
 
 	if (instance.enabled != p_enabled) {
 		instance.enabled = p_enabled;
+		scenario._add_changed_bounds(instance);
 		scenario.dirty = true; // The scenario needs a scene re-build, but the instance doesn't need update
 	}
 
@@ -296,11 +538,22 @@ void RaycastOcclusionCull::scenario_remove_instance(RID p_scenario, RID p_instan
 	}
 }
 
+void RaycastOcclusionCull::scenario_wait_for_commit(RID p_scenario) {
+	ERR_FAIL_COND(!scenarios.has(p_scenario));
+	scenarios[p_scenario].wait_for_commit();
+}
+
+void RaycastOcclusionCull::Scenario::_add_changed_bounds(const OccluderInstance &p_instance) {
+	if (!p_instance.xformed_vertices.is_empty()) {
+		pending_bounds.push_back(p_instance.xformed_aabb);
+	}
+}
+
 void RaycastOcclusionCull::Scenario::_update_dirty_instance_thread(int p_idx, RID *p_instances) {
-	_update_dirty_instance(p_idx, p_instances, nullptr);
+	_update_dirty_instance(p_idx, p_instances, false);
 }
 
-void RaycastOcclusionCull::Scenario::_update_dirty_instance(int p_idx, RID *p_instances, ThreadWorkPool *p_thread_pool) {
+void RaycastOcclusionCull::Scenario::_update_dirty_instance(int p_idx, RID *p_instances, bool p_use_threads) {
 	OccluderInstance *occ_inst = instances.getptr(p_instances[p_idx]);
 
 	if (!occ_inst) {
@@ -321,20 +574,29 @@ void RaycastOcclusionCull::Scenario::_update_dirty_instance(int p_idx, RID *p_in
 	const Vector3 *read_ptr = occ->vertices.ptr();
 	Vector3 *write_ptr = occ_inst->xformed_vertices.ptr();
 
-	if (p_thread_pool && vertices_size > 1024) {
+	if (p_use_threads && vertices_size > 1024) {
 		TransformThreadData td;
 		td.xform = occ_inst->xform;
 		td.read = read_ptr;
 		td.write = write_ptr;
 		td.vertex_count = vertices_size;
-		td.thread_count = p_thread_pool->get_thread_count();
-		p_thread_pool->do_work(td.thread_count, this, &Scenario::_transform_vertices_thread, &td);
+		td.thread_count = WorkerThreadPool::get_singleton()->get_thread_count();
+		WorkerThreadPool::get_singleton()->do_work(td.thread_count, this, &Scenario::_transform_vertices_thread, &td);
 	} else {
 		_transform_vertices_range(read_ptr, write_ptr, occ_inst->xform, 0, vertices_size);
 	}
 
 	occ_inst->indices.resize(occ->indices.size());
 	memcpy(occ_inst->indices.ptr(), occ->indices.ptr(), occ->indices.size() * sizeof(int32_t));
+
+	occ_inst->xformed_aabb = AABB();
+	for (int i = 0; i < vertices_size; i++) {
+		if (i == 0) {
+			occ_inst->xformed_aabb.position = write_ptr[i];
+		} else {
+			occ_inst->xformed_aabb.expand_to(write_ptr[i]);
+		}
+	}
 }
 
 void RaycastOcclusionCull::Scenario::_transform_vertices_thread(uint32_t p_thread, TransformThreadData *p_data) {
@@ -358,7 +620,34 @@ void RaycastOcclusionCull::Scenario::_commit_scene(void *p_ud) {
 	scenario->commit_done = true;
 }
 
-bool RaycastOcclusionCull::Scenario::update(ThreadWorkPool &p_thread_pool) {
+void RaycastOcclusionCull::Scenario::_finish_commit() {
+	commit_thread->wait_to_finish();
+	current_scene_idx = 1 - current_scene_idx;
+
+	version++;
+	if (committing_bounds.size() > MAX_CHANGED_BOUNDS) {
+		forgotten_version = version;
+		changed_bounds.clear();
+	} else {
+		for (uint32_t i = 0; i < committing_bounds.size(); i++) {
+			changed_bounds.push_back({ version, committing_bounds[i] });
+		}
+		while (changed_bounds.size() > MAX_CHANGED_BOUNDS) {
+			forgotten_version = changed_bounds[0].version;
+			uint32_t forgotten_count = 0;
+			while (forgotten_count < changed_bounds.size() && changed_bounds[forgotten_count].version == forgotten_version) {
+				forgotten_count++;
+			}
+			for (uint32_t i = forgotten_count; i < changed_bounds.size(); i++) {
+				changed_bounds[i - forgotten_count] = changed_bounds[i];
+			}
+			changed_bounds.resize(changed_bounds.size() - forgotten_count);
+		}
+	}
+	committing_bounds.clear();
+}
+
+bool RaycastOcclusionCull::Scenario::update() {
 	ERR_FAIL_COND_V(singleton == nullptr, false);
 
 	if (commit_thread == nullptr) {
@@ -367,8 +656,7 @@ bool RaycastOcclusionCull::Scenario::update(ThreadWorkPool &p_thread_pool) {
 
 	if (commit_thread->is_started()) {
 		if (commit_done) {
-			commit_thread->wait_to_finish();
-			current_scene_idx = 1 - current_scene_idx;
+			_finish_commit();
 		} else {
 			return false;
 		}
@@ -389,16 +677,31 @@ bool RaycastOcclusionCull::Scenario::update(ThreadWorkPool &p_thread_pool) {
 	}
 
 	for (unsigned int i = 0; i < removed_instances.size(); i++) {
+		_add_changed_bounds(instances[removed_instances[i]]);
 		instances.erase(removed_instances[i]);
 	}
 
-	if (dirty_instances_array.size() / p_thread_pool.get_thread_count() > 128) {
+	for (unsigned int i = 0; i < dirty_instances_array.size(); i++) {
+		const OccluderInstance *occ_inst = instances.getptr(dirty_instances_array[i]);
+		if (occ_inst) {
+			_add_changed_bounds(*occ_inst);
+		}
+	}
+
+	if (dirty_instances_array.size() / WorkerThreadPool::get_singleton()->get_thread_count() > 128) {
 		// Lots of instances, use per-instance threading
-		p_thread_pool.do_work(dirty_instances_array.size(), this, &Scenario::_update_dirty_instance_thread, dirty_instances_array.ptr());
+		WorkerThreadPool::get_singleton()->do_work(dirty_instances_array.size(), this, &Scenario::_update_dirty_instance_thread, dirty_instances_array.ptr());
 	} else {
 		// Few instances, use threading on the vertex transforms
 		for (unsigned int i = 0; i < dirty_instances_array.size(); i++) {
-			_update_dirty_instance(i, dirty_instances_array.ptr(), &p_thread_pool);
+			_update_dirty_instance(i, dirty_instances_array.ptr(), true);
+		}
+	}
+
+	for (unsigned int i = 0; i < dirty_instances_array.size(); i++) {
+		const OccluderInstance *occ_inst = instances.getptr(dirty_instances_array[i]);
+		if (occ_inst) {
+			_add_changed_bounds(*occ_inst);
 		}
 	}
 
@@ -406,6 +709,9 @@ bool RaycastOcclusionCull::Scenario::update(ThreadWorkPool &p_thread_pool) {
 	dirty_instances_array.clear();
 	removed_instances.clear();
 
+	committing_bounds = pending_bounds;
+	pending_bounds.clear();
+
 	if (raycast_singleton->ebr_device == nullptr) {
 		raycast_singleton->_init_embree();
 	}
@@ -419,6 +725,7 @@ bool RaycastOcclusionCull::Scenario::update(ThreadWorkPool &p_thread_pool) {
 
 	next_scene = rtcNewScene(raycast_singleton->ebr_device);
 	rtcSetSceneBuildQuality(next_scene, RTCBuildQuality(raycast_singleton->build_quality));
+	ebr_triangle_counts[next_scene_idx].clear();
 
 	const RID *inst_rid = nullptr;
 	while ((inst_rid = instances.next(inst_rid))) {
@@ -433,8 +740,13 @@ bool RaycastOcclusionCull::Scenario::update(ThreadWorkPool &p_thread_pool) {
 		rtcSetSharedGeometryBuffer(geom, RTC_BUFFER_TYPE_VERTEX, 0, RTC_FORMAT_FLOAT3, occ_inst->xformed_vertices.ptr(), 0, sizeof(Vector3), occ_inst->xformed_vertices.size());
 		rtcSetSharedGeometryBuffer(geom, RTC_BUFFER_TYPE_INDEX, 0, RTC_FORMAT_UINT3, occ_inst->indices.ptr(), 0, sizeof(uint32_t) * 3, occ_inst->indices.size() / 3);
 		rtcCommitGeometry(geom);
-		rtcAttachGeometry(next_scene, geom);
+		uint32_t geom_id = rtcAttachGeometry(next_scene, geom);
 		rtcReleaseGeometry(geom);
+
+		if (ebr_triangle_counts[next_scene_idx].size() <= geom_id) {
+			ebr_triangle_counts[next_scene_idx].resize(geom_id + 1);
+		}
+		ebr_triangle_counts[next_scene_idx][geom_id] = occ_inst->indices.size() / 3;
 	}
 
 	dirty = false;
@@ -443,15 +755,51 @@ bool RaycastOcclusionCull::Scenario::update(ThreadWorkPool &p_thread_pool) {
 	return false;
 }
 
+void RaycastOcclusionCull::Scenario::wait_for_commit() {
+	if (commit_thread && commit_thread->is_started()) {
+		_finish_commit();
+	}
+}
+
 void RaycastOcclusionCull::Scenario::_raycast(uint32_t p_idx, const RaycastThreadData *p_raycast_data) const {
 	RTCIntersectContext ctx;
 	rtcInitIntersectContext(&ctx);
 	ctx.flags = RTC_INTERSECT_CONTEXT_FLAG_COHERENT;
 
-	rtcIntersect16((const int *)&p_raycast_data->masks[p_idx * TILE_RAYS], ebr_scene[current_scene_idx], &ctx, &p_raycast_data->rays[p_idx]);
+	uint32_t packet_idx = p_raycast_data->packets[p_idx];
+	RayPacket &packet = p_raycast_data->rays[packet_idx];
+	const uint32_t *masks = &p_raycast_data->masks[packet_idx * TILE_RAYS];
+
+	// Embree is built without ray packet support, so rtcIntersect16() would trace the rays one by one anyway,
+	// but without writing back which triangle they hit. Reprojection needs those.
+	for (int i = 0; i < TILE_RAYS; i++) {
+		if (!masks[i]) {
+			continue;
+		}
+
+		RTCRayHit ray_hit;
+		ray_hit.ray.org_x = packet.ray.org_x[i];
+		ray_hit.ray.org_y = packet.ray.org_y[i];
+		ray_hit.ray.org_z = packet.ray.org_z[i];
+		ray_hit.ray.dir_x = packet.ray.dir_x[i];
+		ray_hit.ray.dir_y = packet.ray.dir_y[i];
+		ray_hit.ray.dir_z = packet.ray.dir_z[i];
+		ray_hit.ray.tnear = packet.ray.tnear[i];
+		ray_hit.ray.tfar = packet.ray.tfar[i];
+		ray_hit.ray.time = packet.ray.time[i];
+		ray_hit.ray.mask = packet.ray.mask[i];
+		ray_hit.ray.flags = packet.ray.flags[i];
+		ray_hit.hit.geomID = RTC_INVALID_GEOMETRY_ID;
+
+		rtcIntersect1(ebr_scene[current_scene_idx], &ctx, &ray_hit);
+
+		packet.ray.tfar[i] = ray_hit.ray.tfar;
+		packet.hit.geomID[i] = ray_hit.hit.geomID;
+		packet.hit.primID[i] = ray_hit.hit.primID;
+	}
 }
 
-void RaycastOcclusionCull::Scenario::raycast(LocalVector<RayPacket> &r_rays, const LocalVector<uint32_t> p_valid_masks, ThreadWorkPool &p_thread_pool) const {
+void RaycastOcclusionCull::Scenario::raycast(LocalVector<RayPacket> &r_rays, const LocalVector<uint32_t> &p_valid_masks, const LocalVector<uint32_t> &p_packets) const {
 	ERR_FAIL_COND(singleton == nullptr);
 	if (raycast_singleton->ebr_device == nullptr) {
 		return; // Embree is initialized on demand when there is some scenario with occluders in it.
@@ -464,8 +812,31 @@ void RaycastOcclusionCull::Scenario::raycast(LocalVector<RayPacket> &r_rays, con
 	RaycastThreadData td;
 	td.rays = r_rays.ptr();
 	td.masks = p_valid_masks.ptr();
+	td.packets = p_packets.ptr();
+
+	WorkerThreadPool::get_singleton()->do_work(p_packets.size(), this, &Scenario::_raycast, &td);
+}
+
+bool RaycastOcclusionCull::Scenario::intersect_triangle(uint32_t p_geom_id, uint32_t p_prim_id, const Vector3 &p_from, const Vector3 &p_dir, float &r_distance) const {
+	// IDs come from hits in older scenes too, in which case they may be some other triangle now. That's
+	// fine, any triangle of the current scene is something rays can't see past.
+	const LocalVector<uint32_t> &triangle_counts = ebr_triangle_counts[current_scene_idx];
+	if (ebr_scene[current_scene_idx] == nullptr || p_geom_id >= triangle_counts.size() || p_prim_id >= triangle_counts[p_geom_id]) {
+		return false;
+	}
+
+	RTCGeometry geom = rtcGetGeometry(ebr_scene[current_scene_idx], p_geom_id);
+	const Vector3 *vertices = (const Vector3 *)rtcGetGeometryBufferData(geom, RTC_BUFFER_TYPE_VERTEX, 0);
+	const uint32_t *indices = (const uint32_t *)rtcGetGeometryBufferData(geom, RTC_BUFFER_TYPE_INDEX, 0);
+	const uint32_t *triangle = &indices[p_prim_id * 3];
+
+	Vector3 hit;
+	if (!Geometry3D::ray_intersects_triangle(p_from, p_dir, vertices[triangle[0]], vertices[triangle[1]], vertices[triangle[2]], &hit)) {
+		return false;
+	}
 
-	p_thread_pool.do_work(r_rays.size(), this, &Scenario::_raycast, &td);
+	r_distance = (hit - p_from).dot(p_dir);
+	return true;
 }
 
 ////////////////////////////////////////////////////////
@@ -483,7 +854,10 @@ void RaycastOcclusionCull::remove_buffer(RID p_buffer) {
 void RaycastOcclusionCull::buffer_set_scenario(RID p_buffer, RID p_scenario) {
 	ERR_FAIL_COND(!buffers.has(p_buffer));
 	ERR_FAIL_COND(p_scenario.is_valid() && !scenarios.has(p_scenario));
-	buffers[p_buffer].scenario_rid = p_scenario;
+	if (buffers[p_buffer].scenario_rid != p_scenario) {
+		buffers[p_buffer].scenario_rid = p_scenario;
+		buffers[p_buffer].invalidate_history();
+	}
 }
 
 void RaycastOcclusionCull::buffer_set_size(RID p_buffer, const Vector2i &p_size) {
@@ -491,7 +865,7 @@ void RaycastOcclusionCull::buffer_set_size(RID p_buffer, const Vector2i &p_size)
 	buffers[p_buffer].resize(p_size);
 }
 
-void RaycastOcclusionCull::buffer_update(RID p_buffer, const Transform3D &p_cam_transform, const CameraMatrix &p_cam_projection, bool p_cam_orthogonal, ThreadWorkPool &p_thread_pool) {
+void RaycastOcclusionCull::buffer_update(RID p_buffer, const Transform3D &p_cam_transform, const CameraMatrix &p_cam_projection, bool p_cam_orthogonal) {
 	if (!buffers.has(p_buffer)) {
 		return;
 	}
@@ -504,16 +878,18 @@ void RaycastOcclusionCull::buffer_update(RID p_buffer, const Transform3D &p_cam_
 
 	Scenario &scenario = scenarios[buffer.scenario_rid];
 
-	bool removed = scenario.update(p_thread_pool);
+	bool removed = scenario.update();
 
 	if (removed) {
 		scenarios.erase(buffer.scenario_rid);
 		return;
 	}
 
-	buffer.update_camera_rays(p_cam_transform, p_cam_projection, p_cam_orthogonal, p_thread_pool);
+	if (!buffer.update_dirty_packets(p_cam_transform, p_cam_projection, p_cam_orthogonal, scenario)) {
+		return; // Nothing changed since the last update.
+	}
 
-	scenario.raycast(buffer.camera_rays, buffer.camera_ray_masks, p_thread_pool);
+	scenario.raycast(buffer.camera_rays, buffer.camera_ray_masks, buffer.dirty_packets);
 	buffer.sort_rays();
 	buffer.update_mips();
 }
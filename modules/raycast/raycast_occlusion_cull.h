@@ -45,6 +45,8 @@
 class RaycastOcclusionCull : public RendererSceneOcclusionCull {
 	typedef RTCRayHit16 RayPacket;
 
+	struct Scenario;
+
 public:
 	class RaycastHZBuffer : public HZBuffer {
 	private:
@@ -61,15 +63,46 @@ public:
 		void _camera_rays_threaded(uint32_t p_thread, CameraRayThreadData *p_data);
 		void _generate_camera_rays(const Transform3D &p_cam_transform, const CameraMatrix &p_cam_projection, bool p_cam_orthogonal, int p_from, int p_to);
 
+		// What the rays of the previous update saw, so packets that didn't change aren't raycast again.
+		bool history_valid = false;
+		Transform3D history_cam_transform;
+		CameraMatrix history_cam_projection;
+		bool history_cam_orthogonal = false;
+		uint64_t history_scenario_version = 0;
+		float ray_far = 0.0f;
+
+		// A previous hit, with the occluder triangle it landed on.
+		struct HistorySample {
+			Vector3 point;
+			uint32_t geom_id;
+			uint32_t prim_id;
+		};
+
+		LocalVector<HistorySample> history_samples;
+		LocalVector<float> reprojected_depths;
+		LocalVector<uint32_t> reprojected_samples; // Closest history sample landing on each ray
+		// Packets holding reprojected depths instead of raycast ones, refreshed a few at a time.
+		LocalVector<bool> packet_reprojected;
+		LocalVector<bool> packet_dirty;
+		uint32_t refresh_offset = 0;
+
+		void _mark_packets_dirty(const Rect2i &p_rect);
+		void _reproject_history(const CameraMatrix &p_view_projection, const Scenario &p_scenario);
+
 	public:
 		LocalVector<RayPacket> camera_rays;
 		LocalVector<uint32_t> camera_ray_masks;
+		LocalVector<uint32_t> dirty_packets;
 		RID scenario_rid;
 
 		virtual void clear() override;
 		virtual void resize(const Size2i &p_size) override;
 		void sort_rays();
-		void update_camera_rays(const Transform3D &p_cam_transform, const CameraMatrix &p_cam_projection, bool p_cam_orthogonal, ThreadWorkPool &p_thread_work_pool);
+		void update_camera_rays(const Transform3D &p_cam_transform, const CameraMatrix &p_cam_projection, bool p_cam_orthogonal);
+		void invalidate_history() { history_valid = false; }
+		// Fills dirty_packets with the ray packets that need to be raycast for this camera. Returns
+		// false when the depth from the previous update can be used as is.
+		bool update_dirty_packets(const Transform3D &p_cam_transform, const CameraMatrix &p_cam_projection, bool p_cam_orthogonal, const Scenario &p_scenario);
 	};
 
 private:
@@ -99,6 +132,7 @@ private:
 		RID occluder;
 		LocalVector<uint32_t> indices;
 		LocalVector<Vector3> xformed_vertices;
+		AABB xformed_aabb;
 		Transform3D xform;
 		bool enabled = true;
 		bool removed = false;
@@ -108,6 +142,13 @@ private:
 		struct RaycastThreadData {
 			RayPacket *rays;
 			const uint32_t *masks;
+			const uint32_t *packets;
+		};
+
+		// Bounds of occluders that changed in the committed scene of a given version.
+		struct ChangedBounds {
+			uint64_t version;
+			AABB aabb;
 		};
 
 		struct TransformThreadData {
@@ -124,6 +165,7 @@ private:
 		bool removed = false;
 
 		RTCScene ebr_scene[2] = { nullptr, nullptr };
+		LocalVector<uint32_t> ebr_triangle_counts[2]; // Per geometry ID
 		int current_scene_idx = 0;
 
 		HashMap<RID, OccluderInstance> instances;
@@ -131,15 +173,29 @@ private:
 		LocalVector<RID> dirty_instances_array; // To iterate and split into threads
 		LocalVector<RID> removed_instances;
 
+		// Incremented every time a committed scene replaces the current one. Buffers only raycast again the
+		// parts of the screen covered by the bounds that changed since the version they last saw.
+		uint64_t version = 1;
+		uint64_t forgotten_version = 0; // Buffers older than this can't know what changed
+		LocalVector<AABB> pending_bounds; // Not in any scene yet
+		LocalVector<AABB> committing_bounds; // In the scene being committed
+		LocalVector<ChangedBounds> changed_bounds;
+
+		void _add_changed_bounds(const OccluderInstance &p_instance);
+
 		void _update_dirty_instance_thread(int p_idx, RID *p_instances);
-		void _update_dirty_instance(int p_idx, RID *p_instances, ThreadWorkPool *p_thread_pool);
+		void _update_dirty_instance(int p_idx, RID *p_instances, bool p_use_threads);
 		void _transform_vertices_thread(uint32_t p_thread, TransformThreadData *p_data);
 		void _transform_vertices_range(const Vector3 *p_read, Vector3 *p_write, const Transform3D &p_xform, int p_from, int p_to);
 		static void _commit_scene(void *p_ud);
-		bool update(ThreadWorkPool &p_thread_pool);
+		void _finish_commit();
+		bool update();
+		void wait_for_commit();
 
 		void _raycast(uint32_t p_thread, const RaycastThreadData *p_raycast_data) const;
-		void raycast(LocalVector<RayPacket> &r_rays, const LocalVector<uint32_t> p_valid_masks, ThreadWorkPool &p_thread_pool) const;
+		void raycast(LocalVector<RayPacket> &r_rays, const LocalVector<uint32_t> &p_valid_masks, const LocalVector<uint32_t> &p_packets) const;
+		// Intersects a single triangle of the current scene, as identified by a previous hit.
+		bool intersect_triangle(uint32_t p_geom_id, uint32_t p_prim_id, const Vector3 &p_from, const Vector3 &p_dir, float &r_distance) const;
 	};
 
 	static RaycastOcclusionCull *raycast_singleton;
@@ -147,6 +203,12 @@ private:
 	static const int TILE_SIZE = 4;
 	static const int TILE_RAYS = TILE_SIZE * TILE_SIZE;
 
+	// Past this many changed occluders per commit, buffers raycast everything again.
+	static const uint32_t MAX_CHANGED_BOUNDS = 256;
+	// Fraction of the reprojected packets raycast again each update, since reprojected depths can be farther
+	// than the real ones.
+	static const uint32_t REPROJECTION_REFRESH_DIVISOR = 8;
+
 	RTCDevice ebr_device = nullptr;
 	RID_PtrOwner<Occluder> occluder_owner;
 	HashMap<RID, Scenario> scenarios;
@@ -166,13 +228,15 @@ public:
 	virtual void remove_scenario(RID p_scenario) override;
 	virtual void scenario_set_instance(RID p_scenario, RID p_instance, RID p_occluder, const Transform3D &p_xform, bool p_enabled) override;
 	virtual void scenario_remove_instance(RID p_scenario, RID p_instance) override;
+	// Blocks until the scene being committed on a thread, if any, is the one rays are cast against.
+	void scenario_wait_for_commit(RID p_scenario);
 
 	virtual void add_buffer(RID p_buffer) override;
 	virtual void remove_buffer(RID p_buffer) override;
 	virtual HZBuffer *buffer_get_ptr(RID p_buffer) override;
 	virtual void buffer_set_scenario(RID p_buffer, RID p_scenario) override;
 	virtual void buffer_set_size(RID p_buffer, const Vector2i &p_size) override;
-	virtual void buffer_update(RID p_buffer, const Transform3D &p_cam_transform, const CameraMatrix &p_cam_projection, bool p_cam_orthogonal, ThreadWorkPool &p_thread_pool) override;
+	virtual void buffer_update(RID p_buffer, const Transform3D &p_cam_transform, const CameraMatrix &p_cam_projection, bool p_cam_orthogonal) override;
 	virtual RID buffer_get_debug_texture(RID p_buffer) override;
 
 	virtual void set_build_quality(RS::ViewportOcclusionCullingBuildQuality p_quality) override;
@@ -0,0 +1,158 @@
+/*************************************************************************/
+/*  test_raycast_occlusion_cull.h                                        */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2021 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2021 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef TEST_RAYCAST_OCCLUSION_CULL_H
+#define TEST_RAYCAST_OCCLUSION_CULL_H
+
+#include "core/config/project_settings.h"
+#include "modules/raycast/raycast_occlusion_cull.h"
+
+#include "tests/test_macros.h"
+
+namespace TestRaycastOcclusionCull {
+
+static bool is_box_occluded(const RendererSceneOcclusionCull::HZBuffer *p_buffer, const AABB &p_aabb, const Transform3D &p_cam_transform, const CameraMatrix &p_cam_projection) {
+	real_t bounds[6] = {
+		p_aabb.position.x, p_aabb.position.y, p_aabb.position.z,
+		p_aabb.position.x + p_aabb.size.x, p_aabb.position.y + p_aabb.size.y, p_aabb.position.z + p_aabb.size.z
+	};
+	return p_buffer->is_occluded(bounds, p_cam_transform.origin, p_cam_transform.affine_inverse(), p_cam_projection, p_cam_projection.get_z_near());
+}
+
+TEST_CASE("[RaycastOcclusionCull] Reprojected buffers don't occlude more than full updates") {
+	GLOBAL_DEF("rendering/occlusion_culling/bvh_build_quality", 2);
+	RaycastOcclusionCull occlusion_cull;
+
+	// A 1x1 quad facing +Z, scaled into walls and a floor.
+	PackedVector3Array vertices;
+	vertices.push_back(Vector3(0, 0, 0));
+	vertices.push_back(Vector3(1, 0, 0));
+	vertices.push_back(Vector3(1, 1, 0));
+	vertices.push_back(Vector3(0, 1, 0));
+	PackedInt32Array indices;
+	indices.push_back(0);
+	indices.push_back(1);
+	indices.push_back(2);
+	indices.push_back(0);
+	indices.push_back(2);
+	indices.push_back(3);
+
+	RID occluder = occlusion_cull.occluder_allocate();
+	occlusion_cull.occluder_initialize(occluder);
+	occlusion_cull.occluder_set_mesh(occluder, vertices, indices);
+
+	RID scenario = RID::from_uint64(1);
+	occlusion_cull.add_scenario(scenario);
+
+	// A row of panels with thin gaps between them, which the rays can easily miss. Boxes behind the
+	// gaps are visible, but only a ray going right through one can tell.
+	uint64_t instance_id = 100;
+	for (int i = 0; i < 40; i++) {
+		occlusion_cull.scenario_set_instance(scenario, RID::from_uint64(instance_id++), occluder, Transform3D(Basis().scaled(Vector3(0.98, 8, 1)), Vector3(-20 + i, -1, -20)), true);
+	}
+	// Background and floor, so rays hit something everywhere.
+	occlusion_cull.scenario_set_instance(scenario, RID::from_uint64(instance_id++), occluder, Transform3D(Basis().scaled(Vector3(400, 200, 1)), Vector3(-200, -100, -80)), true);
+	occlusion_cull.scenario_set_instance(scenario, RID::from_uint64(instance_id++), occluder, Transform3D(Basis(Vector3(1, 0, 0), -Math_PI / 2).scaled(Vector3(400, 1, 400)), Vector3(-200, -1, 10)), true);
+
+	RID reprojected = RID::from_uint64(2);
+	RID full = RID::from_uint64(3);
+	occlusion_cull.add_buffer(reprojected);
+	occlusion_cull.buffer_set_scenario(reprojected, scenario);
+	occlusion_cull.buffer_set_size(reprojected, Size2i(64, 36));
+	occlusion_cull.add_buffer(full);
+	occlusion_cull.buffer_set_scenario(full, scenario);
+	occlusion_cull.buffer_set_size(full, Size2i(64, 36));
+
+	RaycastOcclusionCull::RaycastHZBuffer *reprojected_hz = static_cast<RaycastOcclusionCull::RaycastHZBuffer *>(occlusion_cull.buffer_get_ptr(reprojected));
+	RaycastOcclusionCull::RaycastHZBuffer *full_hz = static_cast<RaycastOcclusionCull::RaycastHZBuffer *>(occlusion_cull.buffer_get_ptr(full));
+
+	auto check_camera_path = [&](const CameraMatrix &p_projection, bool p_orthogonal) {
+		// The first update starts committing the scene on a thread, wait until the rays see it.
+		Transform3D camera;
+		AABB probe = AABB(Vector3(0.2, 1, -40), Vector3(0.5, 0.5, 0.5));
+		occlusion_cull.buffer_update(full, camera, p_projection, p_orthogonal);
+		occlusion_cull.scenario_wait_for_commit(scenario);
+		full_hz->invalidate_history();
+		occlusion_cull.buffer_update(full, camera, p_projection, p_orthogonal);
+		REQUIRE(is_box_occluded(full_hz, probe, camera, p_projection));
+
+		int occluded = 0;
+		int extra_occluded = 0;
+		int reprojected_rays = 0;
+		int full_rays = 0;
+
+		for (int frame = 0; frame < 60; frame++) {
+			// Strafe and turn, so the gaps sweep across the rays.
+			camera = Transform3D(Basis(Vector3(0, 1, 0), Math::sin(frame * 0.1) * 0.05), Vector3(frame * 0.037 - 1, 1 + frame * 0.01, -frame * 0.05));
+
+			occlusion_cull.buffer_update(reprojected, camera, p_projection, p_orthogonal);
+			full_hz->invalidate_history();
+			occlusion_cull.buffer_update(full, camera, p_projection, p_orthogonal);
+			reprojected_rays += reprojected_hz->dirty_packets.size();
+			full_rays += full_hz->dirty_packets.size();
+
+			for (int y = 0; y < 6; y++) {
+				for (int x = -60; x < 60; x++) {
+					AABB box = AABB(Vector3(x * 0.25, y, -40), Vector3(0.1, 0.1, 0.1));
+					bool full_occluded = is_box_occluded(full_hz, box, camera, p_projection);
+					if (is_box_occluded(reprojected_hz, box, camera, p_projection)) {
+						occluded++;
+						extra_occluded += !full_occluded;
+					}
+				}
+			}
+		}
+
+		CHECK_MESSAGE(extra_occluded == 0, "Reprojection should only ever occlude less than raycasting everything.");
+		CHECK_MESSAGE(occluded > 0, "The boxes behind the panels should mostly be occluded.");
+		CHECK_MESSAGE(reprojected_rays < full_rays / 2, "Most packets should be reprojected instead of raycast.");
+	};
+
+	SUBCASE("Perspective") {
+		CameraMatrix projection;
+		projection.set_perspective(70, 16.0 / 9.0, 0.05, 200);
+		check_camera_path(projection, false);
+	}
+
+	SUBCASE("Orthogonal") {
+		CameraMatrix projection;
+		projection.set_orthogonal(30, 16.0 / 9.0, 0.05, 200, false);
+		check_camera_path(projection, true);
+	}
+
+	occlusion_cull.remove_buffer(reprojected);
+	occlusion_cull.remove_buffer(full);
+	occlusion_cull.remove_scenario(scenario);
+	occlusion_cull.free_occluder(occluder);
+}
+
+} // namespace TestRaycastOcclusionCull
+
+#endif // TEST_RAYCAST_OCCLUSION_CULL_H
@@ -2876,6 +2876,10 @@ int Viewport::get_render_info(RenderInfoType p_type, RenderInfo p_info) {
 	return RS::get_singleton()->viewport_get_render_info(viewport, RS::ViewportRenderInfoType(p_type), RS::ViewportRenderInfo(p_info));
 }
 
+int Viewport::get_render_lod_info(RenderInfoType p_type, int p_lod, RenderLODInfo p_info) {
+	return RS::get_singleton()->viewport_get_render_lod_info(viewport, RS::ViewportRenderInfoType(p_type), p_lod, RS::ViewportRenderLODInfo(p_info));
+}
+
 void Viewport::set_snap_controls_to_pixels(bool p_enable) {
 	snap_controls_to_pixels = p_enable;
 }
@@ -3501,6 +3505,7 @@ void Viewport::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("get_debug_draw"), &Viewport::get_debug_draw);
 
 	ClassDB::bind_method(D_METHOD("get_render_info", "type", "info"), &Viewport::get_render_info);
+	ClassDB::bind_method(D_METHOD("get_render_lod_info", "type", "lod", "info"), &Viewport::get_render_lod_info);
 
 	ClassDB::bind_method(D_METHOD("get_texture"), &Viewport::get_texture);
 
@@ -3657,12 +3662,17 @@ void Viewport::_bind_methods() {
 	BIND_ENUM_CONSTANT(RENDER_INFO_OBJECTS_IN_FRAME);
 	BIND_ENUM_CONSTANT(RENDER_INFO_PRIMITIVES_IN_FRAME);
 	BIND_ENUM_CONSTANT(RENDER_INFO_DRAW_CALLS_IN_FRAME);
+	BIND_ENUM_CONSTANT(RENDER_INFO_MERGED_DRAW_CALLS_IN_FRAME);
 	BIND_ENUM_CONSTANT(RENDER_INFO_MAX);
 
 	BIND_ENUM_CONSTANT(RENDER_INFO_TYPE_VISIBLE);
 	BIND_ENUM_CONSTANT(RENDER_INFO_TYPE_SHADOW);
 	BIND_ENUM_CONSTANT(RENDER_INFO_TYPE_MAX);
 
+	BIND_ENUM_CONSTANT(RENDER_LOD_INFO_OBJECTS_IN_FRAME);
+	BIND_ENUM_CONSTANT(RENDER_LOD_INFO_PRIMITIVES_IN_FRAME);
+	BIND_ENUM_CONSTANT(RENDER_LOD_INFO_MAX);
+
 	BIND_ENUM_CONSTANT(DEBUG_DRAW_DISABLED);
 	BIND_ENUM_CONSTANT(DEBUG_DRAW_UNSHADED);
 	BIND_ENUM_CONSTANT(DEBUG_DRAW_LIGHTING);
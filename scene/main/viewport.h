@@ -119,6 +119,7 @@ public:
 		RENDER_INFO_OBJECTS_IN_FRAME,
 		RENDER_INFO_PRIMITIVES_IN_FRAME,
 		RENDER_INFO_DRAW_CALLS_IN_FRAME,
+		RENDER_INFO_MERGED_DRAW_CALLS_IN_FRAME,
 		RENDER_INFO_MAX
 	};
 
@@ -128,6 +129,12 @@ public:
 		RENDER_INFO_TYPE_MAX
 	};
 
+	enum RenderLODInfo {
+		RENDER_LOD_INFO_OBJECTS_IN_FRAME,
+		RENDER_LOD_INFO_PRIMITIVES_IN_FRAME,
+		RENDER_LOD_INFO_MAX
+	};
+
 	enum DebugDraw {
 		DEBUG_DRAW_DISABLED,
 		DEBUG_DRAW_UNSHADED,
@@ -533,6 +540,7 @@ public:
 	DebugDraw get_debug_draw() const;
 
 	int get_render_info(RenderInfoType p_type, RenderInfo p_info);
+	int get_render_lod_info(RenderInfoType p_type, int p_lod, RenderLODInfo p_info);
 
 	void set_snap_controls_to_pixels(bool p_enable);
 	bool is_snap_controls_to_pixels_enabled() const;
@@ -710,6 +718,7 @@ VARIANT_ENUM_CAST(Viewport::SDFOversize);
 VARIANT_ENUM_CAST(SubViewport::ClearMode);
 VARIANT_ENUM_CAST(Viewport::RenderInfo);
 VARIANT_ENUM_CAST(Viewport::RenderInfoType);
+VARIANT_ENUM_CAST(Viewport::RenderLODInfo);
 VARIANT_ENUM_CAST(Viewport::DefaultCanvasItemTextureFilter);
 VARIANT_ENUM_CAST(Viewport::DefaultCanvasItemTextureRepeat);
 
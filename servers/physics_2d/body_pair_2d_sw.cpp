@@ -34,6 +34,7 @@
 
 #define POSITION_CORRECTION
 #define ACCUMULATE_IMPULSES
+#define MANIFOLD_REUSE_RECYCLE_RATIO 0.5
 
 void BodyPair2DSW::_add_contact(const Vector2 &p_point_A, const Vector2 &p_point_B, void *p_self) {
 	BodyPair2DSW *self = (BodyPair2DSW *)p_self;
@@ -164,6 +165,38 @@ void BodyPair2DSW::_validate_contacts() {
 	}
 }
 
+// Upper bound of the distance any point of a shape moved between two of its transforms.
+static real_t _get_shape_drift(const Transform2D &p_from, const Transform2D &p_to, const Rect2 &p_shape_aabb) {
+	Vector2 begin = p_shape_aabb.position.abs();
+	Vector2 end = (p_shape_aabb.position + p_shape_aabb.size).abs();
+	Vector2 extents = Vector2(MAX(begin.x, end.x), MAX(begin.y, end.y));
+
+	real_t basis_drift_squared = (p_to[0] - p_from[0]).length_squared() + (p_to[1] - p_from[1]).length_squared();
+
+	return p_from[2].distance_to(p_to[2]) + Math::sqrt(basis_drift_squared) * extents.length();
+}
+
+bool BodyPair2DSW::_can_reuse_manifold(const Transform2D &p_xform_A, const Transform2D &p_xform_B) const {
+	if (!collided || oneway_disabled || contact_count == 0) {
+		return false;
+	}
+
+	// Continuous collision detection depends on the motion, not only on the current transforms.
+	if (A->get_continuous_collision_detection_mode() != PhysicsServer2D::CCD_MODE_DISABLED || B->get_continuous_collision_detection_mode() != PhysicsServer2D::CCD_MODE_DISABLED) {
+		return false;
+	}
+
+	if (A->get_shapes_version() != manifold_shapes_version_A || B->get_shapes_version() != manifold_shapes_version_B) {
+		return false;
+	}
+
+	// Until the shapes move by a fraction of the recycle radius, the narrow phase would only find the same contacts again.
+	real_t drift = _get_shape_drift(manifold_xform_A, p_xform_A, A->get_shape(shape_A)->get_aabb());
+	drift += _get_shape_drift(manifold_xform_B, p_xform_B, B->get_shape(shape_B)->get_aabb());
+
+	return drift < space->get_contact_recycle_radius() * MANIFOLD_REUSE_RECYCLE_RATIO;
+}
+
 bool BodyPair2DSW::_test_ccd(real_t p_step, Body2DSW *p_A, int p_shape_A, const Transform2D &p_xform_A, Body2DSW *p_B, int p_shape_B, const Transform2D &p_xform_B, bool p_swap_result) {
 	Vector2 motion = p_A->get_linear_velocity() * p_step;
 	real_t mlen = motion.length();
@@ -247,6 +280,11 @@ bool BodyPair2DSW::setup(real_t p_step) {
 	//use local A coordinates to avoid numerical issues on collision detection
 	offset_B = B->get_transform().get_origin() - A->get_transform().get_origin();
 
+	if (A->get_shapes_version() != manifold_shapes_version_A || B->get_shapes_version() != manifold_shapes_version_B) {
+		// Contacts cached for other shapes may still look valid, but they no longer lie on the surfaces.
+		contact_count = 0;
+	}
+
 	_validate_contacts();
 
 	const Vector2 &offset_A = A->get_transform().get_origin();
@@ -257,9 +295,22 @@ bool BodyPair2DSW::setup(real_t p_step) {
 	xform_Bu.elements[2] -= offset_A;
 	Transform2D xform_B = xform_Bu * B->get_shape_transform(shape_B);
 
+	if (_can_reuse_manifold(xform_A, xform_B)) {
+		// Keep the contacts from being discarded as left behind on the next validation.
+		for (int i = 0; i < contact_count; i++) {
+			contacts[i].reused = true;
+		}
+		return true;
+	}
+
 	Shape2DSW *shape_A_ptr = A->get_shape(shape_A);
 	Shape2DSW *shape_B_ptr = B->get_shape(shape_B);
 
+	manifold_xform_A = xform_A;
+	manifold_xform_B = xform_B;
+	manifold_shapes_version_A = A->get_shapes_version();
+	manifold_shapes_version_B = B->get_shapes_version();
+
 	Vector2 motion_A, motion_B;
 
 	if (A->get_continuous_collision_detection_mode() == PhysicsServer2D::CCD_MODE_CAST_SHAPE) {
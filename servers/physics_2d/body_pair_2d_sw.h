@@ -81,8 +81,15 @@ class BodyPair2DSW : public Constraint2DSW {
 	bool oneway_disabled = false;
 	bool report_contacts_only = false;
 
+	// Shape transforms and versions used by the last narrow phase, the contacts are reused as long as they barely change.
+	Transform2D manifold_xform_A;
+	Transform2D manifold_xform_B;
+	uint64_t manifold_shapes_version_A = 0;
+	uint64_t manifold_shapes_version_B = 0;
+
 	bool _test_ccd(real_t p_step, Body2DSW *p_A, int p_shape_A, const Transform2D &p_xform_A, Body2DSW *p_B, int p_shape_B, const Transform2D &p_xform_B, bool p_swap_result = false);
 	void _validate_contacts();
+	bool _can_reuse_manifold(const Transform2D &p_xform_A, const Transform2D &p_xform_B) const;
 	static void _add_contact(const Vector2 &p_point_A, const Vector2 &p_point_B, void *p_self);
 	_FORCE_INLINE_ void _contact_added_callback(const Vector2 &p_point_A, const Vector2 &p_point_B);
 
@@ -43,6 +43,7 @@ void CollisionObject2DSW::add_shape(Shape2DSW *p_shape, const Transform2D &p_tra
 	s.one_way_collision_margin = 0;
 	shapes.push_back(s);
 	p_shape->add_owner(this);
+	shapes_version++;
 
 	if (!pending_shape_update_list.in_list()) {
 		PhysicsServer2DSW::singletonsw->pending_shape_update_list.add(&pending_shape_update_list);
@@ -53,6 +54,7 @@ void CollisionObject2DSW::set_shape(int p_index, Shape2DSW *p_shape) {
 	ERR_FAIL_INDEX(p_index, shapes.size());
 	shapes[p_index].shape->remove_owner(this);
 	shapes.write[p_index].shape = p_shape;
+	shapes_version++;
 
 	p_shape->add_owner(this);
 
@@ -71,6 +73,7 @@ void CollisionObject2DSW::set_shape_transform(int p_index, const Transform2D &p_
 
 	shapes.write[p_index].xform = p_transform;
 	shapes.write[p_index].xform_inv = p_transform.affine_inverse();
+	shapes_version++;
 
 	if (!pending_shape_update_list.in_list()) {
 		PhysicsServer2DSW::singletonsw->pending_shape_update_list.add(&pending_shape_update_list);
@@ -86,6 +89,7 @@ void CollisionObject2DSW::set_shape_disabled(int p_idx, bool p_disabled) {
 	}
 
 	shape.disabled = p_disabled;
+	shapes_version++;
 
 	if (!space) {
 		return;
@@ -127,6 +131,7 @@ void CollisionObject2DSW::remove_shape(int p_index) {
 	}
 	shapes[p_index].shape->remove_owner(this);
 	shapes.remove(p_index);
+	shapes_version++;
 
 	if (!pending_shape_update_list.in_list()) {
 		PhysicsServer2DSW::singletonsw->pending_shape_update_list.add(&pending_shape_update_list);
@@ -238,6 +243,7 @@ void CollisionObject2DSW::_set_space(Space2DSW *p_space) {
 }
 
 void CollisionObject2DSW::_shape_changed() {
+	shapes_version++;
 	_update_shapes();
 	_shapes_changed();
 }
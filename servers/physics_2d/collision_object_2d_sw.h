@@ -76,6 +76,7 @@ private:
 	uint32_t collision_mask;
 	uint32_t collision_layer;
 	bool _static;
+	uint64_t shapes_version = 0;
 
 	SelfList<CollisionObject2DSW> pending_shape_update_list;
 
@@ -110,6 +111,8 @@ public:
 	_FORCE_INLINE_ ObjectID get_canvas_instance_id() const { return canvas_instance_id; }
 
 	void _shape_changed();
+	// Incremented whenever shapes are added, removed, moved or reconfigured.
+	_FORCE_INLINE_ uint64_t get_shapes_version() const { return shapes_version; }
 
 	_FORCE_INLINE_ Type get_type() const { return type; }
 	void add_shape(Shape2DSW *p_shape, const Transform2D &p_transform = Transform2D(), bool p_disabled = false);
@@ -153,6 +156,7 @@ public:
 		CRASH_BAD_INDEX(p_idx, shapes.size());
 		shapes.write[p_idx].one_way_collision = p_one_way_collision;
 		shapes.write[p_idx].one_way_collision_margin = p_margin;
+		shapes_version++;
 	}
 	_FORCE_INLINE_ bool is_shape_set_as_one_way_collision(int p_idx) const {
 		CRASH_BAD_INDEX(p_idx, shapes.size());
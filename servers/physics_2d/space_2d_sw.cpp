@@ -32,8 +32,12 @@
 
 #include "collision_solver_2d_sw.h"
 #include "core/os/os.h"
+#include "core/os/worker_thread_pool.h"
 #include "core/templates/pair.h"
 #include "physics_server_2d_sw.h"
+
+#define QUERY_BATCH_SLICE_MIN_SIZE 32
+
 _FORCE_INLINE_ static bool _can_collide_with(CollisionObject2DSW *p_object, uint32_t p_collision_mask, bool p_collide_with_bodies, bool p_collide_with_areas) {
 	if (!(p_object->get_collision_layer() & p_collision_mask)) {
 		return false;
@@ -121,13 +125,17 @@ int PhysicsDirectSpaceState2DSW::intersect_point_on_canvas(const Vector2 &p_poin
 bool PhysicsDirectSpaceState2DSW::intersect_ray(const Vector2 &p_from, const Vector2 &p_to, RayResult &r_result, const Set<RID> &p_exclude, uint32_t p_collision_mask, bool p_collide_with_bodies, bool p_collide_with_areas) {
 	ERR_FAIL_COND_V(space->locked, false);
 
+	return _intersect_ray(p_from, p_to, r_result, p_exclude, p_collision_mask, p_collide_with_bodies, p_collide_with_areas, space->intersection_query_results, space->intersection_query_subindex_results);
+}
+
+bool PhysicsDirectSpaceState2DSW::_intersect_ray(const Vector2 &p_from, const Vector2 &p_to, RayResult &r_result, const Set<RID> &p_exclude, uint32_t p_collision_mask, bool p_collide_with_bodies, bool p_collide_with_areas, CollisionObject2DSW **r_cull_results, int *r_cull_subindex_results) const {
 	Vector2 begin, end;
 	Vector2 normal;
 	begin = p_from;
 	end = p_to;
 	normal = (end - begin).normalized();
 
-	int amount = space->broadphase->cull_segment(begin, end, space->intersection_query_results, Space2DSW::INTERSECTION_QUERY_MAX, space->intersection_query_subindex_results);
+	int amount = space->broadphase->cull_segment(begin, end, r_cull_results, Space2DSW::INTERSECTION_QUERY_MAX, r_cull_subindex_results);
 
 	//todo, create another array that references results, compute AABBs and check closest point to ray origin, sort, and stop evaluating results when beyond first collision
 
@@ -138,17 +146,17 @@ bool PhysicsDirectSpaceState2DSW::intersect_ray(const Vector2 &p_from, const Vec
 	real_t min_d = 1e10;
 
 	for (int i = 0; i < amount; i++) {
-		if (!_can_collide_with(space->intersection_query_results[i], p_collision_mask, p_collide_with_bodies, p_collide_with_areas)) {
+		if (!_can_collide_with(r_cull_results[i], p_collision_mask, p_collide_with_bodies, p_collide_with_areas)) {
 			continue;
 		}
 
-		if (p_exclude.has(space->intersection_query_results[i]->get_self())) {
+		if (p_exclude.has(r_cull_results[i]->get_self())) {
 			continue;
 		}
 
-		const CollisionObject2DSW *col_obj = space->intersection_query_results[i];
+		const CollisionObject2DSW *col_obj = r_cull_results[i];
 
-		int shape_idx = space->intersection_query_subindex_results[i];
+		int shape_idx = r_cull_subindex_results[i];
 		Transform2D inv_xform = col_obj->get_shape_inv_transform(shape_idx) * col_obj->get_inv_transform();
 
 		Vector2 local_from = inv_xform.xform(begin);
@@ -251,35 +259,41 @@ bool PhysicsDirectSpaceState2DSW::cast_motion(const RID &p_shape, const Transfor
 	Shape2DSW *shape = PhysicsServer2DSW::singletonsw->shape_owner.getornull(p_shape);
 	ERR_FAIL_COND_V(!shape, false);
 
-	Rect2 aabb = p_xform.xform(shape->get_aabb());
+	_cast_motion(shape, p_xform, p_motion, p_margin, p_closest_safe, p_closest_unsafe, p_exclude, p_collision_mask, p_collide_with_bodies, p_collide_with_areas, space->intersection_query_results, space->intersection_query_subindex_results);
+
+	return true;
+}
+
+void PhysicsDirectSpaceState2DSW::_cast_motion(Shape2DSW *p_shape, const Transform2D &p_xform, const Vector2 &p_motion, real_t p_margin, real_t &p_closest_safe, real_t &p_closest_unsafe, const Set<RID> &p_exclude, uint32_t p_collision_mask, bool p_collide_with_bodies, bool p_collide_with_areas, CollisionObject2DSW **r_cull_results, int *r_cull_subindex_results) const {
+	Rect2 aabb = p_xform.xform(p_shape->get_aabb());
 	aabb = aabb.merge(Rect2(aabb.position + p_motion, aabb.size)); //motion
 	aabb = aabb.grow(p_margin);
 
-	int amount = space->broadphase->cull_aabb(aabb, space->intersection_query_results, Space2DSW::INTERSECTION_QUERY_MAX, space->intersection_query_subindex_results);
+	int amount = space->broadphase->cull_aabb(aabb, r_cull_results, Space2DSW::INTERSECTION_QUERY_MAX, r_cull_subindex_results);
 
 	real_t best_safe = 1;
 	real_t best_unsafe = 1;
 
 	for (int i = 0; i < amount; i++) {
-		if (!_can_collide_with(space->intersection_query_results[i], p_collision_mask, p_collide_with_bodies, p_collide_with_areas)) {
+		if (!_can_collide_with(r_cull_results[i], p_collision_mask, p_collide_with_bodies, p_collide_with_areas)) {
 			continue;
 		}
 
-		if (p_exclude.has(space->intersection_query_results[i]->get_self())) {
+		if (p_exclude.has(r_cull_results[i]->get_self())) {
 			continue; //ignore excluded
 		}
 
-		const CollisionObject2DSW *col_obj = space->intersection_query_results[i];
-		int shape_idx = space->intersection_query_subindex_results[i];
+		const CollisionObject2DSW *col_obj = r_cull_results[i];
+		int shape_idx = r_cull_subindex_results[i];
 
 		Transform2D col_obj_xform = col_obj->get_transform() * col_obj->get_shape_transform(shape_idx);
 		//test initial overlap, does it collide if going all the way?
-		if (!CollisionSolver2DSW::solve(shape, p_xform, p_motion, col_obj->get_shape(shape_idx), col_obj_xform, Vector2(), nullptr, nullptr, nullptr, p_margin)) {
+		if (!CollisionSolver2DSW::solve(p_shape, p_xform, p_motion, col_obj->get_shape(shape_idx), col_obj_xform, Vector2(), nullptr, nullptr, nullptr, p_margin)) {
 			continue;
 		}
 
 		//test initial overlap, ignore objects it's inside of.
-		if (CollisionSolver2DSW::solve(shape, p_xform, Vector2(), col_obj->get_shape(shape_idx), col_obj_xform, Vector2(), nullptr, nullptr, nullptr, p_margin)) {
+		if (CollisionSolver2DSW::solve(p_shape, p_xform, Vector2(), col_obj->get_shape(shape_idx), col_obj_xform, Vector2(), nullptr, nullptr, nullptr, p_margin)) {
 			continue;
 		}
 
@@ -293,7 +307,7 @@ bool PhysicsDirectSpaceState2DSW::cast_motion(const RID &p_shape, const Transfor
 			real_t fraction = low + (hi - low) * fraction_coeff;
 
 			Vector2 sep = mnormal; //important optimization for this to work fast enough
-			bool collided = CollisionSolver2DSW::solve(shape, p_xform, p_motion * fraction, col_obj->get_shape(shape_idx), col_obj_xform, Vector2(), nullptr, nullptr, &sep, p_margin);
+			bool collided = CollisionSolver2DSW::solve(p_shape, p_xform, p_motion * fraction, col_obj->get_shape(shape_idx), col_obj_xform, Vector2(), nullptr, nullptr, &sep, p_margin);
 
 			if (collided) {
 				hi = fraction;
@@ -326,8 +340,149 @@ bool PhysicsDirectSpaceState2DSW::cast_motion(const RID &p_shape, const Transfor
 
 	p_closest_safe = best_safe;
 	p_closest_unsafe = best_unsafe;
+}
 
-	return true;
+struct PhysicsDirectSpaceState2DSW::RayBatch {
+	const Vector2 *from = nullptr;
+	const Vector2 *to = nullptr;
+	RayResult *results = nullptr;
+	uint32_t ray_count = 0;
+
+	const Set<RID> *exclude = nullptr;
+	uint32_t collision_mask = 0;
+	bool collide_with_bodies = true;
+	bool collide_with_areas = false;
+
+	uint32_t slice_count = 0;
+	LocalVector<CollisionObject2DSW *> cull_results;
+	LocalVector<int> cull_subindex_results;
+};
+
+struct PhysicsDirectSpaceState2DSW::MotionBatch {
+	Shape2DSW *shape = nullptr;
+	const Transform2D *xforms = nullptr;
+	const Vector2 *motions = nullptr;
+	real_t margin = 0.0;
+	real_t *closest_safe = nullptr;
+	real_t *closest_unsafe = nullptr;
+	uint32_t cast_count = 0;
+
+	const Set<RID> *exclude = nullptr;
+	uint32_t collision_mask = 0;
+	bool collide_with_bodies = true;
+	bool collide_with_areas = false;
+
+	uint32_t slice_count = 0;
+	LocalVector<CollisionObject2DSW *> cull_results;
+	LocalVector<int> cull_subindex_results;
+};
+
+// Splits batched queries in slices of at least QUERY_BATCH_SLICE_MIN_SIZE queries, one per worker at most.
+static uint32_t _get_query_batch_slice_count(uint32_t p_query_count) {
+	uint32_t slice_count = (p_query_count + QUERY_BATCH_SLICE_MIN_SIZE - 1) / QUERY_BATCH_SLICE_MIN_SIZE;
+	return CLAMP(slice_count, 1u, (uint32_t)WorkerThreadPool::get_singleton()->get_thread_count());
+}
+
+void PhysicsDirectSpaceState2DSW::_intersect_ray_slice(uint32_t p_slice, RayBatch *p_batch) {
+	uint32_t from = p_slice * p_batch->ray_count / p_batch->slice_count;
+	uint32_t to = (p_slice + 1) * p_batch->ray_count / p_batch->slice_count;
+
+	CollisionObject2DSW **cull_results = &p_batch->cull_results[p_slice * Space2DSW::INTERSECTION_QUERY_MAX];
+	int *cull_subindex_results = &p_batch->cull_subindex_results[p_slice * Space2DSW::INTERSECTION_QUERY_MAX];
+
+	for (uint32_t i = from; i < to; i++) {
+		RayResult &result = p_batch->results[i];
+		result = RayResult();
+		_intersect_ray(p_batch->from[i], p_batch->to[i], result, *p_batch->exclude, p_batch->collision_mask, p_batch->collide_with_bodies, p_batch->collide_with_areas, cull_results, cull_subindex_results);
+	}
+}
+
+int PhysicsDirectSpaceState2DSW::intersect_rays(const Vector2 *p_from, const Vector2 *p_to, int p_ray_count, RayResult *r_results, const Set<RID> &p_exclude, uint32_t p_collision_mask, bool p_collide_with_bodies, bool p_collide_with_areas) {
+	ERR_FAIL_COND_V(space->locked, 0);
+	if (p_ray_count <= 0) {
+		return 0;
+	}
+
+	RayBatch batch;
+	batch.from = p_from;
+	batch.to = p_to;
+	batch.results = r_results;
+	batch.ray_count = p_ray_count;
+	batch.exclude = &p_exclude;
+	batch.collision_mask = p_collision_mask;
+	batch.collide_with_bodies = p_collide_with_bodies;
+	batch.collide_with_areas = p_collide_with_areas;
+	batch.slice_count = _get_query_batch_slice_count(p_ray_count);
+	batch.cull_results.resize(batch.slice_count * Space2DSW::INTERSECTION_QUERY_MAX);
+	batch.cull_subindex_results.resize(batch.slice_count * Space2DSW::INTERSECTION_QUERY_MAX);
+
+	if (batch.slice_count > 1) {
+		WorkerThreadPool::get_singleton()->do_work(batch.slice_count, this, &PhysicsDirectSpaceState2DSW::_intersect_ray_slice, &batch);
+	} else {
+		_intersect_ray_slice(0, &batch);
+	}
+
+	int hit_count = 0;
+	for (int i = 0; i < p_ray_count; i++) {
+		if (r_results[i].rid.is_valid()) {
+			hit_count++;
+		}
+	}
+
+	return hit_count;
+}
+
+void PhysicsDirectSpaceState2DSW::_cast_motion_slice(uint32_t p_slice, MotionBatch *p_batch) {
+	uint32_t from = p_slice * p_batch->cast_count / p_batch->slice_count;
+	uint32_t to = (p_slice + 1) * p_batch->cast_count / p_batch->slice_count;
+
+	CollisionObject2DSW **cull_results = &p_batch->cull_results[p_slice * Space2DSW::INTERSECTION_QUERY_MAX];
+	int *cull_subindex_results = &p_batch->cull_subindex_results[p_slice * Space2DSW::INTERSECTION_QUERY_MAX];
+
+	for (uint32_t i = from; i < to; i++) {
+		_cast_motion(p_batch->shape, p_batch->xforms[i], p_batch->motions[i], p_batch->margin, p_batch->closest_safe[i], p_batch->closest_unsafe[i], *p_batch->exclude, p_batch->collision_mask, p_batch->collide_with_bodies, p_batch->collide_with_areas, cull_results, cull_subindex_results);
+	}
+}
+
+int PhysicsDirectSpaceState2DSW::cast_motions(const RID &p_shape, const Transform2D *p_xforms, const Vector2 *p_motions, int p_cast_count, real_t p_margin, real_t *r_closest_safe, real_t *r_closest_unsafe, const Set<RID> &p_exclude, uint32_t p_collision_mask, bool p_collide_with_bodies, bool p_collide_with_areas) {
+	ERR_FAIL_COND_V(space->locked, 0);
+	if (p_cast_count <= 0) {
+		return 0;
+	}
+
+	Shape2DSW *shape = PhysicsServer2DSW::singletonsw->shape_owner.getornull(p_shape);
+	ERR_FAIL_COND_V(!shape, 0);
+
+	MotionBatch batch;
+	batch.shape = shape;
+	batch.xforms = p_xforms;
+	batch.motions = p_motions;
+	batch.margin = p_margin;
+	batch.closest_safe = r_closest_safe;
+	batch.closest_unsafe = r_closest_unsafe;
+	batch.cast_count = p_cast_count;
+	batch.exclude = &p_exclude;
+	batch.collision_mask = p_collision_mask;
+	batch.collide_with_bodies = p_collide_with_bodies;
+	batch.collide_with_areas = p_collide_with_areas;
+	batch.slice_count = _get_query_batch_slice_count(p_cast_count);
+	batch.cull_results.resize(batch.slice_count * Space2DSW::INTERSECTION_QUERY_MAX);
+	batch.cull_subindex_results.resize(batch.slice_count * Space2DSW::INTERSECTION_QUERY_MAX);
+
+	if (batch.slice_count > 1) {
+		WorkerThreadPool::get_singleton()->do_work(batch.slice_count, this, &PhysicsDirectSpaceState2DSW::_cast_motion_slice, &batch);
+	} else {
+		_cast_motion_slice(0, &batch);
+	}
+
+	int hit_count = 0;
+	for (int i = 0; i < p_cast_count; i++) {
+		if (r_closest_unsafe[i] < 1.0) {
+			hit_count++;
+		}
+	}
+
+	return hit_count;
 }
 
 bool PhysicsDirectSpaceState2DSW::collide_shape(RID p_shape, const Transform2D &p_shape_xform, const Vector2 &p_motion, real_t p_margin, Vector2 *r_results, int p_result_max, int &r_result_count, const Set<RID> &p_exclude, uint32_t p_collision_mask, bool p_collide_with_bodies, bool p_collide_with_areas) {
@@ -33,8 +33,8 @@
 
 #include "space_2d_sw.h"
 
+#include "core/os/worker_thread_pool.h"
 #include "core/templates/local_vector.h"
-#include "core/templates/thread_work_pool.h"
 
 class Step2DSW {
 	uint64_t _step;
@@ -42,8 +42,6 @@ class Step2DSW {
 	int iterations = 0;
 	real_t delta = 0.0;
 
-	ThreadWorkPool work_pool;
-
 	LocalVector<LocalVector<Body2DSW *>> body_islands;
 	LocalVector<LocalVector<Constraint2DSW *>> constraint_islands;
 	LocalVector<Constraint2DSW *> all_constraints;
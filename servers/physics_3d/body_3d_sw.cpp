@@ -596,9 +596,14 @@ void Body3DSW::integrate_velocities(real_t p_step) {
 
 	transform.origin += total_linear_velocity * p_step;
 
-	_set_transform(transform);
+	_set_transform(transform, !continuous_cd);
 	_set_inv_transform(get_transform().inverse());
 
+	if (continuous_cd) {
+		//keep shapes extended along the motion, so the broadphase pairs whatever the next step can reach
+		_update_shapes_with_motion(total_linear_velocity * p_step);
+	}
+
 	_update_transform_dependant();
 
 	/*
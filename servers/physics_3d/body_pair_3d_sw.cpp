@@ -48,6 +48,8 @@
 #define RELAXATION_TIMESTEPS 3
 #define MIN_VELOCITY 0.0001
 #define MAX_BIAS_ROTATION (Math_PI / 8)
+#define MANIFOLD_REUSE_RECYCLE_RATIO 0.5
+#define CCD_MAX_ITERATIONS 16
 
 void BodyPair3DSW::_contact_added_callback(const Vector3 &p_point_A, int p_index_A, const Vector3 &p_point_B, int p_index_B, void *p_userdata) {
 	BodyPair3DSW *pair = (BodyPair3DSW *)p_userdata;
@@ -161,8 +163,100 @@ void BodyPair3DSW::validate_contacts() {
 	}
 }
 
+// Upper bound of the distance any point of a shape moved between two of its transforms.
+static real_t _get_shape_drift(const Transform3D &p_from, const Transform3D &p_to, const AABB &p_shape_aabb) {
+	Vector3 begin = p_shape_aabb.position.abs();
+	Vector3 end = (p_shape_aabb.position + p_shape_aabb.size).abs();
+	Vector3 extents = Vector3(MAX(begin.x, end.x), MAX(begin.y, end.y), MAX(begin.z, end.z));
+
+	real_t basis_drift_squared = 0.0;
+	for (int i = 0; i < 3; i++) {
+		basis_drift_squared += (p_to.basis[i] - p_from.basis[i]).length_squared();
+	}
+
+	return p_from.origin.distance_to(p_to.origin) + Math::sqrt(basis_drift_squared) * extents.length();
+}
+
+bool BodyPair3DSW::_can_reuse_manifold(const Transform3D &p_xform_A, const Transform3D &p_xform_B) const {
+	if (!collided || contact_count == 0) {
+		return false;
+	}
+
+	if (A->get_shapes_version() != manifold_shapes_version_A || B->get_shapes_version() != manifold_shapes_version_B) {
+		return false;
+	}
+
+	// Until the shapes move by a fraction of the recycle radius, the narrow phase would only find the same contacts again.
+	real_t drift = _get_shape_drift(manifold_xform_A, p_xform_A, A->get_shape(shape_A)->get_aabb());
+	drift += _get_shape_drift(manifold_xform_B, p_xform_B, B->get_shape(shape_B)->get_aabb());
+
+	return drift < space->get_contact_recycle_radius() * MANIFOLD_REUSE_RECYCLE_RATIO;
+}
+
+// Conservative advancement of a convex shape A along p_motion towards a convex shape B: A is moved by the largest
+// fraction of the motion that can't make it touch B, based on the current closest points, until it gets within
+// p_tolerance of B. Rotation during the step is ignored.
+static bool _ccd_advance(const Shape3DSW *p_shape_A, const Transform3D &p_xform_A, const Vector3 &p_motion, const Shape3DSW *p_shape_B, const Transform3D &p_xform_B, real_t p_tolerance, real_t &r_toi) {
+	real_t toi = 0.0;
+
+	for (int i = 0; i < CCD_MAX_ITERATIONS; i++) {
+		Transform3D xform_A = p_xform_A;
+		xform_A.origin += p_motion * toi;
+
+		Vector3 point_A, point_B;
+		if (!CollisionSolver3DSW::solve_distance(p_shape_A, xform_A, p_shape_B, p_xform_B, point_A, point_B, AABB())) {
+			if (i == 0) {
+				return false; // Already touching, regular contacts take care of it.
+			}
+			break; // Advanced into contact because of numerical error, stop here.
+		}
+
+		Vector3 separation = point_B - point_A;
+		real_t distance = separation.length();
+		if (distance < p_tolerance) {
+			break;
+		}
+
+		// The closest points define a separating plane, only the motion along its normal closes the gap.
+		real_t closing = p_motion.dot(separation / distance);
+		if (closing < CMP_EPSILON) {
+			return false; // Moving away.
+		}
+
+		toi += (distance - p_tolerance * 0.5) / closing;
+		if (toi >= 1.0) {
+			return false; // No impact during this step.
+		}
+	}
+
+	// Either close enough to B or out of iterations, in which case the fraction reached so far is still safe.
+	r_toi = toi;
+	return true;
+}
+
+struct _CCDConcaveInfo {
+	const Shape3DSW *shape_A = nullptr;
+	const Transform3D *xform_A = nullptr;
+	Vector3 motion;
+	const Transform3D *xform_B = nullptr;
+	real_t tolerance = 0.0;
+	real_t toi = 1.0;
+	bool hit = false;
+};
+
+static void _ccd_concave_callback(void *p_userdata, Shape3DSW *p_convex) {
+	_CCDConcaveInfo &info = *(_CCDConcaveInfo *)p_userdata;
+
+	real_t toi;
+	if (_ccd_advance(info.shape_A, *info.xform_A, info.motion, p_convex, *info.xform_B, info.tolerance, toi) && toi < info.toi) {
+		info.toi = toi;
+		info.hit = true;
+	}
+}
+
 bool BodyPair3DSW::_test_ccd(real_t p_step, Body3DSW *p_A, int p_shape_A, const Transform3D &p_xform_A, Body3DSW *p_B, int p_shape_B, const Transform3D &p_xform_B) {
-	Vector3 motion = p_A->get_linear_velocity() * p_step;
+	// Motion of A relative to B, so moving obstacles are also handled.
+	Vector3 motion = (p_A->get_linear_velocity() - p_B->get_linear_velocity()) * p_step;
 	real_t mlen = motion.length();
 	if (mlen < CMP_EPSILON) {
 		return false;
@@ -170,35 +264,48 @@ bool BodyPair3DSW::_test_ccd(real_t p_step, Body3DSW *p_A, int p_shape_A, const
 
 	Vector3 mnormal = motion / mlen;
 
+	Shape3DSW *shape_A_ptr = p_A->get_shape(p_shape_A);
+	Shape3DSW *shape_B_ptr = p_B->get_shape(p_shape_B);
+
 	real_t min, max;
-	p_A->get_shape(p_shape_A)->project_range(mnormal, p_xform_A, min, max);
+	shape_A_ptr->project_range(mnormal, p_xform_A, min, max);
 	bool fast_object = mlen > (max - min) * 0.3; //going too fast in that direction
 
-	if (!fast_object) { //did it move enough in this direction to even attempt raycast? let's say it should move more than 1/3 the size of the object in that axis
+	if (!fast_object) { //did it move enough in this direction to even attempt ccd? let's say it should move more than 1/3 the size of the object in that axis
 		return false;
 	}
 
-	//cast a segment from support in motion normal, in the same direction of motion by motion length
-	//support is the worst case collision point, so real collision happened before
-	Vector3 s = p_A->get_shape(p_shape_A)->get_support(p_xform_A.basis.xform(mnormal).normalized());
-	Vector3 from = p_xform_A.xform(s);
-	Vector3 to = from + motion;
+	if (shape_A_ptr->is_concave()) {
+		return false; // Closest point queries require a convex moving shape.
+	}
+
+	real_t tolerance = (max - min) * 0.01;
+	real_t toi = 1.0;
 
-	Transform3D from_inv = p_xform_B.affine_inverse();
+	if (shape_B_ptr->is_concave()) {
+		// There is no single separating plane against a concave shape, so advance against every face
+		// touched by the swept shape and keep the earliest impact.
+		AABB swept_aabb = p_xform_A.xform(shape_A_ptr->get_aabb());
+		swept_aabb = swept_aabb.merge(AABB(swept_aabb.position + motion, swept_aabb.size));
 
-	Vector3 local_from = from_inv.xform(from - mnormal * mlen * 0.1); //start from a little inside the bounding box
-	Vector3 local_to = from_inv.xform(to);
+		_CCDConcaveInfo info;
+		info.shape_A = shape_A_ptr;
+		info.xform_A = &p_xform_A;
+		info.motion = motion;
+		info.xform_B = &p_xform_B;
+		info.tolerance = tolerance;
 
-	Vector3 rpos, rnorm;
-	if (!p_B->get_shape(p_shape_B)->intersect_segment(local_from, local_to, rpos, rnorm)) {
+		static_cast<ConcaveShape3DSW *>(shape_B_ptr)->cull(p_xform_B.affine_inverse().xform(swept_aabb), _ccd_concave_callback, &info);
+		if (!info.hit) {
+			return false;
+		}
+		toi = info.toi;
+	} else if (!_ccd_advance(shape_A_ptr, p_xform_A, motion, shape_B_ptr, p_xform_B, tolerance, toi)) {
 		return false;
 	}
 
 	//shorten the linear velocity so it does not hit, but gets close enough, next frame will hit softly or soft enough
-	Vector3 hitpos = p_xform_B.xform(rpos);
-
-	real_t newlen = hitpos.distance_to(from) - (max - min) * 0.01;
-	p_A->set_linear_velocity((mnormal * newlen) / p_step);
+	p_A->set_linear_velocity(p_B->get_linear_velocity() + (motion * toi) / p_step);
 
 	return true;
 }
@@ -232,6 +339,11 @@ bool BodyPair3DSW::setup(real_t p_step) {
 
 	offset_B = B->get_transform().get_origin() - A->get_transform().get_origin();
 
+	if (A->get_shapes_version() != manifold_shapes_version_A || B->get_shapes_version() != manifold_shapes_version_B) {
+		// Contacts cached for other shapes may still look valid, but they no longer lie on the surfaces.
+		contact_count = 0;
+	}
+
 	validate_contacts();
 
 	const Vector3 &offset_A = A->get_transform().get_origin();
@@ -242,13 +354,22 @@ bool BodyPair3DSW::setup(real_t p_step) {
 	xform_Bu.origin -= offset_A;
 	Transform3D xform_B = xform_Bu * B->get_shape_transform(shape_B);
 
+	if (_can_reuse_manifold(xform_A, xform_B)) {
+		return true;
+	}
+
 	Shape3DSW *shape_A_ptr = A->get_shape(shape_A);
 	Shape3DSW *shape_B_ptr = B->get_shape(shape_B);
 
 	collided = CollisionSolver3DSW::solve_static(shape_A_ptr, xform_A, shape_B_ptr, xform_B, _contact_added_callback, this, &sep_axis);
 
+	manifold_xform_A = xform_A;
+	manifold_xform_B = xform_B;
+	manifold_shapes_version_A = A->get_shapes_version();
+	manifold_shapes_version_B = B->get_shapes_version();
+
 	if (!collided) {
-		//test ccd (currently just a raycast)
+		//test ccd (conservative advancement)
 
 		if (A->is_continuous_collision_detection_enabled() && collide_A) {
 			_test_ccd(p_step, A, shape_A, xform_A, B, shape_B, xform_B);
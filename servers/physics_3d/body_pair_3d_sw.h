@@ -36,6 +36,9 @@
 #include "core/templates/local_vector.h"
 #include "soft_body_3d_sw.h"
 
+real_t combine_bounce(Body3DSW *A, Body3DSW *B);
+real_t combine_friction(Body3DSW *A, Body3DSW *B);
+
 class BodyContact3DSW : public Constraint3DSW {
 protected:
 	struct Contact {
@@ -67,6 +70,8 @@ protected:
 };
 
 class BodyPair3DSW : public BodyContact3DSW {
+	friend class ContactBatch3DSW;
+
 	enum {
 		MAX_CONTACTS = 4
 	};
@@ -93,11 +98,18 @@ class BodyPair3DSW : public BodyContact3DSW {
 	Contact contacts[MAX_CONTACTS];
 	int contact_count = 0;
 
+	// Shape transforms and versions used by the last narrow phase, the contacts are reused as long as they barely change.
+	Transform3D manifold_xform_A;
+	Transform3D manifold_xform_B;
+	uint64_t manifold_shapes_version_A = 0;
+	uint64_t manifold_shapes_version_B = 0;
+
 	static void _contact_added_callback(const Vector3 &p_point_A, int p_index_A, const Vector3 &p_point_B, int p_index_B, void *p_userdata);
 
 	void contact_added_callback(const Vector3 &p_point_A, int p_index_A, const Vector3 &p_point_B, int p_index_B);
 
 	void validate_contacts();
+	bool _can_reuse_manifold(const Transform3D &p_xform_A, const Transform3D &p_xform_B) const;
 	bool _test_ccd(real_t p_step, Body3DSW *p_A, int p_shape_A, const Transform3D &p_xform_A, Body3DSW *p_B, int p_shape_B, const Transform3D &p_xform_B);
 
 public:
@@ -105,6 +117,8 @@ public:
 	virtual bool pre_solve(real_t p_step) override;
 	virtual void solve(real_t p_step) override;
 
+	virtual bool is_body_pair() const override { return true; }
+
 	BodyPair3DSW(Body3DSW *p_A, int p_shape_A, Body3DSW *p_B, int p_shape_B);
 	~BodyPair3DSW();
 };
@@ -31,6 +31,8 @@
 #include "broad_phase_3d_bvh.h"
 #include "collision_object_3d_sw.h"
 
+#include "core/config/project_settings.h"
+
 BroadPhase3DBVH::ID BroadPhase3DBVH::create(CollisionObject3DSW *p_object, int p_subindex, const AABB &p_aabb, bool p_static) {
 	ID oid = bvh.create(p_object, true, p_aabb, p_subindex, !p_static, 1 << p_object->get_type(), p_static ? 0 : 0xFFFFF); // Pair everything, don't care?
 	return oid + 1;
@@ -63,16 +65,19 @@ int BroadPhase3DBVH::get_subindex(ID p_id) const {
 	return bvh.get_subindex(p_id - 1);
 }
 
+// Space queries may run on several threads at once, each needs its own list of intermediate hits.
+static thread_local LocalVector<uint32_t, uint32_t, true> cull_hits;
+
 int BroadPhase3DBVH::cull_point(const Vector3 &p_point, CollisionObject3DSW **p_results, int p_max_results, int *p_result_indices) {
-	return bvh.cull_point(p_point, p_results, p_max_results, p_result_indices);
+	return bvh.cull_point(p_point, p_results, p_max_results, p_result_indices, 0xFFFFFFFF, &cull_hits);
 }
 
 int BroadPhase3DBVH::cull_segment(const Vector3 &p_from, const Vector3 &p_to, CollisionObject3DSW **p_results, int p_max_results, int *p_result_indices) {
-	return bvh.cull_segment(p_from, p_to, p_results, p_max_results, p_result_indices);
+	return bvh.cull_segment(p_from, p_to, p_results, p_max_results, p_result_indices, 0xFFFFFFFF, &cull_hits);
 }
 
 int BroadPhase3DBVH::cull_aabb(const AABB &p_aabb, CollisionObject3DSW **p_results, int p_max_results, int *p_result_indices) {
-	return bvh.cull_aabb(p_aabb, p_results, p_max_results, p_result_indices);
+	return bvh.cull_aabb(p_aabb, p_results, p_max_results, p_result_indices, 0xFFFFFFFF, &cull_hits);
 }
 
 void *BroadPhase3DBVH::_pair_callback(void *self, uint32_t p_A, CollisionObject3DSW *p_object_A, int subindex_A, uint32_t p_B, CollisionObject3DSW *p_object_B, int subindex_B) {
@@ -114,6 +119,8 @@ BroadPhase3DSW *BroadPhase3DBVH::_create() {
 BroadPhase3DBVH::BroadPhase3DBVH() {
 	bvh.set_pair_callback(_pair_callback, this);
 	bvh.set_unpair_callback(_unpair_callback, this);
+	bvh.params_set_pairing_thread_threshold(GLOBAL_DEF("physics/3d/broadphase/pairing_thread_threshold", 256));
+	ProjectSettings::get_singleton()->set_custom_property_info("physics/3d/broadphase/pairing_thread_threshold", PropertyInfo(Variant::INT, "physics/3d/broadphase/pairing_thread_threshold", PROPERTY_HINT_RANGE, "0,4096,1,or_greater"));
 	pair_callback = nullptr;
 	pair_userdata = nullptr;
 	unpair_userdata = nullptr;
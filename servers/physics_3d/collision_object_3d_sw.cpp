@@ -41,6 +41,7 @@ void CollisionObject3DSW::add_shape(Shape3DSW *p_shape, const Transform3D &p_tra
 	s.disabled = p_disabled;
 	shapes.push_back(s);
 	p_shape->add_owner(this);
+	shapes_version++;
 
 	if (!pending_shape_update_list.in_list()) {
 		PhysicsServer3DSW::singletonsw->pending_shape_update_list.add(&pending_shape_update_list);
@@ -51,6 +52,7 @@ void CollisionObject3DSW::set_shape(int p_index, Shape3DSW *p_shape) {
 	ERR_FAIL_INDEX(p_index, shapes.size());
 	shapes[p_index].shape->remove_owner(this);
 	shapes.write[p_index].shape = p_shape;
+	shapes_version++;
 
 	p_shape->add_owner(this);
 	if (!pending_shape_update_list.in_list()) {
@@ -63,6 +65,7 @@ void CollisionObject3DSW::set_shape_transform(int p_index, const Transform3D &p_
 
 	shapes.write[p_index].xform = p_transform;
 	shapes.write[p_index].xform_inv = p_transform.affine_inverse();
+	shapes_version++;
 	if (!pending_shape_update_list.in_list()) {
 		PhysicsServer3DSW::singletonsw->pending_shape_update_list.add(&pending_shape_update_list);
 	}
@@ -77,6 +80,7 @@ void CollisionObject3DSW::set_shape_disabled(int p_idx, bool p_disabled) {
 	}
 
 	shape.disabled = p_disabled;
+	shapes_version++;
 
 	if (!space) {
 		return;
@@ -118,6 +122,7 @@ void CollisionObject3DSW::remove_shape(int p_index) {
 	}
 	shapes[p_index].shape->remove_owner(this);
 	shapes.remove(p_index);
+	shapes_version++;
 
 	if (!pending_shape_update_list.in_list()) {
 		PhysicsServer3DSW::singletonsw->pending_shape_update_list.add(&pending_shape_update_list);
@@ -230,6 +235,7 @@ void CollisionObject3DSW::_set_space(Space3DSW *p_space) {
 }
 
 void CollisionObject3DSW::_shape_changed() {
+	shapes_version++;
 	_update_shapes();
 	_shapes_changed();
 }
@@ -76,6 +76,7 @@ private:
 	Transform3D transform;
 	Transform3D inv_transform;
 	bool _static;
+	uint64_t shapes_version = 0;
 
 	SelfList<CollisionObject3DSW> pending_shape_update_list;
 
@@ -114,6 +115,8 @@ public:
 	_FORCE_INLINE_ ObjectID get_instance_id() const { return instance_id; }
 
 	void _shape_changed();
+	// Incremented whenever shapes are added, removed, moved or reconfigured.
+	_FORCE_INLINE_ uint64_t get_shapes_version() const { return shapes_version; }
 
 	_FORCE_INLINE_ Type get_type() const { return type; }
 	void add_shape(Shape3DSW *p_shape, const Transform3D &p_transform = Transform3D(), bool p_disabled = false);
@@ -1,5 +1,5 @@
 /*************************************************************************/
-/*  renderer_thread_pool.cpp                                             */
+/*  constraint_3d_sw.cpp                                                 */
 /*************************************************************************/
 /*                       This file is part of:                           */
 /*                           GODOT ENGINE                                */
@@ -28,15 +28,6 @@
 /* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
 /*************************************************************************/
 
-#include "renderer_thread_pool.h"
+#include "constraint_3d_sw.h"
 
-RendererThreadPool *RendererThreadPool::singleton = nullptr;
-
-RendererThreadPool::RendererThreadPool() {
-	singleton = this;
-	thread_work_pool.init();
-}
-
-RendererThreadPool::~RendererThreadPool() {
-	thread_work_pool.finish();
-}
+SafeNumeric<uint64_t> Constraint3DSW::creation_counter;
@@ -31,13 +31,20 @@
 #ifndef CONSTRAINT_SW_H
 #define CONSTRAINT_SW_H
 
+#include "core/math/math_defs.h"
+#include "core/templates/rid.h"
+#include "core/templates/safe_refcount.h"
+
 class Body3DSW;
 class SoftBody3DSW;
 
 class Constraint3DSW {
+	static SafeNumeric<uint64_t> creation_counter;
+
 	Body3DSW **_body_ptr;
 	int _body_count;
 	uint64_t island_step;
+	uint64_t creation_order;
 	int priority;
 	bool disabled_collisions_between_bodies;
 
@@ -48,6 +55,7 @@ protected:
 		_body_ptr = p_body_ptr;
 		_body_count = p_body_count;
 		island_step = 0;
+		creation_order = creation_counter.increment();
 		priority = 1;
 		disabled_collisions_between_bodies = true;
 	}
@@ -59,12 +67,18 @@ public:
 	_FORCE_INLINE_ uint64_t get_island_step() const { return island_step; }
 	_FORCE_INLINE_ void set_island_step(uint64_t p_step) { island_step = p_step; }
 
+	// Unlike addresses, the creation order is the same on every run, deterministic spaces sort by it.
+	_FORCE_INLINE_ uint64_t get_creation_order() const { return creation_order; }
+
 	_FORCE_INLINE_ Body3DSW **get_body_ptr() const { return _body_ptr; }
 	_FORCE_INLINE_ int get_body_count() const { return _body_count; }
 
 	virtual SoftBody3DSW *get_soft_body_ptr(int p_index) const { return nullptr; }
 	virtual int get_soft_body_count() const { return 0; }
 
+	// Body pairs can be solved in batches by ContactBatch3DSW.
+	virtual bool is_body_pair() const { return false; }
+
 	_FORCE_INLINE_ void set_priority(int p_priority) { priority = p_priority; }
 	_FORCE_INLINE_ int get_priority() const { return priority; }
 
@@ -0,0 +1,453 @@
+/*************************************************************************/
+/*  contact_batch_3d_sw.cpp                                              */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2021 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2021 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "contact_batch_3d_sw.h"
+
+#include "core/os/worker_thread_pool.h"
+
+// Same as in body_pair_3d_sw.cpp, both solvers must give the same results.
+#define MIN_VELOCITY 0.0001
+#define MAX_BIAS_ROTATION (Math_PI / 8)
+
+#define PACKET_THREADING_THRESHOLD 16
+
+typedef ContactBatch3DSW::RealLanes RealLanes;
+typedef ContactBatch3DSW::Vector3Lanes Vector3Lanes;
+
+// Lane operations, each one is a few instructions without branches.
+
+#if defined(CONTACT_BATCH_AVX)
+
+#include <immintrin.h>
+
+#define LANES_SPLAT(m_value) _mm256_set1_ps(m_value)
+#define LANES_ADD(m_a, m_b) _mm256_add_ps(m_a, m_b)
+#define LANES_SUB(m_a, m_b) _mm256_sub_ps(m_a, m_b)
+#define LANES_MUL(m_a, m_b) _mm256_mul_ps(m_a, m_b)
+#define LANES_DIV(m_a, m_b) _mm256_div_ps(m_a, m_b)
+#define LANES_NEG(m_a) _mm256_xor_ps(m_a, _mm256_set1_ps(-0.0f))
+#define LANES_ABS(m_a) _mm256_andnot_ps(_mm256_set1_ps(-0.0f), m_a)
+#define LANES_SQRT(m_a) _mm256_sqrt_ps(m_a)
+#define LANES_MAX(m_a, m_b) _mm256_max_ps(m_a, m_b)
+#define LANES_GREATER(m_a, m_b) _mm256_and_ps(_mm256_cmp_ps(m_a, m_b, _CMP_GT_OQ), _mm256_set1_ps(1.0f))
+#define LANES_SELECT(m_mask, m_a, m_b) _mm256_blendv_ps(m_b, m_a, _mm256_cmp_ps(m_mask, _mm256_setzero_ps(), _CMP_NEQ_UQ))
+#define LANES_LOAD(m_a) _mm256_loadu_ps(m_a.v)
+#define LANES_STORE(m_result, m_a) _mm256_storeu_ps(m_result.v, m_a)
+
+#elif defined(CONTACT_BATCH_SSE)
+
+#include <emmintrin.h>
+
+#define LANES_SPLAT(m_value) _mm_set1_ps(m_value)
+#define LANES_ADD(m_a, m_b) _mm_add_ps(m_a, m_b)
+#define LANES_SUB(m_a, m_b) _mm_sub_ps(m_a, m_b)
+#define LANES_MUL(m_a, m_b) _mm_mul_ps(m_a, m_b)
+#define LANES_DIV(m_a, m_b) _mm_div_ps(m_a, m_b)
+#define LANES_NEG(m_a) _mm_xor_ps(m_a, _mm_set1_ps(-0.0f))
+#define LANES_ABS(m_a) _mm_andnot_ps(_mm_set1_ps(-0.0f), m_a)
+#define LANES_SQRT(m_a) _mm_sqrt_ps(m_a)
+#define LANES_MAX(m_a, m_b) _mm_max_ps(m_a, m_b)
+#define LANES_GREATER(m_a, m_b) _mm_and_ps(_mm_cmpgt_ps(m_a, m_b), _mm_set1_ps(1.0f))
+#define LANES_SELECT(m_mask, m_a, m_b) _lanes_select_sse(_mm_cmpneq_ps(m_mask, _mm_setzero_ps()), m_a, m_b)
+#define LANES_LOAD(m_a) _mm_loadu_ps(m_a.v)
+#define LANES_STORE(m_result, m_a) _mm_storeu_ps(m_result.v, m_a)
+
+static _FORCE_INLINE_ __m128 _lanes_select_sse(__m128 p_mask, __m128 p_a, __m128 p_b) {
+	return _mm_or_ps(_mm_and_ps(p_mask, p_a), _mm_andnot_ps(p_mask, p_b));
+}
+
+#elif defined(CONTACT_BATCH_NEON)
+
+#include <arm_neon.h>
+
+#define LANES_SPLAT(m_value) vdupq_n_f32(m_value)
+#define LANES_ADD(m_a, m_b) vaddq_f32(m_a, m_b)
+#define LANES_SUB(m_a, m_b) vsubq_f32(m_a, m_b)
+#define LANES_MUL(m_a, m_b) vmulq_f32(m_a, m_b)
+#define LANES_DIV(m_a, m_b) vdivq_f32(m_a, m_b)
+#define LANES_NEG(m_a) vnegq_f32(m_a)
+#define LANES_ABS(m_a) vabsq_f32(m_a)
+#define LANES_SQRT(m_a) vsqrtq_f32(m_a)
+#define LANES_MAX(m_a, m_b) vmaxq_f32(m_a, m_b)
+#define LANES_GREATER(m_a, m_b) vreinterpretq_f32_u32(vandq_u32(vcgtq_f32(m_a, m_b), vreinterpretq_u32_f32(vdupq_n_f32(1.0f))))
+#define LANES_SELECT(m_mask, m_a, m_b) vbslq_f32(vmvnq_u32(vceqq_f32(m_mask, vdupq_n_f32(0.0f))), m_a, m_b)
+#define LANES_LOAD(m_a) vld1q_f32(m_a.v)
+#define LANES_STORE(m_result, m_a) vst1q_f32(m_result.v, m_a)
+
+#endif
+
+#ifdef LANES_LOAD
+
+#define LANES_OP_1(m_name, m_op)                                    \
+	static _FORCE_INLINE_ RealLanes m_name(const RealLanes &p_a) { \
+		RealLanes r;                                                \
+		LANES_STORE(r, m_op(LANES_LOAD(p_a)));                      \
+		return r;                                                   \
+	}
+
+#define LANES_OP_2(m_name, m_op)                                                          \
+	static _FORCE_INLINE_ RealLanes m_name(const RealLanes &p_a, const RealLanes &p_b) { \
+		RealLanes r;                                                                      \
+		LANES_STORE(r, m_op(LANES_LOAD(p_a), LANES_LOAD(p_b)));                           \
+		return r;                                                                         \
+	}
+
+static _FORCE_INLINE_ RealLanes _splat(real_t p_value) {
+	RealLanes r;
+	LANES_STORE(r, LANES_SPLAT(p_value));
+	return r;
+}
+
+static _FORCE_INLINE_ RealLanes _select(const RealLanes &p_mask, const RealLanes &p_a, const RealLanes &p_b) {
+	RealLanes r;
+	LANES_STORE(r, LANES_SELECT(LANES_LOAD(p_mask), LANES_LOAD(p_a), LANES_LOAD(p_b)));
+	return r;
+}
+
+#else
+
+// Scalar fallback, also used when real_t is double.
+
+#define LANES_OP_1(m_name, m_op)                                    \
+	static _FORCE_INLINE_ RealLanes m_name(const RealLanes &p_a) { \
+		RealLanes r;                                                \
+		for (int l = 0; l < ContactBatch3DSW::LANES; l++) {         \
+			r.v[l] = m_op(p_a.v[l]);                                \
+		}                                                           \
+		return r;                                                   \
+	}
+
+#define LANES_OP_2(m_name, m_op)                                                          \
+	static _FORCE_INLINE_ RealLanes m_name(const RealLanes &p_a, const RealLanes &p_b) { \
+		RealLanes r;                                                                      \
+		for (int l = 0; l < ContactBatch3DSW::LANES; l++) {                               \
+			r.v[l] = m_op(p_a.v[l], p_b.v[l]);                                            \
+		}                                                                                 \
+		return r;                                                                         \
+	}
+
+#define LANES_ADD(m_a, m_b) ((m_a) + (m_b))
+#define LANES_SUB(m_a, m_b) ((m_a) - (m_b))
+#define LANES_MUL(m_a, m_b) ((m_a) * (m_b))
+#define LANES_DIV(m_a, m_b) ((m_a) / (m_b))
+#define LANES_NEG(m_a) (-(m_a))
+#define LANES_ABS(m_a) Math::abs(m_a)
+#define LANES_SQRT(m_a) Math::sqrt(m_a)
+#define LANES_MAX(m_a, m_b) MAX(m_a, m_b)
+#define LANES_GREATER(m_a, m_b) ((m_a) > (m_b) ? (real_t)1.0 : (real_t)0.0)
+
+static _FORCE_INLINE_ RealLanes _splat(real_t p_value) {
+	RealLanes r;
+	for (int l = 0; l < ContactBatch3DSW::LANES; l++) {
+		r.v[l] = p_value;
+	}
+	return r;
+}
+
+static _FORCE_INLINE_ RealLanes _select(const RealLanes &p_mask, const RealLanes &p_a, const RealLanes &p_b) {
+	RealLanes r;
+	for (int l = 0; l < ContactBatch3DSW::LANES; l++) {
+		r.v[l] = p_mask.v[l] != 0.0 ? p_a.v[l] : p_b.v[l];
+	}
+	return r;
+}
+
+#endif
+
+LANES_OP_2(operator+, LANES_ADD)
+LANES_OP_2(operator-, LANES_SUB)
+LANES_OP_2(operator*, LANES_MUL)
+LANES_OP_2(operator/, LANES_DIV)
+LANES_OP_1(operator-, LANES_NEG)
+LANES_OP_1(_abs, LANES_ABS)
+LANES_OP_1(_sqrt, LANES_SQRT)
+LANES_OP_2(_max, LANES_MAX)
+LANES_OP_2(_greater, LANES_GREATER)
+
+static _FORCE_INLINE_ Vector3Lanes operator+(const Vector3Lanes &p_a, const Vector3Lanes &p_b) {
+	return { p_a.x + p_b.x, p_a.y + p_b.y, p_a.z + p_b.z };
+}
+
+static _FORCE_INLINE_ Vector3Lanes operator-(const Vector3Lanes &p_a, const Vector3Lanes &p_b) {
+	return { p_a.x - p_b.x, p_a.y - p_b.y, p_a.z - p_b.z };
+}
+
+static _FORCE_INLINE_ Vector3Lanes operator-(const Vector3Lanes &p_a) {
+	return { -p_a.x, -p_a.y, -p_a.z };
+}
+
+static _FORCE_INLINE_ Vector3Lanes operator*(const Vector3Lanes &p_a, const RealLanes &p_b) {
+	return { p_a.x * p_b, p_a.y * p_b, p_a.z * p_b };
+}
+
+static _FORCE_INLINE_ RealLanes _dot(const Vector3Lanes &p_a, const Vector3Lanes &p_b) {
+	return p_a.x * p_b.x + p_a.y * p_b.y + p_a.z * p_b.z;
+}
+
+static _FORCE_INLINE_ Vector3Lanes _cross(const Vector3Lanes &p_a, const Vector3Lanes &p_b) {
+	return {
+		p_a.y * p_b.z - p_a.z * p_b.y,
+		p_a.z * p_b.x - p_a.x * p_b.z,
+		p_a.x * p_b.y - p_a.y * p_b.x
+	};
+}
+
+static _FORCE_INLINE_ RealLanes _length(const Vector3Lanes &p_a) {
+	return _sqrt(_dot(p_a, p_a));
+}
+
+static _FORCE_INLINE_ Vector3Lanes _xform(const Vector3Lanes *p_rows, const Vector3Lanes &p_a) {
+	return { _dot(p_rows[0], p_a), _dot(p_rows[1], p_a), _dot(p_rows[2], p_a) };
+}
+
+void ContactBatch3DSW::_set_body_lane(BodyLanes &r_lanes, int p_lane, Body3DSW *p_body, bool p_writable) {
+	r_lanes.body[p_lane] = p_body;
+	r_lanes.writable[p_lane] = p_writable;
+
+	// Bodies that don't receive impulses behave as if they had infinite mass.
+	r_lanes.inv_mass.v[p_lane] = p_writable ? p_body->get_inv_mass() : 0.0;
+	for (int i = 0; i < 3; i++) {
+		r_lanes.inv_inertia[i].set(p_lane, p_writable ? p_body->get_inv_inertia_tensor().elements[i] : Vector3());
+	}
+}
+
+void ContactBatch3DSW::_gather_velocities(BodyLanes &r_lanes) {
+	for (int l = 0; l < LANES; l++) {
+		Body3DSW *body = r_lanes.body[l];
+		if (!body) {
+			continue;
+		}
+		r_lanes.linear_velocity.set(l, body->get_linear_velocity());
+		r_lanes.angular_velocity.set(l, body->get_angular_velocity());
+		r_lanes.biased_linear_velocity.set(l, body->get_biased_linear_velocity());
+		r_lanes.biased_angular_velocity.set(l, body->get_biased_angular_velocity());
+	}
+}
+
+void ContactBatch3DSW::_scatter_velocities(const BodyLanes &p_lanes) {
+	for (int l = 0; l < LANES; l++) {
+		if (!p_lanes.writable[l]) {
+			continue;
+		}
+		Body3DSW *body = p_lanes.body[l];
+		body->set_linear_velocity(p_lanes.linear_velocity.get(l));
+		body->set_angular_velocity(p_lanes.angular_velocity.get(l));
+		body->set_biased_linear_velocity(p_lanes.biased_linear_velocity.get(l));
+		body->set_biased_angular_velocity(p_lanes.biased_angular_velocity.get(l));
+	}
+}
+
+void ContactBatch3DSW::_solve_packet(uint32_t p_packet_index, void *p_userdata) {
+	Packet &packet = packets[p_packet_index];
+	BodyLanes &A = packet.A;
+	BodyLanes &B = packet.B;
+
+	_gather_velocities(A);
+	_gather_velocities(B);
+
+	const RealLanes zero = _splat(0.0);
+	const RealLanes one = _splat(1.0);
+	const RealLanes epsilon = _splat(CMP_EPSILON);
+	const RealLanes min_velocity = _splat(MIN_VELOCITY);
+	const RealLanes max_delta_av = _splat(max_bias_av);
+
+	const RealLanes inv_mass_sum = A.inv_mass + B.inv_mass;
+	const RealLanes safe_inv_mass_sum = _select(_greater(inv_mass_sum, zero), inv_mass_sum, one);
+
+	// Same steps as BodyPair3DSW::solve(), with every condition turned into a mask. Lanes without
+	// an active contact apply zero impulses. Divisions are done on safe values before selecting
+	// the results, so no lane can produce NaN or infinity.
+	for (int i = 0; i < BodyPair3DSW::MAX_CONTACTS; i++) {
+		ContactLanes &c = packet.contacts[i];
+		const Vector3Lanes &normal = c.normal;
+		const Vector3Lanes &rA = c.rA;
+		const Vector3Lanes &rB = c.rB;
+
+		// Bias impulse.
+
+		Vector3Lanes dbv = B.biased_linear_velocity + _cross(B.biased_angular_velocity, rB) - A.biased_linear_velocity - _cross(A.biased_angular_velocity, rA);
+		RealLanes bias_error = c.bias - _dot(dbv, normal);
+		const RealLanes apply_bias = c.active * _greater(_abs(bias_error), min_velocity);
+
+		RealLanes jbn_old = c.acc_bias_impulse;
+		c.acc_bias_impulse = _select(apply_bias, _max(jbn_old + bias_error * c.mass_normal, zero), jbn_old);
+
+		Vector3Lanes jb = normal * (c.acc_bias_impulse - jbn_old);
+
+		Vector3Lanes delta_av_A = _xform(A.inv_inertia, _cross(rA, -jb));
+		Vector3Lanes delta_av_B = _xform(B.inv_inertia, _cross(rB, jb));
+		RealLanes delta_av_A_length = _length(delta_av_A);
+		RealLanes delta_av_B_length = _length(delta_av_B);
+		delta_av_A = delta_av_A * _select(_greater(delta_av_A_length, max_delta_av), max_delta_av / _max(delta_av_A_length, epsilon), one);
+		delta_av_B = delta_av_B * _select(_greater(delta_av_B_length, max_delta_av), max_delta_av / _max(delta_av_B_length, epsilon), one);
+
+		A.biased_linear_velocity = A.biased_linear_velocity - jb * A.inv_mass;
+		A.biased_angular_velocity = A.biased_angular_velocity + delta_av_A;
+		B.biased_linear_velocity = B.biased_linear_velocity + jb * B.inv_mass;
+		B.biased_angular_velocity = B.biased_angular_velocity + delta_av_B;
+
+		// Bias impulse applied to the center of mass.
+
+		dbv = B.biased_linear_velocity + _cross(B.biased_angular_velocity, rB) - A.biased_linear_velocity - _cross(A.biased_angular_velocity, rA);
+		bias_error = c.bias - _dot(dbv, normal);
+		const RealLanes apply_bias_com = apply_bias * _greater(_abs(bias_error), min_velocity);
+
+		RealLanes jbn_com_old = c.acc_bias_impulse_center_of_mass;
+		RealLanes jbn_com = bias_error / safe_inv_mass_sum;
+		c.acc_bias_impulse_center_of_mass = _select(apply_bias_com, _max(jbn_com_old + jbn_com, zero), jbn_com_old);
+
+		Vector3Lanes jb_com = normal * (c.acc_bias_impulse_center_of_mass - jbn_com_old);
+
+		A.biased_linear_velocity = A.biased_linear_velocity - jb_com * A.inv_mass;
+		B.biased_linear_velocity = B.biased_linear_velocity + jb_com * B.inv_mass;
+
+		// Normal impulse.
+
+		Vector3Lanes dv = B.linear_velocity + _cross(B.angular_velocity, rB) - A.linear_velocity - _cross(A.angular_velocity, rA);
+		RealLanes vn = _dot(dv, normal);
+		const RealLanes apply_normal = c.active * _greater(_abs(vn), min_velocity);
+
+		RealLanes jn_old = c.acc_normal_impulse;
+		RealLanes jn = -(c.bounce + vn) * c.mass_normal;
+		c.acc_normal_impulse = _select(apply_normal, _max(jn_old + jn, zero), jn_old);
+
+		Vector3Lanes j = normal * (c.acc_normal_impulse - jn_old);
+
+		A.linear_velocity = A.linear_velocity - j * A.inv_mass;
+		A.angular_velocity = A.angular_velocity + _xform(A.inv_inertia, _cross(rA, -j));
+		B.linear_velocity = B.linear_velocity + j * B.inv_mass;
+		B.angular_velocity = B.angular_velocity + _xform(B.inv_inertia, _cross(rB, j));
+
+		// Friction impulse.
+
+		Vector3Lanes dtv = B.linear_velocity + _cross(B.angular_velocity, rB) - A.linear_velocity - _cross(A.angular_velocity, rA);
+		Vector3Lanes tv = dtv - normal * _dot(normal, dtv);
+		RealLanes tvl = _length(tv);
+		const RealLanes apply_friction = c.active * _greater(tvl, min_velocity);
+
+		tv = tv * _select(apply_friction, one / _max(tvl, min_velocity), zero);
+
+		Vector3Lanes temp1 = _xform(A.inv_inertia, _cross(rA, tv));
+		Vector3Lanes temp2 = _xform(B.inv_inertia, _cross(rB, tv));
+		RealLanes k_tangent = inv_mass_sum + _dot(tv, _cross(temp1, rA) + _cross(temp2, rB));
+		RealLanes t = -tvl / _select(_greater(k_tangent, zero), k_tangent, one);
+
+		Vector3Lanes jt_old = c.acc_tangent_impulse;
+		Vector3Lanes acc_tangent_impulse = jt_old + tv * t;
+
+		RealLanes fi_len = _length(acc_tangent_impulse);
+		RealLanes jt_max = c.acc_normal_impulse * packet.friction;
+		RealLanes clamp_friction = apply_friction * _greater(fi_len, epsilon) * _greater(fi_len, jt_max);
+		c.acc_tangent_impulse = acc_tangent_impulse * _select(clamp_friction, jt_max / _max(fi_len, epsilon), one);
+
+		Vector3Lanes jt = c.acc_tangent_impulse - jt_old;
+
+		A.linear_velocity = A.linear_velocity - jt * A.inv_mass;
+		A.angular_velocity = A.angular_velocity + _xform(A.inv_inertia, _cross(rA, -jt));
+		B.linear_velocity = B.linear_velocity + jt * B.inv_mass;
+		B.angular_velocity = B.angular_velocity + _xform(B.inv_inertia, _cross(rB, jt));
+
+		c.active = _max(apply_bias, _max(apply_normal, apply_friction));
+	}
+
+	_scatter_velocities(A);
+	_scatter_velocities(B);
+}
+
+void ContactBatch3DSW::clear() {
+	packet_count = 0;
+}
+
+void ContactBatch3DSW::add_pair(BodyPair3DSW *p_pair) {
+	if (packet_count == 0 || packets[packet_count - 1].pair_count == LANES) {
+		if (packet_count == packets.size()) {
+			packets.push_back(Packet());
+		}
+		memset(&packets[packet_count], 0, sizeof(Packet));
+		packet_count++;
+	}
+
+	Packet &packet = packets[packet_count - 1];
+	int l = packet.pair_count++;
+
+	packet.pairs[l] = p_pair;
+	packet.friction.v[l] = combine_friction(p_pair->A, p_pair->B);
+
+	_set_body_lane(packet.A, l, p_pair->A, p_pair->collide_A);
+	_set_body_lane(packet.B, l, p_pair->B, p_pair->collide_B);
+
+	for (int i = 0; i < p_pair->contact_count; i++) {
+		const BodyPair3DSW::Contact &contact = p_pair->contacts[i];
+		ContactLanes &c = packet.contacts[i];
+
+		c.active.v[l] = (p_pair->collided && contact.active) ? 1.0 : 0.0;
+		c.normal.set(l, contact.normal);
+		c.rA.set(l, contact.rA);
+		c.rB.set(l, contact.rB);
+		c.acc_tangent_impulse.set(l, contact.acc_tangent_impulse);
+		c.acc_normal_impulse.v[l] = contact.acc_normal_impulse;
+		c.acc_bias_impulse.v[l] = contact.acc_bias_impulse;
+		c.acc_bias_impulse_center_of_mass.v[l] = contact.acc_bias_impulse_center_of_mass;
+		c.mass_normal.v[l] = contact.mass_normal;
+		c.bias.v[l] = contact.bias;
+		c.bounce.v[l] = contact.bounce;
+	}
+}
+
+void ContactBatch3DSW::solve(real_t p_step) {
+	max_bias_av = MAX_BIAS_ROTATION / p_step;
+
+	if (packet_count > PACKET_THREADING_THRESHOLD) {
+		WorkerThreadPool::get_singleton()->do_work(packet_count, this, &ContactBatch3DSW::_solve_packet, (void *)nullptr);
+	} else {
+		for (uint32_t packet_index = 0; packet_index < packet_count; ++packet_index) {
+			_solve_packet(packet_index);
+		}
+	}
+}
+
+void ContactBatch3DSW::finish() {
+	for (uint32_t packet_index = 0; packet_index < packet_count; ++packet_index) {
+		const Packet &packet = packets[packet_index];
+		for (uint32_t l = 0; l < packet.pair_count; l++) {
+			BodyPair3DSW *pair = packet.pairs[l];
+			for (int i = 0; i < pair->contact_count; i++) {
+				BodyPair3DSW::Contact &contact = pair->contacts[i];
+				const ContactLanes &c = packet.contacts[i];
+
+				contact.active = c.active.v[l] != 0.0;
+				contact.acc_tangent_impulse = c.acc_tangent_impulse.get(l);
+				contact.acc_normal_impulse = c.acc_normal_impulse.v[l];
+				contact.acc_bias_impulse = c.acc_bias_impulse.v[l];
+				contact.acc_bias_impulse_center_of_mass = c.acc_bias_impulse_center_of_mass.v[l];
+			}
+		}
+	}
+}
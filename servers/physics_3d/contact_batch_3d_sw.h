@@ -0,0 +1,136 @@
+/*************************************************************************/
+/*  contact_batch_3d_sw.h                                                */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2021 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2021 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef CONTACT_BATCH_3D_SW_H
+#define CONTACT_BATCH_3D_SW_H
+
+#include "body_pair_3d_sw.h"
+
+#include "core/templates/local_vector.h"
+
+// Vector instruction sets used by the batched solver, it falls back to plain loops otherwise.
+#if !defined(REAL_T_IS_DOUBLE) && defined(__AVX__)
+#define CONTACT_BATCH_AVX
+#define CONTACT_BATCH_LANES 8
+#elif !defined(REAL_T_IS_DOUBLE) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define CONTACT_BATCH_SSE
+#define CONTACT_BATCH_LANES 4
+#elif !defined(REAL_T_IS_DOUBLE) && defined(__ARM_NEON) && defined(__aarch64__)
+#define CONTACT_BATCH_NEON
+#define CONTACT_BATCH_LANES 4
+#else
+#define CONTACT_BATCH_LANES 4
+#endif
+
+// Solves the contacts of many body pairs at once. Pairs are packed LANES at a time and their
+// bodies and contacts are gathered into structure of arrays, so every solver step runs on whole
+// packets with SSE/AVX/NEON instructions and no branches.
+// Pairs added to the same batch must not share any dynamic body (see Step3DSW constraint coloring).
+class ContactBatch3DSW {
+public:
+	enum {
+		LANES = CONTACT_BATCH_LANES,
+	};
+
+	// One value per pair in a packet. Masks use 1 and 0, so they have the same width as values.
+	struct RealLanes {
+		real_t v[LANES];
+	};
+
+	struct Vector3Lanes {
+		RealLanes x;
+		RealLanes y;
+		RealLanes z;
+
+		_FORCE_INLINE_ Vector3 get(int p_lane) const { return Vector3(x.v[p_lane], y.v[p_lane], z.v[p_lane]); }
+		_FORCE_INLINE_ void set(int p_lane, const Vector3 &p_value) {
+			x.v[p_lane] = p_value.x;
+			y.v[p_lane] = p_value.y;
+			z.v[p_lane] = p_value.z;
+		}
+	};
+
+private:
+	struct BodyLanes {
+		Body3DSW *body[LANES];
+		bool writable[LANES]; // Only bodies the pair collides with receive impulses.
+		RealLanes inv_mass;
+		Vector3Lanes inv_inertia[3]; // Rows of the inverse inertia tensor.
+		Vector3Lanes linear_velocity;
+		Vector3Lanes angular_velocity;
+		Vector3Lanes biased_linear_velocity;
+		Vector3Lanes biased_angular_velocity;
+	};
+
+	struct ContactLanes {
+		RealLanes active;
+		Vector3Lanes normal;
+		Vector3Lanes rA;
+		Vector3Lanes rB;
+		Vector3Lanes acc_tangent_impulse;
+		RealLanes acc_normal_impulse;
+		RealLanes acc_bias_impulse;
+		RealLanes acc_bias_impulse_center_of_mass;
+		RealLanes mass_normal;
+		RealLanes bias;
+		RealLanes bounce;
+	};
+
+	struct Packet {
+		BodyPair3DSW *pairs[LANES];
+		uint32_t pair_count;
+		RealLanes friction;
+		BodyLanes A;
+		BodyLanes B;
+		ContactLanes contacts[BodyPair3DSW::MAX_CONTACTS];
+	};
+
+	LocalVector<Packet> packets;
+	uint32_t packet_count = 0;
+	real_t max_bias_av = 0.0;
+
+	static void _set_body_lane(BodyLanes &r_lanes, int p_lane, Body3DSW *p_body, bool p_writable);
+	static void _gather_velocities(BodyLanes &r_lanes);
+	static void _scatter_velocities(const BodyLanes &p_lanes);
+
+	void _solve_packet(uint32_t p_packet_index, void *p_userdata = nullptr);
+
+public:
+	void clear();
+	void add_pair(BodyPair3DSW *p_pair);
+	_FORCE_INLINE_ bool is_empty() const { return packet_count == 0; }
+
+	// Runs one solver iteration over all pairs, reading and writing body velocities.
+	void solve(real_t p_step);
+	// Stores the accumulated impulses back into the pairs, for warm starting the next step.
+	void finish();
+};
+
+#endif // CONTACT_BATCH_3D_SW_H
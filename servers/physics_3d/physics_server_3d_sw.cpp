@@ -1593,11 +1593,17 @@ void PhysicsServer3DSW::step(real_t p_step) {
 	island_count = 0;
 	active_objects = 0;
 	collision_pairs = 0;
+	for (int i = 0; i < Space3DSW::ELAPSED_TIME_MAX; i++) {
+		elapsed_time[i] = 0;
+	}
 	for (Set<const Space3DSW *>::Element *E = active_spaces.front(); E; E = E->next()) {
 		stepper->step((Space3DSW *)E->get(), p_step, iterations);
 		island_count += E->get()->get_island_count();
 		active_objects += E->get()->get_active_objects();
 		collision_pairs += E->get()->get_collision_pairs();
+		for (int i = 0; i < Space3DSW::ELAPSED_TIME_MAX; i++) {
+			elapsed_time[i] += E->get()->get_elapsed_time(Space3DSW::ElapsedTime(i));
+		}
 	}
 #endif
 }
@@ -1624,34 +1630,26 @@ void PhysicsServer3DSW::flush_queries() {
 
 	flushing_queries = false;
 
+	flush_queries_time = OS::get_singleton()->get_ticks_usec() - time_beg;
+
 	if (EngineDebugger::is_profiling("servers")) {
-		uint64_t total_time[Space3DSW::ELAPSED_TIME_MAX];
 		static const char *time_name[Space3DSW::ELAPSED_TIME_MAX] = {
 			"integrate_forces",
 			"generate_islands",
 			"setup_constraints",
 			"solve_constraints",
-			"integrate_velocities"
+			"integrate_velocities",
+			"update_broadphase"
 		};
 
-		for (int i = 0; i < Space3DSW::ELAPSED_TIME_MAX; i++) {
-			total_time[i] = 0;
-		}
-
-		for (Set<const Space3DSW *>::Element *E = active_spaces.front(); E; E = E->next()) {
-			for (int i = 0; i < Space3DSW::ELAPSED_TIME_MAX; i++) {
-				total_time[i] += E->get()->get_elapsed_time(Space3DSW::ElapsedTime(i));
-			}
-		}
-
 		Array values;
 		values.resize(Space3DSW::ELAPSED_TIME_MAX * 2);
 		for (int i = 0; i < Space3DSW::ELAPSED_TIME_MAX; i++) {
 			values[i * 2 + 0] = time_name[i];
-			values[i * 2 + 1] = USEC_TO_SEC(total_time[i]);
+			values[i * 2 + 1] = USEC_TO_SEC(elapsed_time[i]);
 		}
 		values.push_back("flush_queries");
-		values.push_back(USEC_TO_SEC(OS::get_singleton()->get_ticks_usec() - time_beg));
+		values.push_back(USEC_TO_SEC(flush_queries_time));
 
 		values.push_front("physics");
 		EngineDebugger::profiler_add_frame_data("servers", values);
@@ -1679,6 +1677,27 @@ int PhysicsServer3DSW::get_process_info(ProcessInfo p_info) {
 		case INFO_ISLAND_COUNT: {
 			return island_count;
 		} break;
+		case INFO_INTEGRATE_FORCES_TIME: {
+			return elapsed_time[Space3DSW::ELAPSED_TIME_INTEGRATE_FORCES];
+		} break;
+		case INFO_GENERATE_ISLANDS_TIME: {
+			return elapsed_time[Space3DSW::ELAPSED_TIME_GENERATE_ISLANDS];
+		} break;
+		case INFO_SETUP_CONSTRAINTS_TIME: {
+			return elapsed_time[Space3DSW::ELAPSED_TIME_SETUP_CONSTRAINTS];
+		} break;
+		case INFO_SOLVE_CONSTRAINTS_TIME: {
+			return elapsed_time[Space3DSW::ELAPSED_TIME_SOLVE_CONSTRAINTS];
+		} break;
+		case INFO_INTEGRATE_VELOCITIES_TIME: {
+			return elapsed_time[Space3DSW::ELAPSED_TIME_INTEGRATE_VELOCITIES];
+		} break;
+		case INFO_UPDATE_BROADPHASE_TIME: {
+			return elapsed_time[Space3DSW::ELAPSED_TIME_UPDATE_BROADPHASE];
+		} break;
+		case INFO_FLUSH_QUERIES_TIME: {
+			return flush_queries_time;
+		} break;
 	}
 
 	return 0;
@@ -1732,6 +1751,10 @@ PhysicsServer3DSW::PhysicsServer3DSW(bool p_using_threads) {
 	island_count = 0;
 	active_objects = 0;
 	collision_pairs = 0;
+	for (int i = 0; i < Space3DSW::ELAPSED_TIME_MAX; i++) {
+		elapsed_time[i] = 0;
+	}
+	flush_queries_time = 0;
 	using_threads = p_using_threads;
 	active = true;
 	flushing_queries = false;
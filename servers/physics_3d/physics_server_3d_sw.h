@@ -50,6 +50,9 @@ class PhysicsServer3DSW : public PhysicsServer3D {
 	int active_objects;
 	int collision_pairs;
 
+	uint64_t elapsed_time[Space3DSW::ELAPSED_TIME_MAX];
+	uint64_t flush_queries_time;
+
 	bool using_threads;
 	bool doing_sync;
 	bool flushing_queries;
@@ -107,6 +107,7 @@ class SoftBody3DSW : public CollisionObject3DSW {
 	VSet<RID> exceptions;
 
 	uint64_t island_step = 0;
+	uint64_t constraint_color_mask = 0;
 
 public:
 	SoftBody3DSW();
@@ -129,6 +130,9 @@ public:
 	_FORCE_INLINE_ uint64_t get_island_step() const { return island_step; }
 	_FORCE_INLINE_ void set_island_step(uint64_t p_step) { island_step = p_step; }
 
+	_FORCE_INLINE_ uint64_t get_constraint_color_mask() const { return constraint_color_mask; }
+	_FORCE_INLINE_ void set_constraint_color_mask(uint64_t p_mask) { constraint_color_mask = p_mask; }
+
 	virtual void set_space(Space3DSW *p_space);
 
 	void set_mesh(const Ref<Mesh> &p_mesh);
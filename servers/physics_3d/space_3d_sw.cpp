@@ -32,8 +32,11 @@
 
 #include "collision_solver_3d_sw.h"
 #include "core/config/project_settings.h"
+#include "core/os/worker_thread_pool.h"
 #include "physics_server_3d_sw.h"
 
+#define QUERY_BATCH_SLICE_MIN_SIZE 32
+
 _FORCE_INLINE_ static bool _can_collide_with(CollisionObject3DSW *p_object, uint32_t p_collision_mask, bool p_collide_with_bodies, bool p_collide_with_areas) {
 	if (!(p_object->get_collision_layer() & p_collision_mask)) {
 		return false;
@@ -104,13 +107,17 @@ int PhysicsDirectSpaceState3DSW::intersect_point(const Vector3 &p_point, ShapeRe
 bool PhysicsDirectSpaceState3DSW::intersect_ray(const Vector3 &p_from, const Vector3 &p_to, RayResult &r_result, const Set<RID> &p_exclude, uint32_t p_collision_mask, bool p_collide_with_bodies, bool p_collide_with_areas, bool p_pick_ray) {
 	ERR_FAIL_COND_V(space->locked, false);
 
+	return _intersect_ray(p_from, p_to, r_result, p_exclude, p_collision_mask, p_collide_with_bodies, p_collide_with_areas, p_pick_ray, space->intersection_query_results, space->intersection_query_subindex_results);
+}
+
+bool PhysicsDirectSpaceState3DSW::_intersect_ray(const Vector3 &p_from, const Vector3 &p_to, RayResult &r_result, const Set<RID> &p_exclude, uint32_t p_collision_mask, bool p_collide_with_bodies, bool p_collide_with_areas, bool p_pick_ray, CollisionObject3DSW **r_cull_results, int *r_cull_subindex_results) const {
 	Vector3 begin, end;
 	Vector3 normal;
 	begin = p_from;
 	end = p_to;
 	normal = (end - begin).normalized();
 
-	int amount = space->broadphase->cull_segment(begin, end, space->intersection_query_results, Space3DSW::INTERSECTION_QUERY_MAX, space->intersection_query_subindex_results);
+	int amount = space->broadphase->cull_segment(begin, end, r_cull_results, Space3DSW::INTERSECTION_QUERY_MAX, r_cull_subindex_results);
 
 	//todo, create another array that references results, compute AABBs and check closest point to ray origin, sort, and stop evaluating results when beyond first collision
 
@@ -121,21 +128,21 @@ bool PhysicsDirectSpaceState3DSW::intersect_ray(const Vector3 &p_from, const Vec
 	real_t min_d = 1e10;
 
 	for (int i = 0; i < amount; i++) {
-		if (!_can_collide_with(space->intersection_query_results[i], p_collision_mask, p_collide_with_bodies, p_collide_with_areas)) {
+		if (!_can_collide_with(r_cull_results[i], p_collision_mask, p_collide_with_bodies, p_collide_with_areas)) {
 			continue;
 		}
 
-		if (p_pick_ray && !(space->intersection_query_results[i]->is_ray_pickable())) {
+		if (p_pick_ray && !(r_cull_results[i]->is_ray_pickable())) {
 			continue;
 		}
 
-		if (p_exclude.has(space->intersection_query_results[i]->get_self())) {
+		if (p_exclude.has(r_cull_results[i]->get_self())) {
 			continue;
 		}
 
-		const CollisionObject3DSW *col_obj = space->intersection_query_results[i];
+		const CollisionObject3DSW *col_obj = r_cull_results[i];
 
-		int shape_idx = space->intersection_query_subindex_results[i];
+		int shape_idx = r_cull_subindex_results[i];
 		Transform3D inv_xform = col_obj->get_shape_inv_transform(shape_idx) * col_obj->get_inv_transform();
 
 		Vector3 local_from = inv_xform.xform(begin);
@@ -239,18 +246,24 @@ bool PhysicsDirectSpaceState3DSW::cast_motion(const RID &p_shape, const Transfor
 	Shape3DSW *shape = PhysicsServer3DSW::singletonsw->shape_owner.getornull(p_shape);
 	ERR_FAIL_COND_V(!shape, false);
 
-	AABB aabb = p_xform.xform(shape->get_aabb());
+	_cast_motion(shape, p_xform, p_motion, p_margin, p_closest_safe, p_closest_unsafe, p_exclude, p_collision_mask, p_collide_with_bodies, p_collide_with_areas, r_info, space->intersection_query_results, space->intersection_query_subindex_results);
+
+	return true;
+}
+
+void PhysicsDirectSpaceState3DSW::_cast_motion(Shape3DSW *p_shape, const Transform3D &p_xform, const Vector3 &p_motion, real_t p_margin, real_t &p_closest_safe, real_t &p_closest_unsafe, const Set<RID> &p_exclude, uint32_t p_collision_mask, bool p_collide_with_bodies, bool p_collide_with_areas, ShapeRestInfo *r_info, CollisionObject3DSW **r_cull_results, int *r_cull_subindex_results) const {
+	AABB aabb = p_xform.xform(p_shape->get_aabb());
 	aabb = aabb.merge(AABB(aabb.position + p_motion, aabb.size)); //motion
 	aabb = aabb.grow(p_margin);
 
-	int amount = space->broadphase->cull_aabb(aabb, space->intersection_query_results, Space3DSW::INTERSECTION_QUERY_MAX, space->intersection_query_subindex_results);
+	int amount = space->broadphase->cull_aabb(aabb, r_cull_results, Space3DSW::INTERSECTION_QUERY_MAX, r_cull_subindex_results);
 
 	real_t best_safe = 1;
 	real_t best_unsafe = 1;
 
 	Transform3D xform_inv = p_xform.affine_inverse();
 	MotionShape3DSW mshape;
-	mshape.shape = shape;
+	mshape.shape = p_shape;
 	mshape.motion = xform_inv.basis.xform(p_motion);
 
 	bool best_first = true;
@@ -260,16 +273,16 @@ bool PhysicsDirectSpaceState3DSW::cast_motion(const RID &p_shape, const Transfor
 	Vector3 closest_A, closest_B;
 
 	for (int i = 0; i < amount; i++) {
-		if (!_can_collide_with(space->intersection_query_results[i], p_collision_mask, p_collide_with_bodies, p_collide_with_areas)) {
+		if (!_can_collide_with(r_cull_results[i], p_collision_mask, p_collide_with_bodies, p_collide_with_areas)) {
 			continue;
 		}
 
-		if (p_exclude.has(space->intersection_query_results[i]->get_self())) {
+		if (p_exclude.has(r_cull_results[i]->get_self())) {
 			continue; //ignore excluded
 		}
 
-		const CollisionObject3DSW *col_obj = space->intersection_query_results[i];
-		int shape_idx = space->intersection_query_subindex_results[i];
+		const CollisionObject3DSW *col_obj = r_cull_results[i];
+		int shape_idx = r_cull_subindex_results[i];
 
 		Vector3 point_A, point_B;
 		Vector3 sep_axis = motion_normal;
@@ -283,7 +296,7 @@ bool PhysicsDirectSpaceState3DSW::cast_motion(const RID &p_shape, const Transfor
 		//test initial overlap, ignore objects it's inside of.
 		sep_axis = motion_normal;
 
-		if (!CollisionSolver3DSW::solve_distance(shape, p_xform, col_obj->get_shape(shape_idx), col_obj_xform, point_A, point_B, aabb, &sep_axis)) {
+		if (!CollisionSolver3DSW::solve_distance(p_shape, p_xform, col_obj->get_shape(shape_idx), col_obj_xform, point_A, point_B, aabb, &sep_axis)) {
 			continue;
 		}
 
@@ -350,8 +363,149 @@ bool PhysicsDirectSpaceState3DSW::cast_motion(const RID &p_shape, const Transfor
 
 	p_closest_safe = best_safe;
 	p_closest_unsafe = best_unsafe;
+}
 
-	return true;
+struct PhysicsDirectSpaceState3DSW::RayBatch {
+	const Vector3 *from = nullptr;
+	const Vector3 *to = nullptr;
+	RayResult *results = nullptr;
+	uint32_t ray_count = 0;
+
+	const Set<RID> *exclude = nullptr;
+	uint32_t collision_mask = 0;
+	bool collide_with_bodies = true;
+	bool collide_with_areas = false;
+
+	uint32_t slice_count = 0;
+	LocalVector<CollisionObject3DSW *> cull_results;
+	LocalVector<int> cull_subindex_results;
+};
+
+struct PhysicsDirectSpaceState3DSW::MotionBatch {
+	Shape3DSW *shape = nullptr;
+	const Transform3D *xforms = nullptr;
+	const Vector3 *motions = nullptr;
+	real_t margin = 0.0;
+	real_t *closest_safe = nullptr;
+	real_t *closest_unsafe = nullptr;
+	uint32_t cast_count = 0;
+
+	const Set<RID> *exclude = nullptr;
+	uint32_t collision_mask = 0;
+	bool collide_with_bodies = true;
+	bool collide_with_areas = false;
+
+	uint32_t slice_count = 0;
+	LocalVector<CollisionObject3DSW *> cull_results;
+	LocalVector<int> cull_subindex_results;
+};
+
+// Splits batched queries in slices of at least QUERY_BATCH_SLICE_MIN_SIZE queries, one per worker at most.
+static uint32_t _get_query_batch_slice_count(uint32_t p_query_count) {
+	uint32_t slice_count = (p_query_count + QUERY_BATCH_SLICE_MIN_SIZE - 1) / QUERY_BATCH_SLICE_MIN_SIZE;
+	return CLAMP(slice_count, 1u, (uint32_t)WorkerThreadPool::get_singleton()->get_thread_count());
+}
+
+void PhysicsDirectSpaceState3DSW::_intersect_ray_slice(uint32_t p_slice, RayBatch *p_batch) {
+	uint32_t from = p_slice * p_batch->ray_count / p_batch->slice_count;
+	uint32_t to = (p_slice + 1) * p_batch->ray_count / p_batch->slice_count;
+
+	CollisionObject3DSW **cull_results = &p_batch->cull_results[p_slice * Space3DSW::INTERSECTION_QUERY_MAX];
+	int *cull_subindex_results = &p_batch->cull_subindex_results[p_slice * Space3DSW::INTERSECTION_QUERY_MAX];
+
+	for (uint32_t i = from; i < to; i++) {
+		RayResult &result = p_batch->results[i];
+		result = RayResult();
+		_intersect_ray(p_batch->from[i], p_batch->to[i], result, *p_batch->exclude, p_batch->collision_mask, p_batch->collide_with_bodies, p_batch->collide_with_areas, false, cull_results, cull_subindex_results);
+	}
+}
+
+int PhysicsDirectSpaceState3DSW::intersect_rays(const Vector3 *p_from, const Vector3 *p_to, int p_ray_count, RayResult *r_results, const Set<RID> &p_exclude, uint32_t p_collision_mask, bool p_collide_with_bodies, bool p_collide_with_areas) {
+	ERR_FAIL_COND_V(space->locked, 0);
+	if (p_ray_count <= 0) {
+		return 0;
+	}
+
+	RayBatch batch;
+	batch.from = p_from;
+	batch.to = p_to;
+	batch.results = r_results;
+	batch.ray_count = p_ray_count;
+	batch.exclude = &p_exclude;
+	batch.collision_mask = p_collision_mask;
+	batch.collide_with_bodies = p_collide_with_bodies;
+	batch.collide_with_areas = p_collide_with_areas;
+	batch.slice_count = _get_query_batch_slice_count(p_ray_count);
+	batch.cull_results.resize(batch.slice_count * Space3DSW::INTERSECTION_QUERY_MAX);
+	batch.cull_subindex_results.resize(batch.slice_count * Space3DSW::INTERSECTION_QUERY_MAX);
+
+	if (batch.slice_count > 1) {
+		WorkerThreadPool::get_singleton()->do_work(batch.slice_count, this, &PhysicsDirectSpaceState3DSW::_intersect_ray_slice, &batch);
+	} else {
+		_intersect_ray_slice(0, &batch);
+	}
+
+	int hit_count = 0;
+	for (int i = 0; i < p_ray_count; i++) {
+		if (r_results[i].rid.is_valid()) {
+			hit_count++;
+		}
+	}
+
+	return hit_count;
+}
+
+void PhysicsDirectSpaceState3DSW::_cast_motion_slice(uint32_t p_slice, MotionBatch *p_batch) {
+	uint32_t from = p_slice * p_batch->cast_count / p_batch->slice_count;
+	uint32_t to = (p_slice + 1) * p_batch->cast_count / p_batch->slice_count;
+
+	CollisionObject3DSW **cull_results = &p_batch->cull_results[p_slice * Space3DSW::INTERSECTION_QUERY_MAX];
+	int *cull_subindex_results = &p_batch->cull_subindex_results[p_slice * Space3DSW::INTERSECTION_QUERY_MAX];
+
+	for (uint32_t i = from; i < to; i++) {
+		_cast_motion(p_batch->shape, p_batch->xforms[i], p_batch->motions[i], p_batch->margin, p_batch->closest_safe[i], p_batch->closest_unsafe[i], *p_batch->exclude, p_batch->collision_mask, p_batch->collide_with_bodies, p_batch->collide_with_areas, nullptr, cull_results, cull_subindex_results);
+	}
+}
+
+int PhysicsDirectSpaceState3DSW::cast_motions(const RID &p_shape, const Transform3D *p_xforms, const Vector3 *p_motions, int p_cast_count, real_t p_margin, real_t *r_closest_safe, real_t *r_closest_unsafe, const Set<RID> &p_exclude, uint32_t p_collision_mask, bool p_collide_with_bodies, bool p_collide_with_areas) {
+	ERR_FAIL_COND_V(space->locked, 0);
+	if (p_cast_count <= 0) {
+		return 0;
+	}
+
+	Shape3DSW *shape = PhysicsServer3DSW::singletonsw->shape_owner.getornull(p_shape);
+	ERR_FAIL_COND_V(!shape, 0);
+
+	MotionBatch batch;
+	batch.shape = shape;
+	batch.xforms = p_xforms;
+	batch.motions = p_motions;
+	batch.margin = p_margin;
+	batch.closest_safe = r_closest_safe;
+	batch.closest_unsafe = r_closest_unsafe;
+	batch.cast_count = p_cast_count;
+	batch.exclude = &p_exclude;
+	batch.collision_mask = p_collision_mask;
+	batch.collide_with_bodies = p_collide_with_bodies;
+	batch.collide_with_areas = p_collide_with_areas;
+	batch.slice_count = _get_query_batch_slice_count(p_cast_count);
+	batch.cull_results.resize(batch.slice_count * Space3DSW::INTERSECTION_QUERY_MAX);
+	batch.cull_subindex_results.resize(batch.slice_count * Space3DSW::INTERSECTION_QUERY_MAX);
+
+	if (batch.slice_count > 1) {
+		WorkerThreadPool::get_singleton()->do_work(batch.slice_count, this, &PhysicsDirectSpaceState3DSW::_cast_motion_slice, &batch);
+	} else {
+		_cast_motion_slice(0, &batch);
+	}
+
+	int hit_count = 0;
+	for (int i = 0; i < p_cast_count; i++) {
+		if (r_closest_unsafe[i] < 1.0) {
+			hit_count++;
+		}
+	}
+
+	return hit_count;
 }
 
 bool PhysicsDirectSpaceState3DSW::collide_shape(RID p_shape, const Transform3D &p_shape_xform, real_t p_margin, Vector3 *r_results, int p_result_max, int &r_result_count, const Set<RID> &p_exclude, uint32_t p_collision_mask, bool p_collide_with_bodies, bool p_collide_with_areas) {
@@ -1148,6 +1302,11 @@ Space3DSW::Space3DSW() {
 	ProjectSettings::get_singleton()->set_custom_property_info("physics/3d/time_before_sleep", PropertyInfo(Variant::FLOAT, "physics/3d/time_before_sleep", PROPERTY_HINT_RANGE, "0,5,0.01,or_greater"));
 	body_angular_velocity_damp_ratio = 10;
 
+	large_island_threshold = GLOBAL_DEF("physics/3d/solver/large_island_threshold", 256);
+	ProjectSettings::get_singleton()->set_custom_property_info("physics/3d/solver/large_island_threshold", PropertyInfo(Variant::INT, "physics/3d/solver/large_island_threshold", PROPERTY_HINT_RANGE, "0,4096,1,or_greater"));
+	batched_contact_solver = GLOBAL_DEF("physics/3d/solver/batched_contact_solver", false);
+	deterministic = GLOBAL_DEF("physics/3d/solver/deterministic", false);
+
 	broadphase = BroadPhase3DSW::create_func();
 	broadphase->set_pair_callback(_broadphase_pair, this);
 	broadphase->set_unpair_callback(_broadphase_unpair, this);
@@ -45,6 +45,16 @@
 class PhysicsDirectSpaceState3DSW : public PhysicsDirectSpaceState3D {
 	GDCLASS(PhysicsDirectSpaceState3DSW, PhysicsDirectSpaceState3D);
 
+	struct RayBatch;
+	struct MotionBatch;
+
+	// The cull results are passed in, so batched queries can use one buffer per worker instead of the space's.
+	bool _intersect_ray(const Vector3 &p_from, const Vector3 &p_to, RayResult &r_result, const Set<RID> &p_exclude, uint32_t p_collision_mask, bool p_collide_with_bodies, bool p_collide_with_areas, bool p_pick_ray, CollisionObject3DSW **r_cull_results, int *r_cull_subindex_results) const;
+	void _cast_motion(Shape3DSW *p_shape, const Transform3D &p_xform, const Vector3 &p_motion, real_t p_margin, real_t &p_closest_safe, real_t &p_closest_unsafe, const Set<RID> &p_exclude, uint32_t p_collision_mask, bool p_collide_with_bodies, bool p_collide_with_areas, ShapeRestInfo *r_info, CollisionObject3DSW **r_cull_results, int *r_cull_subindex_results) const;
+
+	void _intersect_ray_slice(uint32_t p_slice, RayBatch *p_batch);
+	void _cast_motion_slice(uint32_t p_slice, MotionBatch *p_batch);
+
 public:
 	Space3DSW *space;
 
@@ -52,6 +62,8 @@ public:
 	virtual bool intersect_ray(const Vector3 &p_from, const Vector3 &p_to, RayResult &r_result, const Set<RID> &p_exclude = Set<RID>(), uint32_t p_collision_mask = 0xFFFFFFFF, bool p_collide_with_bodies = true, bool p_collide_with_areas = false, bool p_pick_ray = false) override;
 	virtual int intersect_shape(const RID &p_shape, const Transform3D &p_xform, real_t p_margin, ShapeResult *r_results, int p_result_max, const Set<RID> &p_exclude = Set<RID>(), uint32_t p_collision_mask = 0xFFFFFFFF, bool p_collide_with_bodies = true, bool p_collide_with_areas = false) override;
 	virtual bool cast_motion(const RID &p_shape, const Transform3D &p_xform, const Vector3 &p_motion, real_t p_margin, real_t &p_closest_safe, real_t &p_closest_unsafe, const Set<RID> &p_exclude = Set<RID>(), uint32_t p_collision_mask = 0xFFFFFFFF, bool p_collide_with_bodies = true, bool p_collide_with_areas = false, ShapeRestInfo *r_info = nullptr) override;
+	virtual int intersect_rays(const Vector3 *p_from, const Vector3 *p_to, int p_ray_count, RayResult *r_results, const Set<RID> &p_exclude = Set<RID>(), uint32_t p_collision_mask = 0xFFFFFFFF, bool p_collide_with_bodies = true, bool p_collide_with_areas = false) override;
+	virtual int cast_motions(const RID &p_shape, const Transform3D *p_xforms, const Vector3 *p_motions, int p_cast_count, real_t p_margin, real_t *r_closest_safe, real_t *r_closest_unsafe, const Set<RID> &p_exclude = Set<RID>(), uint32_t p_collision_mask = 0xFFFFFFFF, bool p_collide_with_bodies = true, bool p_collide_with_areas = false) override;
 	virtual bool collide_shape(RID p_shape, const Transform3D &p_shape_xform, real_t p_margin, Vector3 *r_results, int p_result_max, int &r_result_count, const Set<RID> &p_exclude = Set<RID>(), uint32_t p_collision_mask = 0xFFFFFFFF, bool p_collide_with_bodies = true, bool p_collide_with_areas = false) override;
 	virtual bool rest_info(RID p_shape, const Transform3D &p_shape_xform, real_t p_margin, ShapeRestInfo *r_info, const Set<RID> &p_exclude = Set<RID>(), uint32_t p_collision_mask = 0xFFFFFFFF, bool p_collide_with_bodies = true, bool p_collide_with_areas = false) override;
 	virtual Vector3 get_closest_point_to_object_volume(RID p_object, const Vector3 p_point) const override;
@@ -67,6 +79,7 @@ public:
 		ELAPSED_TIME_SETUP_CONSTRAINTS,
 		ELAPSED_TIME_SOLVE_CONSTRAINTS,
 		ELAPSED_TIME_INTEGRATE_VELOCITIES,
+		ELAPSED_TIME_UPDATE_BROADPHASE,
 		ELAPSED_TIME_MAX
 
 	};
@@ -110,6 +123,10 @@ private:
 	real_t body_time_to_sleep;
 	real_t body_angular_velocity_damp_ratio;
 
+	int large_island_threshold;
+	bool batched_contact_solver;
+	bool deterministic;
+
 	bool locked;
 
 	int island_count;
@@ -165,6 +182,9 @@ public:
 	_FORCE_INLINE_ real_t get_body_angular_velocity_sleep_threshold() const { return body_angular_velocity_sleep_threshold; }
 	_FORCE_INLINE_ real_t get_body_time_to_sleep() const { return body_time_to_sleep; }
 	_FORCE_INLINE_ real_t get_body_angular_velocity_damp_ratio() const { return body_angular_velocity_damp_ratio; }
+	_FORCE_INLINE_ int get_large_island_threshold() const { return large_island_threshold; }
+	_FORCE_INLINE_ bool is_batched_contact_solver_enabled() const { return batched_contact_solver; }
+	_FORCE_INLINE_ bool is_deterministic() const { return deterministic; }
 
 	void update();
 	void setup();
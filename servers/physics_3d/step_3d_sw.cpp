@@ -38,6 +38,7 @@
 #define ISLAND_COUNT_RESERVE 128
 #define ISLAND_SIZE_RESERVE 512
 #define CONSTRAINT_COUNT_RESERVE 1024
+#define CONSTRAINT_BATCH_CHUNK_SIZE 16
 
 void Step3DSW::_populate_island(Body3DSW *p_body, LocalVector<Body3DSW *> &p_body_island, LocalVector<Constraint3DSW *> &p_constraint_island) {
 	p_body->set_island_step(_step);
@@ -110,8 +111,33 @@ void Step3DSW::_populate_island_soft_body(SoftBody3DSW *p_soft_body, LocalVector
 	}
 }
 
+struct ConstraintCreationOrder {
+	_FORCE_INLINE_ bool operator()(const Constraint3DSW *p_a, const Constraint3DSW *p_b) const {
+		return p_a->get_creation_order() < p_b->get_creation_order();
+	}
+};
+
+void Step3DSW::_sort_island(LocalVector<Constraint3DSW *> &p_constraint_island) const {
+	// Islands are gathered following maps sorted by address, which changes between runs.
+	p_constraint_island.sort_custom<ConstraintCreationOrder>();
+}
+
+bool Step3DSW::_needs_ordered_setup(const Constraint3DSW *p_constraint) const {
+	// Continuous collision detection changes the velocity of the bodies during setup,
+	// so in deterministic spaces these constraints are set up one after the other.
+	for (int i = 0; i < p_constraint->get_body_count(); i++) {
+		if (p_constraint->get_body_ptr()[i]->is_continuous_collision_detection_enabled()) {
+			return true;
+		}
+	}
+	return false;
+}
+
 void Step3DSW::_setup_contraint(uint32_t p_constraint_index, void *p_userdata) {
 	Constraint3DSW *constraint = all_constraints[p_constraint_index];
+	if (deterministic && _needs_ordered_setup(constraint)) {
+		return;
+	}
 	constraint->setup(delta);
 }
 
@@ -156,6 +182,142 @@ void Step3DSW::_solve_island(uint32_t p_island_index, void *p_userdata) {
 	}
 }
 
+void Step3DSW::_solve_small_island(uint32_t p_index, void *p_userdata) {
+	_solve_island(small_islands[p_index]);
+}
+
+void Step3DSW::_color_constraints(const LocalVector<Constraint3DSW *> &p_constraint_island, uint32_t p_constraint_count) {
+	for (uint32_t color = 0; color <= CONSTRAINT_COLOR_MAX; ++color) {
+		constraint_colors[color].clear();
+	}
+
+	for (uint32_t constraint_index = 0; constraint_index < p_constraint_count; ++constraint_index) {
+		Constraint3DSW *constraint = p_constraint_island[constraint_index];
+		for (int i = 0; i < constraint->get_body_count(); i++) {
+			constraint->get_body_ptr()[i]->set_constraint_color_mask(0);
+		}
+		for (int i = 0; i < constraint->get_soft_body_count(); i++) {
+			constraint->get_soft_body_ptr(i)->set_constraint_color_mask(0);
+		}
+	}
+
+	// Greedy coloring: each constraint takes the first color not used yet by any body it writes to.
+	// Static and kinematic bodies only get read during solving, so they can be shared within a color.
+	for (uint32_t constraint_index = 0; constraint_index < p_constraint_count; ++constraint_index) {
+		Constraint3DSW *constraint = p_constraint_island[constraint_index];
+
+		uint64_t used_colors = 0;
+		for (int i = 0; i < constraint->get_body_count(); i++) {
+			Body3DSW *body = constraint->get_body_ptr()[i];
+			if (body->get_mode() > PhysicsServer3D::BODY_MODE_KINEMATIC) {
+				used_colors |= body->get_constraint_color_mask();
+			}
+		}
+		for (int i = 0; i < constraint->get_soft_body_count(); i++) {
+			used_colors |= constraint->get_soft_body_ptr(i)->get_constraint_color_mask();
+		}
+
+		uint32_t color = 0;
+		while (color < CONSTRAINT_COLOR_MAX && (used_colors & (uint64_t(1) << color))) {
+			++color;
+		}
+
+		if (color < CONSTRAINT_COLOR_MAX) {
+			uint64_t color_bit = uint64_t(1) << color;
+			for (int i = 0; i < constraint->get_body_count(); i++) {
+				Body3DSW *body = constraint->get_body_ptr()[i];
+				if (body->get_mode() > PhysicsServer3D::BODY_MODE_KINEMATIC) {
+					body->set_constraint_color_mask(body->get_constraint_color_mask() | color_bit);
+				}
+			}
+			for (int i = 0; i < constraint->get_soft_body_count(); i++) {
+				SoftBody3DSW *soft_body = constraint->get_soft_body_ptr(i);
+				soft_body->set_constraint_color_mask(soft_body->get_constraint_color_mask() | color_bit);
+			}
+		}
+
+		constraint_colors[color].push_back(constraint);
+	}
+}
+
+void Step3DSW::_solve_constraint_batch(uint32_t p_chunk_index, LocalVector<Constraint3DSW *> *p_batch) {
+	uint32_t from = p_chunk_index * CONSTRAINT_BATCH_CHUNK_SIZE;
+	uint32_t to = MIN(from + CONSTRAINT_BATCH_CHUNK_SIZE, p_batch->size());
+	for (uint32_t constraint_index = from; constraint_index < to; ++constraint_index) {
+		(*p_batch)[constraint_index]->solve(delta);
+	}
+}
+
+void Step3DSW::_batch_contacts() {
+	for (uint32_t color = 0; color < CONSTRAINT_COLOR_MAX; ++color) {
+		ContactBatch3DSW &contact_batch = contact_batches[color];
+		contact_batch.clear();
+
+		// Body pairs go to the contact batch, other constraints stay in the color.
+		LocalVector<Constraint3DSW *> &batch = constraint_colors[color];
+		uint32_t remaining_count = 0;
+		for (uint32_t constraint_index = 0; constraint_index < batch.size(); ++constraint_index) {
+			Constraint3DSW *constraint = batch[constraint_index];
+			if (constraint->is_body_pair()) {
+				contact_batch.add_pair(static_cast<BodyPair3DSW *>(constraint));
+			} else {
+				batch[remaining_count++] = constraint;
+			}
+		}
+		batch.resize(remaining_count);
+	}
+}
+
+void Step3DSW::_solve_large_island(LocalVector<Constraint3DSW *> &p_constraint_island) {
+	int current_priority = 1;
+
+	uint32_t constraint_count = p_constraint_island.size();
+	while (constraint_count > 0) {
+		_color_constraints(p_constraint_island, constraint_count);
+
+		if (use_contact_batches) {
+			_batch_contacts();
+		}
+
+		for (int i = 0; i < iterations; i++) {
+			// Colors are solved one after the other, constraints within a color in parallel.
+			for (uint32_t color = 0; color <= CONSTRAINT_COLOR_MAX; ++color) {
+				if (use_contact_batches && color < CONSTRAINT_COLOR_MAX && !contact_batches[color].is_empty()) {
+					contact_batches[color].solve(delta);
+				}
+
+				LocalVector<Constraint3DSW *> &batch = constraint_colors[color];
+				uint32_t chunk_count = (batch.size() + CONSTRAINT_BATCH_CHUNK_SIZE - 1) / CONSTRAINT_BATCH_CHUNK_SIZE;
+				if (color < CONSTRAINT_COLOR_MAX && chunk_count > 1) {
+					WorkerThreadPool::get_singleton()->do_work(chunk_count, this, &Step3DSW::_solve_constraint_batch, &batch);
+				} else {
+					for (uint32_t constraint_index = 0; constraint_index < batch.size(); ++constraint_index) {
+						batch[constraint_index]->solve(delta);
+					}
+				}
+			}
+		}
+
+		if (use_contact_batches) {
+			for (uint32_t color = 0; color < CONSTRAINT_COLOR_MAX; ++color) {
+				contact_batches[color].finish();
+			}
+		}
+
+		// Check priority to keep only higher priority constraints.
+		uint32_t priority_constraint_count = 0;
+		++current_priority;
+		for (uint32_t constraint_index = 0; constraint_index < constraint_count; ++constraint_index) {
+			Constraint3DSW *constraint = p_constraint_island[constraint_index];
+			if (constraint->get_priority() >= current_priority) {
+				// Keep this constraint for the next iteration.
+				p_constraint_island[priority_constraint_count++] = constraint;
+			}
+		}
+		constraint_count = priority_constraint_count;
+	}
+}
+
 void Step3DSW::_check_suspend(const LocalVector<Body3DSW *> &p_body_island) const {
 	bool can_sleep = true;
 
@@ -187,6 +349,8 @@ void Step3DSW::step(Space3DSW *p_space, real_t p_delta, int p_iterations) {
 
 	iterations = p_iterations;
 	delta = p_delta;
+	use_contact_batches = p_space->is_batched_contact_solver_enabled();
+	deterministic = p_space->is_deterministic();
 
 	const SelfList<Body3DSW>::List *body_list = &p_space->get_active_body_list();
 
@@ -279,6 +443,10 @@ void Step3DSW::step(Space3DSW *p_space, real_t p_delta, int p_iterations) {
 
 			_populate_island(body, body_island, constraint_island);
 
+			if (deterministic) {
+				_sort_island(constraint_island);
+			}
+
 			if (body_island.is_empty()) {
 				--body_island_count;
 			}
@@ -315,6 +483,10 @@ void Step3DSW::step(Space3DSW *p_space, real_t p_delta, int p_iterations) {
 
 			_populate_island_soft_body(soft_body, body_island, constraint_island);
 
+			if (deterministic) {
+				_sort_island(constraint_island);
+			}
+
 			if (body_island.is_empty()) {
 				--body_island_count;
 			}
@@ -337,7 +509,19 @@ void Step3DSW::step(Space3DSW *p_space, real_t p_delta, int p_iterations) {
 	/* SETUP CONSTRAINTS / PROCESS COLLISIONS */
 
 	uint32_t total_contraint_count = all_constraints.size();
-	work_pool.do_work(total_contraint_count, this, &Step3DSW::_setup_contraint, nullptr);
+	WorkerThreadPool::get_singleton()->do_work(total_contraint_count, this, &Step3DSW::_setup_contraint, nullptr);
+
+	if (deterministic) {
+		for (uint32_t island_index = 0; island_index < island_count; ++island_index) {
+			const LocalVector<Constraint3DSW *> &constraint_island = constraint_islands[island_index];
+			for (uint32_t constraint_index = 0; constraint_index < constraint_island.size(); ++constraint_index) {
+				Constraint3DSW *constraint = constraint_island[constraint_index];
+				if (_needs_ordered_setup(constraint)) {
+					constraint->setup(delta);
+				}
+			}
+		}
+	}
 
 	{ //profile
 		profile_endtime = OS::get_singleton()->get_ticks_usec();
@@ -354,12 +538,41 @@ void Step3DSW::step(Space3DSW *p_space, real_t p_delta, int p_iterations) {
 
 	/* SOLVE CONSTRAINT ISLANDS */
 
+	// Islands with many constraints would keep a single thread busy for the whole solve,
+	// so they are split into independent batches instead.
+	small_islands.clear();
+	large_islands.clear();
+	uint32_t large_island_threshold = p_space->get_large_island_threshold();
+	for (uint32_t island_index = 0; island_index < island_count; ++island_index) {
+		if (large_island_threshold > 0 && constraint_islands[island_index].size() >= large_island_threshold) {
+			large_islands.push_back(island_index);
+		} else {
+			small_islands.push_back(island_index);
+		}
+	}
+
 	// Warning: _solve_island modifies the constraint islands for optimization purpose,
 	// their content is not reliable after these calls and shouldn't be used anymore.
-	if (island_count > 1) {
-		work_pool.do_work(island_count, this, &Step3DSW::_solve_island, nullptr);
-	} else if (island_count > 0) {
-		_solve_island(0);
+	if (large_islands.is_empty()) {
+		if (island_count > 1) {
+			WorkerThreadPool::get_singleton()->do_work(island_count, this, &Step3DSW::_solve_island, nullptr);
+		} else if (island_count > 0) {
+			_solve_island(0);
+		}
+	} else {
+		// Small islands run in the background while this thread dispatches the batches of the large ones.
+		WorkerThreadPool::GroupID small_island_group = WorkerThreadPool::INVALID_GROUP_ID;
+		if (!small_islands.is_empty()) {
+			small_island_group = WorkerThreadPool::get_singleton()->add_template_group_task(this, &Step3DSW::_solve_small_island, nullptr, small_islands.size());
+		}
+
+		for (uint32_t i = 0; i < large_islands.size(); ++i) {
+			_solve_large_island(constraint_islands[large_islands[i]]);
+		}
+
+		if (small_island_group != WorkerThreadPool::INVALID_GROUP_ID) {
+			WorkerThreadPool::get_singleton()->wait_for_group_task_completion(small_island_group);
+		}
 	}
 
 	{ //profile
@@ -399,7 +612,16 @@ void Step3DSW::step(Space3DSW *p_space, real_t p_delta, int p_iterations) {
 
 	all_constraints.clear();
 
+	/* UPDATE BROADPHASE / GENERATE PAIRS */
+
 	p_space->update();
+
+	{ //profile
+		profile_endtime = OS::get_singleton()->get_ticks_usec();
+		p_space->set_elapsed_time(Space3DSW::ELAPSED_TIME_UPDATE_BROADPHASE, profile_endtime - profile_begtime);
+		profile_begtime = profile_endtime;
+	}
+
 	p_space->unlock();
 	_step++;
 }
@@ -410,10 +632,7 @@ Step3DSW::Step3DSW() {
 	body_islands.reserve(BODY_ISLAND_COUNT_RESERVE);
 	constraint_islands.reserve(ISLAND_COUNT_RESERVE);
 	all_constraints.reserve(CONSTRAINT_COUNT_RESERVE);
-
-	work_pool.init();
 }
 
 Step3DSW::~Step3DSW() {
-	work_pool.finish();
 }
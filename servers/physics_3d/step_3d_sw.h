@@ -31,10 +31,11 @@
 #ifndef STEP_SW_H
 #define STEP_SW_H
 
+#include "contact_batch_3d_sw.h"
 #include "space_3d_sw.h"
 
+#include "core/os/worker_thread_pool.h"
 #include "core/templates/local_vector.h"
-#include "core/templates/thread_work_pool.h"
 
 class Step3DSW {
 	uint64_t _step;
@@ -42,17 +43,36 @@ class Step3DSW {
 	int iterations = 0;
 	real_t delta = 0.0;
 
-	ThreadWorkPool work_pool;
-
 	LocalVector<LocalVector<Body3DSW *>> body_islands;
 	LocalVector<LocalVector<Constraint3DSW *>> constraint_islands;
 	LocalVector<Constraint3DSW *> all_constraints;
 
+	// Large islands are split into batches of constraints that share no dynamic body,
+	// the last batch collects constraints that didn't fit in any color.
+	enum {
+		CONSTRAINT_COLOR_MAX = 64,
+	};
+
+	LocalVector<uint32_t> small_islands;
+	LocalVector<uint32_t> large_islands;
+	LocalVector<Constraint3DSW *> constraint_colors[CONSTRAINT_COLOR_MAX + 1];
+	// Body pairs taken out of each color when the batched contact solver is enabled.
+	ContactBatch3DSW contact_batches[CONSTRAINT_COLOR_MAX];
+	bool use_contact_batches = false;
+	bool deterministic = false;
+
 	void _populate_island(Body3DSW *p_body, LocalVector<Body3DSW *> &p_body_island, LocalVector<Constraint3DSW *> &p_constraint_island);
 	void _populate_island_soft_body(SoftBody3DSW *p_soft_body, LocalVector<Body3DSW *> &p_body_island, LocalVector<Constraint3DSW *> &p_constraint_island);
+	void _sort_island(LocalVector<Constraint3DSW *> &p_constraint_island) const;
+	bool _needs_ordered_setup(const Constraint3DSW *p_constraint) const;
 	void _setup_contraint(uint32_t p_constraint_index, void *p_userdata = nullptr);
 	void _pre_solve_island(LocalVector<Constraint3DSW *> &p_constraint_island) const;
 	void _solve_island(uint32_t p_island_index, void *p_userdata = nullptr);
+	void _solve_small_island(uint32_t p_index, void *p_userdata = nullptr);
+	void _color_constraints(const LocalVector<Constraint3DSW *> &p_constraint_island, uint32_t p_constraint_count);
+	void _solve_constraint_batch(uint32_t p_constraint_index, LocalVector<Constraint3DSW *> *p_batch);
+	void _batch_contacts();
+	void _solve_large_island(LocalVector<Constraint3DSW *> &p_constraint_island);
 	void _check_suspend(const LocalVector<Body3DSW *> &p_body_island) const;
 
 public:
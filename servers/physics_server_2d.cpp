@@ -407,6 +407,103 @@ Dictionary PhysicsDirectSpaceState2D::_get_rest_info(const Ref<PhysicsShapeQuery
 	return r;
 }
 
+Dictionary PhysicsDirectSpaceState2D::_intersect_rays(const PackedVector2Array &p_from, const PackedVector2Array &p_to, const Vector<RID> &p_exclude, uint32_t p_layers, bool p_collide_with_bodies, bool p_collide_with_areas) {
+	ERR_FAIL_COND_V(p_from.size() != p_to.size(), Dictionary());
+
+	Set<RID> exclude;
+	for (int i = 0; i < p_exclude.size(); i++) {
+		exclude.insert(p_exclude[i]);
+	}
+
+	int ray_count = p_from.size();
+	Vector<RayResult> results;
+	results.resize(ray_count);
+	intersect_rays(p_from.ptr(), p_to.ptr(), ray_count, results.ptrw(), exclude, p_layers, p_collide_with_bodies, p_collide_with_areas);
+
+	PackedVector2Array positions;
+	positions.resize(ray_count);
+	PackedVector2Array normals;
+	normals.resize(ray_count);
+	PackedInt64Array collider_ids;
+	collider_ids.resize(ray_count);
+	PackedInt32Array shapes;
+	shapes.resize(ray_count);
+
+	Vector2 *positions_ptr = positions.ptrw();
+	Vector2 *normals_ptr = normals.ptrw();
+	int64_t *collider_ids_ptr = collider_ids.ptrw();
+	int32_t *shapes_ptr = shapes.ptrw();
+	for (int i = 0; i < ray_count; i++) {
+		const RayResult &result = results[i];
+		positions_ptr[i] = result.position;
+		normals_ptr[i] = result.normal;
+		collider_ids_ptr[i] = (int64_t)result.collider_id;
+		shapes_ptr[i] = result.rid.is_valid() ? result.shape : -1;
+	}
+
+	Dictionary d;
+	d["position"] = positions;
+	d["normal"] = normals;
+	d["collider_id"] = collider_ids;
+	d["shape"] = shapes;
+
+	return d;
+}
+
+PackedFloat32Array PhysicsDirectSpaceState2D::_cast_motions(const Ref<PhysicsShapeQueryParameters2D> &p_shape_query, const PackedVector2Array &p_origins, const PackedVector2Array &p_motions) {
+	ERR_FAIL_COND_V(!p_shape_query.is_valid(), PackedFloat32Array());
+	ERR_FAIL_COND_V(p_origins.size() != p_motions.size(), PackedFloat32Array());
+
+	int cast_count = p_origins.size();
+	Vector<Transform2D> xforms;
+	xforms.resize(cast_count);
+	Transform2D *xforms_ptr = xforms.ptrw();
+	for (int i = 0; i < cast_count; i++) {
+		xforms_ptr[i] = p_shape_query->transform;
+		xforms_ptr[i].set_origin(p_origins[i]);
+	}
+
+	Vector<real_t> closest_safe;
+	closest_safe.resize(cast_count);
+	Vector<real_t> closest_unsafe;
+	closest_unsafe.resize(cast_count);
+	cast_motions(p_shape_query->shape, xforms.ptr(), p_motions.ptr(), cast_count, p_shape_query->margin, closest_safe.ptrw(), closest_unsafe.ptrw(), p_shape_query->exclude, p_shape_query->collision_mask, p_shape_query->collide_with_bodies, p_shape_query->collide_with_areas);
+
+	PackedFloat32Array ret;
+	ret.resize(cast_count * 2);
+	float *ret_ptr = ret.ptrw();
+	for (int i = 0; i < cast_count; i++) {
+		ret_ptr[i * 2 + 0] = closest_safe[i];
+		ret_ptr[i * 2 + 1] = closest_unsafe[i];
+	}
+
+	return ret;
+}
+
+int PhysicsDirectSpaceState2D::intersect_rays(const Vector2 *p_from, const Vector2 *p_to, int p_ray_count, RayResult *r_results, const Set<RID> &p_exclude, uint32_t p_collision_layer, bool p_collide_with_bodies, bool p_collide_with_areas) {
+	int hit_count = 0;
+	for (int i = 0; i < p_ray_count; i++) {
+		r_results[i] = RayResult();
+		if (intersect_ray(p_from[i], p_to[i], r_results[i], p_exclude, p_collision_layer, p_collide_with_bodies, p_collide_with_areas)) {
+			hit_count++;
+		}
+	}
+	return hit_count;
+}
+
+int PhysicsDirectSpaceState2D::cast_motions(const RID &p_shape, const Transform2D *p_xforms, const Vector2 *p_motions, int p_cast_count, real_t p_margin, real_t *r_closest_safe, real_t *r_closest_unsafe, const Set<RID> &p_exclude, uint32_t p_collision_layer, bool p_collide_with_bodies, bool p_collide_with_areas) {
+	int hit_count = 0;
+	for (int i = 0; i < p_cast_count; i++) {
+		r_closest_safe[i] = 1.0;
+		r_closest_unsafe[i] = 1.0;
+		cast_motion(p_shape, p_xforms[i], p_motions[i], p_margin, r_closest_safe[i], r_closest_unsafe[i], p_exclude, p_collision_layer, p_collide_with_bodies, p_collide_with_areas);
+		if (r_closest_unsafe[i] < 1.0) {
+			hit_count++;
+		}
+	}
+	return hit_count;
+}
+
 PhysicsDirectSpaceState2D::PhysicsDirectSpaceState2D() {
 }
 
@@ -418,6 +515,8 @@ void PhysicsDirectSpaceState2D::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("cast_motion", "shape"), &PhysicsDirectSpaceState2D::_cast_motion);
 	ClassDB::bind_method(D_METHOD("collide_shape", "shape", "max_results"), &PhysicsDirectSpaceState2D::_collide_shape, DEFVAL(32));
 	ClassDB::bind_method(D_METHOD("get_rest_info", "shape"), &PhysicsDirectSpaceState2D::_get_rest_info);
+	ClassDB::bind_method(D_METHOD("intersect_rays", "from", "to", "exclude", "collision_mask", "collide_with_bodies", "collide_with_areas"), &PhysicsDirectSpaceState2D::_intersect_rays, DEFVAL(Array()), DEFVAL(0x7FFFFFFF), DEFVAL(true), DEFVAL(false));
+	ClassDB::bind_method(D_METHOD("cast_motions", "shape", "origins", "motions"), &PhysicsDirectSpaceState2D::_cast_motions);
 }
 
 ///////////////////////////////
@@ -356,6 +356,102 @@ Dictionary PhysicsDirectSpaceState3D::_get_rest_info(const Ref<PhysicsShapeQuery
 	return r;
 }
 
+Dictionary PhysicsDirectSpaceState3D::_intersect_rays(const PackedVector3Array &p_from, const PackedVector3Array &p_to, const Vector<RID> &p_exclude, uint32_t p_collision_mask, bool p_collide_with_bodies, bool p_collide_with_areas) {
+	ERR_FAIL_COND_V(p_from.size() != p_to.size(), Dictionary());
+
+	Set<RID> exclude;
+	for (int i = 0; i < p_exclude.size(); i++) {
+		exclude.insert(p_exclude[i]);
+	}
+
+	int ray_count = p_from.size();
+	Vector<RayResult> results;
+	results.resize(ray_count);
+	intersect_rays(p_from.ptr(), p_to.ptr(), ray_count, results.ptrw(), exclude, p_collision_mask, p_collide_with_bodies, p_collide_with_areas);
+
+	PackedVector3Array positions;
+	positions.resize(ray_count);
+	PackedVector3Array normals;
+	normals.resize(ray_count);
+	PackedInt64Array collider_ids;
+	collider_ids.resize(ray_count);
+	PackedInt32Array shapes;
+	shapes.resize(ray_count);
+
+	Vector3 *positions_ptr = positions.ptrw();
+	Vector3 *normals_ptr = normals.ptrw();
+	int64_t *collider_ids_ptr = collider_ids.ptrw();
+	int32_t *shapes_ptr = shapes.ptrw();
+	for (int i = 0; i < ray_count; i++) {
+		const RayResult &result = results[i];
+		positions_ptr[i] = result.position;
+		normals_ptr[i] = result.normal;
+		collider_ids_ptr[i] = (int64_t)result.collider_id;
+		shapes_ptr[i] = result.rid.is_valid() ? result.shape : -1;
+	}
+
+	Dictionary d;
+	d["position"] = positions;
+	d["normal"] = normals;
+	d["collider_id"] = collider_ids;
+	d["shape"] = shapes;
+
+	return d;
+}
+
+PackedFloat32Array PhysicsDirectSpaceState3D::_cast_motions(const Ref<PhysicsShapeQueryParameters3D> &p_shape_query, const PackedVector3Array &p_origins, const PackedVector3Array &p_motions) {
+	ERR_FAIL_COND_V(!p_shape_query.is_valid(), PackedFloat32Array());
+	ERR_FAIL_COND_V(p_origins.size() != p_motions.size(), PackedFloat32Array());
+
+	int cast_count = p_origins.size();
+	Vector<Transform3D> xforms;
+	xforms.resize(cast_count);
+	Transform3D *xforms_ptr = xforms.ptrw();
+	for (int i = 0; i < cast_count; i++) {
+		xforms_ptr[i] = Transform3D(p_shape_query->transform.basis, p_origins[i]);
+	}
+
+	Vector<real_t> closest_safe;
+	closest_safe.resize(cast_count);
+	Vector<real_t> closest_unsafe;
+	closest_unsafe.resize(cast_count);
+	cast_motions(p_shape_query->shape, xforms.ptr(), p_motions.ptr(), cast_count, p_shape_query->margin, closest_safe.ptrw(), closest_unsafe.ptrw(), p_shape_query->exclude, p_shape_query->collision_mask, p_shape_query->collide_with_bodies, p_shape_query->collide_with_areas);
+
+	PackedFloat32Array ret;
+	ret.resize(cast_count * 2);
+	float *ret_ptr = ret.ptrw();
+	for (int i = 0; i < cast_count; i++) {
+		ret_ptr[i * 2 + 0] = closest_safe[i];
+		ret_ptr[i * 2 + 1] = closest_unsafe[i];
+	}
+
+	return ret;
+}
+
+int PhysicsDirectSpaceState3D::intersect_rays(const Vector3 *p_from, const Vector3 *p_to, int p_ray_count, RayResult *r_results, const Set<RID> &p_exclude, uint32_t p_collision_mask, bool p_collide_with_bodies, bool p_collide_with_areas) {
+	int hit_count = 0;
+	for (int i = 0; i < p_ray_count; i++) {
+		r_results[i] = RayResult();
+		if (intersect_ray(p_from[i], p_to[i], r_results[i], p_exclude, p_collision_mask, p_collide_with_bodies, p_collide_with_areas)) {
+			hit_count++;
+		}
+	}
+	return hit_count;
+}
+
+int PhysicsDirectSpaceState3D::cast_motions(const RID &p_shape, const Transform3D *p_xforms, const Vector3 *p_motions, int p_cast_count, real_t p_margin, real_t *r_closest_safe, real_t *r_closest_unsafe, const Set<RID> &p_exclude, uint32_t p_collision_mask, bool p_collide_with_bodies, bool p_collide_with_areas) {
+	int hit_count = 0;
+	for (int i = 0; i < p_cast_count; i++) {
+		r_closest_safe[i] = 1.0;
+		r_closest_unsafe[i] = 1.0;
+		cast_motion(p_shape, p_xforms[i], p_motions[i], p_margin, r_closest_safe[i], r_closest_unsafe[i], p_exclude, p_collision_mask, p_collide_with_bodies, p_collide_with_areas);
+		if (r_closest_unsafe[i] < 1.0) {
+			hit_count++;
+		}
+	}
+	return hit_count;
+}
+
 PhysicsDirectSpaceState3D::PhysicsDirectSpaceState3D() {
 }
 
@@ -365,6 +461,8 @@ void PhysicsDirectSpaceState3D::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("cast_motion", "shape", "motion"), &PhysicsDirectSpaceState3D::_cast_motion);
 	ClassDB::bind_method(D_METHOD("collide_shape", "shape", "max_results"), &PhysicsDirectSpaceState3D::_collide_shape, DEFVAL(32));
 	ClassDB::bind_method(D_METHOD("get_rest_info", "shape"), &PhysicsDirectSpaceState3D::_get_rest_info);
+	ClassDB::bind_method(D_METHOD("intersect_rays", "from", "to", "exclude", "collision_mask", "collide_with_bodies", "collide_with_areas"), &PhysicsDirectSpaceState3D::_intersect_rays, DEFVAL(Array()), DEFVAL(0x7FFFFFFF), DEFVAL(true), DEFVAL(false));
+	ClassDB::bind_method(D_METHOD("cast_motions", "shape", "origins", "motions"), &PhysicsDirectSpaceState3D::_cast_motions);
 }
 
 ///////////////////////////////
@@ -798,6 +896,13 @@ void PhysicsServer3D::_bind_methods() {
 	BIND_ENUM_CONSTANT(INFO_ACTIVE_OBJECTS);
 	BIND_ENUM_CONSTANT(INFO_COLLISION_PAIRS);
 	BIND_ENUM_CONSTANT(INFO_ISLAND_COUNT);
+	BIND_ENUM_CONSTANT(INFO_INTEGRATE_FORCES_TIME);
+	BIND_ENUM_CONSTANT(INFO_GENERATE_ISLANDS_TIME);
+	BIND_ENUM_CONSTANT(INFO_SETUP_CONSTRAINTS_TIME);
+	BIND_ENUM_CONSTANT(INFO_SOLVE_CONSTRAINTS_TIME);
+	BIND_ENUM_CONSTANT(INFO_INTEGRATE_VELOCITIES_TIME);
+	BIND_ENUM_CONSTANT(INFO_UPDATE_BROADPHASE_TIME);
+	BIND_ENUM_CONSTANT(INFO_FLUSH_QUERIES_TIME);
 
 	BIND_ENUM_CONSTANT(SPACE_PARAM_CONTACT_RECYCLE_RADIUS);
 	BIND_ENUM_CONSTANT(SPACE_PARAM_CONTACT_MAX_SEPARATION);
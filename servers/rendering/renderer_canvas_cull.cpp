@@ -30,6 +30,7 @@
 
 #include "renderer_canvas_cull.h"
 
+#include "core/config/project_settings.h"
 #include "core/math/geometry_2d.h"
 #include "renderer_viewport.h"
 #include "rendering_server_default.h"
@@ -37,17 +38,17 @@
 
 static const int z_range = RS::CANVAS_ITEM_Z_MAX - RS::CANVAS_ITEM_Z_MIN + 1;
 
-void RendererCanvasCull::_render_canvas_item_tree(RID p_to_render_target, Canvas::ChildItem *p_child_items, int p_child_item_count, Item *p_canvas_item, const Transform2D &p_transform, const Rect2 &p_clip_rect, const Color &p_modulate, RendererCanvasRender::Light *p_lights, RendererCanvasRender::Light *p_directional_lights, RenderingServer::CanvasItemTextureFilter p_default_filter, RenderingServer::CanvasItemTextureRepeat p_default_repeat, bool p_snap_2d_vertices_to_pixel) {
+void RendererCanvasCull::_render_canvas_item_tree(RID p_to_render_target, Canvas::ChildItem *p_child_items, int p_child_item_count, Item *p_canvas_item, const Transform2D &p_transform, const Rect2 &p_clip_rect, const Color &p_modulate, RendererCanvasRender::Light *p_lights, RendererCanvasRender::Light *p_directional_lights, RenderingServer::CanvasItemTextureFilter p_default_filter, RenderingServer::CanvasItemTextureRepeat p_default_repeat, bool p_snap_2d_vertices_to_pixel, uint64_t p_cull_version) {
 	RENDER_TIMESTAMP("Cull CanvasItem Tree");
 
 	memset(z_list, 0, z_range * sizeof(RendererCanvasRender::Item *));
 	memset(z_last_list, 0, z_range * sizeof(RendererCanvasRender::Item *));
 
 	for (int i = 0; i < p_child_item_count; i++) {
-		_cull_canvas_item(p_child_items[i].item, p_transform, p_clip_rect, Color(1, 1, 1, 1), 0, z_list, z_last_list, nullptr, nullptr, true);
+		_cull_canvas_item(p_child_items[i].item, p_transform, p_clip_rect, Color(1, 1, 1, 1), 0, z_list, z_last_list, nullptr, nullptr, true, p_cull_version);
 	}
 	if (p_canvas_item) {
-		_cull_canvas_item(p_canvas_item, p_transform, p_clip_rect, Color(1, 1, 1, 1), 0, z_list, z_last_list, nullptr, nullptr, true);
+		_cull_canvas_item(p_canvas_item, p_transform, p_clip_rect, Color(1, 1, 1, 1), 0, z_list, z_last_list, nullptr, nullptr, true, p_cull_version);
 	}
 
 	RendererCanvasRender::Item *list = nullptr;
@@ -214,7 +215,7 @@ void RendererCanvasCull::_attach_canvas_item_for_draw(RendererCanvasCull::Item *
 	}
 }
 
-void RendererCanvasCull::_cull_canvas_item(Item *p_canvas_item, const Transform2D &p_transform, const Rect2 &p_clip_rect, const Color &p_modulate, int p_z, RendererCanvasRender::Item **z_list, RendererCanvasRender::Item **z_last_list, Item *p_canvas_clip, Item *p_material_owner, bool allow_y_sort) {
+void RendererCanvasCull::_cull_canvas_item(Item *p_canvas_item, const Transform2D &p_transform, const Rect2 &p_clip_rect, const Color &p_modulate, int p_z, RendererCanvasRender::Item **z_list, RendererCanvasRender::Item **z_last_list, Item *p_canvas_clip, Item *p_material_owner, bool allow_y_sort, uint64_t p_parent_cull_version) {
 	Item *ci = p_canvas_item;
 
 	if (!ci->visible) {
@@ -224,24 +225,61 @@ void RendererCanvasCull::_cull_canvas_item(Item *p_canvas_item, const Transform2
 	if (ci->children_order_dirty) {
 		ci->child_items.sort_custom<ItemIndexSort>();
 		ci->children_order_dirty = false;
+		for (int i = 0; i < ci->child_items.size(); i++) {
+			ci->child_items[i]->sibling_order = i;
+		}
 	}
 
-	Rect2 rect = ci->get_rect();
+	Transform2D xform;
+	Rect2 global_rect;
+	Color modulate;
+
+	// A version of 0 means the parent values are not cached, e.g. below mirrored or y-sorted items. Canvas groups
+	// may redraw their rect while culled, so they are not cached either.
+	if (p_parent_cull_version && !ci->cull_dirty && ci->cull_parent_version == p_parent_cull_version && !ci->update_when_visible && !ci->canvas_group) {
+		xform = ci->cull_xform;
+		global_rect = ci->cull_global_rect;
+		modulate = ci->cull_modulate;
+	} else {
+		Rect2 rect = ci->get_rect();
 
-	if (ci->visibility_notifier) {
-		if (ci->visibility_notifier->area.size != Vector2()) {
-			rect = rect.merge(ci->visibility_notifier->area);
+		if (ci->visibility_notifier) {
+			if (ci->visibility_notifier->area.size != Vector2()) {
+				rect = rect.merge(ci->visibility_notifier->area);
+			}
 		}
-	}
 
-	Transform2D xform = ci->xform;
-	if (snapping_2d_transforms_to_pixel) {
-		xform.elements[2] = xform.elements[2].floor();
+		xform = ci->xform;
+		if (snapping_2d_transforms_to_pixel) {
+			xform.elements[2] = xform.elements[2].floor();
+		}
+		xform = p_transform * xform;
+
+		global_rect = xform.xform(rect);
+		global_rect.position += p_clip_rect.position;
+
+		modulate = Color(ci->modulate.r * p_modulate.r, ci->modulate.g * p_modulate.g, ci->modulate.b * p_modulate.b, ci->modulate.a * p_modulate.a);
+
+		if (p_parent_cull_version) {
+			ci->cull_xform = xform;
+			ci->cull_global_rect = global_rect;
+			ci->cull_modulate = modulate;
+			ci->cull_version = ++cull_version_counter;
+			ci->cull_parent_version = p_parent_cull_version;
+			ci->cull_dirty = false;
+		} else {
+			ci->cull_version = 0;
+			ci->cull_dirty = true;
+		}
 	}
-	xform = p_transform * xform;
 
-	Rect2 global_rect = xform.xform(rect);
-	global_rect.position += p_clip_rect.position;
+	if (cull_use_spatial_index) {
+		// skip the whole subtree when none of it is on screen
+		_item_update_bound(ci);
+		if (!ci->bound_unbounded && (!ci->bound_valid || !xform.xform(ci->bound_rect).intersects(Rect2(Point2(), p_clip_rect.size), true))) {
+			return;
+		}
+	}
 
 	if (ci->use_parent_material && p_material_owner) {
 		ci->material_owner = p_material_owner;
@@ -250,8 +288,6 @@ void RendererCanvasCull::_cull_canvas_item(Item *p_canvas_item, const Transform2
 		ci->material_owner = nullptr;
 	}
 
-	Color modulate(ci->modulate.r * p_modulate.r, ci->modulate.g * p_modulate.g, ci->modulate.b * p_modulate.b, ci->modulate.a * p_modulate.a);
-
 	if (modulate.a < 0.007) {
 		return;
 	}
@@ -298,7 +334,7 @@ void RendererCanvasCull::_cull_canvas_item(Item *p_canvas_item, const Transform2
 			sorter.sort(child_items, child_item_count);
 
 			for (i = 0; i < child_item_count; i++) {
-				_cull_canvas_item(child_items[i], xform * child_items[i]->ysort_xform, p_clip_rect, modulate, p_z, z_list, z_last_list, (Item *)ci->final_clip_owner, (Item *)child_items[i]->material_owner, false);
+				_cull_canvas_item(child_items[i], xform * child_items[i]->ysort_xform, p_clip_rect, modulate, p_z, z_list, z_last_list, (Item *)ci->final_clip_owner, (Item *)child_items[i]->material_owner, false, 0);
 			}
 		} else {
 			RendererCanvasRender::Item *canvas_group_from = nullptr;
@@ -318,31 +354,236 @@ void RendererCanvasCull::_cull_canvas_item(Item *p_canvas_item, const Transform2
 			canvas_group_from = z_last_list[zidx];
 		}
 
+		if (cull_use_spatial_index && ci->child_index) {
+			// only visit the children that may be on screen, the index is up to date as the bound was updated above
+			Item **visible_child_items = (Item **)alloca(child_item_count * sizeof(Item *));
+			int visible_child_item_count = _index_cull(ci->child_index, xform, p_clip_rect.size, visible_child_items, child_item_count);
+			if (visible_child_item_count >= 0) {
+				child_items = visible_child_items;
+				child_item_count = visible_child_item_count;
+			}
+		}
+
 		for (int i = 0; i < child_item_count; i++) {
 			if (!child_items[i]->behind && !use_canvas_group) {
 				continue;
 			}
-			_cull_canvas_item(child_items[i], xform, p_clip_rect, modulate, p_z, z_list, z_last_list, (Item *)ci->final_clip_owner, p_material_owner, true);
+			_cull_canvas_item(child_items[i], xform, p_clip_rect, modulate, p_z, z_list, z_last_list, (Item *)ci->final_clip_owner, p_material_owner, true, ci->cull_version);
 		}
 		_attach_canvas_item_for_draw(ci, p_canvas_clip, z_list, z_last_list, xform, p_clip_rect, global_rect, modulate, p_z, p_material_owner, use_canvas_group, canvas_group_from, xform);
 		for (int i = 0; i < child_item_count; i++) {
 			if (child_items[i]->behind || use_canvas_group) {
 				continue;
 			}
-			_cull_canvas_item(child_items[i], xform, p_clip_rect, modulate, p_z, z_list, z_last_list, (Item *)ci->final_clip_owner, p_material_owner, true);
+			_cull_canvas_item(child_items[i], xform, p_clip_rect, modulate, p_z, z_list, z_last_list, (Item *)ci->final_clip_owner, p_material_owner, true, ci->cull_version);
+		}
+	}
+}
+
+void RendererCanvasCull::_item_mark_bound_dirty(Item *p_item) {
+	p_item->bound_dirty = true;
+	p_item->cull_dirty = true;
+	_item_mark_moved(p_item);
+}
+
+void RendererCanvasCull::_item_mark_moved(Item *p_item) {
+	// An item stays marked until its parent updates, by then the bounds of all its ancestors are updated too,
+	// so marking can stop at the first item that is already marked.
+	while (!p_item->bound_moved) {
+		if (canvas_item_owner.owns(p_item->parent)) {
+			Item *parent = canvas_item_owner.getornull(p_item->parent);
+			if (parent->child_index) {
+				parent->child_index->dirty_items.push_back(p_item);
+			}
+			p_item->bound_moved = true;
+			parent->bound_dirty = true;
+			p_item = parent;
+		} else {
+			// canvases have no bound, only their index needs updating
+			Canvas *canvas = canvas_owner.owns(p_item->parent) ? canvas_owner.getornull(p_item->parent) : nullptr;
+			if (canvas && canvas->child_index) {
+				canvas->child_index->dirty_items.push_back(p_item);
+				p_item->bound_moved = true;
+			}
+			break;
 		}
 	}
 }
 
+void RendererCanvasCull::_item_detach_from_index(Item *p_item, ChildIndex *p_index) {
+	if (p_index) {
+		if (p_item->bound_moved) {
+			p_index->dirty_items.erase(p_item);
+		}
+		if (!p_item->index_handle.is_invalid()) {
+			p_index->bvh.erase(p_item->index_handle);
+		}
+		if (p_item->index_unbounded) {
+			p_index->unbounded_items.erase(p_item);
+		}
+	}
+
+	p_item->index_handle.set_invalid();
+	p_item->index_unbounded = false;
+	p_item->bound_moved = false;
+}
+
+void RendererCanvasCull::_item_update_bound(Item *p_item) {
+	if (!p_item->bound_dirty) {
+		return;
+	}
+	p_item->bound_dirty = false;
+
+	// these are processed whenever their parent is, as they may draw or update regardless of their rect
+	bool unbounded = p_item->vp_render || p_item->copy_back_buffer || p_item->update_when_visible || (p_item->canvas_group && p_item->canvas_group->fit_empty);
+	bool valid = false;
+	Rect2 bound;
+
+	if (p_item->commands || p_item->visibility_notifier) {
+		// same rect as used when culling the item itself
+		bound = p_item->get_rect();
+		if (p_item->visibility_notifier && p_item->visibility_notifier->area.size != Vector2()) {
+			bound = bound.merge(p_item->visibility_notifier->area);
+		}
+		bound = bound.abs();
+		valid = true;
+	}
+
+	int child_item_count = p_item->child_items.size();
+
+	if (!p_item->child_index && child_item_count >= SPATIAL_INDEX_MIN_CHILDREN) {
+		p_item->child_index = memnew(ChildIndex);
+		for (int i = 0; i < child_item_count; i++) {
+			p_item->child_items[i]->bound_moved = true;
+			p_item->child_index->dirty_items.push_back(p_item->child_items[i]);
+		}
+	}
+
+	if (p_item->child_index) {
+		_index_update(p_item->child_index);
+
+		Rect2 children_bound;
+		if (p_item->child_index->bvh.get_bounds(children_bound)) {
+			bound = valid ? bound.merge(children_bound) : children_bound;
+			valid = true;
+		}
+		unbounded = unbounded || p_item->child_index->unbounded_items.size();
+	} else {
+		for (int i = 0; i < child_item_count; i++) {
+			Item *child = p_item->child_items[i];
+			child->bound_moved = false;
+
+			if (!child->visible) {
+				continue;
+			}
+
+			_item_update_bound(child);
+			unbounded = unbounded || child->bound_unbounded;
+
+			if (child->bound_valid) {
+				Rect2 child_bound = child->xform.xform(child->bound_rect);
+				bound = valid ? bound.merge(child_bound) : child_bound;
+				valid = true;
+			}
+		}
+	}
+
+	p_item->bound_rect = bound;
+	p_item->bound_valid = valid;
+	p_item->bound_unbounded = unbounded;
+}
+
+void RendererCanvasCull::_index_update(ChildIndex *p_index) {
+	if (!p_index->dirty_items.size()) {
+		return;
+	}
+
+	for (uint32_t i = 0; i < p_index->dirty_items.size(); i++) {
+		Item *item = p_index->dirty_items[i];
+		item->bound_moved = false;
+		_index_update_item(p_index, item);
+	}
+	p_index->dirty_items.clear();
+
+	p_index->bvh.update();
+}
+
+void RendererCanvasCull::_index_update_item(ChildIndex *p_index, Item *p_item) {
+	bool unbounded = false;
+	bool indexed = false;
+
+	if (p_item->visible) {
+		_item_update_bound(p_item);
+		unbounded = p_item->bound_unbounded;
+		indexed = !unbounded && p_item->bound_valid;
+	}
+
+	if (unbounded != p_item->index_unbounded) {
+		if (unbounded) {
+			p_index->unbounded_items.push_back(p_item);
+		} else {
+			p_index->unbounded_items.erase(p_item);
+		}
+		p_item->index_unbounded = unbounded;
+	}
+
+	if (indexed) {
+		Rect2 rect = p_item->xform.xform(p_item->bound_rect);
+		if (p_item->index_handle.is_invalid()) {
+			p_item->index_handle = p_index->bvh.create(p_item, true, rect);
+		} else {
+			p_index->bvh.move(p_item->index_handle, rect);
+		}
+	} else if (!p_item->index_handle.is_invalid()) {
+		p_index->bvh.erase(p_item->index_handle);
+		p_item->index_handle.set_invalid();
+	}
+}
+
+int RendererCanvasCull::_index_cull(ChildIndex *p_index, const Transform2D &p_transform, const Size2 &p_clip_size, Item **r_items, int p_max_items) {
+	// the index is in the parent's space, so the screen is transformed into it
+	if (Math::is_zero_approx(p_transform.basis_determinant())) {
+		return -1;
+	}
+	Rect2 rect = p_transform.affine_inverse().xform(Rect2(Point2(), p_clip_size));
+
+	int count = p_index->bvh.cull_aabb(rect, r_items, p_max_items);
+	for (uint32_t i = 0; i < p_index->unbounded_items.size() && count < p_max_items; i++) {
+		r_items[count++] = p_index->unbounded_items[i];
+	}
+
+	// same order as the children, removing children keeps the order of the others
+	SortArray<Item *, ItemSiblingOrderSort> sorter;
+	sorter.sort(r_items, count);
+
+	return count;
+}
+
 void RendererCanvasCull::render_canvas(RID p_render_target, Canvas *p_canvas, const Transform2D &p_transform, RendererCanvasRender::Light *p_lights, RendererCanvasRender::Light *p_directional_lights, const Rect2 &p_clip_rect, RenderingServer::CanvasItemTextureFilter p_default_filter, RenderingServer::CanvasItemTextureRepeat p_default_repeat, bool p_snap_2d_transforms_to_pixel, bool p_snap_2d_vertices_to_pixel) {
 	RENDER_TIMESTAMP(">Render Canvas");
 
 	sdf_used = false;
 	snapping_2d_transforms_to_pixel = p_snap_2d_transforms_to_pixel;
+	// snapped transforms move items slightly away from their cached bounds
+	cull_use_spatial_index = p_canvas->use_spatial_index && !p_snap_2d_transforms_to_pixel;
+
+	// The cached item transforms stay valid as long as the canvas is culled the same way. While it changes every
+	// frame, e.g. when scrolling, nothing is cached, as storing the values would only be a cost.
+	if (p_canvas->cull_transform != p_transform || p_canvas->cull_clip_position != p_clip_rect.position || p_canvas->cull_snap_2d_transforms_to_pixel != p_snap_2d_transforms_to_pixel) {
+		p_canvas->cull_transform = p_transform;
+		p_canvas->cull_clip_position = p_clip_rect.position;
+		p_canvas->cull_snap_2d_transforms_to_pixel = p_snap_2d_transforms_to_pixel;
+		p_canvas->cull_version = 0;
+	} else if (p_canvas->cull_version == 0) {
+		p_canvas->cull_version = ++cull_version_counter;
+	}
 
 	if (p_canvas->children_order_dirty) {
 		p_canvas->child_items.sort();
 		p_canvas->children_order_dirty = false;
+		for (int i = 0; i < p_canvas->child_items.size(); i++) {
+			p_canvas->child_items[i].item->sibling_order = i;
+		}
 	}
 
 	int l = p_canvas->child_items.size();
@@ -357,26 +598,48 @@ void RendererCanvasCull::render_canvas(RID p_render_target, Canvas *p_canvas, co
 	}
 
 	if (!has_mirror) {
-		_render_canvas_item_tree(p_render_target, ci, l, nullptr, p_transform, p_clip_rect, p_canvas->modulate, p_lights, p_directional_lights, p_default_filter, p_default_repeat, p_snap_2d_vertices_to_pixel);
+		if (cull_use_spatial_index && (p_canvas->child_index || l >= SPATIAL_INDEX_MIN_CHILDREN)) {
+			if (!p_canvas->child_index) {
+				p_canvas->child_index = memnew(ChildIndex);
+				for (int i = 0; i < l; i++) {
+					ci[i].item->bound_moved = true;
+					p_canvas->child_index->dirty_items.push_back(ci[i].item);
+				}
+			}
+			_index_update(p_canvas->child_index);
+
+			Item **visible_items = (Item **)alloca(l * sizeof(Item *));
+			int visible_count = _index_cull(p_canvas->child_index, p_transform, p_clip_rect.size, visible_items, l);
+			if (visible_count >= 0) {
+				ci = (Canvas::ChildItem *)alloca(MAX(visible_count, 1) * sizeof(Canvas::ChildItem));
+				for (int i = 0; i < visible_count; i++) {
+					ci[i].mirror = Point2();
+					ci[i].item = visible_items[i];
+				}
+				l = visible_count;
+			}
+		}
+
+		_render_canvas_item_tree(p_render_target, ci, l, nullptr, p_transform, p_clip_rect, p_canvas->modulate, p_lights, p_directional_lights, p_default_filter, p_default_repeat, p_snap_2d_vertices_to_pixel, p_canvas->cull_version);
 
 	} else {
 		//used for parallaxlayer mirroring
 		for (int i = 0; i < l; i++) {
 			const Canvas::ChildItem &ci2 = p_canvas->child_items[i];
-			_render_canvas_item_tree(p_render_target, nullptr, 0, ci2.item, p_transform, p_clip_rect, p_canvas->modulate, p_lights, p_directional_lights, p_default_filter, p_default_repeat, p_snap_2d_vertices_to_pixel);
+			_render_canvas_item_tree(p_render_target, nullptr, 0, ci2.item, p_transform, p_clip_rect, p_canvas->modulate, p_lights, p_directional_lights, p_default_filter, p_default_repeat, p_snap_2d_vertices_to_pixel, 0);
 
 			//mirroring (useful for scrolling backgrounds)
 			if (ci2.mirror.x != 0) {
 				Transform2D xform2 = p_transform * Transform2D(0, Vector2(ci2.mirror.x, 0));
-				_render_canvas_item_tree(p_render_target, nullptr, 0, ci2.item, xform2, p_clip_rect, p_canvas->modulate, p_lights, p_directional_lights, p_default_filter, p_default_repeat, p_snap_2d_vertices_to_pixel);
+				_render_canvas_item_tree(p_render_target, nullptr, 0, ci2.item, xform2, p_clip_rect, p_canvas->modulate, p_lights, p_directional_lights, p_default_filter, p_default_repeat, p_snap_2d_vertices_to_pixel, 0);
 			}
 			if (ci2.mirror.y != 0) {
 				Transform2D xform2 = p_transform * Transform2D(0, Vector2(0, ci2.mirror.y));
-				_render_canvas_item_tree(p_render_target, nullptr, 0, ci2.item, xform2, p_clip_rect, p_canvas->modulate, p_lights, p_directional_lights, p_default_filter, p_default_repeat, p_snap_2d_vertices_to_pixel);
+				_render_canvas_item_tree(p_render_target, nullptr, 0, ci2.item, xform2, p_clip_rect, p_canvas->modulate, p_lights, p_directional_lights, p_default_filter, p_default_repeat, p_snap_2d_vertices_to_pixel, 0);
 			}
 			if (ci2.mirror.y != 0 && ci2.mirror.x != 0) {
 				Transform2D xform2 = p_transform * Transform2D(0, ci2.mirror);
-				_render_canvas_item_tree(p_render_target, nullptr, 0, ci2.item, xform2, p_clip_rect, p_canvas->modulate, p_lights, p_directional_lights, p_default_filter, p_default_repeat, p_snap_2d_vertices_to_pixel);
+				_render_canvas_item_tree(p_render_target, nullptr, 0, ci2.item, xform2, p_clip_rect, p_canvas->modulate, p_lights, p_directional_lights, p_default_filter, p_default_repeat, p_snap_2d_vertices_to_pixel, 0);
 			}
 		}
 	}
@@ -393,6 +656,7 @@ RID RendererCanvasCull::canvas_allocate() {
 }
 void RendererCanvasCull::canvas_initialize(RID p_rid) {
 	canvas_owner.initialize_rid(p_rid);
+	canvas_owner.getornull(p_rid)->use_spatial_index = default_use_spatial_index;
 }
 
 void RendererCanvasCull::canvas_set_item_mirroring(RID p_canvas, RID p_item, const Point2 &p_mirroring) {
@@ -416,6 +680,13 @@ void RendererCanvasCull::canvas_set_disable_scale(bool p_disable) {
 	disable_scale = p_disable;
 }
 
+void RendererCanvasCull::canvas_set_use_spatial_index(RID p_canvas, bool p_enable) {
+	Canvas *canvas = canvas_owner.getornull(p_canvas);
+	ERR_FAIL_COND(!canvas);
+
+	canvas->use_spatial_index = p_enable;
+}
+
 void RendererCanvasCull::canvas_set_parent(RID p_canvas, RID p_parent, float p_scale) {
 	Canvas *canvas = canvas_owner.getornull(p_canvas);
 	ERR_FAIL_COND(!canvas);
@@ -439,9 +710,12 @@ void RendererCanvasCull::canvas_item_set_parent(RID p_item, RID p_parent) {
 		if (canvas_owner.owns(canvas_item->parent)) {
 			Canvas *canvas = canvas_owner.getornull(canvas_item->parent);
 			canvas->erase_item(canvas_item);
+			_item_detach_from_index(canvas_item, canvas->child_index);
 		} else if (canvas_item_owner.owns(canvas_item->parent)) {
 			Item *item_owner = canvas_item_owner.getornull(canvas_item->parent);
 			item_owner->child_items.erase(canvas_item);
+			_item_detach_from_index(canvas_item, item_owner->child_index);
+			_item_mark_bound_dirty(item_owner);
 
 			if (item_owner->sort_y) {
 				_mark_ysort_dirty(item_owner, canvas_item_owner);
@@ -473,6 +747,7 @@ void RendererCanvasCull::canvas_item_set_parent(RID p_item, RID p_parent) {
 	}
 
 	canvas_item->parent = p_parent;
+	_item_mark_moved(canvas_item);
 }
 
 void RendererCanvasCull::canvas_item_set_visible(RID p_item, bool p_visible) {
@@ -480,6 +755,7 @@ void RendererCanvasCull::canvas_item_set_visible(RID p_item, bool p_visible) {
 	ERR_FAIL_COND(!canvas_item);
 
 	canvas_item->visible = p_visible;
+	_item_mark_moved(canvas_item);
 
 	_mark_ysort_dirty(canvas_item, canvas_item_owner);
 }
@@ -496,6 +772,8 @@ void RendererCanvasCull::canvas_item_set_transform(RID p_item, const Transform2D
 	ERR_FAIL_COND(!canvas_item);
 
 	canvas_item->xform = p_transform;
+	canvas_item->cull_dirty = true;
+	_item_mark_moved(canvas_item);
 }
 
 void RendererCanvasCull::canvas_item_set_clip(RID p_item, bool p_clip) {
@@ -518,6 +796,7 @@ void RendererCanvasCull::canvas_item_set_custom_rect(RID p_item, bool p_custom_r
 
 	canvas_item->custom_rect = p_custom_rect;
 	canvas_item->rect = p_rect;
+	_item_mark_bound_dirty(canvas_item);
 }
 
 void RendererCanvasCull::canvas_item_set_modulate(RID p_item, const Color &p_color) {
@@ -525,6 +804,7 @@ void RendererCanvasCull::canvas_item_set_modulate(RID p_item, const Color &p_col
 	ERR_FAIL_COND(!canvas_item);
 
 	canvas_item->modulate = p_color;
+	canvas_item->cull_dirty = true;
 }
 
 void RendererCanvasCull::canvas_item_set_self_modulate(RID p_item, const Color &p_color) {
@@ -546,11 +826,13 @@ void RendererCanvasCull::canvas_item_set_update_when_visible(RID p_item, bool p_
 	ERR_FAIL_COND(!canvas_item);
 
 	canvas_item->update_when_visible = p_update;
+	_item_mark_bound_dirty(canvas_item);
 }
 
 void RendererCanvasCull::canvas_item_add_line(RID p_item, const Point2 &p_from, const Point2 &p_to, const Color &p_color, float p_width) {
 	Item *canvas_item = canvas_item_owner.getornull(p_item);
 	ERR_FAIL_COND(!canvas_item);
+	_item_mark_bound_dirty(canvas_item);
 
 	Item::CommandPrimitive *line = canvas_item->alloc_command<Item::CommandPrimitive>();
 	ERR_FAIL_COND(!line);
@@ -575,6 +857,7 @@ void RendererCanvasCull::canvas_item_add_polyline(RID p_item, const Vector<Point
 	ERR_FAIL_COND(p_points.size() < 2);
 	Item *canvas_item = canvas_item_owner.getornull(p_item);
 	ERR_FAIL_COND(!canvas_item);
+	_item_mark_bound_dirty(canvas_item);
 
 	Color color = Color(1, 1, 1, 1);
 
@@ -716,6 +999,7 @@ void RendererCanvasCull::canvas_item_add_multiline(RID p_item, const Vector<Poin
 	ERR_FAIL_COND(p_points.size() < 2);
 	Item *canvas_item = canvas_item_owner.getornull(p_item);
 	ERR_FAIL_COND(!canvas_item);
+	_item_mark_bound_dirty(canvas_item);
 
 	Item::CommandPolygon *pline = canvas_item->alloc_command<Item::CommandPolygon>();
 	ERR_FAIL_COND(!pline);
@@ -732,6 +1016,7 @@ void RendererCanvasCull::canvas_item_add_multiline(RID p_item, const Vector<Poin
 void RendererCanvasCull::canvas_item_add_rect(RID p_item, const Rect2 &p_rect, const Color &p_color) {
 	Item *canvas_item = canvas_item_owner.getornull(p_item);
 	ERR_FAIL_COND(!canvas_item);
+	_item_mark_bound_dirty(canvas_item);
 
 	Item::CommandRect *rect = canvas_item->alloc_command<Item::CommandRect>();
 	ERR_FAIL_COND(!rect);
@@ -742,6 +1027,7 @@ void RendererCanvasCull::canvas_item_add_rect(RID p_item, const Rect2 &p_rect, c
 void RendererCanvasCull::canvas_item_add_circle(RID p_item, const Point2 &p_pos, float p_radius, const Color &p_color) {
 	Item *canvas_item = canvas_item_owner.getornull(p_item);
 	ERR_FAIL_COND(!canvas_item);
+	_item_mark_bound_dirty(canvas_item);
 
 	Item::CommandPolygon *circle = canvas_item->alloc_command<Item::CommandPolygon>();
 	ERR_FAIL_COND(!circle);
@@ -778,6 +1064,7 @@ void RendererCanvasCull::canvas_item_add_circle(RID p_item, const Point2 &p_pos,
 void RendererCanvasCull::canvas_item_add_texture_rect(RID p_item, const Rect2 &p_rect, RID p_texture, bool p_tile, const Color &p_modulate, bool p_transpose) {
 	Item *canvas_item = canvas_item_owner.getornull(p_item);
 	ERR_FAIL_COND(!canvas_item);
+	_item_mark_bound_dirty(canvas_item);
 
 	Item::CommandRect *rect = canvas_item->alloc_command<Item::CommandRect>();
 	ERR_FAIL_COND(!rect);
@@ -809,6 +1096,7 @@ void RendererCanvasCull::canvas_item_add_texture_rect(RID p_item, const Rect2 &p
 void RendererCanvasCull::canvas_item_add_texture_rect_region(RID p_item, const Rect2 &p_rect, RID p_texture, const Rect2 &p_src_rect, const Color &p_modulate, bool p_transpose, bool p_clip_uv) {
 	Item *canvas_item = canvas_item_owner.getornull(p_item);
 	ERR_FAIL_COND(!canvas_item);
+	_item_mark_bound_dirty(canvas_item);
 
 	Item::CommandRect *rect = canvas_item->alloc_command<Item::CommandRect>();
 	ERR_FAIL_COND(!rect);
@@ -850,6 +1138,7 @@ void RendererCanvasCull::canvas_item_add_texture_rect_region(RID p_item, const R
 void RendererCanvasCull::canvas_item_add_nine_patch(RID p_item, const Rect2 &p_rect, const Rect2 &p_source, RID p_texture, const Vector2 &p_topleft, const Vector2 &p_bottomright, RS::NinePatchAxisMode p_x_axis_mode, RS::NinePatchAxisMode p_y_axis_mode, bool p_draw_center, const Color &p_modulate) {
 	Item *canvas_item = canvas_item_owner.getornull(p_item);
 	ERR_FAIL_COND(!canvas_item);
+	_item_mark_bound_dirty(canvas_item);
 
 	Item::CommandNinePatch *style = canvas_item->alloc_command<Item::CommandNinePatch>();
 	ERR_FAIL_COND(!style);
@@ -874,6 +1163,7 @@ void RendererCanvasCull::canvas_item_add_primitive(RID p_item, const Vector<Poin
 
 	Item *canvas_item = canvas_item_owner.getornull(p_item);
 	ERR_FAIL_COND(!canvas_item);
+	_item_mark_bound_dirty(canvas_item);
 
 	Item::CommandPrimitive *prim = canvas_item->alloc_command<Item::CommandPrimitive>();
 	ERR_FAIL_COND(!prim);
@@ -900,6 +1190,7 @@ void RendererCanvasCull::canvas_item_add_primitive(RID p_item, const Vector<Poin
 void RendererCanvasCull::canvas_item_add_polygon(RID p_item, const Vector<Point2> &p_points, const Vector<Color> &p_colors, const Vector<Point2> &p_uvs, RID p_texture) {
 	Item *canvas_item = canvas_item_owner.getornull(p_item);
 	ERR_FAIL_COND(!canvas_item);
+	_item_mark_bound_dirty(canvas_item);
 #ifdef DEBUG_ENABLED
 	int pointcount = p_points.size();
 	ERR_FAIL_COND(pointcount < 3);
@@ -921,6 +1212,7 @@ void RendererCanvasCull::canvas_item_add_polygon(RID p_item, const Vector<Point2
 void RendererCanvasCull::canvas_item_add_triangle_array(RID p_item, const Vector<int> &p_indices, const Vector<Point2> &p_points, const Vector<Color> &p_colors, const Vector<Point2> &p_uvs, const Vector<int> &p_bones, const Vector<float> &p_weights, RID p_texture, int p_count) {
 	Item *canvas_item = canvas_item_owner.getornull(p_item);
 	ERR_FAIL_COND(!canvas_item);
+	_item_mark_bound_dirty(canvas_item);
 
 	int vertex_count = p_points.size();
 	ERR_FAIL_COND(vertex_count == 0);
@@ -944,6 +1236,7 @@ void RendererCanvasCull::canvas_item_add_triangle_array(RID p_item, const Vector
 void RendererCanvasCull::canvas_item_add_set_transform(RID p_item, const Transform2D &p_transform) {
 	Item *canvas_item = canvas_item_owner.getornull(p_item);
 	ERR_FAIL_COND(!canvas_item);
+	_item_mark_bound_dirty(canvas_item);
 
 	Item::CommandTransform *tr = canvas_item->alloc_command<Item::CommandTransform>();
 	ERR_FAIL_COND(!tr);
@@ -953,6 +1246,7 @@ void RendererCanvasCull::canvas_item_add_set_transform(RID p_item, const Transfo
 void RendererCanvasCull::canvas_item_add_mesh(RID p_item, const RID &p_mesh, const Transform2D &p_transform, const Color &p_modulate, RID p_texture) {
 	Item *canvas_item = canvas_item_owner.getornull(p_item);
 	ERR_FAIL_COND(!canvas_item);
+	_item_mark_bound_dirty(canvas_item);
 	ERR_FAIL_COND(!p_mesh.is_valid());
 
 	Item::CommandMesh *m = canvas_item->alloc_command<Item::CommandMesh>();
@@ -972,6 +1266,7 @@ void RendererCanvasCull::canvas_item_add_mesh(RID p_item, const RID &p_mesh, con
 void RendererCanvasCull::canvas_item_add_particles(RID p_item, RID p_particles, RID p_texture) {
 	Item *canvas_item = canvas_item_owner.getornull(p_item);
 	ERR_FAIL_COND(!canvas_item);
+	_item_mark_bound_dirty(canvas_item);
 
 	Item::CommandParticles *part = canvas_item->alloc_command<Item::CommandParticles>();
 	ERR_FAIL_COND(!part);
@@ -986,6 +1281,7 @@ void RendererCanvasCull::canvas_item_add_particles(RID p_item, RID p_particles,
 void RendererCanvasCull::canvas_item_add_multimesh(RID p_item, RID p_mesh, RID p_texture) {
 	Item *canvas_item = canvas_item_owner.getornull(p_item);
 	ERR_FAIL_COND(!canvas_item);
+	_item_mark_bound_dirty(canvas_item);
 
 	Item::CommandMultiMesh *mm = canvas_item->alloc_command<Item::CommandMultiMesh>();
 	ERR_FAIL_COND(!mm);
@@ -997,6 +1293,7 @@ void RendererCanvasCull::canvas_item_add_multimesh(RID p_item, RID p_mesh, RID p
 void RendererCanvasCull::canvas_item_add_clip_ignore(RID p_item, bool p_ignore) {
 	Item *canvas_item = canvas_item_owner.getornull(p_item);
 	ERR_FAIL_COND(!canvas_item);
+	_item_mark_bound_dirty(canvas_item);
 
 	Item::CommandClipIgnore *ci = canvas_item->alloc_command<Item::CommandClipIgnore>();
 	ERR_FAIL_COND(!ci);
@@ -1006,6 +1303,7 @@ void RendererCanvasCull::canvas_item_add_clip_ignore(RID p_item, bool p_ignore)
 void RendererCanvasCull::canvas_item_add_animation_slice(RID p_item, double p_animation_length, double p_slice_begin, double p_slice_end, double p_offset) {
 	Item *canvas_item = canvas_item_owner.getornull(p_item);
 	ERR_FAIL_COND(!canvas_item);
+	_item_mark_bound_dirty(canvas_item);
 
 	Item::CommandAnimationSlice *as = canvas_item->alloc_command<Item::CommandAnimationSlice>();
 	ERR_FAIL_COND(!as);
@@ -1084,6 +1382,8 @@ void RendererCanvasCull::canvas_item_set_copy_to_backbuffer(RID p_item, bool p_e
 		canvas_item->copy_back_buffer->rect = p_rect;
 		canvas_item->copy_back_buffer->full = p_rect == Rect2();
 	}
+
+	_item_mark_bound_dirty(canvas_item);
 }
 
 void RendererCanvasCull::canvas_item_clear(RID p_item) {
@@ -1091,6 +1391,7 @@ void RendererCanvasCull::canvas_item_clear(RID p_item) {
 	ERR_FAIL_COND(!canvas_item);
 
 	canvas_item->clear();
+	_item_mark_bound_dirty(canvas_item);
 }
 
 void RendererCanvasCull::canvas_item_set_draw_index(RID p_item, int p_index) {
@@ -1144,6 +1445,8 @@ void RendererCanvasCull::canvas_item_set_visibility_notifier(RID p_item, bool p_
 			canvas_item->visibility_notifier = nullptr;
 		}
 	}
+
+	_item_mark_bound_dirty(canvas_item);
 }
 
 void RendererCanvasCull::canvas_item_set_canvas_group_mode(RID p_item, RS::CanvasGroupMode p_mode, float p_clear_margin, bool p_fit_empty, float p_fit_margin, bool p_blur_mipmaps) {
@@ -1165,6 +1468,8 @@ void RendererCanvasCull::canvas_item_set_canvas_group_mode(RID p_item, RS::Canva
 		canvas_item->canvas_group->blur_mipmaps = p_blur_mipmaps;
 		canvas_item->canvas_group->clear_margin = p_clear_margin;
 	}
+
+	_item_mark_bound_dirty(canvas_item);
 }
 
 RID RendererCanvasCull::canvas_light_allocate() {
@@ -1582,6 +1887,11 @@ bool RendererCanvasCull::free(RID p_rid) {
 
 		for (int i = 0; i < canvas->child_items.size(); i++) {
 			canvas->child_items[i].item->parent = RID();
+			_item_detach_from_index(canvas->child_items[i].item, nullptr);
+		}
+
+		if (canvas->child_index) {
+			memdelete(canvas->child_index);
 		}
 
 		for (Set<RendererCanvasRender::Light *>::Element *E = canvas->lights.front(); E; E = E->next()) {
@@ -1602,9 +1912,12 @@ bool RendererCanvasCull::free(RID p_rid) {
 			if (canvas_owner.owns(canvas_item->parent)) {
 				Canvas *canvas = canvas_owner.getornull(canvas_item->parent);
 				canvas->erase_item(canvas_item);
+				_item_detach_from_index(canvas_item, canvas->child_index);
 			} else if (canvas_item_owner.owns(canvas_item->parent)) {
 				Item *item_owner = canvas_item_owner.getornull(canvas_item->parent);
 				item_owner->child_items.erase(canvas_item);
+				_item_detach_from_index(canvas_item, item_owner->child_index);
+				_item_mark_bound_dirty(item_owner);
 
 				if (item_owner->sort_y) {
 					_mark_ysort_dirty(item_owner, canvas_item_owner);
@@ -1614,6 +1927,11 @@ bool RendererCanvasCull::free(RID p_rid) {
 
 		for (int i = 0; i < canvas_item->child_items.size(); i++) {
 			canvas_item->child_items[i]->parent = RID();
+			_item_detach_from_index(canvas_item->child_items[i], nullptr);
+		}
+
+		if (canvas_item->child_index) {
+			memdelete(canvas_item->child_index);
 		}
 
 		if (canvas_item->visibility_notifier != nullptr) {
@@ -1684,6 +2002,7 @@ RendererCanvasCull::RendererCanvasCull() {
 	z_last_list = (RendererCanvasRender::Item **)memalloc(z_range * sizeof(RendererCanvasRender::Item *));
 
 	disable_scale = false;
+	default_use_spatial_index = GLOBAL_DEF("rendering/2d/culling/use_spatial_index", false);
 }
 
 RendererCanvasCull::~RendererCanvasCull() {
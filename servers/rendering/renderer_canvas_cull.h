@@ -31,12 +31,15 @@
 #ifndef RENDERING_SERVER_CANVAS_CULL_H
 #define RENDERING_SERVER_CANVAS_CULL_H
 
+#include "core/math/bvh.h"
 #include "core/templates/paged_allocator.h"
 #include "renderer_compositor.h"
 #include "renderer_viewport.h"
 
 class RendererCanvasCull {
 public:
+	struct ChildIndex;
+
 	struct Item : public RendererCanvasRender::Item {
 		RID parent; // canvas it belongs to
 		List<Item *>::Element *E;
@@ -70,6 +73,27 @@ public:
 
 		VisibilityNotifierData *visibility_notifier = nullptr;
 
+		// Bound of the item and its visible descendants in local space, used by the spatial index to skip
+		// whole subtrees that are offscreen. Kept up to date lazily, see RendererCanvasCull::_item_update_bound().
+		Rect2 bound_rect;
+		bool bound_valid = false; // false when nothing in the subtree draws
+		bool bound_unbounded = false; // something in the subtree is drawn regardless of its rect
+		bool bound_dirty = true; // bound_rect must be recomputed
+		bool bound_moved = false; // bound_rect or xform changed since the parent last used them
+		bool index_unbounded = false; // in the unbounded list of the parent's child index
+		BVHHandle index_handle; // in the parent's child index
+		uint32_t sibling_order = 0; // position among the parent's children, used to sort index hits
+		ChildIndex *child_index = nullptr; // for items with many children
+
+		// Transform, global rect and modulate computed by the last cull, reused while neither the item nor its
+		// ancestors change. See RendererCanvasCull::_cull_canvas_item().
+		Transform2D cull_xform;
+		Rect2 cull_global_rect;
+		Color cull_modulate;
+		uint64_t cull_version = 0; // changes whenever the values above are recomputed
+		uint64_t cull_parent_version = 0; // cull_version of the parent they were computed from
+		bool cull_dirty = true; // the item's own transform, rect or modulate changed
+
 		Item() {
 			children_order_dirty = true;
 			E = nullptr;
@@ -84,15 +108,34 @@ public:
 			ysort_xform = Transform2D();
 			ysort_pos = Vector2();
 			ysort_index = 0;
+			index_handle.set_invalid();
 		}
 	};
 
+	enum {
+		// items and canvases with this many children index them
+		SPATIAL_INDEX_MIN_CHILDREN = 64,
+	};
+
+	// Spatial index of the children of an item or canvas, using their bounds in the parent's space.
+	struct ChildIndex {
+		BVH_Manager<Item, false, 32, Rect2, Vector2> bvh;
+		LocalVector<Item *> unbounded_items;
+		LocalVector<Item *> dirty_items; // children whose bound moved since the index was updated
+	};
+
 	struct ItemIndexSort {
 		_FORCE_INLINE_ bool operator()(const Item *p_left, const Item *p_right) const {
 			return p_left->index < p_right->index;
 		}
 	};
 
+	struct ItemSiblingOrderSort {
+		_FORCE_INLINE_ bool operator()(const Item *p_left, const Item *p_right) const {
+			return p_left->sibling_order < p_right->sibling_order;
+		}
+	};
+
 	struct ItemPtrSort {
 		_FORCE_INLINE_ bool operator()(const Item *p_left, const Item *p_right) const {
 			if (Math::is_equal_approx(p_left->ysort_pos.y, p_right->ysort_pos.y)) {
@@ -140,6 +183,14 @@ public:
 		Color modulate;
 		RID parent;
 		float parent_scale;
+		bool use_spatial_index;
+		ChildIndex *child_index = nullptr;
+
+		// root of the cached item transforms, 0 while the canvas is culled with a different transform every frame
+		Transform2D cull_transform;
+		Point2 cull_clip_position;
+		bool cull_snap_2d_transforms_to_pixel = false;
+		uint64_t cull_version = 0;
 
 		int find_item(Item *p_item) {
 			for (int i = 0; i < child_items.size(); i++) {
@@ -160,6 +211,7 @@ public:
 			modulate = Color(1, 1, 1, 1);
 			children_order_dirty = true;
 			parent_scale = 1.0;
+			use_spatial_index = false;
 		}
 	};
 
@@ -170,6 +222,9 @@ public:
 	bool disable_scale;
 	bool sdf_used = false;
 	bool snapping_2d_transforms_to_pixel = false;
+	bool default_use_spatial_index = false;
+	bool cull_use_spatial_index = false; // while culling a canvas
+	uint64_t cull_version_counter = 0;
 
 	PagedAllocator<Item::VisibilityNotifierData> visibility_notifier_allocator;
 	SelfList<Item::VisibilityNotifierData>::List visibility_notifier_list;
@@ -177,8 +232,16 @@ public:
 	_FORCE_INLINE_ void _attach_canvas_item_for_draw(Item *ci, Item *p_canvas_clip, RendererCanvasRender::Item **z_list, RendererCanvasRender::Item **z_last_list, const Transform2D &xform, const Rect2 &p_clip_rect, Rect2 global_rect, const Color &modulate, int p_z, RendererCanvasCull::Item *p_material_owner, bool use_canvas_group, RendererCanvasRender::Item *canvas_group_from, const Transform2D &p_xform);
 
 private:
-	void _render_canvas_item_tree(RID p_to_render_target, Canvas::ChildItem *p_child_items, int p_child_item_count, Item *p_canvas_item, const Transform2D &p_transform, const Rect2 &p_clip_rect, const Color &p_modulate, RendererCanvasRender::Light *p_lights, RendererCanvasRender::Light *p_directional_lights, RS::CanvasItemTextureFilter p_default_filter, RS::CanvasItemTextureRepeat p_default_repeat, bool p_snap_2d_vertices_to_pixel);
-	void _cull_canvas_item(Item *p_canvas_item, const Transform2D &p_transform, const Rect2 &p_clip_rect, const Color &p_modulate, int p_z, RendererCanvasRender::Item **z_list, RendererCanvasRender::Item **z_last_list, Item *p_canvas_clip, Item *p_material_owner, bool allow_y_sort);
+	void _render_canvas_item_tree(RID p_to_render_target, Canvas::ChildItem *p_child_items, int p_child_item_count, Item *p_canvas_item, const Transform2D &p_transform, const Rect2 &p_clip_rect, const Color &p_modulate, RendererCanvasRender::Light *p_lights, RendererCanvasRender::Light *p_directional_lights, RS::CanvasItemTextureFilter p_default_filter, RS::CanvasItemTextureRepeat p_default_repeat, bool p_snap_2d_vertices_to_pixel, uint64_t p_cull_version);
+	void _cull_canvas_item(Item *p_canvas_item, const Transform2D &p_transform, const Rect2 &p_clip_rect, const Color &p_modulate, int p_z, RendererCanvasRender::Item **z_list, RendererCanvasRender::Item **z_last_list, Item *p_canvas_clip, Item *p_material_owner, bool allow_y_sort, uint64_t p_parent_cull_version);
+
+	void _item_mark_bound_dirty(Item *p_item);
+	void _item_mark_moved(Item *p_item);
+	void _item_detach_from_index(Item *p_item, ChildIndex *p_index);
+	void _item_update_bound(Item *p_item);
+	void _index_update(ChildIndex *p_index);
+	void _index_update_item(ChildIndex *p_index, Item *p_item);
+	int _index_cull(ChildIndex *p_index, const Transform2D &p_transform, const Size2 &p_clip_size, Item **r_items, int p_max_items);
 
 	RendererCanvasRender::Item **z_list;
 	RendererCanvasRender::Item **z_last_list;
@@ -195,6 +258,7 @@ public:
 	void canvas_set_modulate(RID p_canvas, const Color &p_color);
 	void canvas_set_parent(RID p_canvas, RID p_parent, float p_scale);
 	void canvas_set_disable_scale(bool p_disable);
+	void canvas_set_use_spatial_index(RID p_canvas, bool p_enable);
 
 	RID canvas_item_allocate();
 	void canvas_item_initialize(RID p_rid);
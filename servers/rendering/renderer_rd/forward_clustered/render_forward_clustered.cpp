@@ -30,6 +30,7 @@
 
 #include "render_forward_clustered.h"
 #include "core/config/project_settings.h"
+#include "core/os/worker_thread_pool.h"
 #include "servers/rendering/rendering_device.h"
 #include "servers/rendering/rendering_server_default.h"
 
@@ -542,7 +543,7 @@ void RenderForwardClustered::_render_list(RenderingDevice::DrawListID p_draw_lis
 
 void RenderForwardClustered::_render_list_thread_function(uint32_t p_thread, RenderListParameters *p_params) {
 	uint32_t render_total = p_params->element_count;
-	uint32_t total_threads = RendererThreadPool::singleton->thread_work_pool.get_thread_count();
+	uint32_t total_threads = WorkerThreadPool::get_singleton()->get_thread_count();
 	uint32_t render_from = p_thread * render_total / total_threads;
 	uint32_t render_to = (p_thread + 1 == total_threads) ? render_total : ((p_thread + 1) * render_total / total_threads);
 	_render_list(thread_draw_lists[p_thread], p_params->framebuffer_format, p_params, render_from, render_to);
@@ -554,9 +555,9 @@ void RenderForwardClustered::_render_list_with_threads(RenderListParameters *p_p
 
 	if ((uint32_t)p_params->element_count > render_list_thread_threshold && false) { // secondary command buffers need more testing at this time
 		//multi threaded
-		thread_draw_lists.resize(RendererThreadPool::singleton->thread_work_pool.get_thread_count());
+		thread_draw_lists.resize(WorkerThreadPool::get_singleton()->get_thread_count());
 		RD::get_singleton()->draw_list_begin_split(p_framebuffer, thread_draw_lists.size(), thread_draw_lists.ptr(), p_initial_color_action, p_final_color_action, p_initial_depth_action, p_final_depth_action, p_clear_color_values, p_clear_depth, p_clear_stencil, p_region, p_storage_textures);
-		RendererThreadPool::singleton->thread_work_pool.do_work(thread_draw_lists.size(), this, &RenderForwardClustered::_render_list_thread_function, p_params);
+		WorkerThreadPool::get_singleton()->do_work(thread_draw_lists.size(), this, &RenderForwardClustered::_render_list_thread_function, p_params);
 		RD::get_singleton()->draw_list_end(p_params->barrier);
 	} else {
 		//single threaded
@@ -859,9 +860,12 @@ void RenderForwardClustered::_fill_instance_data(RenderListType p_render_list, i
 
 		bool cant_repeat = instance_data.flags & INSTANCE_DATA_FLAG_MULTIMESH || inst->mesh_instance.is_valid();
 
-		if (prev_surface != nullptr && !cant_repeat && prev_surface->sort.sort_key1 == surface->sort.sort_key1 && prev_surface->sort.sort_key2 == surface->sort.sort_key2 && repeats < RenderElementInfo::MAX_REPEATS) {
+		if (prev_surface != nullptr && !cant_repeat && RenderList::BatchKey(prev_surface) == RenderList::BatchKey(surface) && repeats < RenderElementInfo::MAX_REPEATS) {
 			//this element is the same as the previous one, count repeats to draw it using instancing
 			repeats++;
+			if (p_render_info) {
+				p_render_info[RS::VIEWPORT_RENDER_INFO_MERGED_DRAW_CALLS_IN_FRAME]++;
+			}
 		} else {
 			if (repeats > 0) {
 				for (uint32_t j = 1; j <= repeats; j++) {
@@ -905,33 +909,212 @@ _FORCE_INLINE_ static uint32_t _indices_to_primitives(RS::PrimitiveType p_primit
 	static const uint32_t subtractor[RS::PRIMITIVE_MAX] = { 0, 0, 1, 0, 1 };
 	return (p_indices - subtractor[p_primitive]) / divisor[p_primitive];
 }
-void RenderForwardClustered::_fill_render_list(RenderListType p_render_list, const RenderDataRD *p_render_data, PassMode p_pass_mode, bool p_using_sdfgi, bool p_using_opaque_gi, bool p_append) {
-	if (p_render_list == RENDER_LIST_OPAQUE) {
-		scene_state.used_sss = false;
-		scene_state.used_screen_texture = false;
-		scene_state.used_normal_texture = false;
-		scene_state.used_depth_texture = false;
+void RenderForwardClustered::RenderList::_radix_gather_thread_function(uint32_t p_thread, RadixSortData *p_data) {
+	uint32_t from = p_thread * p_data->size / p_data->thread_count;
+	uint32_t to = (p_thread + 1) * p_data->size / p_data->thread_count;
+
+	uint64_t and1 = ~uint64_t(0);
+	uint64_t or1 = 0;
+	uint64_t and2 = ~uint64_t(0);
+	uint64_t or2 = 0;
+
+	for (uint32_t i = from; i < to; i++) {
+		RadixSortItem &item = p_data->src[i];
+		item.element = p_data->elements[i];
+		item.key1 = item.element->sort.sort_key1;
+		item.key2 = item.element->sort.sort_key2;
+		and1 &= item.key1;
+		or1 |= item.key1;
+		and2 &= item.key2;
+		or2 |= item.key2;
 	}
-	uint32_t lightmap_captures_used = 0;
 
-	Plane near_plane(p_render_data->cam_transform.origin, -p_render_data->cam_transform.basis.get_axis(Vector3::AXIS_Z));
-	near_plane.d += p_render_data->cam_projection.get_z_near();
-	float z_max = p_render_data->cam_projection.get_z_far() - p_render_data->cam_projection.get_z_near();
+	uint64_t *masks = &radix_key_masks[p_thread * 4];
+	masks[0] = and1;
+	masks[1] = or1;
+	masks[2] = and2;
+	masks[3] = or2;
+}
 
-	RenderList *rl = &render_list[p_render_list];
-	_update_dirty_geometry_instances();
+void RenderForwardClustered::RenderList::_radix_count_thread_function(uint32_t p_thread, RadixSortData *p_data) {
+	uint32_t from = p_thread * p_data->size / p_data->thread_count;
+	uint32_t to = (p_thread + 1) * p_data->size / p_data->thread_count;
+	uint32_t shift = (p_data->digit & 7) * 8;
+	bool use_key2 = p_data->digit >= 8;
 
-	if (!p_append) {
-		rl->clear();
-		if (p_render_list == RENDER_LIST_OPAQUE) {
-			render_list[RENDER_LIST_ALPHA].clear(); //opaque fills alpha too
+	uint32_t *counts = &radix_offsets[p_thread * 256];
+	memset(counts, 0, sizeof(uint32_t) * 256);
+
+	for (uint32_t i = from; i < to; i++) {
+		const RadixSortItem &item = p_data->src[i];
+		counts[((use_key2 ? item.key2 : item.key1) >> shift) & 0xFF]++;
+	}
+}
+
+void RenderForwardClustered::RenderList::_radix_scatter_thread_function(uint32_t p_thread, RadixSortData *p_data) {
+	uint32_t from = p_thread * p_data->size / p_data->thread_count;
+	uint32_t to = (p_thread + 1) * p_data->size / p_data->thread_count;
+	uint32_t shift = (p_data->digit & 7) * 8;
+	bool use_key2 = p_data->digit >= 8;
+
+	uint32_t *offsets = &radix_offsets[p_thread * 256];
+
+	for (uint32_t i = from; i < to; i++) {
+		const RadixSortItem &item = p_data->src[i];
+		p_data->dst[offsets[((use_key2 ? item.key2 : item.key1) >> shift) & 0xFF]++] = item;
+	}
+}
+
+void RenderForwardClustered::RenderList::_radix_sort(GeometryInstanceSurfaceDataCache **p_elements, uint32_t p_size) {
+	if (p_size < RADIX_SORT_MIN_ELEMENTS) {
+		SortArray<GeometryInstanceSurfaceDataCache *, SortByKey> sorter;
+		sorter.sort(p_elements, p_size);
+		return;
+	}
+
+	RadixSortData data;
+	data.elements = p_elements;
+	data.size = p_size;
+	data.thread_count = p_size >= RADIX_SORT_THREAD_MIN_ELEMENTS ? WorkerThreadPool::get_singleton()->get_thread_count() : 1;
+
+	if (radix_items.size() < p_size) {
+		radix_items.resize(p_size);
+		radix_items_swap.resize(p_size);
+	}
+	radix_offsets.resize(data.thread_count * 256);
+	radix_key_masks.resize(data.thread_count * 4);
+
+	data.src = radix_items.ptr();
+	data.dst = radix_items_swap.ptr();
+
+	if (data.thread_count > 1) {
+		WorkerThreadPool::get_singleton()->do_work(data.thread_count, this, &RenderList::_radix_gather_thread_function, &data);
+	} else {
+		_radix_gather_thread_function(0, &data);
+	}
+
+	uint64_t and1 = ~uint64_t(0);
+	uint64_t or1 = 0;
+	uint64_t and2 = ~uint64_t(0);
+	uint64_t or2 = 0;
+	for (uint32_t i = 0; i < data.thread_count; i++) {
+		const uint64_t *masks = &radix_key_masks[i * 4];
+		and1 &= masks[0];
+		or1 |= masks[1];
+		and2 &= masks[2];
+		or2 |= masks[3];
+	}
+	uint64_t changed1 = and1 ^ or1;
+	uint64_t changed2 = and2 ^ or2;
+
+	// Least significant byte first, key2 holds the most significant half.
+	for (uint32_t digit = 0; digit < 16; digit++) {
+		uint64_t changed = digit >= 8 ? changed2 : changed1;
+		if (((changed >> ((digit & 7) * 8)) & 0xFF) == 0) {
+			continue; // Same in all the keys, it can't change the order.
 		}
+
+		data.digit = digit;
+
+		if (data.thread_count > 1) {
+			WorkerThreadPool::get_singleton()->do_work(data.thread_count, this, &RenderList::_radix_count_thread_function, &data);
+		} else {
+			_radix_count_thread_function(0, &data);
+		}
+
+		// Each thread scatters its part after the same bucket of the threads before it, which keeps the sort stable.
+		uint32_t offset = 0;
+		for (uint32_t i = 0; i < 256; i++) {
+			for (uint32_t j = 0; j < data.thread_count; j++) {
+				uint32_t count = radix_offsets[j * 256 + i];
+				radix_offsets[j * 256 + i] = offset;
+				offset += count;
+			}
+		}
+
+		if (data.thread_count > 1) {
+			WorkerThreadPool::get_singleton()->do_work(data.thread_count, this, &RenderList::_radix_scatter_thread_function, &data);
+		} else {
+			_radix_scatter_thread_function(0, &data);
+		}
+
+		SWAP(data.src, data.dst);
 	}
 
-	//fill list
+	for (uint32_t i = 0; i < p_size; i++) {
+		p_elements[i] = data.src[i].element;
+	}
+}
+
+void RenderForwardClustered::RenderList::merge_instances_range(uint32_t p_from, uint32_t p_size) {
+	// Move every instance that can be drawn together with an earlier one right after it, keeping
+	// the first instance of each group where the sort placed it. Identical meshes at different
+	// depths then end up next to each other and become a single instanced draw.
+	GeometryInstanceSurfaceDataCache **elements_ptr = elements.ptr() + p_from;
+
+	batch_groups.clear();
+	batch_group_offsets.clear();
+	batch_element_groups.resize(p_size);
+
+	for (uint32_t i = 0; i < p_size; i++) {
+		const GeometryInstanceSurfaceDataCache *surface = elements_ptr[i];
+		uint32_t group = batch_group_offsets.size();
+
+		bool cant_repeat = surface->owner->flags_cache & INSTANCE_DATA_FLAG_MULTIMESH || surface->owner->mesh_instance.is_valid();
+		if (!cant_repeat) {
+			BatchKey key(surface);
+			const uint32_t *existing = batch_groups.lookup_ptr(key);
+			if (existing) {
+				group = *existing;
+			} else {
+				batch_groups.insert(key, group);
+			}
+		}
+
+		if (group == batch_group_offsets.size()) {
+			batch_group_offsets.push_back(0);
+		}
+		batch_group_offsets[group]++;
+		batch_element_groups[i] = group;
+	}
+
+	if (batch_group_offsets.size() == p_size) {
+		return; // Nothing to merge.
+	}
+
+	uint32_t offset = 0;
+	for (uint32_t i = 0; i < batch_group_offsets.size(); i++) {
+		uint32_t count = batch_group_offsets[i];
+		batch_group_offsets[i] = offset;
+		offset += count;
+	}
+
+	batch_elements.resize(p_size);
+	for (uint32_t i = 0; i < p_size; i++) {
+		batch_elements[batch_group_offsets[batch_element_groups[i]]++] = elements_ptr[i];
+	}
+
+	memcpy(elements_ptr, batch_elements.ptr(), sizeof(GeometryInstanceSurfaceDataCache *) * p_size);
+}
+
+void RenderForwardClustered::_fill_render_list_thread_function(uint32_t p_thread, FillRenderListParameters *p_params) {
+	const Plane &near_plane = p_params->near_plane;
+	float z_max = p_params->z_max;
+
+	uint32_t from = p_thread * p_params->render_data->instances->size() / p_params->thread_count;
+	uint32_t to = (p_thread + 1) * p_params->render_data->instances->size() / p_params->thread_count;
 
-	for (int i = 0; i < (int)p_render_data->instances->size(); i++) {
-		GeometryInstanceForwardClustered *inst = static_cast<GeometryInstanceForwardClustered *>((*p_render_data->instances)[i]);
+	FillRenderListThreadData &td = fill_render_list_threads[p_thread];
+	td.elements.clear();
+	td.alpha_elements.clear();
+	td.render_info = RendererScene::RenderInfo();
+	td.used_sss = false;
+	td.used_screen_texture = false;
+	td.used_normal_texture = false;
+	td.used_depth_texture = false;
+
+	for (uint32_t i = from; i < to; i++) {
+		GeometryInstanceForwardClustered *inst = static_cast<GeometryInstanceForwardClustered *>((*p_params->render_data->instances)[i]);
 
 		Vector3 support_min = inst->transformed_aabb.get_support(-near_plane.normal);
 		inst->depth = near_plane.distance_to(support_min);
@@ -945,7 +1128,7 @@ void RenderForwardClustered::_fill_render_list(RenderListType p_render_list, con
 		bool uses_lightmap = false;
 		bool uses_gi = false;
 
-		if (p_render_list == RENDER_LIST_OPAQUE) {
+		if (p_params->render_list == RENDER_LIST_OPAQUE) {
 			//setup GI
 
 			if (inst->lightmap_instance.is_valid()) {
@@ -969,23 +1152,13 @@ void RenderForwardClustered::_fill_render_list(RenderListType p_render_list, con
 				}
 
 			} else if (inst->lightmap_sh) {
-				if (lightmap_captures_used < scene_state.max_lightmap_captures) {
-					const Color *src_capture = inst->lightmap_sh->sh;
-					LightmapCaptureData &lcd = scene_state.lightmap_captures[lightmap_captures_used];
-					for (int j = 0; j < 9; j++) {
-						lcd.sh[j * 4 + 0] = src_capture[j].r;
-						lcd.sh[j * 4 + 1] = src_capture[j].g;
-						lcd.sh[j * 4 + 2] = src_capture[j].b;
-						lcd.sh[j * 4 + 3] = src_capture[j].a;
-					}
+				if (inst->gi_offset_cache != 0xFFFFFFFF) { // Got a capture slot in _fill_render_list().
 					flags |= INSTANCE_DATA_FLAG_USE_LIGHTMAP_CAPTURE;
-					inst->gi_offset_cache = lightmap_captures_used;
-					lightmap_captures_used++;
 					uses_lightmap = true;
 				}
 
 			} else {
-				if (p_using_opaque_gi) {
+				if (p_params->using_opaque_gi) {
 					flags |= INSTANCE_DATA_FLAG_USE_GI_BUFFERS;
 				}
 
@@ -1010,7 +1183,7 @@ void RenderForwardClustered::_fill_render_list(RenderListType p_render_list, con
 					flags |= INSTANCE_DATA_FLAG_USE_VOXEL_GI;
 					uses_gi = true;
 				} else {
-					if (p_using_sdfgi && inst->can_sdfgi) {
+					if (p_params->using_sdfgi && inst->can_sdfgi) {
 						flags |= INSTANCE_DATA_FLAG_USE_SDFGI;
 						uses_gi = true;
 					}
@@ -1028,13 +1201,13 @@ void RenderForwardClustered::_fill_render_list(RenderListType p_render_list, con
 
 			// LOD
 
-			if (p_render_data->screen_lod_threshold > 0.0 && storage->mesh_surface_has_lod(surf->surface)) {
+			if (p_params->render_data->screen_lod_threshold > 0.0 && storage->mesh_surface_has_lod(surf->surface)) {
 				//lod
-				Vector3 lod_support_min = inst->transformed_aabb.get_support(-p_render_data->lod_camera_plane.normal);
-				Vector3 lod_support_max = inst->transformed_aabb.get_support(p_render_data->lod_camera_plane.normal);
+				Vector3 lod_support_min = inst->transformed_aabb.get_support(-p_params->render_data->lod_camera_plane.normal);
+				Vector3 lod_support_max = inst->transformed_aabb.get_support(p_params->render_data->lod_camera_plane.normal);
 
-				float distance_min = p_render_data->lod_camera_plane.distance_to(lod_support_min);
-				float distance_max = p_render_data->lod_camera_plane.distance_to(lod_support_max);
+				float distance_min = p_params->render_data->lod_camera_plane.distance_to(lod_support_min);
+				float distance_max = p_params->render_data->lod_camera_plane.distance_to(lod_support_max);
 
 				float distance = 0.0;
 
@@ -1048,41 +1221,46 @@ void RenderForwardClustered::_fill_render_list(RenderListType p_render_list, con
 				}
 
 				uint32_t indices;
-				surf->sort.lod_index = storage->mesh_surface_get_lod(surf->surface, inst->lod_model_scale * inst->lod_bias, distance * p_render_data->lod_distance_multiplier, p_render_data->screen_lod_threshold, &indices);
-				if (p_render_data->render_info) {
-					indices = _indices_to_primitives(surf->primitive, indices);
-					if (p_render_list == RENDER_LIST_OPAQUE) { //opaque
-						p_render_data->render_info->info[RS::VIEWPORT_RENDER_INFO_TYPE_VISIBLE][RS::VIEWPORT_RENDER_INFO_PRIMITIVES_IN_FRAME] += indices;
-					} else if (p_render_list == RENDER_LIST_SECONDARY) { //shadow
-						p_render_data->render_info->info[RS::VIEWPORT_RENDER_INFO_TYPE_SHADOW][RS::VIEWPORT_RENDER_INFO_PRIMITIVES_IN_FRAME] += indices;
+				surf->sort.lod_index = storage->mesh_surface_get_lod(surf->surface, inst->lod_model_scale * inst->lod_bias, distance * p_params->render_data->lod_distance_multiplier, p_params->render_data->screen_lod_threshold, &indices);
+				if (p_params->render_data->render_info) {
+					// Both counters include every instance drawn, so the LOD totals add up to the frame total.
+					indices = _indices_to_primitives(surf->primitive, indices) * inst->instance_count;
+					if (p_params->render_list == RENDER_LIST_OPAQUE) { //opaque
+						td.render_info.info[RS::VIEWPORT_RENDER_INFO_TYPE_VISIBLE][RS::VIEWPORT_RENDER_INFO_PRIMITIVES_IN_FRAME] += indices;
+						td.render_info.add_lod_info(RS::VIEWPORT_RENDER_INFO_TYPE_VISIBLE, surf->sort.lod_index, indices);
+					} else if (p_params->render_list == RENDER_LIST_SECONDARY) { //shadow
+						td.render_info.info[RS::VIEWPORT_RENDER_INFO_TYPE_SHADOW][RS::VIEWPORT_RENDER_INFO_PRIMITIVES_IN_FRAME] += indices;
+						td.render_info.add_lod_info(RS::VIEWPORT_RENDER_INFO_TYPE_SHADOW, surf->sort.lod_index, indices);
 					}
 				}
 			} else {
 				surf->sort.lod_index = 0;
-				if (p_render_data->render_info) {
+				if (p_params->render_data->render_info) {
 					uint32_t to_draw = storage->mesh_surface_get_vertices_drawn_count(surf->surface);
 					to_draw = _indices_to_primitives(surf->primitive, to_draw);
 					to_draw *= inst->instance_count;
-					if (p_render_list == RENDER_LIST_OPAQUE) { //opaque
-						p_render_data->render_info->info[RS::VIEWPORT_RENDER_INFO_TYPE_VISIBLE][RS::VIEWPORT_RENDER_INFO_PRIMITIVES_IN_FRAME] += storage->mesh_surface_get_vertices_drawn_count(surf->surface);
-					} else if (p_render_list == RENDER_LIST_SECONDARY) { //shadow
-						p_render_data->render_info->info[RS::VIEWPORT_RENDER_INFO_TYPE_SHADOW][RS::VIEWPORT_RENDER_INFO_PRIMITIVES_IN_FRAME] += storage->mesh_surface_get_vertices_drawn_count(surf->surface);
+					if (p_params->render_list == RENDER_LIST_OPAQUE) { //opaque
+						td.render_info.info[RS::VIEWPORT_RENDER_INFO_TYPE_VISIBLE][RS::VIEWPORT_RENDER_INFO_PRIMITIVES_IN_FRAME] += to_draw;
+						td.render_info.add_lod_info(RS::VIEWPORT_RENDER_INFO_TYPE_VISIBLE, 0, to_draw);
+					} else if (p_params->render_list == RENDER_LIST_SECONDARY) { //shadow
+						td.render_info.info[RS::VIEWPORT_RENDER_INFO_TYPE_SHADOW][RS::VIEWPORT_RENDER_INFO_PRIMITIVES_IN_FRAME] += to_draw;
+						td.render_info.add_lod_info(RS::VIEWPORT_RENDER_INFO_TYPE_SHADOW, 0, to_draw);
 					}
 				}
 			}
 
 			// ADD Element
-			if (p_pass_mode == PASS_MODE_COLOR) {
+			if (p_params->pass_mode == PASS_MODE_COLOR) {
 #ifdef DEBUG_ENABLED
 				bool force_alpha = unlikely(get_debug_draw_mode() == RS::VIEWPORT_DEBUG_DRAW_OVERDRAW);
 #else
 				bool force_alpha = false;
 #endif
 				if (!force_alpha && (surf->flags & (GeometryInstanceSurfaceDataCache::FLAG_PASS_DEPTH | GeometryInstanceSurfaceDataCache::FLAG_PASS_OPAQUE))) {
-					rl->add_element(surf);
+					td.elements.push_back(surf);
 				}
 				if (force_alpha || (surf->flags & GeometryInstanceSurfaceDataCache::FLAG_PASS_ALPHA)) {
-					render_list[RENDER_LIST_ALPHA].add_element(surf);
+					td.alpha_elements.push_back(surf);
 					if (uses_gi) {
 						surf->sort.uses_forward_gi = 1;
 					}
@@ -1093,25 +1271,25 @@ void RenderForwardClustered::_fill_render_list(RenderListType p_render_list, con
 				}
 
 				if (surf->flags & GeometryInstanceSurfaceDataCache::FLAG_USES_SUBSURFACE_SCATTERING) {
-					scene_state.used_sss = true;
+					td.used_sss = true;
 				}
 				if (surf->flags & GeometryInstanceSurfaceDataCache::FLAG_USES_SCREEN_TEXTURE) {
-					scene_state.used_screen_texture = true;
+					td.used_screen_texture = true;
 				}
 				if (surf->flags & GeometryInstanceSurfaceDataCache::FLAG_USES_NORMAL_TEXTURE) {
-					scene_state.used_normal_texture = true;
+					td.used_normal_texture = true;
 				}
 				if (surf->flags & GeometryInstanceSurfaceDataCache::FLAG_USES_DEPTH_TEXTURE) {
-					scene_state.used_depth_texture = true;
+					td.used_depth_texture = true;
 				}
 
-			} else if (p_pass_mode == PASS_MODE_SHADOW || p_pass_mode == PASS_MODE_SHADOW_DP) {
+			} else if (p_params->pass_mode == PASS_MODE_SHADOW || p_params->pass_mode == PASS_MODE_SHADOW_DP) {
 				if (surf->flags & GeometryInstanceSurfaceDataCache::FLAG_PASS_SHADOW) {
-					rl->add_element(surf);
+					td.elements.push_back(surf);
 				}
 			} else {
 				if (surf->flags & (GeometryInstanceSurfaceDataCache::FLAG_PASS_DEPTH | GeometryInstanceSurfaceDataCache::FLAG_PASS_OPAQUE)) {
-					rl->add_element(surf);
+					td.elements.push_back(surf);
 				}
 			}
 
@@ -1120,9 +1298,112 @@ void RenderForwardClustered::_fill_render_list(RenderListType p_render_list, con
 			surf = surf->next;
 		}
 	}
+}
+
+void RenderForwardClustered::_fill_render_list(RenderListType p_render_list, const RenderDataRD *p_render_data, PassMode p_pass_mode, bool p_using_sdfgi, bool p_using_opaque_gi, bool p_append) {
+	if (p_render_list == RENDER_LIST_OPAQUE) {
+		scene_state.used_sss = false;
+		scene_state.used_screen_texture = false;
+		scene_state.used_normal_texture = false;
+		scene_state.used_depth_texture = false;
+	}
+
+	Plane near_plane(p_render_data->cam_transform.origin, -p_render_data->cam_transform.basis.get_axis(Vector3::AXIS_Z));
+	near_plane.d += p_render_data->cam_projection.get_z_near();
+	float z_max = p_render_data->cam_projection.get_z_far() - p_render_data->cam_projection.get_z_near();
+
+	RenderList *rl = &render_list[p_render_list];
+	_update_dirty_geometry_instances();
+
+	if (!p_append) {
+		rl->clear();
+		if (p_render_list == RENDER_LIST_OPAQUE) {
+			render_list[RENDER_LIST_ALPHA].clear(); //opaque fills alpha too
+		}
+	}
+
+	uint32_t instance_count = p_render_data->instances->size();
+
+	if (p_render_list == RENDER_LIST_OPAQUE) {
+		// Lightmap captures are packed in order, hand out the slots before filling the lists in parallel.
+		uint32_t lightmap_captures_used = 0;
+
+		for (uint32_t i = 0; i < instance_count; i++) {
+			GeometryInstanceForwardClustered *inst = static_cast<GeometryInstanceForwardClustered *>((*p_render_data->instances)[i]);
+			if (inst->lightmap_instance.is_valid() || !inst->lightmap_sh) {
+				continue;
+			}
+
+			if (lightmap_captures_used < scene_state.max_lightmap_captures) {
+				const Color *src_capture = inst->lightmap_sh->sh;
+				LightmapCaptureData &lcd = scene_state.lightmap_captures[lightmap_captures_used];
+				for (int j = 0; j < 9; j++) {
+					lcd.sh[j * 4 + 0] = src_capture[j].r;
+					lcd.sh[j * 4 + 1] = src_capture[j].g;
+					lcd.sh[j * 4 + 2] = src_capture[j].b;
+					lcd.sh[j * 4 + 3] = src_capture[j].a;
+				}
+				inst->gi_offset_cache = lightmap_captures_used;
+				lightmap_captures_used++;
+			} else {
+				inst->gi_offset_cache = 0xFFFFFFFF;
+			}
+		}
+
+		if (lightmap_captures_used) {
+			RD::get_singleton()->buffer_update(scene_state.lightmap_capture_buffer, 0, sizeof(LightmapCaptureData) * lightmap_captures_used, scene_state.lightmap_captures, RD::BARRIER_MASK_RASTER);
+		}
+	}
+
+	//fill list
 
-	if (p_render_list == RENDER_LIST_OPAQUE && lightmap_captures_used) {
-		RD::get_singleton()->buffer_update(scene_state.lightmap_capture_buffer, 0, sizeof(LightmapCaptureData) * lightmap_captures_used, scene_state.lightmap_captures, RD::BARRIER_MASK_RASTER);
+	FillRenderListParameters params;
+	params.render_list = p_render_list;
+	params.render_data = p_render_data;
+	params.pass_mode = p_pass_mode;
+	params.using_sdfgi = p_using_sdfgi;
+	params.using_opaque_gi = p_using_opaque_gi;
+	params.near_plane = near_plane;
+	params.z_max = z_max;
+	params.thread_count = instance_count > render_list_thread_threshold ? WorkerThreadPool::get_singleton()->get_thread_count() : 1;
+
+	if (fill_render_list_threads.size() < params.thread_count) {
+		fill_render_list_threads.resize(params.thread_count);
+	}
+
+	if (params.thread_count > 1) {
+		WorkerThreadPool::get_singleton()->do_work(params.thread_count, this, &RenderForwardClustered::_fill_render_list_thread_function, &params);
+	} else {
+		_fill_render_list_thread_function(0, &params);
+	}
+
+	for (uint32_t i = 0; i < params.thread_count; i++) {
+		const FillRenderListThreadData &td = fill_render_list_threads[i];
+
+		for (uint32_t j = 0; j < td.elements.size(); j++) {
+			rl->add_element(td.elements[j]);
+		}
+		for (uint32_t j = 0; j < td.alpha_elements.size(); j++) {
+			render_list[RENDER_LIST_ALPHA].add_element(td.alpha_elements[j]);
+		}
+
+		scene_state.used_sss = scene_state.used_sss || td.used_sss;
+		scene_state.used_screen_texture = scene_state.used_screen_texture || td.used_screen_texture;
+		scene_state.used_normal_texture = scene_state.used_normal_texture || td.used_normal_texture;
+		scene_state.used_depth_texture = scene_state.used_depth_texture || td.used_depth_texture;
+
+		if (p_render_data->render_info) {
+			for (int j = 0; j < RS::VIEWPORT_RENDER_INFO_TYPE_MAX; j++) {
+				for (int k = 0; k < RS::VIEWPORT_RENDER_INFO_MAX; k++) {
+					p_render_data->render_info->info[j][k] += td.render_info.info[j][k];
+				}
+				for (int k = 0; k < RS::MAX_RENDER_INFO_LODS; k++) {
+					for (int l = 0; l < RS::VIEWPORT_RENDER_LOD_INFO_MAX; l++) {
+						p_render_data->render_info->lod_info[j][k][l] += td.render_info.lod_info[j][k][l];
+					}
+				}
+			}
+		}
 	}
 }
 
@@ -1273,6 +1554,7 @@ void RenderForwardClustered::_render_scene(RenderDataRD *p_render_data, const Co
 
 	_fill_render_list(RENDER_LIST_OPAQUE, p_render_data, PASS_MODE_COLOR, using_sdfgi, using_sdfgi || using_voxelgi);
 	render_list[RENDER_LIST_OPAQUE].sort_by_key();
+	render_list[RENDER_LIST_OPAQUE].merge_instances();
 	render_list[RENDER_LIST_ALPHA].sort_by_reverse_depth_and_priority();
 	_fill_instance_data(RENDER_LIST_OPAQUE, p_render_data->render_info ? p_render_data->render_info->info[RS::VIEWPORT_RENDER_INFO_TYPE_VISIBLE] : (int *)nullptr);
 	_fill_instance_data(RENDER_LIST_ALPHA);
@@ -1607,6 +1889,7 @@ void RenderForwardClustered::_render_shadow_append(RID p_framebuffer, const Page
 	_fill_render_list(RENDER_LIST_SECONDARY, &render_data, pass_mode, false, false, true);
 	uint32_t render_list_size = render_list[RENDER_LIST_SECONDARY].elements.size() - render_list_from;
 	render_list[RENDER_LIST_SECONDARY].sort_by_key_range(render_list_from, render_list_size);
+	render_list[RENDER_LIST_SECONDARY].merge_instances_range(render_list_from, render_list_size);
 	_fill_instance_data(RENDER_LIST_SECONDARY, p_render_info ? p_render_info->info[RS::VIEWPORT_RENDER_INFO_TYPE_SHADOW] : (int *)nullptr, render_list_from, render_list_size, false);
 
 	{
@@ -1685,6 +1968,7 @@ void RenderForwardClustered::_render_particle_collider_heightfield(RID p_fb, con
 
 	_fill_render_list(RENDER_LIST_SECONDARY, &render_data, pass_mode);
 	render_list[RENDER_LIST_SECONDARY].sort_by_key();
+	render_list[RENDER_LIST_SECONDARY].merge_instances();
 	_fill_instance_data(RENDER_LIST_SECONDARY);
 
 	RID rp_uniform_set = _setup_render_pass_uniform_set(RENDER_LIST_SECONDARY, nullptr, RID());
@@ -1721,6 +2005,7 @@ void RenderForwardClustered::_render_material(const Transform3D &p_cam_transform
 	PassMode pass_mode = PASS_MODE_DEPTH_MATERIAL;
 	_fill_render_list(RENDER_LIST_SECONDARY, &render_data, pass_mode);
 	render_list[RENDER_LIST_SECONDARY].sort_by_key();
+	render_list[RENDER_LIST_SECONDARY].merge_instances();
 	_fill_instance_data(RENDER_LIST_SECONDARY);
 
 	RID rp_uniform_set = _setup_render_pass_uniform_set(RENDER_LIST_SECONDARY, nullptr, RID());
@@ -1764,6 +2049,7 @@ void RenderForwardClustered::_render_uv2(const PagedArray<GeometryInstance *> &p
 	PassMode pass_mode = PASS_MODE_DEPTH_MATERIAL;
 	_fill_render_list(RENDER_LIST_SECONDARY, &render_data, pass_mode);
 	render_list[RENDER_LIST_SECONDARY].sort_by_key();
+	render_list[RENDER_LIST_SECONDARY].merge_instances();
 	_fill_instance_data(RENDER_LIST_SECONDARY);
 
 	RID rp_uniform_set = _setup_render_pass_uniform_set(RENDER_LIST_SECONDARY, nullptr, RID());
@@ -1830,6 +2116,7 @@ void RenderForwardClustered::_render_sdfgi(RID p_render_buffers, const Vector3i
 	PassMode pass_mode = PASS_MODE_SDF;
 	_fill_render_list(RENDER_LIST_SECONDARY, &render_data, pass_mode);
 	render_list[RENDER_LIST_SECONDARY].sort_by_key();
+	render_list[RENDER_LIST_SECONDARY].merge_instances();
 	_fill_instance_data(RENDER_LIST_SECONDARY);
 
 	Vector3 half_extents = p_bounds.size * 0.5;
@@ -31,6 +31,7 @@
 #ifndef RENDERING_SERVER_SCENE_RENDER_FORWARD_CLUSTERED_H
 #define RENDERING_SERVER_SCENE_RENDER_FORWARD_CLUSTERED_H
 
+#include "core/templates/oa_hash_map.h"
 #include "core/templates/paged_allocator.h"
 #include "servers/rendering/renderer_rd/forward_clustered/scene_shader_forward_clustered.h"
 #include "servers/rendering/renderer_rd/pipeline_cache_rd.h"
@@ -528,22 +529,84 @@ class RenderForwardClustered : public RendererSceneRenderRD {
 			element_info.clear();
 		}
 
-		//should eventually be replaced by radix
-
 		struct SortByKey {
 			_FORCE_INLINE_ bool operator()(const GeometryInstanceSurfaceDataCache *A, const GeometryInstanceSurfaceDataCache *B) const {
 				return (A->sort.sort_key2 == B->sort.sort_key2) ? (A->sort.sort_key1 < B->sort.sort_key1) : (A->sort.sort_key2 < B->sort.sort_key2);
 			}
 		};
 
+		// Bigger lists are radix sorted a byte at a time, skipping the bytes that are the same in all the keys.
+		enum {
+			RADIX_SORT_MIN_ELEMENTS = 512,
+			RADIX_SORT_THREAD_MIN_ELEMENTS = 16384,
+		};
+
+		struct RadixSortItem {
+			uint64_t key1;
+			uint64_t key2;
+			GeometryInstanceSurfaceDataCache *element;
+		};
+
+		struct RadixSortData {
+			GeometryInstanceSurfaceDataCache **elements;
+			uint32_t size;
+			uint32_t thread_count;
+			uint32_t digit;
+			RadixSortItem *src;
+			RadixSortItem *dst;
+		};
+
+		LocalVector<RadixSortItem> radix_items;
+		LocalVector<RadixSortItem> radix_items_swap;
+		LocalVector<uint32_t> radix_offsets; // 256 per thread.
+		LocalVector<uint64_t> radix_key_masks; // AND and OR of both keys, per thread.
+
+		void _radix_gather_thread_function(uint32_t p_thread, RadixSortData *p_data);
+		void _radix_count_thread_function(uint32_t p_thread, RadixSortData *p_data);
+		void _radix_scatter_thread_function(uint32_t p_thread, RadixSortData *p_data);
+		void _radix_sort(GeometryInstanceSurfaceDataCache **p_elements, uint32_t p_size);
+
 		void sort_by_key() {
-			SortArray<GeometryInstanceSurfaceDataCache *, SortByKey> sorter;
-			sorter.sort(elements.ptr(), elements.size());
+			_radix_sort(elements.ptr(), elements.size());
 		}
 
 		void sort_by_key_range(uint32_t p_from, uint32_t p_size) {
-			SortArray<GeometryInstanceSurfaceDataCache *, SortByKey> sorter;
-			sorter.sort(elements.ptr() + p_from, p_size);
+			_radix_sort(elements.ptr() + p_from, p_size);
+		}
+
+		// Instances whose keys only differ in depth layer can be drawn together with a single instanced draw.
+		struct BatchKey {
+			uint64_t key1 = 0;
+			uint64_t key2 = 0;
+
+			_FORCE_INLINE_ bool operator==(const BatchKey &p_key) const {
+				return key1 == p_key.key1 && key2 == p_key.key2;
+			}
+
+			_FORCE_INLINE_ BatchKey() {}
+			_FORCE_INLINE_ BatchKey(const GeometryInstanceSurfaceDataCache *p_element) {
+				auto sort = p_element->sort;
+				sort.depth_layer = 0;
+				key1 = sort.sort_key1;
+				key2 = sort.sort_key2;
+			}
+		};
+
+		struct BatchKeyHasher {
+			static _FORCE_INLINE_ uint32_t hash(const BatchKey &p_key) {
+				return hash_djb2_one_64(p_key.key2, hash_one_uint64(p_key.key1));
+			}
+		};
+
+		OAHashMap<BatchKey, uint32_t, BatchKeyHasher> batch_groups;
+		LocalVector<uint32_t> batch_element_groups;
+		LocalVector<uint32_t> batch_group_offsets;
+		LocalVector<GeometryInstanceSurfaceDataCache *> batch_elements;
+
+		void merge_instances_range(uint32_t p_from, uint32_t p_size);
+
+		void merge_instances() {
+			merge_instances_range(0, elements.size());
 		}
 
 		struct SortByDepth {
@@ -577,6 +640,31 @@ class RenderForwardClustered : public RendererSceneRenderRD {
 
 	RenderList render_list[RENDER_LIST_MAX];
 
+	struct FillRenderListParameters {
+		RenderListType render_list;
+		const RenderDataRD *render_data;
+		PassMode pass_mode;
+		bool using_sdfgi;
+		bool using_opaque_gi;
+		Plane near_plane;
+		float z_max;
+		uint32_t thread_count;
+	};
+
+	// Each thread fills its own lists, they are appended in thread order so the result is the same as with one thread.
+	struct FillRenderListThreadData {
+		LocalVector<GeometryInstanceSurfaceDataCache *> elements;
+		LocalVector<GeometryInstanceSurfaceDataCache *> alpha_elements;
+		RendererScene::RenderInfo render_info;
+		bool used_sss = false;
+		bool used_screen_texture = false;
+		bool used_normal_texture = false;
+		bool used_depth_texture = false;
+	};
+
+	LocalVector<FillRenderListThreadData> fill_render_list_threads;
+	void _fill_render_list_thread_function(uint32_t p_thread, FillRenderListParameters *p_params);
+
 	virtual void _update_shader_quality_settings() override;
 
 protected:
@@ -204,6 +204,15 @@ public:
 
 	struct RenderInfo {
 		int info[RS::VIEWPORT_RENDER_INFO_TYPE_MAX][RS::VIEWPORT_RENDER_INFO_MAX] = {};
+		int lod_info[RS::VIEWPORT_RENDER_INFO_TYPE_MAX][RS::MAX_RENDER_INFO_LODS][RS::VIEWPORT_RENDER_LOD_INFO_MAX] = {};
+
+		// Like info[][VIEWPORT_RENDER_INFO_PRIMITIVES_IN_FRAME], p_primitives includes every instance drawn.
+		_FORCE_INLINE_ void add_lod_info(RS::ViewportRenderInfoType p_type, uint32_t p_lod, int p_primitives) {
+			// The last LOD also counts the ones after it.
+			uint32_t lod = MIN(p_lod, uint32_t(RS::MAX_RENDER_INFO_LODS - 1));
+			lod_info[p_type][lod][RS::VIEWPORT_RENDER_LOD_INFO_OBJECTS_IN_FRAME]++;
+			lod_info[p_type][lod][RS::VIEWPORT_RENDER_LOD_INFO_PRIMITIVES_IN_FRAME] += p_primitives;
+		}
 	};
 
 	virtual void render_camera(RID p_render_buffers, RID p_camera, RID p_scenario, RID p_viewport, Size2 p_viewport_size, float p_lod_threshold, RID p_shadow_atlas, Ref<XRInterface> &p_xr_interface, RenderInfo *r_render_info = nullptr) = 0;
@@ -32,6 +32,8 @@
 
 #include "core/config/project_settings.h"
 #include "core/os/os.h"
+#include "core/os/worker_thread_pool.h"
+#include "renderer_scene_occlusion_cull_raster.h"
 #include "rendering_server_default.h"
 #include "rendering_server_globals.h"
 
@@ -365,7 +367,6 @@ void RendererSceneCull::scenario_initialize(RID p_rid) {
 	scene_render->shadow_atlas_set_quadrant_subdivision(scenario->reflection_probe_shadow_atlas, 3, 8);
 	scenario->reflection_atlas = scene_render->reflection_atlas_create();
 
-	scenario->instance_aabbs.set_page_pool(&instance_aabb_page_pool);
 	scenario->instance_data.set_page_pool(&instance_data_page_pool);
 	scenario->instance_visibility.set_page_pool(&instance_visibility_data_page_pool);
 
@@ -811,6 +812,7 @@ void RendererSceneCull::instance_set_layer_mask(RID p_instance, uint32_t p_mask)
 	instance->layer_mask = p_mask;
 	if (instance->scenario && instance->array_index >= 0) {
 		instance->scenario->instance_data[instance->array_index].layer_mask = p_mask;
+		instance->scenario->instance_bounds.set_layer_mask(instance->array_index, p_mask);
 	}
 
 	if ((1 << instance->base_type) & RS::INSTANCE_GEOMETRY_MASK && instance->base_data) {
@@ -1624,7 +1626,7 @@ void RendererSceneCull::_update_instance(Instance *p_instance) {
 		}
 
 		p_instance->scenario->instance_data.push_back(idata);
-		p_instance->scenario->instance_aabbs.push_back(InstanceBounds(p_instance->transformed_aabb));
+		p_instance->scenario->instance_bounds.push_back(p_instance->transformed_aabb, p_instance->layer_mask);
 		_update_instance_visibility_dependencies(p_instance);
 	} else {
 		if ((1 << p_instance->base_type) & RS::INSTANCE_GEOMETRY_MASK) {
@@ -1632,7 +1634,7 @@ void RendererSceneCull::_update_instance(Instance *p_instance) {
 		} else {
 			p_instance->scenario->indexers[Scenario::INDEXER_VOLUMES].update(p_instance->indexer_id, bvh_aabb);
 		}
-		p_instance->scenario->instance_aabbs[p_instance->array_index] = InstanceBounds(p_instance->transformed_aabb);
+		p_instance->scenario->instance_bounds.set_aabb(p_instance->array_index, p_instance->transformed_aabb);
 	}
 
 	if (p_instance->visibility_index != -1) {
@@ -1715,7 +1717,7 @@ void RendererSceneCull::_unpair_instance(Instance *p_instance) {
 		Instance *swapped_instance = p_instance->scenario->instance_data[swap_with_index].instance;
 		swapped_instance->array_index = p_instance->array_index; //swap
 		p_instance->scenario->instance_data[p_instance->array_index] = p_instance->scenario->instance_data[swap_with_index];
-		p_instance->scenario->instance_aabbs[p_instance->array_index] = p_instance->scenario->instance_aabbs[swap_with_index];
+		p_instance->scenario->instance_bounds.copy(p_instance->array_index, swap_with_index);
 
 		if (swapped_instance->visibility_index != -1) {
 			swapped_instance->scenario->instance_visibility[swapped_instance->visibility_index].array_index = swapped_instance->array_index;
@@ -1734,7 +1736,7 @@ void RendererSceneCull::_unpair_instance(Instance *p_instance) {
 
 	// pop last
 	p_instance->scenario->instance_data.pop_back();
-	p_instance->scenario->instance_aabbs.pop_back();
+	p_instance->scenario->instance_bounds.pop_back();
 
 	//uninitialize
 	p_instance->array_index = -1;
@@ -2195,14 +2197,12 @@ void RendererSceneCull::_light_instance_setup_directional_shadow(int p_shadow_in
 	}
 }
 
-bool RendererSceneCull::_light_instance_update_shadow(Instance *p_instance, const Transform3D p_cam_transform, const CameraMatrix &p_cam_projection, bool p_cam_orthogonal, bool p_cam_vaspect, RID p_shadow_atlas, Scenario *p_scenario, float p_screen_lod_threshold) {
+bool RendererSceneCull::_light_instance_setup_shadow_passes(Instance *p_instance) {
 	InstanceLightData *light = static_cast<InstanceLightData *>(p_instance->base_data);
 
 	Transform3D light_transform = p_instance->transform;
 	light_transform.orthonormalize(); //scale does not count on lights
 
-	bool animated_material_found = false;
-
 	switch (RSG::storage->light_get_type(p_instance->base)) {
 		case RS::LIGHT_DIRECTIONAL: {
 		} break;
@@ -2211,73 +2211,27 @@ bool RendererSceneCull::_light_instance_update_shadow(Instance *p_instance, cons
 
 			if (shadow_mode == RS::LIGHT_OMNI_SHADOW_DUAL_PARABOLOID || !scene_render->light_instances_can_render_shadow_cube()) {
 				if (max_shadows_used + 2 > MAX_UPDATE_SHADOWS) {
-					return true;
+					return false;
 				}
 				for (int i = 0; i < 2; i++) {
-					//using this one ensures that raster deferred will have it
-					RENDER_TIMESTAMP("Culling Shadow Paraboloid" + itos(i));
-
 					real_t radius = RSG::storage->light_get_param(p_instance->base, RS::LIGHT_PARAM_RANGE);
 
 					real_t z = i == 0 ? -1 : 1;
-					Vector<Plane> planes;
-					planes.resize(6);
-					planes.write[0] = light_transform.xform(Plane(Vector3(0, 0, z), radius));
-					planes.write[1] = light_transform.xform(Plane(Vector3(1, 0, z).normalized(), radius));
-					planes.write[2] = light_transform.xform(Plane(Vector3(-1, 0, z).normalized(), radius));
-					planes.write[3] = light_transform.xform(Plane(Vector3(0, 1, z).normalized(), radius));
-					planes.write[4] = light_transform.xform(Plane(Vector3(0, -1, z).normalized(), radius));
-					planes.write[5] = light_transform.xform(Plane(Vector3(0, 0, -z), 0));
-
-					instance_shadow_cull_result.clear();
-
-					Vector<Vector3> points = Geometry3D::compute_convex_mesh_points(&planes[0], planes.size());
-
-					struct CullConvex {
-						PagedArray<Instance *> *result;
-						_FORCE_INLINE_ bool operator()(void *p_data) {
-							Instance *p_instance = (Instance *)p_data;
-							result->push_back(p_instance);
-							return false;
-						}
-					};
-
-					CullConvex cull_convex;
-					cull_convex.result = &instance_shadow_cull_result;
-
-					p_scenario->indexers[Scenario::INDEXER_GEOMETRY].convex_query(planes.ptr(), planes.size(), points.ptr(), points.size(), cull_convex);
-
-					Plane near_plane(light_transform.origin, light_transform.basis.get_axis(2) * z);
-
-					RendererSceneRender::RenderShadowData &shadow_data = render_shadow_data[max_shadows_used++];
-
-					for (int j = 0; j < (int)instance_shadow_cull_result.size(); j++) {
-						Instance *instance = instance_shadow_cull_result[j];
-						if (!instance->visible || !((1 << instance->base_type) & RS::INSTANCE_GEOMETRY_MASK) || !static_cast<InstanceGeometryData *>(instance->base_data)->can_cast_shadows) {
-							continue;
-						} else {
-							if (static_cast<InstanceGeometryData *>(instance->base_data)->material_is_animated) {
-								animated_material_found = true;
-							}
-
-							if (instance->mesh_instance.is_valid()) {
-								RSG::storage->mesh_instance_check_for_update(instance->mesh_instance);
-							}
-						}
-
-						shadow_data.instances.push_back(static_cast<InstanceGeometryData *>(instance->base_data)->geometry_instance);
-					}
-
-					RSG::storage->update_mesh_instances();
+					ShadowCullPass &pass = _shadow_cull_pass_add(p_instance, i);
+					pass.planes.resize(6);
+					pass.planes.write[0] = light_transform.xform(Plane(Vector3(0, 0, z), radius));
+					pass.planes.write[1] = light_transform.xform(Plane(Vector3(1, 0, z).normalized(), radius));
+					pass.planes.write[2] = light_transform.xform(Plane(Vector3(-1, 0, z).normalized(), radius));
+					pass.planes.write[3] = light_transform.xform(Plane(Vector3(0, 1, z).normalized(), radius));
+					pass.planes.write[4] = light_transform.xform(Plane(Vector3(0, -1, z).normalized(), radius));
+					pass.planes.write[5] = light_transform.xform(Plane(Vector3(0, 0, -z), 0));
 
 					scene_render->light_instance_set_shadow_transform(light->instance, CameraMatrix(), light_transform, radius, 0, i, 0);
-					shadow_data.light = light->instance;
-					shadow_data.pass = i;
 				}
 			} else { //shadow cube
 
 				if (max_shadows_used + 6 > MAX_UPDATE_SHADOWS) {
-					return true;
+					return false;
 				}
 
 				real_t radius = RSG::storage->light_get_param(p_instance->base, RS::LIGHT_PARAM_RANGE);
@@ -2285,9 +2239,6 @@ bool RendererSceneCull::_light_instance_update_shadow(Instance *p_instance, cons
 				cm.set_perspective(90, 1, 0.01, radius);
 
 				for (int i = 0; i < 6; i++) {
-					RENDER_TIMESTAMP("Culling Shadow Cube side" + itos(i));
-					//using this one ensures that raster deferred will have it
-
 					static const Vector3 view_normals[6] = {
 						Vector3(+1, 0, 0),
 						Vector3(-1, 0, 0),
@@ -2307,49 +2258,10 @@ bool RendererSceneCull::_light_instance_update_shadow(Instance *p_instance, cons
 
 					Transform3D xform = light_transform * Transform3D().looking_at(view_normals[i], view_up[i]);
 
-					Vector<Plane> planes = cm.get_projection_planes(xform);
+					ShadowCullPass &pass = _shadow_cull_pass_add(p_instance, i);
+					pass.planes = cm.get_projection_planes(xform);
 
-					instance_shadow_cull_result.clear();
-
-					Vector<Vector3> points = Geometry3D::compute_convex_mesh_points(&planes[0], planes.size());
-
-					struct CullConvex {
-						PagedArray<Instance *> *result;
-						_FORCE_INLINE_ bool operator()(void *p_data) {
-							Instance *p_instance = (Instance *)p_data;
-							result->push_back(p_instance);
-							return false;
-						}
-					};
-
-					CullConvex cull_convex;
-					cull_convex.result = &instance_shadow_cull_result;
-
-					p_scenario->indexers[Scenario::INDEXER_GEOMETRY].convex_query(planes.ptr(), planes.size(), points.ptr(), points.size(), cull_convex);
-
-					RendererSceneRender::RenderShadowData &shadow_data = render_shadow_data[max_shadows_used++];
-
-					for (int j = 0; j < (int)instance_shadow_cull_result.size(); j++) {
-						Instance *instance = instance_shadow_cull_result[j];
-						if (!instance->visible || !((1 << instance->base_type) & RS::INSTANCE_GEOMETRY_MASK) || !static_cast<InstanceGeometryData *>(instance->base_data)->can_cast_shadows) {
-							continue;
-						} else {
-							if (static_cast<InstanceGeometryData *>(instance->base_data)->material_is_animated) {
-								animated_material_found = true;
-							}
-							if (instance->mesh_instance.is_valid()) {
-								RSG::storage->mesh_instance_check_for_update(instance->mesh_instance);
-							}
-						}
-
-						shadow_data.instances.push_back(static_cast<InstanceGeometryData *>(instance->base_data)->geometry_instance);
-					}
-
-					RSG::storage->update_mesh_instances();
 					scene_render->light_instance_set_shadow_transform(light->instance, cm, xform, radius, 0, i, 0);
-
-					shadow_data.light = light->instance;
-					shadow_data.pass = i;
 				}
 
 				//restore the regular DP matrix
@@ -2358,10 +2270,8 @@ bool RendererSceneCull::_light_instance_update_shadow(Instance *p_instance, cons
 
 		} break;
 		case RS::LIGHT_SPOT: {
-			RENDER_TIMESTAMP("Culling Spot Light");
-
 			if (max_shadows_used + 1 > MAX_UPDATE_SHADOWS) {
-				return true;
+				return false;
 			}
 
 			real_t radius = RSG::storage->light_get_param(p_instance->base, RS::LIGHT_PARAM_RANGE);
@@ -2370,54 +2280,63 @@ bool RendererSceneCull::_light_instance_update_shadow(Instance *p_instance, cons
 			CameraMatrix cm;
 			cm.set_perspective(angle * 2.0, 1.0, 0.01, radius);
 
-			Vector<Plane> planes = cm.get_projection_planes(light_transform);
+			ShadowCullPass &pass = _shadow_cull_pass_add(p_instance, 0);
+			pass.planes = cm.get_projection_planes(light_transform);
 
-			instance_shadow_cull_result.clear();
-
-			Vector<Vector3> points = Geometry3D::compute_convex_mesh_points(&planes[0], planes.size());
+			scene_render->light_instance_set_shadow_transform(light->instance, cm, light_transform, radius, 0, 0, 0);
 
-			struct CullConvex {
-				PagedArray<Instance *> *result;
-				_FORCE_INLINE_ bool operator()(void *p_data) {
-					Instance *p_instance = (Instance *)p_data;
-					result->push_back(p_instance);
-					return false;
-				}
-			};
+		} break;
+	}
 
-			CullConvex cull_convex;
-			cull_convex.result = &instance_shadow_cull_result;
+	return true;
+}
 
-			p_scenario->indexers[Scenario::INDEXER_GEOMETRY].convex_query(planes.ptr(), planes.size(), points.ptr(), points.size(), cull_convex);
+RendererSceneCull::ShadowCullPass &RendererSceneCull::_shadow_cull_pass_add(Instance *p_light, int p_pass) {
+	InstanceLightData *light = static_cast<InstanceLightData *>(p_light->base_data);
 
-			RendererSceneRender::RenderShadowData &shadow_data = render_shadow_data[max_shadows_used++];
+	RendererSceneRender::RenderShadowData &shadow_data = render_shadow_data[max_shadows_used];
+	shadow_data.light = light->instance;
+	shadow_data.pass = p_pass;
 
-			for (int j = 0; j < (int)instance_shadow_cull_result.size(); j++) {
-				Instance *instance = instance_shadow_cull_result[j];
-				if (!instance->visible || !((1 << instance->base_type) & RS::INSTANCE_GEOMETRY_MASK) || !static_cast<InstanceGeometryData *>(instance->base_data)->can_cast_shadows) {
-					continue;
-				} else {
-					if (static_cast<InstanceGeometryData *>(instance->base_data)->material_is_animated) {
-						animated_material_found = true;
-					}
+	shadow_cull_passes.push_back(ShadowCullPass());
+	ShadowCullPass &pass = shadow_cull_passes[shadow_cull_passes.size() - 1];
+	pass.light = p_light;
+	pass.shadow_index = max_shadows_used++;
+	return pass;
+}
 
-					if (instance->mesh_instance.is_valid()) {
-						RSG::storage->mesh_instance_check_for_update(instance->mesh_instance);
-					}
-				}
-				shadow_data.instances.push_back(static_cast<InstanceGeometryData *>(instance->base_data)->geometry_instance);
-			}
+void RendererSceneCull::_shadow_cull_pass_threaded(uint32_t p_pass, Scenario *p_scenario) {
+	_shadow_cull_pass(shadow_cull_passes[p_pass], p_scenario);
+}
 
-			RSG::storage->update_mesh_instances();
+void RendererSceneCull::_shadow_cull_pass(ShadowCullPass &p_pass, Scenario *p_scenario) {
+	Vector<Vector3> points = Geometry3D::compute_convex_mesh_points(p_pass.planes.ptr(), p_pass.planes.size());
 
-			scene_render->light_instance_set_shadow_transform(light->instance, cm, light_transform, radius, 0, 0, 0);
-			shadow_data.light = light->instance;
-			shadow_data.pass = 0;
+	struct CullConvex {
+		ShadowCullPass *pass;
+		PagedArray<RendererSceneRender::GeometryInstance *> *result;
+		_FORCE_INLINE_ bool operator()(void *p_data) {
+			Instance *instance = (Instance *)p_data;
+			if (!instance->visible || !((1 << instance->base_type) & RS::INSTANCE_GEOMETRY_MASK) || !static_cast<InstanceGeometryData *>(instance->base_data)->can_cast_shadows) {
+				return false;
+			}
+			if (static_cast<InstanceGeometryData *>(instance->base_data)->material_is_animated) {
+				pass->animated_material_found = true;
+			}
+			if (instance->mesh_instance.is_valid()) {
+				// checked for updates on the render thread once all passes are culled
+				pass->mesh_instances.push_back(instance->mesh_instance);
+			}
+			result->push_back(static_cast<InstanceGeometryData *>(instance->base_data)->geometry_instance);
+			return false;
+		}
+	};
 
-		} break;
-	}
+	CullConvex cull_convex;
+	cull_convex.pass = &p_pass;
+	cull_convex.result = &render_shadow_data[p_pass.shadow_index].instances;
 
-	return animated_material_found;
+	p_scenario->indexers[Scenario::INDEXER_GEOMETRY].convex_query(p_pass.planes.ptr(), p_pass.planes.size(), points.ptr(), points.size(), cull_convex);
 }
 
 void RendererSceneCull::render_camera(RID p_render_buffers, RID p_camera, RID p_scenario, RID p_viewport, Size2 p_viewport_size, float p_screen_lod_threshold, RID p_shadow_atlas, Ref<XRInterface> &p_xr_interface, RenderInfo *r_render_info) {
@@ -2500,14 +2419,14 @@ void RendererSceneCull::render_camera(RID p_render_buffers, RID p_camera, RID p_
 
 	RENDER_TIMESTAMP("Update occlusion buffer")
 	// For now just cull on the first camera
-	RendererSceneOcclusionCull::get_singleton()->buffer_update(p_viewport, camera_data.main_transform, camera_data.main_projection, camera_data.is_ortogonal, RendererThreadPool::singleton->thread_work_pool);
+	RendererSceneOcclusionCull::get_singleton()->buffer_update(p_viewport, camera_data.main_transform, camera_data.main_projection, camera_data.is_ortogonal);
 
 	_render_scene(&camera_data, p_render_buffers, environment, camera->effects, camera->visible_layers, p_scenario, p_viewport, p_shadow_atlas, RID(), -1, p_screen_lod_threshold, true, r_render_info);
 #endif
 }
 
 void RendererSceneCull::_visibility_cull_threaded(uint32_t p_thread, VisibilityCullData *cull_data) {
-	uint32_t total_threads = RendererThreadPool::singleton->thread_work_pool.get_thread_count();
+	uint32_t total_threads = WorkerThreadPool::get_singleton()->get_thread_count();
 	uint32_t bin_from = p_thread * cull_data->cull_count / total_threads;
 	uint32_t bin_to = (p_thread + 1 == total_threads) ? cull_data->cull_count : ((p_thread + 1) * cull_data->cull_count / total_threads);
 
@@ -2565,13 +2484,19 @@ int RendererSceneCull::_visibility_range_check(InstanceVisibilityData &r_vis_dat
 
 void RendererSceneCull::_scene_cull_threaded(uint32_t p_thread, CullData *cull_data) {
 	uint32_t cull_total = cull_data->scenario->instance_data.size();
-	uint32_t total_threads = RendererThreadPool::singleton->thread_work_pool.get_thread_count();
+	uint32_t total_threads = WorkerThreadPool::get_singleton()->get_thread_count();
 	uint32_t cull_from = p_thread * cull_total / total_threads;
 	uint32_t cull_to = (p_thread + 1 == total_threads) ? cull_total : ((p_thread + 1) * cull_total / total_threads);
 
 	_scene_cull(*cull_data, scene_cull_result_threads[p_thread], cull_from, cull_to);
 }
 
+static _FORCE_INLINE_ bool _instance_is_occluded(const RendererSceneOcclusionCull::HZBuffer *p_buffer, const RendererSceneCullBounds &p_bounds, uint32_t p_index, const Vector3 &p_cam_position, const Transform3D &p_cam_inv_transform, const CameraMatrix &p_cam_projection, real_t p_near) {
+	real_t bounds[6];
+	p_bounds.get_bounds(p_index, bounds);
+	return p_buffer->is_occluded(bounds, p_cam_position, p_cam_inv_transform, p_cam_projection, p_near);
+}
+
 void RendererSceneCull::_scene_cull(CullData &cull_data, InstanceCullResult &cull_result, uint64_t p_from, uint64_t p_to) {
 	uint64_t frame_number = RSG::rasterizer->get_frame_number();
 	float lightmap_probe_update_speed = RSG::storage->lightmap_get_probe_capture_update_speed() * RSG::rasterizer->get_frame_delta_time();
@@ -2584,7 +2509,34 @@ void RendererSceneCull::_scene_cull(CullData &cull_data, InstanceCullResult &cul
 	Transform3D inv_cam_transform = cull_data.cam_transform.inverse();
 	float z_near = cull_data.camera_matrix->get_z_near();
 
+	const RendererSceneCullBounds &bounds = cull_data.scenario->instance_bounds;
+	const Cull *cull = cull_data.cull;
+
+	// Per block of instances, the ones in the camera frustum with a visible layer and the ones in each
+	// shadow cascade. Instances in neither are skipped, unless SDFGI regions need them.
+	uint32_t frustum_mask = 0;
+	uint32_t cascade_masks[RendererSceneRender::MAX_DIRECTIONAL_LIGHTS][RendererSceneRender::MAX_DIRECTIONAL_LIGHT_CASCADES];
+	uint32_t block_mask = 0;
+
 	for (uint64_t i = p_from; i < p_to; i++) {
+		uint32_t lane_bit = 1 << (i % RendererSceneCullBounds::BLOCK_SIZE);
+		if (i == p_from || lane_bit == 1) {
+			uint32_t block = i / RendererSceneCullBounds::BLOCK_SIZE;
+			frustum_mask = bounds.cull_block(block, cull->frustum.planes_ptr, cull->frustum.plane_count, cull_data.visible_layers);
+			block_mask = frustum_mask;
+			for (uint32_t j = 0; j < cull->shadow_count; j++) {
+				for (uint32_t k = 0; k < cull->shadows[j].cascade_count; k++) {
+					const Frustum &frustum = cull->shadows[j].cascades[k].frustum;
+					cascade_masks[j][k] = bounds.cull_block(block, frustum.planes_ptr, frustum.plane_count, 0xFFFFFFFF);
+					block_mask |= cascade_masks[j][k];
+				}
+			}
+		}
+
+		if (!(block_mask & lane_bit) && cull->sdfgi.region_count == 0) {
+			continue;
+		}
+
 		bool mesh_visible = false;
 
 		InstanceData &idata = cull_data.scenario->instance_data[i];
@@ -2592,15 +2544,13 @@ void RendererSceneCull::_scene_cull(CullData &cull_data, InstanceCullResult &cul
 		int32_t visibility_check = -1;
 
 #define HIDDEN_BY_VISIBILITY_CHECKS (visibility_flags == InstanceData::FLAG_VISIBILITY_DEPENDENCY_HIDDEN_CLOSE_RANGE || visibility_flags == InstanceData::FLAG_VISIBILITY_DEPENDENCY_HIDDEN)
-#define LAYER_CHECK (cull_data.visible_layers & idata.layer_mask)
-#define IN_FRUSTUM(f) (cull_data.scenario->instance_aabbs[i].in_frustum(f))
 #define VIS_RANGE_CHECK ((idata.visibility_index == -1) || _visibility_range_check(cull_data.scenario->instance_visibility[idata.visibility_index], cull_data.cam_transform.origin, cull_data.visibility_viewport_mask) == 0)
 #define VIS_PARENT_CHECK ((idata.parent_array_index == -1) || ((cull_data.scenario->instance_data[idata.parent_array_index].flags & InstanceData::FLAG_VISIBILITY_DEPENDENCY_NEEDS_CHECK) == InstanceData::FLAG_VISIBILITY_DEPENDENCY_HIDDEN_CLOSE_RANGE))
 #define VIS_CHECK (visibility_check < 0 ? (visibility_check = (visibility_flags != InstanceData::FLAG_VISIBILITY_DEPENDENCY_NEEDS_CHECK || (VIS_RANGE_CHECK && VIS_PARENT_CHECK))) : visibility_check)
-#define OCCLUSION_CULLED (cull_data.occlusion_buffer != nullptr && (cull_data.scenario->instance_data[i].flags & InstanceData::FLAG_IGNORE_OCCLUSION_CULLING) == 0 && cull_data.occlusion_buffer->is_occluded(cull_data.scenario->instance_aabbs[i].bounds, cull_data.cam_transform.origin, inv_cam_transform, *cull_data.camera_matrix, z_near))
+#define OCCLUSION_CULLED (cull_data.occlusion_buffer != nullptr && (cull_data.scenario->instance_data[i].flags & InstanceData::FLAG_IGNORE_OCCLUSION_CULLING) == 0 && _instance_is_occluded(cull_data.occlusion_buffer, bounds, i, cull_data.cam_transform.origin, inv_cam_transform, *cull_data.camera_matrix, z_near))
 
 		if (!HIDDEN_BY_VISIBILITY_CHECKS) {
-			if (LAYER_CHECK && IN_FRUSTUM(cull_data.cull->frustum) && VIS_CHECK && !OCCLUSION_CULLED) {
+			if ((frustum_mask & lane_bit) && VIS_CHECK && !OCCLUSION_CULLED) {
 				uint32_t base_type = idata.flags & InstanceData::FLAG_BASE_TYPE_MASK;
 				if (base_type == RS::INSTANCE_LIGHT) {
 					cull_result.lights.push_back(idata.instance);
@@ -2767,7 +2717,7 @@ void RendererSceneCull::_scene_cull(CullData &cull_data, InstanceCullResult &cul
 
 			for (uint32_t j = 0; j < cull_data.cull->shadow_count; j++) {
 				for (uint32_t k = 0; k < cull_data.cull->shadows[j].cascade_count; k++) {
-					if (IN_FRUSTUM(cull_data.cull->shadows[j].cascades[k].frustum) && VIS_CHECK) {
+					if ((cascade_masks[j][k] & lane_bit) && VIS_CHECK) {
 						uint32_t base_type = idata.flags & InstanceData::FLAG_BASE_TYPE_MASK;
 
 						if (((1 << base_type) & RS::INSTANCE_GEOMETRY_MASK) && idata.flags & InstanceData::FLAG_CAST_SHADOWS) {
@@ -2780,15 +2730,13 @@ void RendererSceneCull::_scene_cull(CullData &cull_data, InstanceCullResult &cul
 		}
 
 #undef HIDDEN_BY_VISIBILITY_CHECKS
-#undef LAYER_CHECK
-#undef IN_FRUSTUM
 #undef VIS_RANGE_CHECK
 #undef VIS_PARENT_CHECK
 #undef VIS_CHECK
 #undef OCCLUSION_CULLED
 
 		for (uint32_t j = 0; j < cull_data.cull->sdfgi.region_count; j++) {
-			if (cull_data.scenario->instance_aabbs[i].in_aabb(cull_data.cull->sdfgi.region_aabb[j])) {
+			if (bounds.intersects_aabb(i, cull_data.cull->sdfgi.region_aabb[j])) {
 				uint32_t base_type = idata.flags & InstanceData::FLAG_BASE_TYPE_MASK;
 
 				if (base_type == RS::INSTANCE_LIGHT) {
@@ -2850,7 +2798,7 @@ void RendererSceneCull::_render_scene(const RendererSceneRender::CameraData *p_c
 			}
 
 			if (visibility_cull_data.cull_count > thread_cull_threshold) {
-				RendererThreadPool::singleton->thread_work_pool.do_work(RendererThreadPool::singleton->thread_work_pool.get_thread_count(), this, &RendererSceneCull::_visibility_cull_threaded, &visibility_cull_data);
+				WorkerThreadPool::get_singleton()->do_work(WorkerThreadPool::get_singleton()->get_thread_count(), this, &RendererSceneCull::_visibility_cull_threaded, &visibility_cull_data);
 			} else {
 				_visibility_cull(visibility_cull_data, visibility_cull_data.cull_offset, visibility_cull_data.cull_offset + visibility_cull_data.cull_count);
 			}
@@ -2958,7 +2906,7 @@ void RendererSceneCull::_render_scene(const RendererSceneRender::CameraData *p_c
 				scene_cull_result_threads[i].clear();
 			}
 
-			RendererThreadPool::singleton->thread_work_pool.do_work(scene_cull_result_threads.size(), this, &RendererSceneCull::_scene_cull_threaded, &cull_data);
+			WorkerThreadPool::get_singleton()->do_work(scene_cull_result_threads.size(), this, &RendererSceneCull::_scene_cull_threaded, &cull_data);
 
 			for (uint32_t i = 0; i < scene_cull_result_threads.size(); i++) {
 				scene_cull_result.append_from(scene_cull_result_threads[i]);
@@ -3096,14 +3044,36 @@ void RendererSceneCull::_render_scene(const RendererSceneRender::CameraData *p_c
 			bool redraw = scene_render->shadow_atlas_update_light(p_shadow_atlas, light->instance, coverage, light->last_version);
 
 			if (redraw && max_shadows_used < MAX_UPDATE_SHADOWS) {
-				//must redraw!
-				RENDER_TIMESTAMP(">Rendering Light " + itos(i));
-				light->shadow_dirty = _light_instance_update_shadow(ins, p_camera_data->main_transform, p_camera_data->main_projection, p_camera_data->is_ortogonal, p_camera_data->vaspect, p_shadow_atlas, scenario, p_screen_lod_threshold);
-				RENDER_TIMESTAMP("<Rendering Light " + itos(i));
+				//must redraw! the passes are culled below, they may still find animated materials
+				light->shadow_dirty = !_light_instance_setup_shadow_passes(ins);
 			} else {
 				light->shadow_dirty = redraw;
 			}
 		}
+
+		// Cull all positional shadow passes in one sweep, over several threads when there is more than one pass.
+		if (shadow_cull_passes.size()) {
+			RENDER_TIMESTAMP("Culling Positional Shadows");
+
+			if (shadow_cull_passes.size() > 1) {
+				WorkerThreadPool::get_singleton()->do_work(shadow_cull_passes.size(), this, &RendererSceneCull::_shadow_cull_pass_threaded, scenario);
+			} else {
+				_shadow_cull_pass(shadow_cull_passes[0], scenario);
+			}
+
+			for (uint32_t i = 0; i < shadow_cull_passes.size(); i++) {
+				const ShadowCullPass &pass = shadow_cull_passes[i];
+				for (uint32_t j = 0; j < pass.mesh_instances.size(); j++) {
+					RSG::storage->mesh_instance_check_for_update(pass.mesh_instances[j]);
+				}
+				if (pass.animated_material_found) {
+					static_cast<InstanceLightData *>(pass.light->base_data)->shadow_dirty = true;
+				}
+			}
+			RSG::storage->update_mesh_instances();
+
+			shadow_cull_passes.clear();
+		}
 	}
 
 	//render SDFGI
@@ -3827,7 +3797,7 @@ bool RendererSceneCull::free(RID p_rid) {
 		while (scenario->instances.first()) {
 			instance_set_scenario(scenario->instances.first()->self()->self, RID());
 		}
-		scenario->instance_aabbs.reset();
+		scenario->instance_bounds.reset();
 		scenario->instance_data.reset();
 		scenario->instance_visibility.reset();
 
@@ -3909,7 +3879,6 @@ RendererSceneCull::RendererSceneCull() {
 	singleton = this;
 
 	instance_cull_result.set_page_pool(&instance_cull_page_pool);
-	instance_shadow_cull_result.set_page_pool(&instance_cull_page_pool);
 
 	for (uint32_t i = 0; i < MAX_UPDATE_SHADOWS; i++) {
 		render_shadow_data[i].instances.set_page_pool(&geometry_instance_cull_page_pool);
@@ -3919,21 +3888,20 @@ RendererSceneCull::RendererSceneCull() {
 	}
 
 	scene_cull_result.init(&rid_cull_page_pool, &geometry_instance_cull_page_pool, &instance_cull_page_pool);
-	scene_cull_result_threads.resize(RendererThreadPool::singleton->thread_work_pool.get_thread_count());
+	scene_cull_result_threads.resize(WorkerThreadPool::get_singleton()->get_thread_count());
 	for (uint32_t i = 0; i < scene_cull_result_threads.size(); i++) {
 		scene_cull_result_threads[i].init(&rid_cull_page_pool, &geometry_instance_cull_page_pool, &instance_cull_page_pool);
 	}
 
 	indexer_update_iterations = GLOBAL_GET("rendering/limits/spatial_indexer/update_iterations_per_frame");
 	thread_cull_threshold = GLOBAL_GET("rendering/limits/spatial_indexer/threaded_cull_minimum_instances");
-	thread_cull_threshold = MAX(thread_cull_threshold, (uint32_t)RendererThreadPool::singleton->thread_work_pool.get_thread_count()); //make sure there is at least one thread per CPU
+	thread_cull_threshold = MAX(thread_cull_threshold, (uint32_t)WorkerThreadPool::get_singleton()->get_thread_count()); //make sure there is at least one thread per CPU
 
-	dummy_occlusion_culling = memnew(RendererSceneOcclusionCull);
+	raster_occlusion_culling = memnew(RendererSceneOcclusionCullRaster);
 }
 
 RendererSceneCull::~RendererSceneCull() {
 	instance_cull_result.reset();
-	instance_shadow_cull_result.reset();
 
 	for (uint32_t i = 0; i < MAX_UPDATE_SHADOWS; i++) {
 		render_shadow_data[i].instances.reset();
@@ -3948,7 +3916,7 @@ RendererSceneCull::~RendererSceneCull() {
 	}
 	scene_cull_result_threads.clear();
 
-	if (dummy_occlusion_culling) {
-		memdelete(dummy_occlusion_culling);
+	if (raster_occlusion_culling) {
+		memdelete(raster_occlusion_culling);
 	}
 }
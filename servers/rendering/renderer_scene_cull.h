@@ -46,6 +46,7 @@
 #include "core/templates/rid_owner.h"
 #include "core/templates/self_list.h"
 #include "servers/rendering/renderer_scene.h"
+#include "servers/rendering/renderer_scene_cull_bounds.h"
 #include "servers/rendering/renderer_scene_occlusion_cull.h"
 #include "servers/rendering/renderer_scene_render.h"
 #include "servers/xr/xr_interface.h"
@@ -120,7 +121,8 @@ public:
 
 	/* VISIBILITY NOTIFIER API */
 
-	RendererSceneOcclusionCull *dummy_occlusion_culling;
+	// Used unless a module registers another occlusion culling backend.
+	RendererSceneOcclusionCull *raster_occlusion_culling;
 
 	/* SCENARIO API */
 
@@ -186,65 +188,6 @@ public:
 		}
 	};
 
-	struct InstanceBounds {
-		// Efficiently store instance bounds.
-		// Because bounds checking is performed first,
-		// keep it separated from data.
-
-		real_t bounds[6];
-		_ALWAYS_INLINE_ InstanceBounds() {}
-
-		_ALWAYS_INLINE_ InstanceBounds(const AABB &p_aabb) {
-			bounds[0] = p_aabb.position.x;
-			bounds[1] = p_aabb.position.y;
-			bounds[2] = p_aabb.position.z;
-			bounds[3] = p_aabb.position.x + p_aabb.size.x;
-			bounds[4] = p_aabb.position.y + p_aabb.size.y;
-			bounds[5] = p_aabb.position.z + p_aabb.size.z;
-		}
-		_ALWAYS_INLINE_ bool in_frustum(const Frustum &p_frustum) const {
-			// This is not a full SAT check and the possibility of false positives exist,
-			// but the tradeoff vs performance is still very good.
-
-			for (uint32_t i = 0; i < p_frustum.plane_count; i++) {
-				Vector3 min(
-						bounds[p_frustum.plane_signs_ptr[i].signs[0]],
-						bounds[p_frustum.plane_signs_ptr[i].signs[1]],
-						bounds[p_frustum.plane_signs_ptr[i].signs[2]]);
-
-				if (p_frustum.planes_ptr[i].distance_to(min) >= 0.0) {
-					return false;
-				}
-			}
-
-			return true;
-		}
-		_ALWAYS_INLINE_ bool in_aabb(const AABB &p_aabb) const {
-			Vector3 end = p_aabb.position + p_aabb.size;
-
-			if (bounds[0] >= end.x) {
-				return false;
-			}
-			if (bounds[3] <= p_aabb.position.x) {
-				return false;
-			}
-			if (bounds[1] >= end.y) {
-				return false;
-			}
-			if (bounds[4] <= p_aabb.position.y) {
-				return false;
-			}
-			if (bounds[2] >= end.z) {
-				return false;
-			}
-			if (bounds[5] <= p_aabb.position.z) {
-				return false;
-			}
-
-			return true;
-		}
-	};
-
 	struct InstanceVisibilityNotifierData;
 
 	struct InstanceData {
@@ -303,7 +246,6 @@ public:
 		}
 	};
 
-	PagedArrayPool<InstanceBounds> instance_aabb_page_pool;
 	PagedArrayPool<InstanceData> instance_data_page_pool;
 	PagedArrayPool<InstanceVisibilityData> instance_visibility_data_page_pool;
 
@@ -331,7 +273,7 @@ public:
 
 		LocalVector<RID> dynamic_lights;
 
-		PagedArray<InstanceBounds> instance_aabbs;
+		RendererSceneCullBounds instance_bounds;
 		PagedArray<InstanceData> instance_data;
 		VisibilityArray instance_visibility;
 
@@ -777,7 +719,6 @@ public:
 	PagedArrayPool<RID> rid_cull_page_pool;
 
 	PagedArray<Instance *> instance_cull_result;
-	PagedArray<Instance *> instance_shadow_cull_result;
 
 	struct InstanceCullResult {
 		PagedArray<RendererSceneRender::GeometryInstance *> geometry_instances;
@@ -961,7 +902,21 @@ public:
 
 	void _light_instance_setup_directional_shadow(int p_shadow_index, Instance *p_instance, const Transform3D p_cam_transform, const CameraMatrix &p_cam_projection, bool p_cam_orthogonal, bool p_cam_vaspect);
 
-	_FORCE_INLINE_ bool _light_instance_update_shadow(Instance *p_instance, const Transform3D p_cam_transform, const CameraMatrix &p_cam_projection, bool p_cam_orthogonal, bool p_cam_vaspect, RID p_shadow_atlas, Scenario *p_scenario, float p_scren_lod_threshold);
+	// A shadow map of a positional light to be culled, omni lights use several.
+	struct ShadowCullPass {
+		Instance *light = nullptr;
+		uint32_t shadow_index = 0; // in render_shadow_data
+		Vector<Plane> planes;
+		LocalVector<RID> mesh_instances; // to check for updates once culled
+		bool animated_material_found = false;
+	};
+
+	LocalVector<ShadowCullPass> shadow_cull_passes;
+
+	bool _light_instance_setup_shadow_passes(Instance *p_instance);
+	ShadowCullPass &_shadow_cull_pass_add(Instance *p_light, int p_pass);
+	void _shadow_cull_pass_threaded(uint32_t p_pass, Scenario *p_scenario);
+	void _shadow_cull_pass(ShadowCullPass &p_pass, Scenario *p_scenario);
 
 	RID _render_get_environment(RID p_camera, RID p_scenario);
 
@@ -0,0 +1,177 @@
+/*************************************************************************/
+/*  renderer_scene_cull_bounds.cpp                                       */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2021 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2021 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+
+#include "renderer_scene_cull_bounds.h"
+
+#if defined(SCENE_CULL_BOUNDS_AVX)
+#include <immintrin.h>
+#elif defined(SCENE_CULL_BOUNDS_SSE)
+#include <emmintrin.h>
+#elif defined(SCENE_CULL_BOUNDS_NEON)
+#include <arm_neon.h>
+#endif
+
+void RendererSceneCullBounds::push_back(const AABB &p_aabb, uint32_t p_layer_mask) {
+	if (count % BLOCK_SIZE == 0) {
+		blocks.push_back(Block());
+	}
+	count++;
+	set_aabb(count - 1, p_aabb);
+	set_layer_mask(count - 1, p_layer_mask);
+}
+
+void RendererSceneCullBounds::pop_back() {
+	ERR_FAIL_COND(count == 0);
+	count--;
+	if (count % BLOCK_SIZE == 0) {
+		blocks.resize(blocks.size() - 1);
+	}
+}
+
+void RendererSceneCullBounds::copy(uint32_t p_to, uint32_t p_from) {
+	const Block &from = blocks[p_from / BLOCK_SIZE];
+	uint32_t from_lane = p_from % BLOCK_SIZE;
+	Block &to = blocks[p_to / BLOCK_SIZE];
+	uint32_t to_lane = p_to % BLOCK_SIZE;
+
+	to.min_x[to_lane] = from.min_x[from_lane];
+	to.min_y[to_lane] = from.min_y[from_lane];
+	to.min_z[to_lane] = from.min_z[from_lane];
+	to.max_x[to_lane] = from.max_x[from_lane];
+	to.max_y[to_lane] = from.max_y[from_lane];
+	to.max_z[to_lane] = from.max_z[from_lane];
+	to.layer_mask[to_lane] = from.layer_mask[from_lane];
+}
+
+void RendererSceneCullBounds::reset() {
+	blocks.reset();
+	count = 0;
+}
+
+uint32_t RendererSceneCullBounds::cull_block(uint32_t p_block, const Plane *p_planes, uint32_t p_plane_count, uint32_t p_layers) const {
+	const Block &block = blocks[p_block];
+
+	// For each plane, the corner of the box furthest behind it is tested, the box is outside when that
+	// corner is in front of the plane.
+
+#if defined(SCENE_CULL_BOUNDS_AVX)
+
+	// Without AVX2 integer instructions, the layers are checked four at a time.
+	__m128i layers_low = _mm_and_si128(_mm_loadu_si128((const __m128i *)block.layer_mask), _mm_set1_epi32(p_layers));
+	__m128i layers_high = _mm_and_si128(_mm_loadu_si128((const __m128i *)(block.layer_mask + 4)), _mm_set1_epi32(p_layers));
+	__m256 outside = _mm256_castsi256_ps(_mm256_set_m128i(_mm_cmpeq_epi32(layers_high, _mm_setzero_si128()), _mm_cmpeq_epi32(layers_low, _mm_setzero_si128())));
+
+	for (uint32_t i = 0; i < p_plane_count; i++) {
+		const Plane &p = p_planes[i];
+		__m256 x = _mm256_loadu_ps(p.normal.x > 0 ? block.min_x : block.max_x);
+		__m256 y = _mm256_loadu_ps(p.normal.y > 0 ? block.min_y : block.max_y);
+		__m256 z = _mm256_loadu_ps(p.normal.z > 0 ? block.min_z : block.max_z);
+		__m256 distance = _mm256_sub_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(x, _mm256_set1_ps(p.normal.x)), _mm256_mul_ps(y, _mm256_set1_ps(p.normal.y))), _mm256_mul_ps(z, _mm256_set1_ps(p.normal.z))), _mm256_set1_ps(p.d));
+		outside = _mm256_or_ps(outside, _mm256_cmp_ps(distance, _mm256_setzero_ps(), _CMP_GE_OQ));
+	}
+
+	return ~uint32_t(_mm256_movemask_ps(outside)) & 0xFF;
+
+#elif defined(SCENE_CULL_BOUNDS_SSE) || defined(SCENE_CULL_BOUNDS_NEON)
+
+	uint32_t mask = 0;
+
+	// Two halves of four instances.
+	for (uint32_t h = 0; h < BLOCK_SIZE; h += 4) {
+#if defined(SCENE_CULL_BOUNDS_SSE)
+		__m128i layers = _mm_and_si128(_mm_loadu_si128((const __m128i *)(block.layer_mask + h)), _mm_set1_epi32(p_layers));
+		__m128 outside = _mm_castsi128_ps(_mm_cmpeq_epi32(layers, _mm_setzero_si128()));
+
+		for (uint32_t i = 0; i < p_plane_count; i++) {
+			const Plane &p = p_planes[i];
+			__m128 x = _mm_loadu_ps((p.normal.x > 0 ? block.min_x : block.max_x) + h);
+			__m128 y = _mm_loadu_ps((p.normal.y > 0 ? block.min_y : block.max_y) + h);
+			__m128 z = _mm_loadu_ps((p.normal.z > 0 ? block.min_z : block.max_z) + h);
+			__m128 distance = _mm_sub_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(p.normal.x)), _mm_mul_ps(y, _mm_set1_ps(p.normal.y))), _mm_mul_ps(z, _mm_set1_ps(p.normal.z))), _mm_set1_ps(p.d));
+			outside = _mm_or_ps(outside, _mm_cmpge_ps(distance, _mm_setzero_ps()));
+		}
+
+		mask |= (~uint32_t(_mm_movemask_ps(outside)) & 0xF) << h;
+#else
+		uint32x4_t layers = vandq_u32(vld1q_u32(block.layer_mask + h), vdupq_n_u32(p_layers));
+		uint32x4_t outside = vceqq_u32(layers, vdupq_n_u32(0));
+
+		for (uint32_t i = 0; i < p_plane_count; i++) {
+			const Plane &p = p_planes[i];
+			float32x4_t x = vld1q_f32((p.normal.x > 0 ? block.min_x : block.max_x) + h);
+			float32x4_t y = vld1q_f32((p.normal.y > 0 ? block.min_y : block.max_y) + h);
+			float32x4_t z = vld1q_f32((p.normal.z > 0 ? block.min_z : block.max_z) + h);
+			float32x4_t distance = vmulq_n_f32(x, p.normal.x);
+			distance = vmlaq_n_f32(distance, y, p.normal.y);
+			distance = vmlaq_n_f32(distance, z, p.normal.z);
+			distance = vsubq_f32(distance, vdupq_n_f32(p.d));
+			outside = vorrq_u32(outside, vcgeq_f32(distance, vdupq_n_f32(0.0f)));
+		}
+
+		// Lanes are all ones or all zeros, keep one bit of each.
+		static const uint32_t lane_bits[4] = { 1, 2, 4, 8 };
+		mask |= (vaddvq_u32(vbicq_u32(vld1q_u32(lane_bits), outside))) << h;
+#endif
+	}
+
+	return mask;
+
+#else
+
+	uint32_t mask = 0;
+
+	for (uint32_t lane = 0; lane < BLOCK_SIZE; lane++) {
+		if (!(block.layer_mask[lane] & p_layers)) {
+			continue;
+		}
+
+		bool inside = true;
+		for (uint32_t i = 0; i < p_plane_count; i++) {
+			const Plane &p = p_planes[i];
+			Vector3 corner(
+					p.normal.x > 0 ? block.min_x[lane] : block.max_x[lane],
+					p.normal.y > 0 ? block.min_y[lane] : block.max_y[lane],
+					p.normal.z > 0 ? block.min_z[lane] : block.max_z[lane]);
+			if (p.distance_to(corner) >= 0.0) {
+				inside = false;
+				break;
+			}
+		}
+
+		if (inside) {
+			mask |= 1 << lane;
+		}
+	}
+
+	return mask;
+
+#endif
+}
@@ -0,0 +1,123 @@
+/*************************************************************************/
+/*  renderer_scene_cull_bounds.h                                         */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2021 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2021 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+
+#ifndef RENDERER_SCENE_CULL_BOUNDS_H
+#define RENDERER_SCENE_CULL_BOUNDS_H
+
+#include "core/math/aabb.h"
+#include "core/math/plane.h"
+#include "core/templates/local_vector.h"
+
+// Vector instruction sets used by the frustum test, it falls back to plain loops otherwise.
+#if !defined(REAL_T_IS_DOUBLE) && defined(__AVX__)
+#define SCENE_CULL_BOUNDS_AVX
+#elif !defined(REAL_T_IS_DOUBLE) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define SCENE_CULL_BOUNDS_SSE
+#elif !defined(REAL_T_IS_DOUBLE) && defined(__ARM_NEON) && defined(__aarch64__)
+#define SCENE_CULL_BOUNDS_NEON
+#endif
+
+// Bounds and layer masks of the instances of a scenario, indexed like Scenario::instance_data.
+// They are stored as structure of arrays in blocks of BLOCK_SIZE instances, so a whole block is
+// tested against a frustum at once, and instances outside of it are skipped without reading
+// their InstanceData.
+class RendererSceneCullBounds {
+public:
+	enum {
+		BLOCK_SIZE = 8,
+	};
+
+private:
+	struct Block {
+		real_t min_x[BLOCK_SIZE];
+		real_t min_y[BLOCK_SIZE];
+		real_t min_z[BLOCK_SIZE];
+		real_t max_x[BLOCK_SIZE];
+		real_t max_y[BLOCK_SIZE];
+		real_t max_z[BLOCK_SIZE];
+		uint32_t layer_mask[BLOCK_SIZE];
+	};
+
+	LocalVector<Block> blocks;
+	uint32_t count = 0;
+
+public:
+	_FORCE_INLINE_ uint32_t size() const { return count; }
+
+	void push_back(const AABB &p_aabb, uint32_t p_layer_mask);
+	void pop_back();
+	// Copies the bounds and layer mask of an instance to another index, for unordered removal.
+	void copy(uint32_t p_to, uint32_t p_from);
+	void reset();
+
+	_FORCE_INLINE_ void set_aabb(uint32_t p_index, const AABB &p_aabb) {
+		Block &block = blocks[p_index / BLOCK_SIZE];
+		uint32_t lane = p_index % BLOCK_SIZE;
+		block.min_x[lane] = p_aabb.position.x;
+		block.min_y[lane] = p_aabb.position.y;
+		block.min_z[lane] = p_aabb.position.z;
+		block.max_x[lane] = p_aabb.position.x + p_aabb.size.x;
+		block.max_y[lane] = p_aabb.position.y + p_aabb.size.y;
+		block.max_z[lane] = p_aabb.position.z + p_aabb.size.z;
+	}
+
+	_FORCE_INLINE_ void set_layer_mask(uint32_t p_index, uint32_t p_layer_mask) {
+		blocks[p_index / BLOCK_SIZE].layer_mask[p_index % BLOCK_SIZE] = p_layer_mask;
+	}
+
+	// Bounds as minimum x, y, z followed by maximum x, y, z.
+	_FORCE_INLINE_ void get_bounds(uint32_t p_index, real_t *r_bounds) const {
+		const Block &block = blocks[p_index / BLOCK_SIZE];
+		uint32_t lane = p_index % BLOCK_SIZE;
+		r_bounds[0] = block.min_x[lane];
+		r_bounds[1] = block.min_y[lane];
+		r_bounds[2] = block.min_z[lane];
+		r_bounds[3] = block.max_x[lane];
+		r_bounds[4] = block.max_y[lane];
+		r_bounds[5] = block.max_z[lane];
+	}
+
+	_FORCE_INLINE_ bool intersects_aabb(uint32_t p_index, const AABB &p_aabb) const {
+		const Block &block = blocks[p_index / BLOCK_SIZE];
+		uint32_t lane = p_index % BLOCK_SIZE;
+		Vector3 end = p_aabb.position + p_aabb.size;
+		return block.min_x[lane] < end.x && block.max_x[lane] > p_aabb.position.x &&
+				block.min_y[lane] < end.y && block.max_y[lane] > p_aabb.position.y &&
+				block.min_z[lane] < end.z && block.max_z[lane] > p_aabb.position.z;
+	}
+
+	// Returns one bit per instance of the block, set when the instance has a layer in p_layers and its
+	// bounds may be inside the convex volume of the planes. Like the scalar test it replaces, this is not a
+	// full SAT test, so false positives are possible. Bits past the last instance are undefined.
+	uint32_t cull_block(uint32_t p_block, const Plane *p_planes, uint32_t p_plane_count, uint32_t p_layers) const;
+};
+
+#endif // RENDERER_SCENE_CULL_BOUNDS_H
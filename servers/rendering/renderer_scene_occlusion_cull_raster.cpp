@@ -0,0 +1,537 @@
+/*************************************************************************/
+/*  renderer_scene_occlusion_cull_raster.cpp                             */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2021 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2021 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "renderer_scene_occlusion_cull_raster.h"
+
+#include "core/os/worker_thread_pool.h"
+
+#if defined(OCCLUSION_CULL_RASTER_SSE)
+#include <emmintrin.h>
+#elif defined(OCCLUSION_CULL_RASTER_NEON)
+#include <arm_neon.h>
+#endif
+
+RendererSceneOcclusionCullRaster *RendererSceneOcclusionCullRaster::raster_singleton = nullptr;
+
+// Keeps the nearest value of each pixel in [p_from, p_to], the value at pixel x being p_value + p_step * x.
+static _FORCE_INLINE_ void _fill_span(float *p_row, int p_from, int p_to, float p_value, float p_step) {
+	int x = p_from;
+#if defined(OCCLUSION_CULL_RASTER_SSE)
+	const __m128 step = _mm_set1_ps(p_step);
+	const __m128 value = _mm_set1_ps(p_value);
+	__m128 lane_x = _mm_add_ps(_mm_set1_ps(float(x)), _mm_set_ps(3.0f, 2.0f, 1.0f, 0.0f));
+	const __m128 four = _mm_set1_ps(4.0f);
+	for (; x + 3 <= p_to; x += 4) {
+		__m128 nearness = _mm_add_ps(value, _mm_mul_ps(step, lane_x));
+		_mm_storeu_ps(&p_row[x], _mm_max_ps(_mm_loadu_ps(&p_row[x]), nearness));
+		lane_x = _mm_add_ps(lane_x, four);
+	}
+#elif defined(OCCLUSION_CULL_RASTER_NEON)
+	const float32x4_t step = vdupq_n_f32(p_step);
+	const float32x4_t value = vdupq_n_f32(p_value);
+	const float lanes[4] = { 0.0f, 1.0f, 2.0f, 3.0f };
+	float32x4_t lane_x = vaddq_f32(vdupq_n_f32(float(x)), vld1q_f32(lanes));
+	const float32x4_t four = vdupq_n_f32(4.0f);
+	for (; x + 3 <= p_to; x += 4) {
+		float32x4_t nearness = vmlaq_f32(value, step, lane_x);
+		vst1q_f32(&p_row[x], vmaxq_f32(vld1q_f32(&p_row[x]), nearness));
+		lane_x = vaddq_f32(lane_x, four);
+	}
+#endif
+	for (; x <= p_to; x++) {
+		p_row[x] = MAX(p_row[x], p_value + p_step * x);
+	}
+}
+
+void RendererSceneOcclusionCullRaster::RasterHZBuffer::clear() {
+	HZBuffer::clear();
+
+	triangles.clear();
+	view_vertices.clear();
+	screen_vertices.clear();
+}
+
+Vector3 RendererSceneOcclusionCullRaster::RasterHZBuffer::_project(const Vector3 &p_view, const CameraMatrix &p_cam_projection, bool p_orthogonal) const {
+	Vector3 projected = p_cam_projection.xform(p_view);
+	return Vector3(
+			(projected.x + 1.0) * (sizes[0].x - 1) * 0.5,
+			(projected.y + 1.0) * (sizes[0].y - 1) * 0.5,
+			p_orthogonal ? p_view.z : -1.0 / p_view.z);
+}
+
+void RendererSceneOcclusionCullRaster::RasterHZBuffer::_add_clipped_triangle(const Vector3 p_view[3], const CameraMatrix &p_cam_projection, float p_z_near, bool p_orthogonal) {
+	// Clip against the near plane, leaving a polygon of up to four vertices.
+	Vector3 polygon[4];
+	int count = 0;
+	for (int i = 0; i < 3; i++) {
+		const Vector3 &a = p_view[i];
+		const Vector3 &b = p_view[(i + 1) % 3];
+		bool a_inside = a.z <= -p_z_near;
+		bool b_inside = b.z <= -p_z_near;
+		if (a_inside) {
+			polygon[count++] = _project(a, p_cam_projection, p_orthogonal);
+		}
+		if (a_inside != b_inside) {
+			real_t t = (-p_z_near - a.z) / (b.z - a.z);
+			polygon[count++] = _project(a + (b - a) * t, p_cam_projection, p_orthogonal);
+		}
+	}
+
+	if (count < 3) {
+		return;
+	}
+
+	_add_screen_triangle(polygon);
+	if (count == 4) {
+		Vector3 second[3] = { polygon[0], polygon[2], polygon[3] };
+		_add_screen_triangle(second);
+	}
+}
+
+void RendererSceneOcclusionCullRaster::RasterHZBuffer::_add_screen_triangle(const Vector3 p_screen[3]) {
+	double x[3] = { p_screen[0].x, p_screen[1].x, p_screen[2].x };
+	double y[3] = { p_screen[0].y, p_screen[1].y, p_screen[2].y };
+	double n[3] = { p_screen[0].z, p_screen[1].z, p_screen[2].z };
+
+	double area = (x[1] - x[0]) * (y[2] - y[0]) - (x[2] - x[0]) * (y[1] - y[0]);
+	if (Math::absd(area) < 1e-6) {
+		return; // Degenerate, or too small to cover any pixel center.
+	}
+
+	Triangle triangle;
+	triangle.min_x = MAX(0, int(Math::ceil(MIN(x[0], MIN(x[1], x[2])))));
+	triangle.max_x = MIN(sizes[0].x - 1, int(Math::floor(MAX(x[0], MAX(x[1], x[2])))));
+	triangle.min_y = MAX(0, int(Math::ceil(MIN(y[0], MIN(y[1], y[2])))));
+	triangle.max_y = MIN(sizes[0].y - 1, int(Math::floor(MAX(y[0], MAX(y[1], y[2])))));
+
+	if (triangle.min_x > triangle.max_x || triangle.min_y > triangle.max_y) {
+		return;
+	}
+
+	// Shared edges give the exact same coefficients (up to the sign) to both triangles, so no pixel
+	// center falls in a crack between them.
+	double orientation = area > 0.0 ? 1.0 : -1.0;
+	for (int i = 0; i < 3; i++) {
+		int j = (i + 1) % 3;
+		triangle.edge_a[i] = (y[i] - y[j]) * orientation;
+		triangle.edge_b[i] = (x[j] - x[i]) * orientation;
+		triangle.edge_c[i] = (x[i] * y[j] - y[i] * x[j]) * orientation;
+	}
+
+	triangle.nearness_x = ((n[1] - n[0]) * (y[2] - y[0]) - (n[2] - n[0]) * (y[1] - y[0])) / area;
+	triangle.nearness_y = ((n[2] - n[0]) * (x[1] - x[0]) - (n[1] - n[0]) * (x[2] - x[0])) / area;
+	triangle.nearness_c = n[0] - triangle.nearness_x * x[0] - triangle.nearness_y * y[0];
+
+	triangles.push_back(triangle);
+}
+
+void RendererSceneOcclusionCullRaster::RasterHZBuffer::_rasterize_band(uint32_t p_band, const RasterThreadData *p_data) {
+	int width = sizes[0].x;
+	int height = sizes[0].y;
+	int from_y = p_band * BAND_ROWS;
+	int to_y = MIN(height, from_y + BAND_ROWS) - 1;
+	float *depth = mips[0];
+
+	// Perspective nearness is 1 / view depth, so 0 means nothing was hit.
+	float empty = p_data->orthogonal ? -FLT_MAX : 0.0f;
+	for (int i = from_y * width; i < (to_y + 1) * width; i++) {
+		depth[i] = empty;
+	}
+
+	for (uint32_t i = 0; i < triangles.size(); i++) {
+		const Triangle &triangle = triangles[i];
+		int min_y = MAX(from_y, triangle.min_y);
+		int max_y = MIN(to_y, triangle.max_y);
+
+		for (int y = min_y; y <= max_y; y++) {
+			double span_min = triangle.min_x;
+			double span_max = triangle.max_x;
+			bool outside = false;
+
+			for (int j = 0; j < 3; j++) {
+				double a = triangle.edge_a[j];
+				double r = -(triangle.edge_b[j] * y + triangle.edge_c[j]);
+				if (a > 0.0) {
+					span_min = MAX(span_min, r / a);
+				} else if (a < 0.0) {
+					span_max = MIN(span_max, r / a);
+				} else if (r > 0.0) {
+					outside = true;
+				}
+			}
+
+			if (outside || span_min > span_max) {
+				continue;
+			}
+
+			int x_from = Math::ceil(span_min);
+			int x_to = Math::floor(span_max);
+			_fill_span(&depth[y * width], x_from, x_to, triangle.nearness_c + triangle.nearness_y * y, triangle.nearness_x);
+		}
+	}
+
+	// Convert nearness to what HZBuffer::is_occluded() expects: the distance along the ray of the pixel
+	// from the near plane.
+	for (int y = from_y; y <= to_y; y++) {
+		real_t v = (height > 1 ? real_t(y) / (height - 1) : 0.5) * 2.0 - 1.0;
+		for (int x = 0; x < width; x++) {
+			float &d = depth[y * width + x];
+
+			if (d == empty) {
+				d = p_data->miss_depth;
+			} else if (p_data->orthogonal) {
+				d = MAX(0.0f, -d - p_data->z_near);
+			} else {
+				real_t u = (width > 1 ? real_t(x) / (width - 1) : 0.5) * 2.0 - 1.0;
+				Vector3 near_point = p_data->inv_projection.xform(Vector3(u, v, -1.0));
+				real_t ray_scale = near_point.length() / -near_point.z;
+				d = MAX(0.0f, float((1.0 / d - p_data->z_near) * ray_scale));
+			}
+		}
+	}
+}
+
+////////////////////////////////////////////////////////
+
+bool RendererSceneOcclusionCullRaster::is_occluder(RID p_rid) {
+	return occluder_owner.owns(p_rid);
+}
+
+RID RendererSceneOcclusionCullRaster::occluder_allocate() {
+	return occluder_owner.allocate_rid();
+}
+
+void RendererSceneOcclusionCullRaster::occluder_initialize(RID p_occluder) {
+	Occluder *occluder = memnew(Occluder);
+	occluder_owner.initialize_rid(p_occluder, occluder);
+}
+
+void RendererSceneOcclusionCullRaster::occluder_set_mesh(RID p_occluder, const PackedVector3Array &p_vertices, const PackedInt32Array &p_indices) {
+	Occluder *occluder = occluder_owner.getornull(p_occluder);
+	ERR_FAIL_COND(!occluder);
+
+	occluder->vertices = p_vertices;
+	occluder->indices = p_indices;
+
+	for (Set<InstanceID>::Element *E = occluder->users.front(); E; E = E->next()) {
+		Scenario *scenario = scenarios.getptr(E->get().scenario);
+		ERR_CONTINUE(!scenario);
+		_mark_instance_dirty(*scenario, E->get().instance);
+	}
+}
+
+void RendererSceneOcclusionCullRaster::free_occluder(RID p_occluder) {
+	Occluder *occluder = occluder_owner.getornull(p_occluder);
+	ERR_FAIL_COND(!occluder);
+
+	// Instances still using it stop occluding.
+	for (Set<InstanceID>::Element *E = occluder->users.front(); E; E = E->next()) {
+		Scenario *scenario = scenarios.getptr(E->get().scenario);
+		if (scenario) {
+			_mark_instance_dirty(*scenario, E->get().instance);
+		}
+	}
+
+	memdelete(occluder);
+	occluder_owner.free(p_occluder);
+}
+
+////////////////////////////////////////////////////////
+
+void RendererSceneOcclusionCullRaster::_mark_instance_dirty(Scenario &p_scenario, RID p_instance) {
+	if (!p_scenario.instances.has(p_instance) || p_scenario.dirty_instances.has(p_instance)) {
+		return;
+	}
+	p_scenario.dirty_instances.insert(p_instance);
+	p_scenario.dirty_instances_array.push_back(p_instance);
+}
+
+void RendererSceneOcclusionCullRaster::add_scenario(RID p_scenario) {
+	ERR_FAIL_COND(scenarios.has(p_scenario));
+	scenarios[p_scenario] = Scenario();
+}
+
+void RendererSceneOcclusionCullRaster::remove_scenario(RID p_scenario) {
+	Scenario *scenario = scenarios.getptr(p_scenario);
+	ERR_FAIL_COND(!scenario);
+
+	const RID *instance_rid = nullptr;
+	while ((instance_rid = scenario->instances.next(instance_rid))) {
+		Occluder *occluder = occluder_owner.getornull(scenario->instances[*instance_rid].occluder);
+		if (occluder) {
+			occluder->users.erase(InstanceID(p_scenario, *instance_rid));
+		}
+	}
+
+	scenarios.erase(p_scenario);
+}
+
+void RendererSceneOcclusionCullRaster::scenario_set_instance(RID p_scenario, RID p_instance, RID p_occluder, const Transform3D &p_xform, bool p_enabled) {
+	Scenario *scenario = scenarios.getptr(p_scenario);
+	ERR_FAIL_COND(!scenario);
+
+	if (!scenario->instances.has(p_instance)) {
+		scenario->instances[p_instance] = OccluderInstance();
+	}
+
+	OccluderInstance &instance = scenario->instances[p_instance];
+	bool changed = false;
+
+	if (instance.occluder != p_occluder) {
+		Occluder *old_occluder = occluder_owner.getornull(instance.occluder);
+		if (old_occluder) {
+			old_occluder->users.erase(InstanceID(p_scenario, p_instance));
+		}
+
+		instance.occluder = p_occluder;
+
+		if (p_occluder.is_valid()) {
+			Occluder *occluder = occluder_owner.getornull(p_occluder);
+			ERR_FAIL_COND(!occluder);
+			occluder->users.insert(InstanceID(p_scenario, p_instance));
+		}
+		changed = true;
+	}
+
+	if (instance.xform != p_xform) {
+		instance.xform = p_xform;
+		changed = true;
+	}
+
+	// Disabled instances are skipped when rasterizing, they don't need an update.
+	instance.enabled = p_enabled;
+
+	if (changed) {
+		_mark_instance_dirty(*scenario, p_instance);
+	}
+}
+
+void RendererSceneOcclusionCullRaster::scenario_remove_instance(RID p_scenario, RID p_instance) {
+	Scenario *scenario = scenarios.getptr(p_scenario);
+	ERR_FAIL_COND(!scenario);
+
+	OccluderInstance *instance = scenario->instances.getptr(p_instance);
+	if (!instance) {
+		return;
+	}
+
+	Occluder *occluder = occluder_owner.getornull(instance->occluder);
+	if (occluder) {
+		occluder->users.erase(InstanceID(p_scenario, p_instance));
+	}
+
+	if (scenario->dirty_instances.has(p_instance)) {
+		scenario->dirty_instances.erase(p_instance);
+		scenario->dirty_instances_array.erase(p_instance);
+	}
+	scenario->instances.erase(p_instance);
+}
+
+void RendererSceneOcclusionCullRaster::Scenario::_update_dirty_instance(uint32_t p_idx, RID *p_instances) {
+	OccluderInstance *occ_inst = instances.getptr(p_instances[p_idx]);
+	if (!occ_inst) {
+		return;
+	}
+
+	Occluder *occ = raster_singleton->occluder_owner.getornull(occ_inst->occluder);
+	if (!occ) {
+		occ_inst->xformed_vertices.clear();
+		occ_inst->indices.clear();
+		return;
+	}
+
+	int vertex_count = occ->vertices.size();
+	const Vector3 *read = occ->vertices.ptr();
+	occ_inst->xformed_vertices.resize(vertex_count);
+	for (int i = 0; i < vertex_count; i++) {
+		occ_inst->xformed_vertices[i] = occ_inst->xform.xform(read[i]);
+		if (i == 0) {
+			occ_inst->aabb = AABB(occ_inst->xformed_vertices[i], Vector3());
+		} else {
+			occ_inst->aabb.expand_to(occ_inst->xformed_vertices[i]);
+		}
+	}
+
+	// Triangles with out of range indices are dropped here, so rasterizing doesn't need to check them.
+	const int32_t *indices = occ->indices.ptr();
+	int index_count = occ->indices.size() - occ->indices.size() % 3;
+	occ_inst->indices.clear();
+	occ_inst->indices.reserve(index_count);
+	for (int i = 0; i < index_count; i += 3) {
+		if (uint32_t(indices[i]) >= uint32_t(vertex_count) || uint32_t(indices[i + 1]) >= uint32_t(vertex_count) || uint32_t(indices[i + 2]) >= uint32_t(vertex_count)) {
+			continue;
+		}
+		occ_inst->indices.push_back(indices[i]);
+		occ_inst->indices.push_back(indices[i + 1]);
+		occ_inst->indices.push_back(indices[i + 2]);
+	}
+}
+
+void RendererSceneOcclusionCullRaster::Scenario::update() {
+	if (dirty_instances_array.is_empty()) {
+		return;
+	}
+
+	if (dirty_instances_array.size() / WorkerThreadPool::get_singleton()->get_thread_count() > 128) {
+		WorkerThreadPool::get_singleton()->do_work(dirty_instances_array.size(), this, &Scenario::_update_dirty_instance, dirty_instances_array.ptr());
+	} else {
+		for (uint32_t i = 0; i < dirty_instances_array.size(); i++) {
+			_update_dirty_instance(i, dirty_instances_array.ptr());
+		}
+	}
+
+	dirty_instances.clear();
+	dirty_instances_array.clear();
+}
+
+////////////////////////////////////////////////////////
+
+void RendererSceneOcclusionCullRaster::add_buffer(RID p_buffer) {
+	ERR_FAIL_COND(buffers.has(p_buffer));
+	buffers[p_buffer] = RasterHZBuffer();
+}
+
+void RendererSceneOcclusionCullRaster::remove_buffer(RID p_buffer) {
+	ERR_FAIL_COND(!buffers.has(p_buffer));
+	buffers.erase(p_buffer);
+}
+
+void RendererSceneOcclusionCullRaster::buffer_set_scenario(RID p_buffer, RID p_scenario) {
+	ERR_FAIL_COND(!buffers.has(p_buffer));
+	ERR_FAIL_COND(p_scenario.is_valid() && !scenarios.has(p_scenario));
+	buffers[p_buffer].scenario_rid = p_scenario;
+}
+
+void RendererSceneOcclusionCullRaster::buffer_set_size(RID p_buffer, const Vector2i &p_size) {
+	ERR_FAIL_COND(!buffers.has(p_buffer));
+	buffers[p_buffer].resize(p_size);
+}
+
+void RendererSceneOcclusionCullRaster::buffer_update(RID p_buffer, const Transform3D &p_cam_transform, const CameraMatrix &p_cam_projection, bool p_cam_orthogonal) {
+	RasterHZBuffer *buffer = buffers.getptr(p_buffer);
+	if (!buffer || buffer->is_empty()) {
+		return;
+	}
+
+	Scenario *scenario = scenarios.getptr(buffer->scenario_rid);
+	if (!scenario) {
+		return;
+	}
+
+	scenario->update();
+
+	Transform3D inv_cam_transform = p_cam_transform.affine_inverse();
+	Vector<Plane> planes = p_cam_projection.get_projection_planes(p_cam_transform);
+	float z_near = p_cam_projection.get_z_near();
+
+	// Triangle setup is serial, occluders are meant to be simple. Rasterizing is split in bands of rows.
+	buffer->triangles.clear();
+
+	const RID *instance_rid = nullptr;
+	while ((instance_rid = scenario->instances.next(instance_rid))) {
+		const OccluderInstance &instance = scenario->instances[*instance_rid];
+		if (!instance.enabled || instance.indices.is_empty()) {
+			continue;
+		}
+
+		bool inside = true;
+		for (int i = 0; i < planes.size(); i++) {
+			if (planes[i].distance_to(instance.aabb.get_support(-planes[i].normal)) > 0) {
+				inside = false;
+				break;
+			}
+		}
+		if (!inside) {
+			continue;
+		}
+
+		uint32_t vertex_count = instance.xformed_vertices.size();
+		buffer->view_vertices.resize(vertex_count);
+		buffer->screen_vertices.resize(vertex_count);
+		for (uint32_t i = 0; i < vertex_count; i++) {
+			Vector3 view = inv_cam_transform.xform(instance.xformed_vertices[i]);
+			buffer->view_vertices[i] = view;
+			if (view.z <= -z_near) {
+				buffer->screen_vertices[i] = buffer->_project(view, p_cam_projection, p_cam_orthogonal);
+			}
+		}
+
+		for (uint32_t i = 0; i < instance.indices.size(); i += 3) {
+			uint32_t a = instance.indices[i];
+			uint32_t b = instance.indices[i + 1];
+			uint32_t c = instance.indices[i + 2];
+			if (buffer->view_vertices[a].z <= -z_near && buffer->view_vertices[b].z <= -z_near && buffer->view_vertices[c].z <= -z_near) {
+				Vector3 triangle[3] = { buffer->screen_vertices[a], buffer->screen_vertices[b], buffer->screen_vertices[c] };
+				buffer->_add_screen_triangle(triangle);
+			} else {
+				Vector3 triangle[3] = { buffer->view_vertices[a], buffer->view_vertices[b], buffer->view_vertices[c] };
+				buffer->_add_clipped_triangle(triangle, p_cam_projection, z_near, p_cam_orthogonal);
+			}
+		}
+	}
+
+	RasterHZBuffer::RasterThreadData td;
+	td.inv_projection = p_cam_projection.inverse();
+	td.z_near = z_near;
+	td.miss_depth = p_cam_projection.get_z_far() * 1.05f;
+	td.orthogonal = p_cam_orthogonal;
+	buffer->debug_tex_range = td.miss_depth;
+
+	uint32_t band_count = (buffer->sizes[0].y + RasterHZBuffer::BAND_ROWS - 1) / RasterHZBuffer::BAND_ROWS;
+	WorkerThreadPool::get_singleton()->do_work(band_count, buffer, &RasterHZBuffer::_rasterize_band, &td);
+
+	buffer->update_mips();
+}
+
+RendererSceneOcclusionCull::HZBuffer *RendererSceneOcclusionCullRaster::buffer_get_ptr(RID p_buffer) {
+	return buffers.getptr(p_buffer);
+}
+
+RID RendererSceneOcclusionCullRaster::buffer_get_debug_texture(RID p_buffer) {
+	ERR_FAIL_COND_V(!buffers.has(p_buffer), RID());
+	return buffers[p_buffer].get_debug_texture();
+}
+
+////////////////////////////////////////////////////////
+
+RendererSceneOcclusionCullRaster::RendererSceneOcclusionCullRaster() {
+	raster_singleton = this;
+}
+
+RendererSceneOcclusionCullRaster::~RendererSceneOcclusionCullRaster() {
+	List<RID> occluders;
+	occluder_owner.get_owned_list(&occluders);
+	for (List<RID>::Element *E = occluders.front(); E; E = E->next()) {
+		memdelete(occluder_owner.getornull(E->get()));
+		occluder_owner.free(E->get());
+	}
+
+	raster_singleton = nullptr;
+}
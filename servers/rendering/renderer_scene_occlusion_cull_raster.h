@@ -0,0 +1,177 @@
+/*************************************************************************/
+/*  renderer_scene_occlusion_cull_raster.h                               */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2021 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2021 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef RENDERER_SCENE_OCCLUSION_CULL_RASTER_H
+#define RENDERER_SCENE_OCCLUSION_CULL_RASTER_H
+
+#include "core/math/camera_matrix.h"
+#include "core/templates/hash_map.h"
+#include "core/templates/local_vector.h"
+#include "core/templates/rid_owner.h"
+#include "core/templates/set.h"
+#include "servers/rendering/renderer_scene_occlusion_cull.h"
+
+// Vector instruction sets used to fill depth spans, it falls back to plain loops otherwise.
+// The depth buffer is always single precision, so these don't depend on REAL_T_IS_DOUBLE.
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define OCCLUSION_CULL_RASTER_SSE
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#define OCCLUSION_CULL_RASTER_NEON
+#endif
+
+// Occlusion culling that rasterizes the occluders into the low resolution depth buffer on the CPU,
+// instead of raycasting them. It needs no third party library, so it works on every platform,
+// and it's used whenever the raycast (Embree) backend isn't available or isn't selected in
+// the "rendering/occlusion_culling/backend" project setting.
+class RendererSceneOcclusionCullRaster : public RendererSceneOcclusionCull {
+public:
+	class RasterHZBuffer : public HZBuffer {
+		friend class RendererSceneOcclusionCullRaster;
+
+	public:
+		// Rows of the depth buffer rasterized by each task.
+		static const int BAND_ROWS = 8;
+
+	private:
+		// Triangle in depth buffer space, where pixel centers are at integer coordinates. Edges are
+		// oriented so a*x + b*y + c >= 0 inside, and "nearness" (1 / view depth for perspective, view
+		// Z for orthogonal projections) is interpolated linearly across the screen. Doubles are used
+		// because near-clipped triangles can project very far off screen.
+		struct Triangle {
+			double edge_a[3];
+			double edge_b[3];
+			double edge_c[3];
+			double nearness_x;
+			double nearness_y;
+			double nearness_c;
+			int min_x;
+			int max_x;
+			int min_y;
+			int max_y;
+		};
+
+		struct RasterThreadData {
+			CameraMatrix inv_projection;
+			float z_near;
+			float miss_depth;
+			bool orthogonal;
+		};
+
+		LocalVector<Triangle> triangles;
+		// Vertices of the occluder being set up, in view space and projected to the depth buffer
+		// (with nearness as Z). Only those in front of the near plane are projected.
+		LocalVector<Vector3> view_vertices;
+		LocalVector<Vector3> screen_vertices;
+
+		_FORCE_INLINE_ Vector3 _project(const Vector3 &p_view, const CameraMatrix &p_cam_projection, bool p_orthogonal) const;
+		void _add_clipped_triangle(const Vector3 p_view[3], const CameraMatrix &p_cam_projection, float p_z_near, bool p_orthogonal);
+		void _add_screen_triangle(const Vector3 p_screen[3]);
+		void _rasterize_band(uint32_t p_band, const RasterThreadData *p_data);
+
+	public:
+		RID scenario_rid;
+
+		virtual void clear() override;
+	};
+
+private:
+	struct InstanceID {
+		RID scenario;
+		RID instance;
+
+		bool operator<(const InstanceID &rhs) const {
+			if (instance == rhs.instance) {
+				return rhs.scenario < scenario;
+			}
+			return instance < rhs.instance;
+		}
+
+		InstanceID() {}
+		InstanceID(RID s, RID i) :
+				scenario(s), instance(i) {}
+	};
+
+	struct Occluder {
+		PackedVector3Array vertices;
+		PackedInt32Array indices;
+		Set<InstanceID> users;
+	};
+
+	struct OccluderInstance {
+		RID occluder;
+		LocalVector<Vector3> xformed_vertices;
+		LocalVector<uint32_t> indices;
+		AABB aabb;
+		Transform3D xform;
+		bool enabled = true;
+	};
+
+	struct Scenario {
+		HashMap<RID, OccluderInstance> instances;
+		Set<RID> dirty_instances; // To avoid duplicates
+		LocalVector<RID> dirty_instances_array; // To iterate and split into threads
+
+		void _update_dirty_instance(uint32_t p_idx, RID *p_instances);
+		void update();
+	};
+
+	static RendererSceneOcclusionCullRaster *raster_singleton;
+
+	RID_PtrOwner<Occluder> occluder_owner;
+	HashMap<RID, Scenario> scenarios;
+	HashMap<RID, RasterHZBuffer> buffers;
+
+	void _mark_instance_dirty(Scenario &p_scenario, RID p_instance);
+
+public:
+	virtual bool is_occluder(RID p_rid) override;
+	virtual RID occluder_allocate() override;
+	virtual void occluder_initialize(RID p_occluder) override;
+	virtual void occluder_set_mesh(RID p_occluder, const PackedVector3Array &p_vertices, const PackedInt32Array &p_indices) override;
+	virtual void free_occluder(RID p_occluder) override;
+
+	virtual void add_scenario(RID p_scenario) override;
+	virtual void remove_scenario(RID p_scenario) override;
+	virtual void scenario_set_instance(RID p_scenario, RID p_instance, RID p_occluder, const Transform3D &p_xform, bool p_enabled) override;
+	virtual void scenario_remove_instance(RID p_scenario, RID p_instance) override;
+
+	virtual void add_buffer(RID p_buffer) override;
+	virtual void remove_buffer(RID p_buffer) override;
+	virtual HZBuffer *buffer_get_ptr(RID p_buffer) override;
+	virtual void buffer_set_scenario(RID p_buffer, RID p_scenario) override;
+	virtual void buffer_set_size(RID p_buffer, const Vector2i &p_size) override;
+	virtual void buffer_update(RID p_buffer, const Transform3D &p_cam_transform, const CameraMatrix &p_cam_projection, bool p_cam_orthogonal) override;
+	virtual RID buffer_get_debug_texture(RID p_buffer) override;
+
+	RendererSceneOcclusionCullRaster();
+	~RendererSceneOcclusionCullRaster();
+};
+
+#endif // RENDERER_SCENE_OCCLUSION_CULL_RASTER_H
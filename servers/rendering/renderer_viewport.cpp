@@ -31,6 +31,7 @@
 #include "renderer_viewport.h"
 
 #include "core/config/project_settings.h"
+#include "core/os/worker_thread_pool.h"
 #include "renderer_canvas_cull.h"
 #include "renderer_scene_cull.h"
 #include "rendering_server_globals.h"
@@ -82,7 +83,7 @@ void RendererViewport::_draw_3d(Viewport *p_viewport) {
 	if (p_viewport->use_occlusion_culling) {
 		if (p_viewport->occlusion_buffer_dirty) {
 			float aspect = p_viewport->size.aspect();
-			int max_size = occlusion_rays_per_thread * RendererThreadPool::singleton->thread_work_pool.get_thread_count();
+			int max_size = occlusion_rays_per_thread * WorkerThreadPool::get_singleton()->get_thread_count();
 
 			int viewport_size = p_viewport->size.width * p_viewport->size.height;
 			max_size = CLAMP(max_size, viewport_size / (32 * 32), viewport_size / (2 * 2)); // At least one depth pixel for every 16x16 region. At most one depth pixel for every 2x2 region.
@@ -116,6 +117,11 @@ void RendererViewport::_draw_viewport(Viewport *p_viewport, uint32_t p_view_coun
 		for (int j = 0; j < RS::VIEWPORT_RENDER_INFO_MAX; j++) {
 			p_viewport->render_info.info[i][j] = 0;
 		}
+		for (int j = 0; j < RS::MAX_RENDER_INFO_LODS; j++) {
+			for (int k = 0; k < RS::VIEWPORT_RENDER_LOD_INFO_MAX; k++) {
+				p_viewport->render_info.lod_info[i][j][k] = 0;
+			}
+		}
 	}
 
 	Color bgcolor = RSG::storage->get_default_clear_color();
@@ -999,6 +1005,19 @@ int RendererViewport::viewport_get_render_info(RID p_viewport, RS::ViewportRende
 	return viewport->render_info.info[p_type][p_info];
 }
 
+int RendererViewport::viewport_get_render_lod_info(RID p_viewport, RS::ViewportRenderInfoType p_type, int p_lod, RS::ViewportRenderLODInfo p_info) {
+	ERR_FAIL_INDEX_V(p_type, RS::VIEWPORT_RENDER_INFO_TYPE_MAX, -1);
+	ERR_FAIL_INDEX_V(p_lod, RS::MAX_RENDER_INFO_LODS, -1);
+	ERR_FAIL_INDEX_V(p_info, RS::VIEWPORT_RENDER_LOD_INFO_MAX, -1);
+
+	Viewport *viewport = viewport_owner.getornull(p_viewport);
+	if (!viewport) {
+		return 0; //there should be a lock here..
+	}
+
+	return viewport->render_info.lod_info[p_type][p_lod][p_info];
+}
+
 void RendererViewport::viewport_set_debug_draw(RID p_viewport, RS::ViewportDebugDraw p_draw) {
 	Viewport *viewport = viewport_owner.getornull(p_viewport);
 	ERR_FAIL_COND(!viewport);
@@ -246,6 +246,7 @@ public:
 	void viewport_set_lod_threshold(RID p_viewport, float p_pixels);
 
 	virtual int viewport_get_render_info(RID p_viewport, RS::ViewportRenderInfoType p_type, RS::ViewportRenderInfo p_info);
+	virtual int viewport_get_render_lod_info(RID p_viewport, RS::ViewportRenderInfoType p_type, int p_lod, RS::ViewportRenderLODInfo p_info);
 	virtual void viewport_set_debug_draw(RID p_viewport, RS::ViewportDebugDraw p_draw);
 
 	void viewport_set_measure_render_time(RID p_viewport, bool p_enable);
@@ -571,6 +571,7 @@ public:
 	FUNC2(viewport_set_lod_threshold, RID, float)
 
 	FUNC3R(int, viewport_get_render_info, RID, ViewportRenderInfoType, ViewportRenderInfo)
+	FUNC4R(int, viewport_get_render_lod_info, RID, ViewportRenderInfoType, int, ViewportRenderLODInfo)
 	FUNC2(viewport_set_debug_draw, RID, ViewportDebugDraw)
 
 	FUNC2(viewport_set_measure_render_time, RID, bool)
@@ -727,6 +728,7 @@ public:
 	FUNC2(canvas_set_modulate, RID, const Color &)
 	FUNC3(canvas_set_parent, RID, RID, float)
 	FUNC1(canvas_set_disable_scale, bool)
+	FUNC2(canvas_set_use_spatial_index, RID, bool)
 
 	FUNCRIDSPLIT(canvas_texture)
 	FUNC3(canvas_texture_set_channel, RID, CanvasTextureChannel, RID)
@@ -39,7 +39,6 @@
 #include "core/variant/typed_array.h"
 #include "core/variant/variant.h"
 #include "servers/display_server.h"
-#include "servers/rendering/renderer_thread_pool.h"
 #include "servers/rendering/rendering_device.h"
 #include "servers/rendering/shader_language.h"
 
@@ -53,8 +52,6 @@ class RenderingServer : public Object {
 
 	Array _get_array_from_surface(uint32_t p_format, Vector<uint8_t> p_vertex_data, Vector<uint8_t> p_attrib_data, Vector<uint8_t> p_skin_data, int p_vertex_len, Vector<uint8_t> p_index_data, int p_index_len) const;
 
-	RendererThreadPool *thread_pool = nullptr;
-
 protected:
 	RID _make_test_cube();
 	void _free_internal_rids();
@@ -79,6 +76,7 @@ public:
 		MAX_GLOW_LEVELS = 7,
 		MAX_CURSORS = 8,
 		MAX_2D_DIRECTIONAL_LIGHTS = 8,
+		MAX_RENDER_INFO_LODS = 8,
 		MAX_MESH_SURFACES = 256
 	};
 
@@ -859,6 +857,7 @@ public:
 		VIEWPORT_RENDER_INFO_OBJECTS_IN_FRAME,
 		VIEWPORT_RENDER_INFO_PRIMITIVES_IN_FRAME,
 		VIEWPORT_RENDER_INFO_DRAW_CALLS_IN_FRAME,
+		VIEWPORT_RENDER_INFO_MERGED_DRAW_CALLS_IN_FRAME,
 		VIEWPORT_RENDER_INFO_MAX,
 	};
 
@@ -870,6 +869,14 @@ public:
 
 	virtual int viewport_get_render_info(RID p_viewport, ViewportRenderInfoType p_type, ViewportRenderInfo p_info) = 0;
 
+	enum ViewportRenderLODInfo {
+		VIEWPORT_RENDER_LOD_INFO_OBJECTS_IN_FRAME,
+		VIEWPORT_RENDER_LOD_INFO_PRIMITIVES_IN_FRAME,
+		VIEWPORT_RENDER_LOD_INFO_MAX,
+	};
+
+	virtual int viewport_get_render_lod_info(RID p_viewport, ViewportRenderInfoType p_type, int p_lod, ViewportRenderLODInfo p_info) = 0;
+
 	enum ViewportDebugDraw {
 		VIEWPORT_DEBUG_DRAW_DISABLED,
 		VIEWPORT_DEBUG_DRAW_UNSHADED,
@@ -1197,6 +1204,7 @@ public:
 	virtual void canvas_set_parent(RID p_canvas, RID p_parent, float p_scale) = 0;
 
 	virtual void canvas_set_disable_scale(bool p_disable) = 0;
+	virtual void canvas_set_use_spatial_index(RID p_canvas, bool p_enable) = 0;
 
 	/* CANVAS TEXTURE */
 	virtual RID canvas_texture_create() = 0;
@@ -1538,6 +1546,7 @@ VARIANT_ENUM_CAST(RenderingServer::ViewportMSAA);
 VARIANT_ENUM_CAST(RenderingServer::ViewportScreenSpaceAA);
 VARIANT_ENUM_CAST(RenderingServer::ViewportRenderInfo);
 VARIANT_ENUM_CAST(RenderingServer::ViewportRenderInfoType);
+VARIANT_ENUM_CAST(RenderingServer::ViewportRenderLODInfo);
 VARIANT_ENUM_CAST(RenderingServer::ViewportDebugDraw);
 VARIANT_ENUM_CAST(RenderingServer::ViewportOcclusionCullingBuildQuality);
 VARIANT_ENUM_CAST(RenderingServer::ViewportSDFOversize);
@@ -0,0 +1,192 @@
+/*************************************************************************/
+/*  test_bvh.h                                                           */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2021 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2021 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef TEST_BVH_H
+#define TEST_BVH_H
+
+#include "core/math/bvh.h"
+#include "core/math/random_pcg.h"
+
+#include "tests/test_macros.h"
+
+namespace TestBVH {
+
+TEST_CASE("[BVH] Culling stays exact while the tree is rebuilt") {
+	const int item_count = 1024;
+	const int update_count = 1024;
+
+	// Small leaves, so the tree is deep enough to degrade.
+	BVH_Manager<int, false, 8> bvh;
+
+	RandomPCG rng(1234);
+	LocalVector<int> values;
+	LocalVector<AABB> aabbs;
+	LocalVector<BVHHandle> handles;
+	values.resize(item_count);
+	aabbs.resize(item_count);
+	handles.resize(item_count);
+
+	for (int i = 0; i < item_count; i++) {
+		values[i] = i;
+		aabbs[i] = AABB(Vector3(rng.randf(), rng.randf(), rng.randf()) * 100, Vector3(1, 1, 1));
+		handles[i] = bvh.create(&values[i], true, aabbs[i]);
+	}
+
+	LocalVector<int *> results;
+	results.resize(item_count);
+	LocalVector<uint8_t> found;
+	found.resize(item_count);
+
+	bool culls_match = true;
+
+	for (int update = 0; update < update_count; update++) {
+		// Items drift across the world, which slowly degrades the tree.
+		for (int i = 0; i < item_count; i++) {
+			aabbs[i].position += Vector3(rng.randf() - 0.2, rng.randf() - 0.5, rng.randf() - 0.5);
+			bvh.move(handles[i], aabbs[i]);
+		}
+
+		// Replace a few items, so some are added and removed while a rebuild is running.
+		for (int n = 0; n < 4; n++) {
+			int i = rng.rand() % item_count;
+			bvh.erase(handles[i]);
+			handles[i] = bvh.create(&values[i], true, aabbs[i]);
+		}
+
+		bvh.update();
+
+		if (update % 16) {
+			continue;
+		}
+
+		for (int query = 0; query < 8; query++) {
+			AABB cull_aabb = aabbs[rng.rand() % item_count].grow(rng.randf() * 10);
+			int count = bvh.cull_aabb(cull_aabb, results.ptr(), item_count);
+
+			memset(found.ptr(), 0, found.size());
+			for (int n = 0; n < count; n++) {
+				found[*results[n]] = 1;
+			}
+
+			int expected_count = 0;
+			for (int i = 0; i < item_count; i++) {
+				bool expected = aabbs[i].intersects(cull_aabb);
+				expected_count += expected ? 1 : 0;
+				culls_match = culls_match && (found[i] != 0) == expected;
+			}
+			culls_match = culls_match && count == expected_count;
+		}
+	}
+
+	CHECK_MESSAGE(culls_match, "Culling should find exactly the intersecting items.");
+	CHECK_MESSAGE(bvh.get_quality_ratio() < 2.0, "The tree should be rebuilt before its quality degrades too much.");
+
+	for (int i = 0; i < item_count; i++) {
+		bvh.erase(handles[i]);
+	}
+}
+
+struct PairingLog {
+	LocalVector<int> events;
+
+	static void *pair(void *p_self, uint32_t p_id_a, int *p_a, int p_subindex_a, uint32_t p_id_b, int *p_b, int p_subindex_b) {
+		PairingLog *self = (PairingLog *)p_self;
+		self->events.push_back(*p_a);
+		self->events.push_back(*p_b);
+		return nullptr;
+	}
+
+	static void unpair(void *p_self, uint32_t p_id_a, int *p_a, int p_subindex_a, uint32_t p_id_b, int *p_b, int p_subindex_b, void *p_pair_data) {
+		PairingLog *self = (PairingLog *)p_self;
+		self->events.push_back(-*p_a - 1);
+		self->events.push_back(-*p_b - 1);
+	}
+};
+
+TEST_CASE("[BVH] Pairing on worker threads matches single threaded pairing") {
+	const int item_count = 1024;
+
+	BVH_Manager<int, true, 8> bvh_serial;
+	BVH_Manager<int, true, 8> bvh_threaded;
+	bvh_threaded.params_set_pairing_thread_threshold(1);
+
+	PairingLog log_serial;
+	PairingLog log_threaded;
+	bvh_serial.set_pair_callback(PairingLog::pair, &log_serial);
+	bvh_serial.set_unpair_callback(PairingLog::unpair, &log_serial);
+	bvh_threaded.set_pair_callback(PairingLog::pair, &log_threaded);
+	bvh_threaded.set_unpair_callback(PairingLog::unpair, &log_threaded);
+
+	RandomPCG rng(4321);
+	LocalVector<int> values;
+	LocalVector<AABB> aabbs;
+	LocalVector<BVHHandle> handles_serial;
+	LocalVector<BVHHandle> handles_threaded;
+	values.resize(item_count);
+	aabbs.resize(item_count);
+	handles_serial.resize(item_count);
+	handles_threaded.resize(item_count);
+
+	for (int i = 0; i < item_count; i++) {
+		values[i] = i;
+		aabbs[i] = AABB(Vector3(rng.randf(), rng.randf(), rng.randf()) * 50, Vector3(1, 1, 1));
+		// half the items are static, they only pair with moving items
+		bool pairable = i % 2;
+		handles_serial[i] = bvh_serial.create(&values[i], true, aabbs[i], 0, pairable, 1, pairable ? 1 : 0);
+		handles_threaded[i] = bvh_threaded.create(&values[i], true, aabbs[i], 0, pairable, 1, pairable ? 1 : 0);
+	}
+
+	for (int update = 0; update < 256; update++) {
+		for (int i = 1; i < item_count; i += 2) {
+			aabbs[i].position += Vector3(rng.randf() - 0.5, rng.randf() - 0.5, rng.randf() - 0.5);
+			bvh_serial.move(handles_serial[i], aabbs[i]);
+			bvh_threaded.move(handles_threaded[i], aabbs[i]);
+		}
+		bvh_serial.update();
+		bvh_threaded.update();
+	}
+
+	CHECK_MESSAGE(log_serial.events.size() > 0, "Moving items should pair and unpair.");
+
+	bool logs_match = log_serial.events.size() == log_threaded.events.size();
+	for (uint32_t n = 0; logs_match && n < log_serial.events.size(); n++) {
+		logs_match = log_serial.events[n] == log_threaded.events[n];
+	}
+	CHECK_MESSAGE(logs_match, "Pair and unpair callbacks should happen in the same order.");
+
+	for (int i = 0; i < item_count; i++) {
+		bvh_serial.erase(handles_serial[i]);
+		bvh_threaded.erase(handles_threaded[i]);
+	}
+}
+
+} // namespace TestBVH
+
+#endif // TEST_BVH_H
@@ -0,0 +1,303 @@
+/*************************************************************************/
+/*  test_canvas_cull_benchmark.h                                         */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2021 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2021 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef TEST_CANVAS_CULL_BENCHMARK_H
+#define TEST_CANVAS_CULL_BENCHMARK_H
+
+#include "core/os/os.h"
+#include "core/string/print_string.h"
+#include "core/templates/hashfuncs.h"
+#include "servers/rendering/rasterizer_dummy.h"
+#include "servers/rendering/renderer_canvas_cull.h"
+#include "servers/rendering/rendering_server_globals.h"
+
+#include "tests/test_macros.h"
+
+// Headless benchmark of 2D canvas culling using the dummy rasterizer. Each scene is culled for a few hundred frames,
+// once without and once with the canvas spatial index, and checks that both draw the same items.
+// Run all scenes with `godot --test canvas-cull-benchmark`, or only some of them by adding their names.
+
+namespace TestCanvasCullBenchmark {
+
+const int FRAME_COUNT = 300;
+const Size2 SCREEN_SIZE = Size2(1280, 720);
+const int LEVEL_TILES = 256; // along each side
+const real_t TILE_SIZE = 16;
+
+// Counts the items that would be drawn, so culling with and without the index can be compared.
+class CountingCanvasRender : public RasterizerCanvasDummy {
+public:
+	uint64_t item_count = 0;
+	uint64_t checksum = 5381;
+
+	void canvas_render_items(RID p_to_render_target, Item *p_item_list, const Color &p_modulate, Light *p_light_list, Light *p_directional_list, const Transform2D &p_canvas_transform, RS::CanvasItemTextureFilter p_default_filter, RS::CanvasItemTextureRepeat p_default_repeat, bool p_snap_2d_vertices_to_pixel, bool &r_sdf_used) override {
+		for (Item *item = p_item_list; item; item = item->next) {
+			item_count++;
+			checksum = hash_djb2_one_64((uint64_t)item, checksum);
+		}
+		r_sdf_used = false;
+	}
+};
+
+struct Scene {
+	RendererCanvasCull *canvas_cull = nullptr;
+	RID canvas;
+	LocalVector<RID> items; // Freed in reverse order once the scene is done.
+
+	RID add_item(RID p_parent, const Point2 &p_position, const Size2 &p_size = Size2()) {
+		RID item = canvas_cull->canvas_item_allocate();
+		canvas_cull->canvas_item_initialize(item);
+		canvas_cull->canvas_item_set_parent(item, p_parent);
+		canvas_cull->canvas_item_set_transform(item, Transform2D(0, p_position));
+		if (p_size != Size2()) {
+			canvas_cull->canvas_item_add_rect(item, Rect2(Point2(), p_size), Color(1, 1, 1));
+		}
+		items.push_back(item);
+		return item;
+	}
+
+	virtual void create() = 0;
+	// Called before each pass, so both passes see the same changes.
+	virtual void reset() {}
+	virtual void update(int p_frame) {}
+	virtual Vector2 get_camera(int p_frame) {
+		// Scroll diagonally across the level.
+		return Vector2(p_frame * 11, p_frame * 7);
+	}
+
+	virtual ~Scene() {}
+};
+
+// A single layer of tiles, like a large level where every tile is a sprite.
+struct FlatTilesScene : public Scene {
+	virtual void create() override {
+		RID level = add_item(canvas, Point2());
+		for (int y = 0; y < LEVEL_TILES; y++) {
+			for (int x = 0; x < LEVEL_TILES; x++) {
+				add_item(level, Point2(x, y) * TILE_SIZE, Size2(TILE_SIZE, TILE_SIZE));
+			}
+		}
+	}
+};
+
+// The same tiles grouped in chunks of 16x16, like tile map quadrants.
+struct ChunkedTilesScene : public Scene {
+	virtual void create() override {
+		const int chunk_tiles = 16;
+		RID level = add_item(canvas, Point2());
+		for (int cy = 0; cy < LEVEL_TILES / chunk_tiles; cy++) {
+			for (int cx = 0; cx < LEVEL_TILES / chunk_tiles; cx++) {
+				RID chunk = add_item(level, Point2(cx, cy) * chunk_tiles * TILE_SIZE);
+				for (int y = 0; y < chunk_tiles; y++) {
+					for (int x = 0; x < chunk_tiles; x++) {
+						add_item(chunk, Point2(x, y) * TILE_SIZE, Size2(TILE_SIZE, TILE_SIZE));
+					}
+				}
+			}
+		}
+	}
+};
+
+// Sprites placed directly in the canvas, with no common parent.
+struct TopLevelSpritesScene : public Scene {
+	virtual void create() override {
+		for (int i = 0; i < 16384; i++) {
+			add_item(canvas, _sprite_position(i), Size2(32, 32));
+		}
+	}
+
+	static Point2 _sprite_position(int p_index) {
+		// Scattered over the level without a pattern.
+		uint32_t h = hash_djb2_one_32(p_index);
+		return Point2(h % 4096, (h / 4096) % 4096);
+	}
+};
+
+// Sprites under a common parent, a sixteenth of which move every frame.
+struct MovingSpritesScene : public Scene {
+	LocalVector<RID> sprites;
+
+	virtual void create() override {
+		RID level = add_item(canvas, Point2());
+		for (int i = 0; i < 16384; i++) {
+			sprites.push_back(add_item(level, _sprite_position(i, 0), Size2(32, 32)));
+		}
+	}
+
+	virtual void reset() override {
+		for (uint32_t i = 0; i < sprites.size(); i++) {
+			canvas_cull->canvas_item_set_transform(sprites[i], Transform2D(0, _sprite_position(i, 0)));
+		}
+	}
+
+	virtual void update(int p_frame) override {
+		for (uint32_t i = p_frame % 16; i < sprites.size(); i += 16) {
+			canvas_cull->canvas_item_set_transform(sprites[i], Transform2D(0, _sprite_position(i, p_frame)));
+		}
+	}
+
+	static Point2 _sprite_position(int p_index, int p_frame) {
+		uint32_t h = hash_djb2_one_32(p_index);
+		real_t angle = p_frame * 0.05 + p_index;
+		return Point2(h % 4096, (h / 4096) % 4096) + Vector2(Math::cos(angle), Math::sin(angle)) * 64;
+	}
+};
+
+// A static user interface of nested panels, with one blinking widget, that stays entirely on screen.
+struct StaticHudScene : public Scene {
+	RID blinking_widget;
+
+	virtual void create() override {
+		const int panels = 32;
+		const int widgets = 64; // per panel
+		RID hud = add_item(canvas, Point2());
+		for (int p = 0; p < panels; p++) {
+			RID panel = add_item(hud, Point2(p % 8, p / 8) * Vector2(160, 180), Size2(160, 180));
+			for (int w = 0; w < widgets; w++) {
+				RID widget = add_item(panel, Point2(w % 8, w / 8) * Vector2(20, 22), Size2(18, 20));
+				add_item(widget, Point2(2, 2), Size2(14, 8)); // label
+			}
+		}
+		blinking_widget = items[items.size() - 2];
+	}
+
+	virtual void reset() override {
+		canvas_cull->canvas_item_set_modulate(blinking_widget, Color(1, 1, 1));
+	}
+
+	virtual void update(int p_frame) override {
+		canvas_cull->canvas_item_set_modulate(blinking_widget, Color(1, 1, 1, (p_frame / 30) % 2));
+	}
+
+	virtual Vector2 get_camera(int p_frame) override {
+		return Vector2();
+	}
+};
+
+static void run_scene(const char *p_name, Scene *p_scene) {
+	CountingCanvasRender canvas_render;
+	RendererCanvasRender *prev_canvas_render = RSG::canvas_render;
+	RSG::canvas_render = &canvas_render;
+	RasterizerStorageDummy storage;
+	RendererStorage *prev_storage = RSG::storage;
+	RSG::storage = &storage;
+
+	RendererCanvasCull *canvas_cull = memnew(RendererCanvasCull);
+	p_scene->canvas_cull = canvas_cull;
+	p_scene->canvas = canvas_cull->canvas_allocate();
+	canvas_cull->canvas_initialize(p_scene->canvas);
+	p_scene->create();
+
+	uint64_t item_count[2] = {};
+	uint64_t checksum[2] = {};
+
+	for (int pass = 0; pass < 2; pass++) {
+		bool use_spatial_index = pass == 1;
+		canvas_cull->canvas_set_use_spatial_index(p_scene->canvas, use_spatial_index);
+		p_scene->reset();
+
+		canvas_render.item_count = 0;
+		canvas_render.checksum = 5381;
+		uint64_t cull_time = 0;
+		uint64_t first_frame_time = 0;
+
+		uint64_t begin_time = OS::get_singleton()->get_ticks_usec();
+		for (int frame = 0; frame < FRAME_COUNT; frame++) {
+			p_scene->update(frame);
+
+			Vector2 camera = p_scene->get_camera(frame);
+			RendererCanvasCull::Canvas *canvas = canvas_cull->canvas_owner.getornull(p_scene->canvas);
+
+			uint64_t cull_begin_time = OS::get_singleton()->get_ticks_usec();
+			canvas_cull->render_canvas(RID(), canvas, Transform2D(0, -camera), nullptr, nullptr, Rect2(Point2(), SCREEN_SIZE), RS::CANVAS_ITEM_TEXTURE_FILTER_LINEAR, RS::CANVAS_ITEM_TEXTURE_REPEAT_DISABLED, false, false);
+			uint64_t frame_cull_time = OS::get_singleton()->get_ticks_usec() - cull_begin_time;
+
+			// The first frame builds the index, report it separately.
+			if (frame == 0) {
+				first_frame_time = frame_cull_time;
+			} else {
+				cull_time += frame_cull_time;
+			}
+		}
+		uint64_t total_time = OS::get_singleton()->get_ticks_usec() - begin_time;
+
+		item_count[pass] = canvas_render.item_count;
+		checksum[pass] = canvas_render.checksum;
+
+		print_line(vformat("%s (%s): %d items, %d frames, %.2f ms total,", p_name, use_spatial_index ? "spatial index" : "no index", p_scene->items.size(), FRAME_COUNT, total_time / 1000.0) +
+				vformat(" %.3f ms first frame, %.3f ms/frame culling, %.1f items drawn/frame.", first_frame_time / 1000.0, cull_time / 1000.0 / (FRAME_COUNT - 1), (double)item_count[pass] / FRAME_COUNT));
+	}
+
+	if (item_count[0] != item_count[1] || checksum[0] != checksum[1]) {
+		ERR_PRINT(vformat("%s: culling with the spatial index drew different items.", p_name));
+	}
+
+	for (int i = p_scene->items.size() - 1; i >= 0; i--) {
+		canvas_cull->free(p_scene->items[i]);
+	}
+	canvas_cull->free(p_scene->canvas);
+	memdelete(canvas_cull);
+
+	RSG::canvas_render = prev_canvas_render;
+	RSG::storage = prev_storage;
+}
+
+static void benchmark() {
+	List<String> args = OS::get_singleton()->get_cmdline_args();
+
+	struct {
+		const char *name;
+		Scene *scene;
+	} scenes[] = {
+		{ "flat_tiles", memnew(FlatTilesScene) },
+		{ "chunked_tiles", memnew(ChunkedTilesScene) },
+		{ "top_level_sprites", memnew(TopLevelSpritesScene) },
+		{ "moving_sprites", memnew(MovingSpritesScene) },
+		{ "static_hud", memnew(StaticHudScene) },
+	};
+
+	bool run_all = true;
+	for (const auto &scene : scenes) {
+		run_all = run_all && !args.find(scene.name);
+	}
+
+	for (const auto &scene : scenes) {
+		if (run_all || args.find(scene.name)) {
+			run_scene(scene.name, scene.scene);
+		}
+		memdelete(scene.scene);
+	}
+}
+
+REGISTER_TEST_COMMAND("canvas-cull-benchmark", &benchmark);
+
+} // namespace TestCanvasCullBenchmark
+
+#endif // TEST_CANVAS_CULL_BENCHMARK_H
@@ -36,6 +36,8 @@
 #include "test_array.h"
 #include "test_astar.h"
 #include "test_basis.h"
+#include "test_bvh.h"
+#include "test_canvas_cull_benchmark.h"
 #include "test_class_db.h"
 #include "test_color.h"
 #include "test_command_queue.h"
@@ -61,16 +63,23 @@
 #include "test_node_path.h"
 #include "test_oa_hash_map.h"
 #include "test_object.h"
+#include "test_occlusion_cull_raster.h"
 #include "test_ordered_hash_map.h"
 #include "test_paged_array.h"
 #include "test_path_3d.h"
 #include "test_pck_packer.h"
 #include "test_physics_2d.h"
 #include "test_physics_3d.h"
+#include "test_physics_benchmark.h"
+#include "test_physics_contacts.h"
+#include "test_physics_determinism.h"
+#include "test_physics_queries.h"
 #include "test_random_number_generator.h"
 #include "test_rect2.h"
 #include "test_render.h"
+#include "test_render_benchmark.h"
 #include "test_resource.h"
+#include "test_scene_cull_bounds.h"
 #include "test_shader_lang.h"
 #include "test_string.h"
 #include "test_text_server.h"
@@ -79,6 +88,7 @@
 #include "test_validate_testing.h"
 #include "test_variant.h"
 #include "test_vector.h"
+#include "test_worker_thread_pool.h"
 #include "test_xml_parser.h"
 
 #include "modules/modules_tests.gen.h"
@@ -0,0 +1,131 @@
+/*************************************************************************/
+/*  test_occlusion_cull_raster.h                                         */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2021 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2021 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef TEST_OCCLUSION_CULL_RASTER_H
+#define TEST_OCCLUSION_CULL_RASTER_H
+
+#include "servers/rendering/renderer_scene_occlusion_cull_raster.h"
+
+#include "tests/test_macros.h"
+
+namespace TestOcclusionCullRaster {
+
+static bool is_box_occluded(const RendererSceneOcclusionCull::HZBuffer *p_buffer, const AABB &p_aabb, const Transform3D &p_cam_transform, const CameraMatrix &p_cam_projection) {
+	real_t bounds[6] = {
+		p_aabb.position.x, p_aabb.position.y, p_aabb.position.z,
+		p_aabb.position.x + p_aabb.size.x, p_aabb.position.y + p_aabb.size.y, p_aabb.position.z + p_aabb.size.z
+	};
+	return p_buffer->is_occluded(bounds, p_cam_transform.origin, p_cam_transform.affine_inverse(), p_cam_projection, p_cam_projection.get_z_near());
+}
+
+TEST_CASE("[OcclusionCullRaster] Boxes behind an occluder are culled") {
+	RendererSceneOcclusionCullRaster occlusion_cull;
+
+	// Two triangles making a 20x20 wall facing the camera.
+	PackedVector3Array vertices;
+	vertices.push_back(Vector3(-10, -10, 0));
+	vertices.push_back(Vector3(10, -10, 0));
+	vertices.push_back(Vector3(10, 10, 0));
+	vertices.push_back(Vector3(-10, 10, 0));
+	PackedInt32Array indices;
+	indices.push_back(0);
+	indices.push_back(1);
+	indices.push_back(2);
+	indices.push_back(0);
+	indices.push_back(2);
+	indices.push_back(3);
+
+	RID occluder = occlusion_cull.occluder_allocate();
+	occlusion_cull.occluder_initialize(occluder);
+	occlusion_cull.occluder_set_mesh(occluder, vertices, indices);
+
+	RID scenario = RID::from_uint64(1);
+	RID instance = RID::from_uint64(2);
+	RID buffer = RID::from_uint64(3);
+	occlusion_cull.add_scenario(scenario);
+	occlusion_cull.scenario_set_instance(scenario, instance, occluder, Transform3D(Basis(), Vector3(0, 0, -10)), true);
+	occlusion_cull.add_buffer(buffer);
+	occlusion_cull.buffer_set_scenario(buffer, scenario);
+	occlusion_cull.buffer_set_size(buffer, Size2i(64, 36));
+
+	SUBCASE("Perspective") {
+		CameraMatrix projection;
+		projection.set_perspective(70, 16.0 / 9.0, 0.05, 100);
+		Transform3D camera = Transform3D(Basis(Vector3(0, 1, 0), 0.1), Vector3(1, 0.5, 0));
+		occlusion_cull.buffer_update(buffer, camera, projection, false);
+		const RendererSceneOcclusionCull::HZBuffer *hz = occlusion_cull.buffer_get_ptr(buffer);
+
+		CHECK(is_box_occluded(hz, AABB(Vector3(-1, -1, -31), Vector3(2, 2, 2)), camera, projection));
+		CHECK(is_box_occluded(hz, AABB(Vector3(-2, -2, -12), Vector3(4, 4, 1)), camera, projection));
+		CHECK_FALSE(is_box_occluded(hz, AABB(Vector3(-1, -1, -6), Vector3(2, 2, 2)), camera, projection));
+		CHECK_FALSE(is_box_occluded(hz, AABB(Vector3(30, -1, -31), Vector3(2, 2, 2)), camera, projection));
+		// Crossing the occluder.
+		CHECK_FALSE(is_box_occluded(hz, AABB(Vector3(-1, -1, -11), Vector3(2, 2, 2)), camera, projection));
+	}
+
+	SUBCASE("Orthogonal") {
+		CameraMatrix projection;
+		projection.set_orthogonal(40, 16.0 / 9.0, 0.05, 100, false);
+		Transform3D camera;
+		occlusion_cull.buffer_update(buffer, camera, projection, true);
+		const RendererSceneOcclusionCull::HZBuffer *hz = occlusion_cull.buffer_get_ptr(buffer);
+
+		CHECK(is_box_occluded(hz, AABB(Vector3(-8, -8, -31), Vector3(2, 2, 2)), camera, projection));
+		CHECK_FALSE(is_box_occluded(hz, AABB(Vector3(-8, -8, -6), Vector3(2, 2, 2)), camera, projection));
+		CHECK_FALSE(is_box_occluded(hz, AABB(Vector3(12, -1, -31), Vector3(2, 2, 2)), camera, projection));
+	}
+
+	SUBCASE("Disabled and moved occluders") {
+		CameraMatrix projection;
+		projection.set_perspective(70, 16.0 / 9.0, 0.05, 100);
+		Transform3D camera;
+		AABB box = AABB(Vector3(-1, -1, -31), Vector3(2, 2, 2));
+
+		occlusion_cull.scenario_set_instance(scenario, instance, occluder, Transform3D(Basis(), Vector3(0, 0, -10)), false);
+		occlusion_cull.buffer_update(buffer, camera, projection, false);
+		CHECK_FALSE(is_box_occluded(occlusion_cull.buffer_get_ptr(buffer), box, camera, projection));
+
+		occlusion_cull.scenario_set_instance(scenario, instance, occluder, Transform3D(Basis(), Vector3(0, 0, -40)), true);
+		occlusion_cull.buffer_update(buffer, camera, projection, false);
+		CHECK_FALSE(is_box_occluded(occlusion_cull.buffer_get_ptr(buffer), box, camera, projection));
+
+		occlusion_cull.scenario_remove_instance(scenario, instance);
+		occlusion_cull.buffer_update(buffer, camera, projection, false);
+		CHECK_FALSE(is_box_occluded(occlusion_cull.buffer_get_ptr(buffer), AABB(Vector3(-1, -1, -51), Vector3(2, 2, 2)), camera, projection));
+	}
+
+	occlusion_cull.remove_buffer(buffer);
+	occlusion_cull.remove_scenario(scenario);
+	occlusion_cull.free_occluder(occluder);
+}
+
+} // namespace TestOcclusionCullRaster
+
+#endif // TEST_OCCLUSION_CULL_RASTER_H
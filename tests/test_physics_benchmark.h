@@ -0,0 +1,295 @@
+/*************************************************************************/
+/*  test_physics_benchmark.h                                             */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2021 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2021 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef TEST_PHYSICS_BENCHMARK_H
+#define TEST_PHYSICS_BENCHMARK_H
+
+#include "core/os/os.h"
+#include "core/string/print_string.h"
+#include "servers/physics_3d/physics_server_3d_sw.h"
+
+#include "tests/test_macros.h"
+
+// Headless throughput benchmark of the 3D physics server, reporting the time spent in each phase of the step.
+// Run all scenes with `godot --test physics-3d-benchmark`, or only some of them by adding their names.
+
+namespace TestPhysicsBenchmark {
+
+const int STEP_COUNT = 300;
+const real_t STEP_TIME = 1.0 / 60.0;
+
+struct Scene {
+	PhysicsServer3DSW *ps = nullptr;
+	RID space;
+	LocalVector<RID> rids; // Freed in reverse order once the scene is done.
+	int body_count = 0;
+	int query_count = 0;
+
+	RID add_shape(RID p_shape, const Variant &p_data) {
+		ps->shape_set_data(p_shape, p_data);
+		rids.push_back(p_shape);
+		return p_shape;
+	}
+
+	RID add_body(RID p_shape, const Transform3D &p_xform, PhysicsServer3D::BodyMode p_mode = PhysicsServer3D::BODY_MODE_DYNAMIC) {
+		RID body = ps->body_create();
+		ps->body_set_mode(body, p_mode);
+		ps->body_set_space(body, space);
+		ps->body_add_shape(body, p_shape);
+		ps->body_set_state(body, PhysicsServer3D::BODY_STATE_TRANSFORM, p_xform);
+		rids.push_back(body);
+		body_count++;
+		return body;
+	}
+
+	void add_ground() {
+		RID ground_shape = add_shape(ps->box_shape_create(), Vector3(100, 1, 100));
+		add_body(ground_shape, Transform3D(Basis(), Vector3(0, -1, 0)), PhysicsServer3D::BODY_MODE_STATIC);
+		body_count--;
+	}
+
+	virtual void create() = 0;
+	virtual void query() {}
+
+	virtual ~Scene() {}
+};
+
+struct BoxStackScene : public Scene {
+	virtual void create() override {
+		add_ground();
+		RID box_shape = add_shape(ps->box_shape_create(), Vector3(0.5, 0.5, 0.5));
+		for (int x = 0; x < 8; x++) {
+			for (int z = 0; z < 8; z++) {
+				for (int y = 0; y < 8; y++) {
+					add_body(box_shape, Transform3D(Basis(), Vector3(x * 3, 0.5 + y, z * 3)));
+				}
+			}
+		}
+	}
+};
+
+struct PyramidScene : public Scene {
+	virtual void create() override {
+		add_ground();
+		RID box_shape = add_shape(ps->box_shape_create(), Vector3(0.5, 0.5, 0.5));
+		const int base = 20;
+		for (int y = 0; y < base; y++) {
+			for (int x = 0; x < base - y; x++) {
+				add_body(box_shape, Transform3D(Basis(), Vector3(x * 1.05 + y * 0.525, 0.5 + y, 0)));
+			}
+		}
+	}
+};
+
+struct RagdollPileScene : public Scene {
+	virtual void create() override {
+		add_ground();
+
+		Dictionary torso_data;
+		torso_data["radius"] = 0.2;
+		torso_data["height"] = 0.8;
+		RID torso_shape = add_shape(ps->capsule_shape_create(), torso_data);
+		RID head_shape = add_shape(ps->sphere_shape_create(), 0.15);
+		Dictionary limb_data;
+		limb_data["radius"] = 0.08;
+		limb_data["height"] = 0.6;
+		RID limb_shape = add_shape(ps->capsule_shape_create(), limb_data);
+
+		// Limbs hang from the torso, each joint sits at the top of the limb.
+		const Vector3 limb_anchors[4] = { Vector3(-0.3, 0.3, 0), Vector3(0.3, 0.3, 0), Vector3(-0.12, -0.45, 0), Vector3(0.12, -0.45, 0) };
+
+		for (int i = 0; i < 32; i++) {
+			Vector3 origin = Vector3((i % 4) * 0.5, 1.5 + i * 0.6, (i / 4 % 2) * 0.5);
+			Basis basis = Basis(Vector3(0, 1, 0), i * 0.7);
+
+			RID torso = add_body(torso_shape, Transform3D(basis, origin));
+
+			RID head = add_body(head_shape, Transform3D(basis, origin + basis.xform(Vector3(0, 0.6, 0))));
+			_add_joint(torso, Vector3(0, 0.45, 0), head, Vector3(0, -0.15, 0));
+
+			for (int j = 0; j < 4; j++) {
+				RID limb = add_body(limb_shape, Transform3D(basis, origin + basis.xform(limb_anchors[j] - Vector3(0, 0.3, 0))));
+				_add_joint(torso, limb_anchors[j], limb, Vector3(0, 0.3, 0));
+			}
+		}
+	}
+
+	void _add_joint(RID p_body_A, const Vector3 &p_anchor_A, RID p_body_B, const Vector3 &p_anchor_B) {
+		RID joint = ps->joint_create();
+		ps->joint_make_cone_twist(joint, p_body_A, Transform3D(Basis(), p_anchor_A), p_body_B, Transform3D(Basis(), p_anchor_B));
+		ps->cone_twist_joint_set_param(joint, PhysicsServer3D::CONE_TWIST_JOINT_SWING_SPAN, Math::deg2rad(45.0));
+		ps->cone_twist_joint_set_param(joint, PhysicsServer3D::CONE_TWIST_JOINT_TWIST_SPAN, Math::deg2rad(30.0));
+		rids.push_back(joint);
+	}
+};
+
+struct RaycastScene : public Scene {
+	Vector<Vector3> from;
+	Vector<Vector3> to;
+	Vector<PhysicsDirectSpaceState3D::RayResult> results;
+
+	virtual void create() override {
+		add_ground();
+		RID box_shape = add_shape(ps->box_shape_create(), Vector3(0.5, 2, 0.5));
+		RID sphere_shape = add_shape(ps->sphere_shape_create(), 0.5);
+		for (int x = 0; x < 16; x++) {
+			for (int z = 0; z < 16; z++) {
+				add_body(box_shape, Transform3D(Basis(), Vector3(x * 4, 2, z * 4)), PhysicsServer3D::BODY_MODE_STATIC);
+				if ((x + z) % 4 == 0) {
+					add_body(sphere_shape, Transform3D(Basis(), Vector3(x * 4 + 2, 5, z * 4 + 2)));
+				}
+			}
+		}
+
+		// A fan of rays crossing the whole field, like line of sight checks between many agents.
+		for (int i = 0; i < 1024; i++) {
+			real_t angle = Math_TAU * i / 64;
+			Vector3 origin = Vector3((i % 64) + 0.25, 0.5 + (i / 64) % 4, (i / 256) * 16 + 2);
+			from.push_back(origin);
+			to.push_back(origin + Vector3(Math::cos(angle), 0, Math::sin(angle)) * 60);
+		}
+		results.resize(from.size());
+	}
+
+	virtual void query() override {
+		PhysicsDirectSpaceState3D *space_state = ps->space_get_direct_state(space);
+		space_state->intersect_rays(from.ptr(), to.ptr(), from.size(), results.ptrw());
+		query_count += from.size();
+	}
+};
+
+struct AreaOverlapScene : public Scene {
+	virtual void create() override {
+		add_ground();
+		RID area_shape = add_shape(ps->sphere_shape_create(), 3.0);
+		RID sphere_shape = add_shape(ps->sphere_shape_create(), 0.25);
+		for (int x = 0; x < 8; x++) {
+			for (int z = 0; z < 8; z++) {
+				RID area = ps->area_create();
+				ps->area_set_space(area, space);
+				ps->area_add_shape(area, area_shape);
+				ps->area_set_transform(area, Transform3D(Basis(), Vector3(x * 4, 2, z * 4)));
+				rids.push_back(area);
+			}
+		}
+		for (int i = 0; i < 1024; i++) {
+			add_body(sphere_shape, Transform3D(Basis(), Vector3((i % 32) * 0.9, 3 + (i / 1024.0) * 20, ((i / 32) % 32) * 0.9)));
+		}
+	}
+};
+
+static void run_scene(const char *p_name, Scene *p_scene) {
+	PhysicsServer3DSW *ps = memnew(PhysicsServer3DSW);
+	ps->init();
+
+	p_scene->ps = ps;
+	p_scene->space = ps->space_create();
+	ps->space_set_active(p_scene->space, true);
+	p_scene->create();
+
+	static const char *phase_names[] = {
+		"integrate_forces",
+		"generate_islands",
+		"setup_constraints",
+		"solve_constraints",
+		"integrate_velocities",
+		"update_broadphase",
+		"flush_queries",
+	};
+	const int phase_count = sizeof(phase_names) / sizeof(phase_names[0]);
+	uint64_t phase_time[phase_count] = {};
+	uint64_t query_time = 0;
+
+	uint64_t begin_time = OS::get_singleton()->get_ticks_usec();
+	for (int i = 0; i < STEP_COUNT; i++) {
+		ps->step(STEP_TIME);
+		ps->sync();
+		ps->flush_queries();
+		ps->end_sync();
+
+		for (int j = 0; j < phase_count; j++) {
+			phase_time[j] += ps->get_process_info(PhysicsServer3D::ProcessInfo(PhysicsServer3D::INFO_INTEGRATE_FORCES_TIME + j));
+		}
+
+		uint64_t query_begin_time = OS::get_singleton()->get_ticks_usec();
+		p_scene->query();
+		query_time += OS::get_singleton()->get_ticks_usec() - query_begin_time;
+	}
+	uint64_t total_time = OS::get_singleton()->get_ticks_usec() - begin_time;
+
+	print_line(vformat("%s: %d bodies, %d steps, %.2f ms total, %d active objects at the end.", p_name, p_scene->body_count, STEP_COUNT, total_time / 1000.0, ps->get_process_info(PhysicsServer3D::INFO_ACTIVE_OBJECTS)));
+	for (int j = 0; j < phase_count; j++) {
+		print_line(vformat("    %-22s %10.2f ms %8.3f ms/step", phase_names[j], phase_time[j] / 1000.0, phase_time[j] / 1000.0 / STEP_COUNT));
+	}
+	if (p_scene->query_count > 0) {
+		print_line(vformat("    %-22s %10.2f ms %8.3f us/query", "queries", query_time / 1000.0, (double)query_time / p_scene->query_count));
+	}
+
+	for (int i = p_scene->rids.size() - 1; i >= 0; i--) {
+		ps->free(p_scene->rids[i]);
+	}
+	ps->free(p_scene->space);
+
+	ps->finish();
+	memdelete(ps);
+}
+
+static void benchmark() {
+	List<String> args = OS::get_singleton()->get_cmdline_args();
+
+	struct {
+		const char *name;
+		Scene *scene;
+	} scenes[] = {
+		{ "box_stack", memnew(BoxStackScene) },
+		{ "pyramid", memnew(PyramidScene) },
+		{ "ragdoll_pile", memnew(RagdollPileScene) },
+		{ "raycasts", memnew(RaycastScene) },
+		{ "area_overlap", memnew(AreaOverlapScene) },
+	};
+
+	bool run_all = true;
+	for (const auto &scene : scenes) {
+		run_all = run_all && !args.find(scene.name);
+	}
+
+	for (const auto &scene : scenes) {
+		if (run_all || args.find(scene.name)) {
+			run_scene(scene.name, scene.scene);
+		}
+		memdelete(scene.scene);
+	}
+}
+
+REGISTER_TEST_COMMAND("physics-3d-benchmark", &benchmark);
+
+} // namespace TestPhysicsBenchmark
+
+#endif // TEST_PHYSICS_BENCHMARK_H
@@ -0,0 +1,180 @@
+/*************************************************************************/
+/*  test_physics_contacts.h                                              */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2021 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2021 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef TEST_PHYSICS_CONTACTS_H
+#define TEST_PHYSICS_CONTACTS_H
+
+#include "servers/physics_3d/body_3d_sw.h"
+#include "servers/physics_3d/physics_server_3d_sw.h"
+#include "servers/physics_3d/shape_3d_sw.h"
+
+#include "tests/test_macros.h"
+
+namespace TestPhysicsContacts {
+
+TEST_CASE("[Physics3D] Changing shapes invalidates cached contact manifolds") {
+	PhysicsServer3DSW *ps = memnew(PhysicsServer3DSW);
+	ps->init();
+
+	SUBCASE("Every shape change bumps the shapes version") {
+		BoxShape3DSW box;
+		box.set_data(Vector3(0.5, 0.5, 0.5));
+		SphereShape3DSW sphere;
+		sphere.set_data(0.5);
+
+		Body3DSW *body = memnew(Body3DSW);
+		uint64_t version = body->get_shapes_version();
+		body->add_shape(&box);
+		CHECK_MESSAGE(body->get_shapes_version() != version, "Adding a shape should change the shapes version.");
+		version = body->get_shapes_version();
+		body->set_shape_transform(0, Transform3D(Basis(), Vector3(0, 1, 0)));
+		CHECK_MESSAGE(body->get_shapes_version() != version, "Moving a shape should change the shapes version.");
+		version = body->get_shapes_version();
+		body->set_shape(0, &sphere);
+		CHECK_MESSAGE(body->get_shapes_version() != version, "Replacing a shape should change the shapes version.");
+		version = body->get_shapes_version();
+		body->set_shape_disabled(0, true);
+		CHECK_MESSAGE(body->get_shapes_version() != version, "Disabling a shape should change the shapes version.");
+		version = body->get_shapes_version();
+		body->remove_shape(0);
+		CHECK_MESSAGE(body->get_shapes_version() != version, "Removing a shape should change the shapes version.");
+		memdelete(body);
+	}
+
+	SUBCASE("Swapping the shape of a resting body rebuilds its contacts") {
+		RID space = ps->space_create();
+		ps->space_set_active(space, true);
+
+		RID floor_shape = ps->box_shape_create();
+		ps->shape_set_data(floor_shape, Vector3(10, 1, 10));
+		RID box_shape = ps->box_shape_create();
+		ps->shape_set_data(box_shape, Vector3(0.5, 0.5, 0.5));
+		RID sphere_shape = ps->sphere_shape_create();
+		ps->shape_set_data(sphere_shape, 0.5);
+
+		RID floor = ps->body_create();
+		ps->body_set_mode(floor, PhysicsServer3D::BODY_MODE_STATIC);
+		ps->body_set_space(floor, space);
+		ps->body_add_shape(floor, floor_shape);
+		ps->body_set_state(floor, PhysicsServer3D::BODY_STATE_TRANSFORM, Transform3D(Basis(), Vector3(0, -1, 0)));
+
+		RID body = ps->body_create();
+		ps->body_set_mode(body, PhysicsServer3D::BODY_MODE_DYNAMIC);
+		ps->body_set_space(body, space);
+		ps->body_add_shape(body, box_shape);
+		ps->body_set_max_contacts_reported(body, 8);
+		ps->body_set_state(body, PhysicsServer3D::BODY_STATE_CAN_SLEEP, false);
+		ps->body_set_state(body, PhysicsServer3D::BODY_STATE_TRANSFORM, Transform3D(Basis(), Vector3(0, 0.5, 0)));
+
+		for (int i = 0; i < 60; i++) {
+			ps->step(1.0 / 60.0);
+		}
+		PhysicsDirectBodyState3D *state = ps->body_get_direct_state(body);
+		REQUIRE(state);
+		CHECK_MESSAGE(state->get_contact_count() == 4, "A box resting on its face should touch the floor with its four corners.");
+
+		// The sphere has the same height, so the body doesn't move and only the shape tells the manifolds apart.
+		ps->body_set_shape(body, 0, sphere_shape);
+		ps->step(1.0 / 60.0);
+		state = ps->body_get_direct_state(body);
+		REQUIRE(state);
+		CHECK_MESSAGE(state->get_contact_count() == 1, "A sphere should touch the floor at a single point.");
+		if (state->get_contact_count() > 0) {
+			const Vector3 contact = state->get_contact_local_position(0);
+			CHECK_MESSAGE(Vector2(contact.x, contact.z).length() < 0.01, "The contact should be right below the sphere, not at a corner of the box.");
+		}
+
+		ps->free(body);
+		ps->free(floor);
+		ps->free(floor_shape);
+		ps->free(box_shape);
+		ps->free(sphere_shape);
+		ps->free(space);
+	}
+
+	ps->finish();
+	memdelete(ps);
+}
+
+// Drops a small sphere fast enough to cross a thin static box within a single step, returns where it ends up.
+static Vector3 drop_through_thin_box(bool p_continuous_cd) {
+	PhysicsServer3DSW *ps = memnew(PhysicsServer3DSW);
+	ps->init();
+
+	RID space = ps->space_create();
+	ps->space_set_active(space, true);
+
+	RID wall_shape = ps->box_shape_create();
+	ps->shape_set_data(wall_shape, Vector3(2, 0.05, 2));
+	RID ball_shape = ps->sphere_shape_create();
+	ps->shape_set_data(ball_shape, 0.1);
+
+	RID wall = ps->body_create();
+	ps->body_set_mode(wall, PhysicsServer3D::BODY_MODE_STATIC);
+	ps->body_set_space(wall, space);
+	ps->body_add_shape(wall, wall_shape);
+
+	// Moves 1 unit per step, so it's above the wall after the first step and fully below it after the second one.
+	RID ball = ps->body_create();
+	ps->body_set_mode(ball, PhysicsServer3D::BODY_MODE_DYNAMIC);
+	ps->body_set_space(ball, space);
+	ps->body_add_shape(ball, ball_shape);
+	ps->body_set_enable_continuous_collision_detection(ball, p_continuous_cd);
+	ps->body_set_state(ball, PhysicsServer3D::BODY_STATE_CAN_SLEEP, false);
+	ps->body_set_state(ball, PhysicsServer3D::BODY_STATE_TRANSFORM, Transform3D(Basis(), Vector3(0, 1.5, 0)));
+	ps->body_set_state(ball, PhysicsServer3D::BODY_STATE_LINEAR_VELOCITY, Vector3(0, -60, 0));
+
+	for (int i = 0; i < 10; i++) {
+		ps->step(1.0 / 60.0);
+	}
+	const Vector3 position = Transform3D(ps->body_get_state(ball, PhysicsServer3D::BODY_STATE_TRANSFORM)).origin;
+
+	ps->free(ball);
+	ps->free(wall);
+	ps->free(ball_shape);
+	ps->free(wall_shape);
+	ps->free(space);
+	ps->finish();
+	memdelete(ps);
+
+	return position;
+}
+
+TEST_CASE("[Physics3D] Continuous collision detection stops fast bodies at thin obstacles") {
+	CHECK_MESSAGE(drop_through_thin_box(false).y < -0.15, "Without continuous collision detection, the sphere should tunnel through the wall.");
+
+	const Vector3 position = drop_through_thin_box(true);
+	CHECK_MESSAGE(position.y > 0.1, "The sphere should stop on top of the wall.");
+	CHECK_MESSAGE(position.y < 0.2, "The sphere should stop at the surface of the wall, not before it.");
+}
+
+} // namespace TestPhysicsContacts
+
+#endif // TEST_PHYSICS_CONTACTS_H
@@ -0,0 +1,182 @@
+/*************************************************************************/
+/*  test_physics_determinism.h                                           */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2021 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2021 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef TEST_PHYSICS_DETERMINISM_H
+#define TEST_PHYSICS_DETERMINISM_H
+
+#include "core/config/project_settings.h"
+#include "core/os/worker_thread_pool.h"
+#include "core/templates/hashfuncs.h"
+#include "servers/physics_3d/physics_server_3d_sw.h"
+
+#include "tests/test_macros.h"
+
+namespace TestPhysicsDeterminism {
+
+// Drops a pile of boxes and a fast sphere on a floor, and hashes the state of every body after each step.
+// The final transforms of the bodies are stored in `r_transforms`, if set.
+uint32_t simulate_3d(int p_steps, LocalVector<Transform3D> *r_transforms = nullptr) {
+	PhysicsServer3DSW *ps = memnew(PhysicsServer3DSW);
+	ps->init();
+
+	RID space = ps->space_create();
+	ps->space_set_active(space, true);
+
+	RID floor_shape = ps->box_shape_create();
+	ps->shape_set_data(floor_shape, Vector3(50, 1, 50));
+	RID box_shape = ps->box_shape_create();
+	ps->shape_set_data(box_shape, Vector3(0.5, 0.5, 0.5));
+	RID sphere_shape = ps->sphere_shape_create();
+	ps->shape_set_data(sphere_shape, 0.25);
+
+	RID floor = ps->body_create();
+	ps->body_set_mode(floor, PhysicsServer3D::BODY_MODE_STATIC);
+	ps->body_set_space(floor, space);
+	ps->body_add_shape(floor, floor_shape);
+	ps->body_set_state(floor, PhysicsServer3D::BODY_STATE_TRANSFORM, Transform3D(Basis(), Vector3(0, -1, 0)));
+
+	LocalVector<RID> bodies;
+	for (int y = 0; y < 6; y++) {
+		for (int x = 0; x < 4; x++) {
+			for (int z = 0; z < 4; z++) {
+				RID body = ps->body_create();
+				ps->body_set_mode(body, PhysicsServer3D::BODY_MODE_DYNAMIC);
+				ps->body_set_space(body, space);
+				ps->body_add_shape(body, box_shape);
+				Vector3 origin = Vector3(x * 1.01 + y * 0.1, 0.5 + y * 1.01, z * 1.01 - y * 0.05);
+				ps->body_set_state(body, PhysicsServer3D::BODY_STATE_TRANSFORM, Transform3D(Basis(Vector3(0, 1, 0), y * 0.1), origin));
+				bodies.push_back(body);
+			}
+		}
+	}
+
+	RID sphere = ps->body_create();
+	ps->body_set_mode(sphere, PhysicsServer3D::BODY_MODE_DYNAMIC);
+	ps->body_set_space(sphere, space);
+	ps->body_add_shape(sphere, sphere_shape);
+	ps->body_set_enable_continuous_collision_detection(sphere, true);
+	ps->body_set_state(sphere, PhysicsServer3D::BODY_STATE_TRANSFORM, Transform3D(Basis(), Vector3(-20, 1, 2)));
+	ps->body_set_state(sphere, PhysicsServer3D::BODY_STATE_LINEAR_VELOCITY, Vector3(200, 0, 0));
+	bodies.push_back(sphere);
+
+	uint32_t hash = 5381;
+	for (int i = 0; i < p_steps; i++) {
+		ps->step(1.0 / 60.0);
+		for (uint32_t j = 0; j < bodies.size(); j++) {
+			Transform3D transform = ps->body_get_state(bodies[j], PhysicsServer3D::BODY_STATE_TRANSFORM);
+			Vector3 linear_velocity = ps->body_get_state(bodies[j], PhysicsServer3D::BODY_STATE_LINEAR_VELOCITY);
+			Vector3 angular_velocity = ps->body_get_state(bodies[j], PhysicsServer3D::BODY_STATE_ANGULAR_VELOCITY);
+			hash = hash_djb2_buffer((const uint8_t *)&transform, sizeof(Transform3D), hash);
+			hash = hash_djb2_buffer((const uint8_t *)&linear_velocity, sizeof(Vector3), hash);
+			hash = hash_djb2_buffer((const uint8_t *)&angular_velocity, sizeof(Vector3), hash);
+		}
+	}
+
+	if (r_transforms) {
+		r_transforms->clear();
+		for (uint32_t j = 0; j < bodies.size(); j++) {
+			r_transforms->push_back(ps->body_get_state(bodies[j], PhysicsServer3D::BODY_STATE_TRANSFORM));
+		}
+	}
+
+	for (uint32_t j = 0; j < bodies.size(); j++) {
+		ps->free(bodies[j]);
+	}
+	ps->free(floor);
+	ps->free(floor_shape);
+	ps->free(box_shape);
+	ps->free(sphere_shape);
+	ps->free(space);
+
+	ps->finish();
+	memdelete(ps);
+
+	return hash;
+}
+
+TEST_CASE("[Physics3D] Deterministic spaces give the same results with any number of threads") {
+	ProjectSettings *project_settings = ProjectSettings::get_singleton();
+	const char *settings[] = { "physics/3d/solver/deterministic", "physics/3d/solver/large_island_threshold", "physics/3d/solver/batched_contact_solver" };
+	Variant previous_values[3];
+	for (int i = 0; i < 3; i++) {
+		// Restoring a nil value erases settings that weren't defined before.
+		previous_values[i] = project_settings->has_setting(settings[i]) ? project_settings->get_setting(settings[i]) : Variant();
+	}
+
+	// Small threshold so the pile is solved in parallel batches.
+	project_settings->set_setting("physics/3d/solver/deterministic", true);
+	project_settings->set_setting("physics/3d/solver/large_island_threshold", 16);
+
+	WorkerThreadPool *pool = WorkerThreadPool::get_singleton();
+	const int steps = 180;
+
+	pool->finish();
+	pool->init(0);
+	uint32_t no_threads_hash = simulate_3d(steps);
+
+	pool->finish();
+	pool->init(4);
+	LocalVector<Transform3D> transforms;
+	uint32_t threads_hash = simulate_3d(steps, &transforms);
+	uint32_t second_run_hash = simulate_3d(steps);
+
+	project_settings->set_setting("physics/3d/solver/batched_contact_solver", true);
+	LocalVector<Transform3D> batched_transforms;
+	uint32_t batched_hash = simulate_3d(steps, &batched_transforms);
+	uint32_t batched_second_run_hash = simulate_3d(steps);
+
+	pool->finish();
+	pool->init();
+
+	for (int i = 0; i < 3; i++) {
+		project_settings->set_setting(settings[i], previous_values[i]);
+	}
+
+	CHECK_MESSAGE(threads_hash == no_threads_hash, "Using threads shouldn't change the results.");
+	CHECK_MESSAGE(second_run_hash == threads_hash, "Running again shouldn't change the results.");
+	CHECK_MESSAGE(batched_second_run_hash == batched_hash, "Running again with batched contacts shouldn't change the results.");
+
+	// Batched contacts are solved in a different order, so the results aren't bit for bit the same, but the pile should settle the same way.
+	REQUIRE(batched_transforms.size() == transforms.size());
+	real_t max_distance = 0.0;
+	real_t max_basis_difference = 0.0;
+	for (uint32_t i = 0; i < transforms.size(); i++) {
+		max_distance = MAX(max_distance, transforms[i].origin.distance_to(batched_transforms[i].origin));
+		for (int j = 0; j < 3; j++) {
+			max_basis_difference = MAX(max_basis_difference, (transforms[i].basis[j] - batched_transforms[i].basis[j]).length());
+		}
+	}
+	CHECK_MESSAGE(max_distance < 0.01, vformat("Batched contacts moved a body %f away from where the regular solver put it.", max_distance));
+	CHECK_MESSAGE(max_basis_difference < 0.01, vformat("Batched contacts rotated a body differently than the regular solver, by up to %f.", max_basis_difference));
+}
+
+} // namespace TestPhysicsDeterminism
+
+#endif // TEST_PHYSICS_DETERMINISM_H
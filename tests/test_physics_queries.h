@@ -0,0 +1,145 @@
+/*************************************************************************/
+/*  test_physics_queries.h                                               */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2021 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2021 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef TEST_PHYSICS_QUERIES_H
+#define TEST_PHYSICS_QUERIES_H
+
+#include "core/os/worker_thread_pool.h"
+#include "servers/physics_3d/physics_server_3d_sw.h"
+
+#include "tests/test_macros.h"
+
+namespace TestPhysicsQueries {
+
+TEST_CASE("[Physics3D] Batched queries match single queries") {
+	PhysicsServer3DSW *ps = memnew(PhysicsServer3DSW);
+	ps->init();
+
+	RID space = ps->space_create();
+	ps->space_set_active(space, true);
+
+	RID box_shape = ps->box_shape_create();
+	ps->shape_set_data(box_shape, Vector3(0.5, 0.5, 0.5));
+	RID sphere_shape = ps->sphere_shape_create();
+	ps->shape_set_data(sphere_shape, 0.25);
+
+	// A grid of boxes with every other cell left empty.
+	LocalVector<RID> bodies;
+	for (int x = 0; x < 16; x++) {
+		for (int z = 0; z < 16; z++) {
+			if ((x + z) % 2) {
+				continue;
+			}
+			RID body = ps->body_create();
+			ps->body_set_mode(body, PhysicsServer3D::BODY_MODE_STATIC);
+			ps->body_set_space(body, space);
+			ps->body_add_shape(body, box_shape);
+			ps->body_set_state(body, PhysicsServer3D::BODY_STATE_TRANSFORM, Transform3D(Basis(), Vector3(x * 2, 0, z * 2)));
+			bodies.push_back(body);
+		}
+	}
+
+	// Stepping applies the pending shape updates, which puts the bodies in the broadphase.
+	ps->step(1.0 / 60.0);
+
+	PhysicsDirectSpaceState3D *space_state = ps->space_get_direct_state(space);
+
+	const int query_count = 512;
+	Vector<Vector3> from;
+	Vector<Vector3> to;
+	Vector<Transform3D> xforms;
+	for (int i = 0; i < query_count; i++) {
+		Vector3 origin = Vector3((i % 32) - 1, (i / 32) * 0.05 - 0.4, -2);
+		from.push_back(origin);
+		to.push_back(origin + Vector3(i % 7, 0, 40));
+		xforms.push_back(Transform3D(Basis(), origin));
+	}
+
+	// Enough threads to split the batches in several slices.
+	WorkerThreadPool *pool = WorkerThreadPool::get_singleton();
+	pool->finish();
+	pool->init(4);
+
+	Vector<PhysicsDirectSpaceState3D::RayResult> results;
+	results.resize(query_count);
+	int hit_count = space_state->intersect_rays(from.ptr(), to.ptr(), query_count, results.ptrw());
+
+	int expected_hit_count = 0;
+	bool rays_match = true;
+	for (int i = 0; i < query_count; i++) {
+		PhysicsDirectSpaceState3D::RayResult expected;
+		if (space_state->intersect_ray(from[i], to[i], expected)) {
+			expected_hit_count++;
+			rays_match = rays_match && results[i].rid == expected.rid && results[i].position == expected.position && results[i].normal == expected.normal;
+		} else {
+			rays_match = rays_match && !results[i].rid.is_valid();
+		}
+	}
+	CHECK_MESSAGE(hit_count > 0, "Some rays should hit the boxes.");
+	CHECK_MESSAGE(hit_count < query_count, "Some rays should miss the boxes.");
+	CHECK(hit_count == expected_hit_count);
+	CHECK_MESSAGE(rays_match, "Batched rays should hit the same points as single rays.");
+
+	Vector<real_t> closest_safe;
+	closest_safe.resize(query_count);
+	Vector<real_t> closest_unsafe;
+	closest_unsafe.resize(query_count);
+	Vector<Vector3> motions;
+	for (int i = 0; i < query_count; i++) {
+		motions.push_back(to[i] - from[i]);
+	}
+	space_state->cast_motions(sphere_shape, xforms.ptr(), motions.ptr(), query_count, 0.0, closest_safe.ptrw(), closest_unsafe.ptrw());
+
+	pool->finish();
+	pool->init();
+
+	bool casts_match = true;
+	for (int i = 0; i < query_count; i++) {
+		real_t expected_safe = 1.0;
+		real_t expected_unsafe = 1.0;
+		space_state->cast_motion(sphere_shape, xforms[i], motions[i], 0.0, expected_safe, expected_unsafe);
+		casts_match = casts_match && closest_safe[i] == expected_safe && closest_unsafe[i] == expected_unsafe;
+	}
+	CHECK_MESSAGE(casts_match, "Batched shape casts should stop at the same fractions as single casts.");
+
+	for (uint32_t i = 0; i < bodies.size(); i++) {
+		ps->free(bodies[i]);
+	}
+	ps->free(box_shape);
+	ps->free(sphere_shape);
+	ps->free(space);
+
+	ps->finish();
+	memdelete(ps);
+}
+
+} // namespace TestPhysicsQueries
+
+#endif // TEST_PHYSICS_QUERIES_H
@@ -0,0 +1,491 @@
+/*************************************************************************/
+/*  test_render_benchmark.h                                              */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2021 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2021 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef TEST_RENDER_BENCHMARK_H
+#define TEST_RENDER_BENCHMARK_H
+
+#include "core/os/os.h"
+#include "core/string/print_string.h"
+#include "core/templates/hashfuncs.h"
+#include "core/templates/ordered_hash_map.h"
+#include "servers/rendering/rasterizer_dummy.h"
+#include "servers/rendering/rendering_server_default.h"
+#include "servers/rendering/rendering_server_globals.h"
+
+#include "tests/test_macros.h"
+
+// Headless benchmark of the CPU side of the rendering server, using the dummy rasterizer so it runs without a GPU.
+// Each scene is drawn for a few hundred frames through `RenderingServer::draw()`, and the time between the frame
+// profiling timestamps of the server is reported per stage. "Frame Begin" covers the instance updates.
+// Run all scenes with `godot --test render-benchmark`, or only some of them by adding their names.
+
+namespace TestRenderBenchmark {
+
+const int FRAME_COUNT = 300;
+const Size2i VIEWPORT_SIZE = Size2i(1280, 720);
+const int GRID_SIZE = 128; // along each side
+
+// The dummy storage doesn't keep anything, so the scene cull would see no meshes or lights at all.
+// This keeps just what culling needs, and records CPU timestamps for the frame profile.
+class BenchmarkStorage : public RasterizerStorageDummy {
+	struct BenchmarkMesh {
+		AABB aabb;
+		int surface_count = 0;
+	};
+
+	struct BenchmarkLight {
+		RS::LightType type = RS::LIGHT_OMNI;
+		float param[RS::LIGHT_PARAM_MAX] = {};
+	};
+
+	mutable RID_Owner<BenchmarkMesh> mesh_owner;
+	mutable RID_Owner<BenchmarkLight> light_owner;
+	mutable RID_Owner<Size2i> render_target_owner;
+
+	LocalVector<String> timestamp_names;
+	LocalVector<uint64_t> timestamp_times;
+	uint64_t timestamp_frame = 0;
+
+	RID _light_allocate() {
+		return light_owner.allocate_rid();
+	}
+
+	void _light_initialize(RID p_rid, RS::LightType p_type) {
+		BenchmarkLight light;
+		light.type = p_type;
+		light.param[RS::LIGHT_PARAM_ENERGY] = 1.0;
+		light.param[RS::LIGHT_PARAM_RANGE] = 1.0;
+		light.param[RS::LIGHT_PARAM_SPOT_ANGLE] = 45;
+		light_owner.initialize_rid(p_rid, light);
+	}
+
+public:
+	RID mesh_allocate() override { return mesh_owner.allocate_rid(); }
+	void mesh_initialize(RID p_rid) override { mesh_owner.initialize_rid(p_rid, BenchmarkMesh()); }
+	void mesh_add_surface(RID p_mesh, const RS::SurfaceData &p_surface) override {
+		BenchmarkMesh *mesh = mesh_owner.getornull(p_mesh);
+		ERR_FAIL_COND(!mesh);
+		mesh->aabb = mesh->surface_count == 0 ? p_surface.aabb : mesh->aabb.merge(p_surface.aabb);
+		mesh->surface_count++;
+	}
+	int mesh_get_surface_count(RID p_mesh) const override {
+		const BenchmarkMesh *mesh = mesh_owner.getornull(p_mesh);
+		ERR_FAIL_COND_V(!mesh, 0);
+		return mesh->surface_count;
+	}
+	AABB mesh_get_aabb(RID p_mesh, RID p_skeleton = RID()) override {
+		const BenchmarkMesh *mesh = mesh_owner.getornull(p_mesh);
+		ERR_FAIL_COND_V(!mesh, AABB());
+		return mesh->aabb;
+	}
+
+	RID omni_light_allocate() override { return _light_allocate(); }
+	void omni_light_initialize(RID p_rid) override { _light_initialize(p_rid, RS::LIGHT_OMNI); }
+	RID spot_light_allocate() override { return _light_allocate(); }
+	void spot_light_initialize(RID p_rid) override { _light_initialize(p_rid, RS::LIGHT_SPOT); }
+	void light_set_param(RID p_light, RS::LightParam p_param, float p_value) override {
+		BenchmarkLight *light = light_owner.getornull(p_light);
+		ERR_FAIL_COND(!light);
+		ERR_FAIL_INDEX(p_param, RS::LIGHT_PARAM_MAX);
+		light->param[p_param] = p_value;
+	}
+	RS::LightType light_get_type(RID p_light) const override {
+		const BenchmarkLight *light = light_owner.getornull(p_light);
+		ERR_FAIL_COND_V(!light, RS::LIGHT_OMNI);
+		return light->type;
+	}
+	float light_get_param(RID p_light, RS::LightParam p_param) override {
+		const BenchmarkLight *light = light_owner.getornull(p_light);
+		ERR_FAIL_COND_V(!light, 0.0);
+		ERR_FAIL_INDEX_V(p_param, RS::LIGHT_PARAM_MAX, 0.0);
+		return light->param[p_param];
+	}
+	AABB light_get_aabb(RID p_light) const override {
+		const BenchmarkLight *light = light_owner.getornull(p_light);
+		ERR_FAIL_COND_V(!light, AABB());
+		float range = light->param[RS::LIGHT_PARAM_RANGE];
+		if (light->type == RS::LIGHT_SPOT) {
+			float size = Math::tan(Math::deg2rad(light->param[RS::LIGHT_PARAM_SPOT_ANGLE])) * range;
+			return AABB(Vector3(-size, -size, -range), Vector3(size * 2, size * 2, range));
+		}
+		return AABB(-Vector3(range, range, range), Vector3(range, range, range) * 2);
+	}
+	Color light_get_color(RID p_light) override { return Color(1, 1, 1); }
+
+	// Viewports without a render target are skipped.
+	RID render_target_create() override { return render_target_owner.make_rid(Size2i()); }
+	void render_target_set_size(RID p_render_target, int p_width, int p_height, uint32_t p_view_count) override {
+		Size2i *size = render_target_owner.getornull(p_render_target);
+		ERR_FAIL_COND(!size);
+		*size = Size2i(p_width, p_height);
+	}
+
+	RS::InstanceType get_base_type(RID p_rid) const override {
+		if (mesh_owner.owns(p_rid)) {
+			return RS::INSTANCE_MESH;
+		} else if (light_owner.owns(p_rid)) {
+			return RS::INSTANCE_LIGHT;
+		}
+		return RS::INSTANCE_NONE;
+	}
+	bool free(RID p_rid) override {
+		if (mesh_owner.owns(p_rid)) {
+			mesh_owner.free(p_rid);
+		} else if (light_owner.owns(p_rid)) {
+			light_owner.free(p_rid);
+		} else if (render_target_owner.owns(p_rid)) {
+			render_target_owner.free(p_rid);
+		} else {
+			return RasterizerStorageDummy::free(p_rid);
+		}
+		return true;
+	}
+
+	void capture_timestamps_begin() override {
+		timestamp_names.clear();
+		timestamp_times.clear();
+		timestamp_frame++;
+		capture_timestamp("Frame Begin");
+	}
+	void capture_timestamp(const String &p_name) override {
+		timestamp_names.push_back(p_name);
+		timestamp_times.push_back(OS::get_singleton()->get_ticks_usec());
+	}
+	uint32_t get_captured_timestamps_count() const override { return timestamp_names.size(); }
+	uint64_t get_captured_timestamps_frame() const override { return timestamp_frame; }
+	uint64_t get_captured_timestamp_gpu_time(uint32_t p_index) const override { return 0; }
+	uint64_t get_captured_timestamp_cpu_time(uint32_t p_index) const override {
+		ERR_FAIL_UNSIGNED_INDEX_V(p_index, timestamp_times.size(), 0);
+		return timestamp_times[p_index];
+	}
+	String get_captured_timestamp_name(uint32_t p_index) const override {
+		ERR_FAIL_UNSIGNED_INDEX_V(p_index, timestamp_names.size(), String());
+		return timestamp_names[p_index];
+	}
+};
+
+// Pairs lights with geometry like the real renderers, and counts what reaches the scene render.
+class BenchmarkSceneRender : public RasterizerSceneDummy {
+public:
+	uint64_t instance_count = 0;
+	uint64_t light_count = 0;
+
+	uint32_t geometry_instance_get_pair_mask() override { return (1 << RS::INSTANCE_LIGHT); }
+
+	void render_scene(RID p_render_buffers, const CameraData *p_camera_data, const PagedArray<GeometryInstance *> &p_instances, const PagedArray<RID> &p_lights, const PagedArray<RID> &p_reflection_probes, const PagedArray<RID> &p_voxel_gi_instances, const PagedArray<RID> &p_decals, const PagedArray<RID> &p_lightmaps, RID p_environment, RID p_camera_effects, RID p_shadow_atlas, RID p_occluder_debug_tex, RID p_reflection_atlas, RID p_reflection_probe, int p_reflection_probe_pass, float p_screen_lod_threshold, const RenderShadowData *p_render_shadows, int p_render_shadow_count, const RenderSDFGIData *p_render_sdfgi_regions, int p_render_sdfgi_region_count, const RenderSDFGIUpdateData *p_sdfgi_update_data = nullptr, RendererScene::RenderInfo *r_info = nullptr) override {
+		instance_count += p_instances.size();
+		light_count += p_lights.size();
+	}
+};
+
+class BenchmarkCanvasRender : public RasterizerCanvasDummy {
+public:
+	uint64_t item_count = 0;
+
+	void canvas_render_items(RID p_to_render_target, Item *p_item_list, const Color &p_modulate, Light *p_light_list, Light *p_directional_list, const Transform2D &p_canvas_transform, RS::CanvasItemTextureFilter p_default_filter, RS::CanvasItemTextureRepeat p_default_repeat, bool p_snap_2d_vertices_to_pixel, bool &r_sdf_used) override {
+		for (Item *item = p_item_list; item; item = item->next) {
+			item_count++;
+		}
+		r_sdf_used = false;
+	}
+};
+
+class BenchmarkRasterizer : public RasterizerDummy {
+public:
+	BenchmarkStorage benchmark_storage;
+	BenchmarkSceneRender benchmark_scene;
+	BenchmarkCanvasRender benchmark_canvas;
+
+	RendererStorage *get_storage() override { return &benchmark_storage; }
+	RendererCanvasRender *get_canvas() override { return &benchmark_canvas; }
+	RendererSceneRender *get_scene() override { return &benchmark_scene; }
+
+	static RendererCompositor *_create_current() {
+		return memnew(BenchmarkRasterizer);
+	}
+
+	static void make_current() {
+		_create_func = _create_current;
+	}
+};
+
+struct Scene {
+	RenderingServer *rs = nullptr;
+	RID scenario;
+	RID camera;
+	RID canvas;
+	RID mesh;
+	LocalVector<RID> rids; // Freed in reverse order once the scene is done.
+	int instance_count = 0;
+	int light_count = 0;
+	int canvas_item_count = 0;
+
+	RID add_mesh_instance(const Vector3 &p_position) {
+		RID instance = rs->instance_create2(mesh, scenario);
+		rs->instance_set_transform(instance, Transform3D(Basis(), p_position));
+		rids.push_back(instance);
+		instance_count++;
+		return instance;
+	}
+
+	RID add_omni_light(const Vector3 &p_position, float p_range) {
+		RID light = rs->omni_light_create();
+		rs->light_set_param(light, RS::LIGHT_PARAM_RANGE, p_range);
+		rids.push_back(light);
+		RID instance = rs->instance_create2(light, scenario);
+		rs->instance_set_transform(instance, Transform3D(Basis(), p_position));
+		rids.push_back(instance);
+		light_count++;
+		return instance;
+	}
+
+	RID add_canvas_item(RID p_parent, const Point2 &p_position, const Size2 &p_size = Size2()) {
+		RID item = rs->canvas_item_create();
+		rs->canvas_item_set_parent(item, p_parent);
+		rs->canvas_item_set_transform(item, Transform2D(0, p_position));
+		if (p_size != Size2()) {
+			rs->canvas_item_add_rect(item, Rect2(Point2(), p_size), Color(1, 1, 1));
+		}
+		rids.push_back(item);
+		canvas_item_count++;
+		return item;
+	}
+
+	// A grid of cubes on the ground, one unit apart.
+	void add_mesh_grid(int p_size) {
+		for (int z = 0; z < p_size; z++) {
+			for (int x = 0; x < p_size; x++) {
+				add_mesh_instance(_grid_position(x, z, p_size));
+			}
+		}
+	}
+
+	static Vector3 _grid_position(int p_x, int p_z, int p_size) {
+		return Vector3(p_x - p_size / 2, 0, p_z - p_size / 2) * 2;
+	}
+
+	virtual void create() = 0;
+	virtual void update(int p_frame) {}
+	virtual Transform3D get_camera(int p_frame) {
+		// Circle around the middle of the grid, looking outwards and down.
+		real_t angle = p_frame * Math_TAU / FRAME_COUNT;
+		return Transform3D(Basis(Vector3(0, 1, 0), angle) * Basis(Vector3(1, 0, 0), -0.5), Vector3(0, 20, 0));
+	}
+	virtual Transform2D get_canvas_transform(int p_frame) {
+		return Transform2D();
+	}
+
+	virtual ~Scene() {}
+};
+
+// Static cubes, only the camera moves.
+struct StaticMeshesScene : public Scene {
+	virtual void create() override {
+		add_mesh_grid(GRID_SIZE);
+	}
+};
+
+// The same cubes, an eighth of which move every frame.
+struct MovingMeshesScene : public Scene {
+	virtual void create() override {
+		add_mesh_grid(GRID_SIZE);
+	}
+
+	virtual void update(int p_frame) override {
+		for (int i = p_frame % 8; i < instance_count; i += 8) {
+			Vector3 position = _grid_position(i % GRID_SIZE, i / GRID_SIZE, GRID_SIZE);
+			position.y = Math::sin(p_frame * 0.1 + i) * 4;
+			rs->instance_set_transform(rids[i], Transform3D(Basis(), position));
+		}
+	}
+};
+
+// Fewer cubes lit by many omni lights, a sixteenth of which move every frame.
+struct OmniLightsScene : public Scene {
+	LocalVector<RID> lights;
+
+	virtual void create() override {
+		add_mesh_grid(GRID_SIZE / 2);
+		for (int i = 0; i < 1024; i++) {
+			lights.push_back(add_omni_light(_light_position(i, 0), 8));
+		}
+	}
+
+	virtual void update(int p_frame) override {
+		for (uint32_t i = p_frame % 16; i < lights.size(); i += 16) {
+			rs->instance_set_transform(lights[i], Transform3D(Basis(), _light_position(i, p_frame)));
+		}
+	}
+
+	static Vector3 _light_position(int p_index, int p_frame) {
+		// Scattered over the grid without a pattern.
+		uint32_t h = hash_djb2_one_32(p_index);
+		real_t angle = p_frame * 0.05 + p_index;
+		return Vector3(int(h % GRID_SIZE) - GRID_SIZE / 2, 2, int((h / GRID_SIZE) % GRID_SIZE) - GRID_SIZE / 2) + Vector3(Math::cos(angle), 0, Math::sin(angle)) * 4;
+	}
+};
+
+// Sprites in a 2D canvas drawn on top of the viewport, scrolled across every frame.
+struct CanvasItemsScene : public Scene {
+	virtual void create() override {
+		RID level = add_canvas_item(canvas, Point2());
+		for (int i = 0; i < 16384; i++) {
+			uint32_t h = hash_djb2_one_32(i);
+			add_canvas_item(level, Point2(h % 4096, (h / 4096) % 4096), Size2(32, 32));
+		}
+	}
+
+	virtual Transform2D get_canvas_transform(int p_frame) override {
+		return Transform2D(0, -Vector2(p_frame * 11, p_frame * 7));
+	}
+};
+
+static void run_scene(const char *p_name, Scene *p_scene) {
+	RenderingServer *rs = RenderingServer::get_singleton();
+	BenchmarkRasterizer *rasterizer = static_cast<BenchmarkRasterizer *>(RSG::rasterizer);
+
+	p_scene->rs = rs;
+	p_scene->scenario = rs->scenario_create();
+	p_scene->camera = rs->camera_create();
+	rs->camera_set_perspective(p_scene->camera, 70, 0.05, 200);
+	p_scene->canvas = rs->canvas_create();
+
+	p_scene->mesh = rs->mesh_create();
+	RS::SurfaceData surface;
+	surface.primitive = RS::PRIMITIVE_TRIANGLES;
+	surface.vertex_count = 36;
+	surface.aabb = AABB(Vector3(-0.5, -0.5, -0.5), Vector3(1, 1, 1));
+	rs->mesh_add_surface(p_scene->mesh, surface);
+
+	RID viewport = rs->viewport_create();
+	rs->viewport_set_size(viewport, VIEWPORT_SIZE.width, VIEWPORT_SIZE.height);
+	rs->viewport_set_update_mode(viewport, RS::VIEWPORT_UPDATE_ALWAYS);
+	rs->viewport_set_scenario(viewport, p_scene->scenario);
+	rs->viewport_attach_camera(viewport, p_scene->camera);
+	rs->viewport_attach_canvas(viewport, p_scene->canvas);
+	rs->viewport_set_active(viewport, true);
+
+	p_scene->create();
+
+	rasterizer->benchmark_scene.instance_count = 0;
+	rasterizer->benchmark_scene.light_count = 0;
+	rasterizer->benchmark_canvas.item_count = 0;
+
+	OrderedHashMap<String, double> stage_times;
+	uint64_t draw_time = 0;
+	uint64_t first_frame_time = 0;
+
+	for (int frame = 0; frame < FRAME_COUNT; frame++) {
+		p_scene->update(frame);
+		rs->camera_set_transform(p_scene->camera, p_scene->get_camera(frame));
+		rs->viewport_set_canvas_transform(viewport, p_scene->canvas, p_scene->get_canvas_transform(frame));
+
+		uint64_t draw_begin_time = OS::get_singleton()->get_ticks_usec();
+		rs->draw(false, 1.0 / 60.0);
+		uint64_t frame_time = OS::get_singleton()->get_ticks_usec() - draw_begin_time;
+
+		// The first frame inserts everything in the culling structures, report it separately.
+		if (frame == 0) {
+			first_frame_time = frame_time;
+			continue;
+		}
+		draw_time += frame_time;
+
+		// Each stage lasts until the next timestamp, the last one until the end of the frame.
+		Vector<RS::FrameProfileArea> profile = rs->get_frame_profile();
+		for (int i = 0; i < profile.size(); i++) {
+			double end = i + 1 < profile.size() ? profile[i + 1].cpu_msec : frame_time / 1000.0;
+			double time = MAX(end - profile[i].cpu_msec, 0.0);
+			OrderedHashMap<String, double>::Element E = stage_times.find(profile[i].name);
+			if (E) {
+				E.value() += time;
+			} else {
+				stage_times.insert(profile[i].name, time);
+			}
+		}
+	}
+
+	const int measured_frames = FRAME_COUNT - 1;
+	print_line(vformat("%s: %d instances, %d lights, %d canvas items, %d frames,", p_name, p_scene->instance_count, p_scene->light_count, p_scene->canvas_item_count, FRAME_COUNT) +
+			vformat(" %.3f ms first frame, %.3f ms/frame,", first_frame_time / 1000.0, draw_time / 1000.0 / measured_frames) +
+			vformat(" %.1f instances, %.1f lights, %.1f canvas items drawn/frame.", (double)rasterizer->benchmark_scene.instance_count / FRAME_COUNT, (double)rasterizer->benchmark_scene.light_count / FRAME_COUNT, (double)rasterizer->benchmark_canvas.item_count / FRAME_COUNT));
+	for (OrderedHashMap<String, double>::Element E = stage_times.front(); E; E = E.next()) {
+		print_line(vformat("\t%s: %.3f ms/frame", E.key(), E.value() / measured_frames));
+	}
+
+	rs->free(viewport);
+	for (int i = p_scene->rids.size() - 1; i >= 0; i--) {
+		rs->free(p_scene->rids[i]);
+	}
+	rs->free(p_scene->mesh);
+	rs->free(p_scene->canvas);
+	rs->free(p_scene->camera);
+	rs->free(p_scene->scenario);
+}
+
+static void benchmark() {
+	List<String> args = OS::get_singleton()->get_cmdline_args();
+
+	BenchmarkRasterizer::make_current();
+	RenderingServer *rs = memnew(RenderingServerDefault(false));
+	rs->init();
+	rs->set_frame_profiling_enabled(true);
+
+	struct {
+		const char *name;
+		Scene *scene;
+	} scenes[] = {
+		{ "static_meshes", memnew(StaticMeshesScene) },
+		{ "moving_meshes", memnew(MovingMeshesScene) },
+		{ "omni_lights", memnew(OmniLightsScene) },
+		{ "canvas_items", memnew(CanvasItemsScene) },
+	};
+
+	bool run_all = true;
+	for (const auto &scene : scenes) {
+		run_all = run_all && !args.find(scene.name);
+	}
+
+	for (const auto &scene : scenes) {
+		if (run_all || args.find(scene.name)) {
+			run_scene(scene.name, scene.scene);
+		}
+		memdelete(scene.scene);
+	}
+
+	rs->finish();
+	memdelete(rs);
+}
+
+REGISTER_TEST_COMMAND("render-benchmark", &benchmark);
+
+} // namespace TestRenderBenchmark
+
+#endif // TEST_RENDER_BENCHMARK_H
@@ -0,0 +1,113 @@
+/*************************************************************************/
+/*  test_scene_cull_bounds.h                                             */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2021 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2021 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+
+#ifndef TEST_SCENE_CULL_BOUNDS_H
+#define TEST_SCENE_CULL_BOUNDS_H
+
+#include "core/math/camera_matrix.h"
+#include "core/math/random_pcg.h"
+#include "servers/rendering/renderer_scene_cull_bounds.h"
+
+#include "tests/test_macros.h"
+
+namespace TestSceneCullBounds {
+
+static bool in_planes(const AABB &p_aabb, const Vector<Plane> &p_planes) {
+	for (int i = 0; i < p_planes.size(); i++) {
+		const Plane &p = p_planes[i];
+		Vector3 corner(
+				p.normal.x > 0 ? p_aabb.position.x : p_aabb.position.x + p_aabb.size.x,
+				p.normal.y > 0 ? p_aabb.position.y : p_aabb.position.y + p_aabb.size.y,
+				p.normal.z > 0 ? p_aabb.position.z : p_aabb.position.z + p_aabb.size.z);
+		if (p.distance_to(corner) >= 0.0) {
+			return false;
+		}
+	}
+	return true;
+}
+
+TEST_CASE("[SceneCullBounds] Block culling matches culling each instance") {
+	RandomPCG rng(5678);
+	RendererSceneCullBounds bounds;
+	LocalVector<AABB> aabbs;
+	LocalVector<uint32_t> layers;
+
+	// Remove some instances like the scenario does, so copied and popped slots are tested too.
+	for (int i = 0; i < 1000; i++) {
+		if (aabbs.size() && rng.randf() < 0.25) {
+			uint32_t index = rng.rand() % aabbs.size();
+			uint32_t last = aabbs.size() - 1;
+			if (index != last) {
+				bounds.copy(index, last);
+				aabbs[index] = aabbs[last];
+				layers[index] = layers[last];
+			}
+			bounds.pop_back();
+			aabbs.resize(last);
+			layers.resize(last);
+		} else {
+			AABB aabb(Vector3(rng.random(-100.0, 100.0), rng.random(-100.0, 100.0), rng.random(-100.0, 100.0)), Vector3(rng.random(0.0, 10.0), rng.random(0.0, 10.0), rng.random(0.0, 10.0)));
+			uint32_t layer = 1 << (rng.rand() % 4);
+			bounds.push_back(aabb, layer);
+			aabbs.push_back(aabb);
+			layers.push_back(layer);
+		}
+	}
+	REQUIRE(bounds.size() == aabbs.size());
+
+	for (int f = 0; f < 16; f++) {
+		CameraMatrix cm;
+		cm.set_perspective(rng.random(30.0, 90.0), rng.random(0.5, 2.0), 0.05, rng.random(20.0, 200.0));
+		Transform3D xform;
+		xform.origin = Vector3(rng.random(-50.0, 50.0), rng.random(-50.0, 50.0), rng.random(-50.0, 50.0));
+		xform.basis = Basis(Vector3(rng.random(-1.0, 1.0), rng.random(-1.0, 1.0), rng.random(-1.0, 1.0)).normalized(), rng.random(0.0, Math_TAU));
+		Vector<Plane> planes = cm.get_projection_planes(xform);
+		uint32_t visible_layers = f % 2 ? 0xFFFFFFFF : 0x5;
+
+		uint32_t mismatches = 0;
+		uint32_t inside = 0;
+		for (uint32_t i = 0; i < aabbs.size(); i++) {
+			uint32_t mask = bounds.cull_block(i / RendererSceneCullBounds::BLOCK_SIZE, planes.ptr(), planes.size(), visible_layers);
+			bool block_inside = mask & (1 << (i % RendererSceneCullBounds::BLOCK_SIZE));
+			bool expected_inside = (layers[i] & visible_layers) && in_planes(aabbs[i], planes);
+			mismatches += block_inside != expected_inside;
+			inside += expected_inside;
+		}
+		CHECK_MESSAGE(mismatches == 0, "Instances culled by block should match instances culled one by one.");
+		if (f == 1) {
+			CHECK_MESSAGE(inside > 0, "The test frustum should contain some instances.");
+		}
+	}
+}
+
+} // namespace TestSceneCullBounds
+
+#endif // TEST_SCENE_CULL_BOUNDS_H
@@ -0,0 +1,100 @@
+/*************************************************************************/
+/*  test_worker_thread_pool.h                                            */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2021 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2021 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef TEST_WORKER_THREAD_POOL_H
+#define TEST_WORKER_THREAD_POOL_H
+
+#include "core/os/worker_thread_pool.h"
+
+#include "tests/test_macros.h"
+
+namespace TestWorkerThreadPool {
+
+class Counter {
+public:
+	std::atomic<uint64_t> sum;
+	LocalVector<uint32_t> order;
+	BinaryMutex order_mutex;
+
+	void add_index(uint32_t p_index, uint32_t p_multiplier) {
+		sum.fetch_add(p_index * p_multiplier);
+	}
+
+	void nested(uint32_t p_index, uint32_t p_elements) {
+		WorkerThreadPool::get_singleton()->do_work(p_elements, this, &Counter::add_index, 1u);
+	}
+
+	void record(uint32_t p_value) {
+		MutexLock lock(order_mutex);
+		order.push_back(p_value);
+	}
+
+	Counter() {
+		sum.store(0);
+	}
+};
+
+TEST_CASE("[WorkerThreadPool] Group task visits every element once") {
+	Counter counter;
+	WorkerThreadPool::get_singleton()->do_work(1000, &counter, &Counter::add_index, 2u);
+	CHECK(counter.sum.load() == 999000);
+
+	WorkerThreadPool::GroupID group = WorkerThreadPool::get_singleton()->add_template_group_task(&counter, &Counter::add_index, 1u, 100);
+	WorkerThreadPool::get_singleton()->wait_for_group_task_completion(group);
+	CHECK(counter.sum.load() == 999000 + 4950);
+}
+
+TEST_CASE("[WorkerThreadPool] Nested group tasks do not deadlock") {
+	Counter counter;
+	const uint32_t outer = WorkerThreadPool::get_singleton()->get_thread_count() * 4;
+	WorkerThreadPool::get_singleton()->do_work(outer, &counter, &Counter::nested, 100u);
+	CHECK(counter.sum.load() == outer * 4950);
+}
+
+TEST_CASE("[WorkerThreadPool] Task dependencies are respected") {
+	Counter counter;
+	WorkerThreadPool::TaskID first = WorkerThreadPool::get_singleton()->add_template_task(&counter, &Counter::record, 1u);
+	WorkerThreadPool::TaskID second = WorkerThreadPool::get_singleton()->add_template_task(&counter, &Counter::record, 2u, &first, 1);
+	WorkerThreadPool::TaskID third = WorkerThreadPool::get_singleton()->add_template_task(&counter, &Counter::record, 3u, &second, 1);
+
+	WorkerThreadPool::get_singleton()->wait_for_task_completion(third);
+	CHECK(WorkerThreadPool::get_singleton()->is_task_completed(first));
+	WorkerThreadPool::get_singleton()->wait_for_task_completion(second);
+	WorkerThreadPool::get_singleton()->wait_for_task_completion(first);
+
+	REQUIRE(counter.order.size() == 3);
+	CHECK(counter.order[0] == 1);
+	CHECK(counter.order[1] == 2);
+	CHECK(counter.order[2] == 3);
+}
+
+} // namespace TestWorkerThreadPool
+
+#endif // TEST_WORKER_THREAD_POOL_H